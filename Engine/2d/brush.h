@@ -27,6 +27,7 @@ class Brush {
     Tempest::Color              color;
     PaintDevice::Blend          blend = PaintDevice::NoBlend;
     ClampMode                   clamp = ClampMode::Repeat;
+    bool                        sdf   = false;
 
     struct Info {
       int      w=0,h=0;
@@ -0,0 +1,89 @@
+#include "drawbatcher.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+bool DrawBatcher::overlaps(const Open& b, const Item& it) {
+  // touching counts as overlap: shared edges may rasterize to the same pixels
+  return b.x0<=it.x1+it.padX && it.x0-it.padX<=b.x1 &&
+         b.y0<=it.y1+it.padY && it.y0-it.padY<=b.y1;
+  }
+
+void DrawBatcher::build(const std::vector<Item>& items) {
+  open.clear();
+  batch.clear();
+  ord.clear();
+  next.assign(items.size(),size_t(-1));
+  reordered = false;
+
+  for(size_t i=0; i<items.size(); ++i) {
+    auto& it = items[i];
+    if(it.size==0)
+      continue;
+
+    size_t target = size_t(-1);
+    size_t stop   = open.size()>MaxLookBehind ? open.size()-MaxLookBehind : 0;
+    for(size_t r=open.size(); r>stop;) {
+      --r;
+      if(open[r].key==it.key) {
+        target = r;
+        break;
+        }
+      if(overlaps(open[r],it))
+        break;
+      }
+
+    if(target==size_t(-1)) {
+      Open b;
+      b.key  = it.key;
+      b.head = i;
+      b.tail = i;
+      b.x0   = it.x0-it.padX;
+      b.y0   = it.y0-it.padY;
+      b.x1   = it.x1+it.padX;
+      b.y1   = it.y1+it.padY;
+      open.push_back(b);
+      target = open.size()-1;
+      } else {
+      auto& b = open[target];
+      next[b.tail] = i;
+      b.tail = i;
+      b.x0   = std::min(b.x0,it.x0-it.padX);
+      b.y0   = std::min(b.y0,it.y0-it.padY);
+      b.x1   = std::max(b.x1,it.x1+it.padX);
+      b.y1   = std::max(b.y1,it.y1+it.padY);
+      }
+    open[target].count++;
+    open[target].size += it.size;
+    }
+
+  // flatten, and check if vertex ranges of every batch are already adjacent
+  batch.resize(open.size());
+  for(size_t i=0; i<open.size(); ++i) {
+    auto& b = open[i];
+    auto& r = batch[i];
+    r.key   = b.key;
+    r.first = ord.size();
+    r.count = b.count;
+    r.begin = items[b.head].begin;
+    r.size  = b.size;
+
+    size_t end = items[b.head].begin;
+    for(size_t id=b.head; id!=size_t(-1); id=next[id]) {
+      if(items[id].begin!=end)
+        reordered = true;
+      end = items[id].begin+items[id].size;
+      ord.push_back(id);
+      }
+    }
+
+  if(reordered) {
+    size_t offset = 0;
+    for(auto& r:batch) {
+      r.begin = offset;
+      offset += r.size;
+      }
+    }
+  }
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Tempest {
+namespace Detail {
+
+// Groups draw ranges with the same state into batches.
+// Range may be moved back to an earlier batch, only if it does not overlap anything drawn in between,
+// so result is pixel-identical to drawing ranges in submission order.
+class DrawBatcher final {
+  public:
+    enum : size_t {
+      MaxLookBehind = 16,
+      };
+
+    struct Item {
+      uint32_t key   = 0; // draw-state id; items with same key can share a draw call
+      size_t   begin = 0;
+      size_t   size  = 0;
+      float    x0 = 0, y0 = 0;
+      float    x1 = 0, y1 = 0;
+      // rasterization may cover pixels past vertex bbox by that much (lines); bbox is inflated by it
+      float    padX = 0, padY = 0;
+      };
+
+    struct Batch {
+      uint32_t key   = 0;
+      size_t   first = 0; // first item in order()
+      size_t   count = 0;
+      size_t   begin = 0; // vertex offset; in batched stream, if isReordered()
+      size_t   size  = 0;
+      };
+
+    void build(const std::vector<Item>& items);
+
+    const std::vector<Batch>&  batches()     const { return batch;     }
+    const std::vector<size_t>& order()       const { return ord;       }
+    // true, if vertices have to be regrouped in order() to be drawn by batches()
+    bool                       isReordered() const { return reordered; }
+
+  private:
+    struct Open {
+      uint32_t key   = 0;
+      size_t   head  = 0;
+      size_t   tail  = 0;
+      size_t   count = 0;
+      size_t   size  = 0;
+      float    x0 = 0, y0 = 0;
+      float    x1 = 0, y1 = 0;
+      };
+
+    static bool overlaps(const Open& b, const Item& it);
+
+    std::vector<Open>   open;
+    std::vector<size_t> next;
+    std::vector<Batch>  batch;
+    std::vector<size_t> ord;
+    bool                reordered = false;
+  };
+
+}
+}
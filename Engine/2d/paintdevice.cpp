@@ -1,3 +1,14 @@
 #include "paintdevice.h"
 
+#include <algorithm>
+
 using namespace Tempest;
+
+static uint32_t toUnorm8(float v) {
+  v = std::min(std::max(v,0.f),1.f);
+  return uint32_t(v*255.f+0.5f);
+  }
+
+void PaintDevice::Point::setColor(float r, float g, float b, float a) {
+  color = toUnorm8(r) | (toUnorm8(g)<<8) | (toUnorm8(b)<<16) | (toUnorm8(a)<<24);
+  }
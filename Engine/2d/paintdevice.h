@@ -41,10 +41,13 @@ class PaintDevice {
       Add
       };
 
+    // 20 bytes: position, texture coordinates, RGBA8 color (red in lowest byte)
     struct Point {
-      float x=0,y=0,z=0;
-      float u=0,v=0;
-      float r=0,g=0,b=0,a=0;
+      float    x=0,y=0;
+      float    u=0,v=0;
+      uint32_t color=0;
+
+      void setColor(float r, float g, float b, float a);
       };
 
   protected:
@@ -60,7 +63,7 @@ class PaintDevice {
     virtual void   popState(size_t id)=0;
 
     virtual void   setState(const TexPtr& t, const Color& c, TextureFormat frm, ClampMode clamp)=0;
-    virtual void   setState(const Sprite& s, const Color& c)=0;
+    virtual void   setState(const Sprite& s, const Color& c, bool sdf)=0;
     virtual void   setTopology(Topology t)=0;
     virtual void   setBlend(const Blend b)=0;
 
@@ -7,6 +7,10 @@
 #include <Tempest/Pen>
 
 #include "../utility/utf8_helper.h"
+#include "../formats/textruncache.h"
+
+#include <algorithm>
+#include <functional>
 
 using namespace Tempest;
 
@@ -76,10 +80,7 @@ void Painter::implAddPoint(int x, int y, float u, float v) {
   }
 
 void Painter::implSetColor(float r, float g, float b, float a) {
-  pt.r=r;
-  pt.g=g;
-  pt.b=b;
-  pt.a=a;
+  pt.setColor(r,g,b,a);
   }
 
 void Painter::drawTriangle(int x0, int y0, float u0, float v0,
@@ -231,7 +232,7 @@ void Painter::implBrush(const Brush &b) {
   if(b.tex) {
     dev.setState(b.tex,b.color,b.texFrm,b.clamp);
     } else {
-    dev.setState(b.spr,b.color);
+    dev.setState(b.spr,b.color,b.sdf);
     }
   dev.setBlend(b.blend);
   implSetColor(b.color.r(),b.color.g(),b.color.b(),b.color.a());
@@ -520,63 +521,173 @@ void Painter::popState() {
     }
   }
 
+static void addGlyph(Detail::TextRun& run, const Font::Letter& v, int x, int y) {
+  Detail::TextRun::Glyph g;
+  g.pos  = Point(x,y);
+  g.dpos = v.dpos;
+  g.size = v.size;
+  g.view = v.view;
+  g.sdf  = v.sdf;
+  run.glyph.emplace_back(std::move(g));
+  }
+
 void Painter::drawText(int x, int y, const char *txt) {
   if(txt==nullptr)
     return;
-  auto pb = s.br;
   auto fx = s.fnt;
-  const float kH = 1.f/s.tr.mat.scaleHintH();
-  const float kV = 1.f/s.tr.mat.scaleHintV();
   fx.setPixelSize(std::ceil(fx.pixelSize()*s.tr.mat.scaleHint()));
-  Utf8Iterator i(txt);
-  while(i.hasData()) {
-    auto c = i.next();
-    if(c=='\0'){
-      setBrush(pb);
-      return;
-      }
-
-    auto l = s.fnt.letterGeometry(c);
-    if(!l.size.isEmpty()) {
-      auto& v     = fx.letter(c,ta);
-      float dposX = float(v.dpos.x*kH), dposY = float(v.dpos.y*kV);
-      float szX   = float(v.size.w*kH), szY   = float(v.size.h*kV);
 
-      setBrush(Brush(v.view,pb.color,PaintDevice::Alpha));
-      drawRect(float(x)+dposX,float(y)+dposY,szX,szY,
-               0.f,0.f,float(v.view.w()),float(v.view.h()));
+  Detail::TextRunCache::Key k;
+  k.kind       = Detail::TextRunCache::Draw;
+  k.text       = txt;
+  k.size       = s.fnt.pixelSize();
+  k.rasterSize = fx.pixelSize();
+  k.atlas      = &ta;
+
+  auto& cache = s.fnt.runCache();
+  auto  run   = cache.find(k);
+  if(run==nullptr) {
+    Detail::TextRun r;
+    int          px = 0;
+    Utf8Iterator i(txt);
+    while(i.hasData()) {
+      auto c = i.next();
+      if(c=='\0')
+        break;
+      auto l = s.fnt.letterGeometry(c);
+      if(!l.size.isEmpty())
+        addGlyph(r,fx.letter(c,ta),px,0);
+      px += l.advance.x;
       }
-
-    x += l.advance.x;
+    r.size = Size(px,0);
+    run = cache.insert(k,std::move(r));
     }
-  setBrush(pb);
+  implDrawRun(*run,x,y);
   }
 
 void Painter::drawText(int x, int y, const char16_t *txt) {
   if(txt==nullptr)
     return;
-  auto pb = s.br;
   auto fx = s.fnt;
+  fx.setPixelSize(fx.pixelSize()*s.tr.mat.scaleHint());
+
+  size_t len = 0;
+  while(txt[len])
+    ++len;
+
+  Detail::TextRunCache::Key k;
+  k.kind       = Detail::TextRunCache::Draw16;
+  k.text       = std::string_view(reinterpret_cast<const char*>(txt),len*sizeof(char16_t));
+  k.size       = s.fnt.pixelSize();
+  k.rasterSize = fx.pixelSize();
+  k.atlas      = &ta;
+
+  auto& cache = s.fnt.runCache();
+  auto  run   = cache.find(k);
+  if(run==nullptr) {
+    Detail::TextRun r;
+    int px = 0;
+    for(size_t i=0; i<len; ++i) {
+      auto l = s.fnt.letterGeometry(txt[i]);
+      if(!l.size.isEmpty())
+        addGlyph(r,fx.letter(txt[i],ta),px,0);
+      px += l.advance.x;
+      }
+    r.size = Size(px,0);
+    run = cache.insert(k,std::move(r));
+    }
+  implDrawRun(*run,x,y);
+  }
+
+void Painter::implDrawRun(const Detail::TextRun& run, int x, int y) {
+  if(run.glyph.empty())
+    return;
   const float kH = 1.f/s.tr.mat.scaleHintH();
   const float kV = 1.f/s.tr.mat.scaleHintV();
-  fx.setPixelSize(fx.pixelSize()*s.tr.mat.scaleHint());
 
-  for(;*txt;++txt) {
-    auto l = s.fnt.letterGeometry(*txt);
-    if(!l.size.isEmpty()) {
-      auto& v     = fx.letter(*txt,ta);
-      float dposX = float(v.dpos.x*kH), dposY = float(v.dpos.y*kV);
-      float szX   = float(v.size.w*kH), szY   = float(v.size.h*kV);
+  // group by atlas page, so run is one block per page; page and uv are resolved here,
+  // as TextureAtlas::compact() may move sprites of cached run.
+  // glyphs share one color, so alpha blending of overlapped ones does not depend on order
+  runOrder.resize(run.glyph.size());
+  for(size_t i=0; i<runOrder.size(); ++i)
+    runOrder[i] = uint32_t(i);
+  std::stable_sort(runOrder.begin(),runOrder.end(),[&run](uint32_t a, uint32_t b){
+    auto& ga = run.glyph[a];
+    auto& gb = run.glyph[b];
+    if(ga.sdf!=gb.sdf)
+      return ga.sdf<gb.sdf;
+    return std::less<void*>()(ga.view.pageId(),gb.view.pageId());
+    });
 
-      setBrush(Brush(v.view,pb.color,PaintDevice::Alpha));
-      drawRect(float(x)+dposX,float(y)+dposY,szX,szY,
-               0.f,0.f,float(v.view.w()),float(v.view.h()));
+  if(state!=StBrush) {
+    dev.setTopology(Triangles);
+    state=StBrush;
+    }
+  const Color& cl = s.br.color;
+  dev.setBlend(PaintDevice::Alpha);
+  implSetColor(cl.r(),cl.g(),cl.b(),cl.a());
+
+  const bool axisAligned = (s.tr.mat.type()==Transform::T_AxisAligned);
+  for(auto id:runOrder) {
+    auto& g = run.glyph[id];
+    // same page: no new block, only sprite is recorded for VectorImage::Mesh remap
+    dev.setState(g.view,cl,g.sdf);
+
+    const Rect  pr = g.view.pageRect();
+    float u1 = float(pr.x)/float(pr.w), u2 = float(pr.x+g.view.w())/float(pr.w);
+    float v1 = float(pr.y)/float(pr.h), v2 = float(pr.y+g.view.h())/float(pr.h);
+    float x1 = float(x+g.pos.x)+float(g.dpos.x)*kH, x2 = x1+float(g.size.w)*kH;
+    float y1 = float(y+g.pos.y)+float(g.dpos.y)*kV, y2 = y1+float(g.size.h)*kV;
+    if(!axisAligned) {
+      implDrawRectF(x1,y1,x2,y2, u1,v1,u2,v2);
+      continue;
       }
 
-    x += l.advance.x;
-    }
+    s.tr.mat.map(x1,y1, x1,y1);
+    s.tr.mat.map(x2,y2, x2,y2);
+    if(x1>x2) {
+      std::swap(x1,x2);
+      std::swap(u1,u2);
+      }
+    if(y1>y2) {
+      std::swap(y1,y2);
+      std::swap(v1,v2);
+      }
+    if(x1>=x2 || y1>=y2)
+      continue;
+
+    const ScissorRect& sc   = s.scRect;
+    const float        invW = (u2-u1)/(x2-x1);
+    const float        invH = (v2-v1)/(y2-y1);
+    if(x1<float(sc.x)) {
+      u1 += (float(sc.x)-x1)*invW;
+      x1  = float(sc.x);
+      }
+    if(x2>float(sc.x1)) {
+      u2 -= (x2-float(sc.x1))*invW;
+      x2  = float(sc.x1);
+      }
+    if(y1<float(sc.y)) {
+      v1 += (float(sc.y)-y1)*invH;
+      y1  = float(sc.y);
+      }
+    if(y2>float(sc.y1)) {
+      v2 -= (y2-float(sc.y1))*invH;
+      y2  = float(sc.y1);
+      }
+    if(x1>=x2 || y1>=y2)
+      continue;
+
+    implAddPoint(x1,y1, u1,v1);
+    implAddPoint(x2,y1, u2,v1);
+    implAddPoint(x2,y2, u2,v2);
 
-  setBrush(pb);
+    implAddPoint(x1,y1, u1,v1);
+    implAddPoint(x2,y2, u2,v2);
+    implAddPoint(x1,y2, u1,v2);
+    }
+  // back to current brush
+  implBrush(s.br);
   }
 
 void Painter::drawText(int x, int y, const std::string &txt) {
@@ -637,12 +748,30 @@ static int calcTextHeight(const char* txt, const int w, int& l0, const Font& fnt
 void Painter::drawText(int rx, int ry, int w, int h, const char *txt, AlignFlag flg) {
   if(txt==nullptr)
     return;
-  auto pb = s.br;
   auto fx = s.fnt;
-  const float kH = 1.f/s.tr.mat.scaleHintH();
-  const float kV = 1.f/s.tr.mat.scaleHintV();
   fx.setPixelSize(std::ceil(fx.pixelSize()*s.tr.mat.scaleHint()));
 
+  Detail::TextRunCache::Key k;
+  k.kind       = Detail::TextRunCache::DrawRect;
+  k.text       = txt;
+  k.size       = s.fnt.pixelSize();
+  k.rasterSize = fx.pixelSize();
+  k.w          = w;
+  k.h          = h;
+  k.flags      = flg;
+  k.atlas      = &ta;
+
+  auto& cache = s.fnt.runCache();
+  auto  run   = cache.find(k);
+  if(run==nullptr) {
+    Detail::TextRun r;
+    implLayoutText(r,fx,w,h,txt,flg);
+    run = cache.insert(k,std::move(r));
+    }
+  implDrawRun(*run,rx,ry);
+  }
+
+void Painter::implLayoutText(Detail::TextRun& run, const Font& fx, int w, int h, const char* txt, AlignFlag flg) {
   int  x = 0, y = 0, pSz = int(std::ceil(s.fnt.pixelSize()));
 
   if(flg!=0) {
@@ -674,29 +803,17 @@ void Painter::drawText(int rx, int ry, int w, int h, const char *txt, AlignFlag
 
     while(i!=eol) {
       auto c=i.next();
-      if(c=='\0'){
-        setBrush(pb);
+      if(c=='\0')
         return;
-        }
       if(c=='\n' || c=='\r')
         continue;
       auto l=s.fnt.letterGeometry(c);
-
-      if(!l.size.isEmpty()) {
-        auto& v     = fx.letter(c,ta);
-        float dposX = float(v.dpos.x*kH), dposY = float(v.dpos.y*kV);
-        float szX   = float(v.size.w*kH), szY   = float(v.size.h*kV);
-
-        setBrush(Brush(v.view,pb.color,PaintDevice::Alpha));
-        drawRect(float(rx)+float(x)+dposX,float(ry)+float(y)+dposY,szX,szY,
-                 0.f,0.f,float(v.view.w()),float(v.view.h()));
-        }
-
+      if(!l.size.isEmpty())
+        addGlyph(run,fx.letter(c,ta),x,y);
       x += l.advance.x;
       }
     y+=pSz;
     }
-  setBrush(pb);
   }
 
 void Painter::drawText(int x, int y, int w, int h, const std::string &txt, AlignFlag flg) {
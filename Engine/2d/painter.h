@@ -10,6 +10,10 @@ namespace Tempest {
 
 class PaintEvent;
 
+namespace Detail {
+class TextRun;
+}
+
 class Painter {
   public:
     enum Mode : uint8_t {
@@ -120,6 +124,7 @@ class Painter {
     State              state=StNo;
     InternalState      s;
     std::vector<InternalState> stStk;
+    std::vector<uint32_t>      runOrder;
 
     struct FPoint{
       float x,y;
@@ -143,6 +148,9 @@ class Painter {
                        float u1, float v1, float u2, float v2);
     void implDrawWideLine(float width, int x1,int y1,int x2,int y2);
 
+    void implLayoutText(Detail::TextRun& run, const Font& fx, int w, int h, const char* txt, AlignFlag flg);
+    void implDrawRun(const Detail::TextRun& run, int x, int y);
+
     friend class Font;
   };
 
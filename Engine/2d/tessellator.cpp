@@ -0,0 +1,332 @@
+#include "tessellator.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static const int   MaxFlattenLevel = 10;
+static const float Pi              = 3.14159265358979f;
+
+static Tessellator::Vec operator + (const Tessellator::Vec& a, const Tessellator::Vec& b) { return {a.x+b.x, a.y+b.y}; }
+static Tessellator::Vec operator - (const Tessellator::Vec& a, const Tessellator::Vec& b) { return {a.x-b.x, a.y-b.y}; }
+static Tessellator::Vec operator * (const Tessellator::Vec& a, float k)                   { return {a.x*k,   a.y*k  }; }
+
+static float cross(const Tessellator::Vec& a, const Tessellator::Vec& b) { return a.x*b.y-a.y*b.x; }
+static float dot  (const Tessellator::Vec& a, const Tessellator::Vec& b) { return a.x*b.x+a.y*b.y; }
+
+static Tessellator::Vec normalize(const Tessellator::Vec& v) {
+  const float l = std::sqrt(dot(v,v));
+  if(l<=0.f)
+    return {0,0};
+  return v*(1.f/l);
+  }
+
+static void triangle(std::vector<Tessellator::Vec>& out,
+                     const Tessellator::Vec& a, const Tessellator::Vec& b, const Tessellator::Vec& c) {
+  out.push_back(a);
+  out.push_back(b);
+  out.push_back(c);
+  }
+
+Tessellator::Tessellator(float tolerance)
+  :tolerance(std::max(tolerance,0.001f)) {
+  }
+
+void Tessellator::clear() {
+  pts.clear();
+  contours.clear();
+  }
+
+void Tessellator::moveTo(const Vec& p) {
+  if(!contours.empty() && contours.back().size<=1) {
+    // consecutive moveTo - previous contour is empty
+    pts.resize(contours.back().begin);
+    contours.back().size = 0;
+    } else {
+    contours.push_back(Contour{pts.size(),0,false});
+    }
+  push(p);
+  }
+
+void Tessellator::lineTo(const Vec& p) {
+  if(contours.empty() || contours.back().closed)
+    moveTo(contours.empty() ? p : pts[contours.back().begin]);
+  push(p);
+  }
+
+void Tessellator::cubicTo(const Vec& c1, const Vec& c2, const Vec& p) {
+  if(contours.empty() || contours.back().closed)
+    moveTo(contours.empty() ? c1 : pts[contours.back().begin]);
+  const Vec p0 = pts.back();
+  flatten(p0,c1,c2,p,0);
+  }
+
+void Tessellator::closePath() {
+  if(contours.empty())
+    return;
+  auto& c = contours.back();
+  if(c.size>1) {
+    const Vec& a = pts[c.begin];
+    const Vec& b = pts.back();
+    if(a.x==b.x && a.y==b.y) {
+      pts.pop_back();
+      c.size--;
+      }
+    }
+  c.closed = true;
+  }
+
+void Tessellator::push(const Vec& p) {
+  auto& c = contours.back();
+  if(c.size>0) {
+    const Vec& b = pts.back();
+    if(b.x==p.x && b.y==p.y)
+      return;
+    }
+  pts.push_back(p);
+  c.size++;
+  }
+
+void Tessellator::flatten(const Vec& p0, const Vec& c1, const Vec& c2, const Vec& p1, int level) {
+  const Vec   d   = p1-p0;
+  const float len = dot(d,d);
+  float       dist;
+  if(len>0.f) {
+    // distances of control points to the chord, scaled by chord length
+    const float d1 = std::abs(cross(c1-p1,d));
+    const float d2 = std::abs(cross(c2-p1,d));
+    dist = (d1+d2)*(d1+d2) - tolerance*tolerance*len;
+    } else {
+    const Vec e1 = c1-p0, e2 = c2-p0;
+    dist = std::max(dot(e1,e1),dot(e2,e2)) - tolerance*tolerance;
+    }
+
+  if(dist<=0.f || level>=MaxFlattenLevel) {
+    push(p1);
+    return;
+    }
+
+  const Vec p01  = (p0 +c1 )*0.5f;
+  const Vec p12  = (c1 +c2 )*0.5f;
+  const Vec p23  = (c2 +p1 )*0.5f;
+  const Vec p012 = (p01+p12)*0.5f;
+  const Vec p123 = (p12+p23)*0.5f;
+  const Vec mid  = (p012+p123)*0.5f;
+  flatten(p0, p01, p012, mid,level+1);
+  flatten(mid,p123,p23,  p1, level+1);
+  }
+
+void Tessellator::fill(FillRule rule, std::vector<Vec>& out) const {
+  std::vector<Edge>  edges;
+  std::vector<float> ys;
+  for(auto& c:contours) {
+    if(c.size<3)
+      continue;
+    const Vec* p = &pts[c.begin];
+    for(size_t i=0; i<c.size; ++i) {
+      const Vec& a = p[i];
+      const Vec& b = p[(i+1)%c.size];
+      ys.push_back(a.y);
+      if(a.y==b.y)
+        continue;
+      Edge e;
+      if(a.y<b.y) {
+        e = Edge{a.x,a.y,b.x,b.y,0,1};
+        } else {
+        e = Edge{b.x,b.y,a.x,a.y,0,-1};
+        }
+      e.dxdy = (e.x1-e.x0)/(e.y1-e.y0);
+      edges.push_back(e);
+      }
+    }
+  if(edges.size()<2)
+    return;
+
+  std::sort(ys.begin(),ys.end());
+  ys.erase(std::unique(ys.begin(),ys.end()),ys.end());
+  std::sort(edges.begin(),edges.end(),[](const Edge& a, const Edge& b){ return a.y0<b.y0; });
+
+  // sweep over horizontal slabs, bounded by consecutive vertices
+  std::vector<const Edge*> active;
+  size_t                   next = 0;
+  for(size_t i=0; i+1<ys.size(); ++i) {
+    const float y0 = ys[i];
+    const float y1 = ys[i+1];
+    active.erase(std::remove_if(active.begin(),active.end(),[y0](const Edge* e){ return e->y1<=y0; }),
+                 active.end());
+    while(next<edges.size() && edges[next].y0<=y0) {
+      active.push_back(&edges[next]);
+      ++next;
+      }
+    if(active.size()>=2)
+      fillSlab(active,y0,y1,rule,out);
+    }
+  }
+
+void Tessellator::fillSlab(std::vector<const Edge*>& active, float y0, float y1,
+                           FillRule rule, std::vector<Vec>& out) const {
+  struct Span {
+    float       t = 0;
+    float       b = 0;
+    const Edge* e = nullptr;
+    };
+  std::vector<Span> xs(active.size());
+
+  const float minStep = (y1-y0)*1e-3f;
+  float       top     = y0;
+  while(top<y1) {
+    for(size_t i=0; i<active.size(); ++i) {
+      xs[i].e = active[i];
+      xs[i].t = active[i]->xAt(top);
+      xs[i].b = active[i]->xAt(y1);
+      }
+    std::sort(xs.begin(),xs.end(),[](const Span& l, const Span& r){
+      if(l.t!=r.t)
+        return l.t<r.t;
+      return l.b<r.b;
+      });
+
+    // self-intersecting path: split slab at first crossing of adjacent edges
+    float bottom = y1;
+    for(size_t i=0; i+1<xs.size(); ++i) {
+      const Span& l = xs[i];
+      const Span& r = xs[i+1];
+      if(l.b<=r.b)
+        continue;
+      const float s = (r.t-l.t)/((l.b-l.t)-(r.b-r.t));
+      bottom = std::min(bottom,top+s*(y1-top));
+      }
+    if(bottom<top+minStep)
+      bottom = std::min(y1,top+minStep);
+    // large coordinates: step is below float precision of top - take rest of slab, instead of spinning
+    if(!(bottom>top))
+      bottom = y1;
+    if(bottom<y1) {
+      for(auto& i:xs)
+        i.b = i.e->xAt(bottom);
+      }
+
+    int    winding = 0;
+    size_t left    = 0;
+    for(size_t i=0; i<xs.size(); ++i) {
+      const bool was = (rule==EvenOdd) ? (winding&1)!=0 : winding!=0;
+      winding += xs[i].e->dir;
+      const bool now = (rule==EvenOdd) ? (winding&1)!=0 : winding!=0;
+      if(!was && now) {
+        left = i;
+        }
+      else if(was && !now) {
+        const Span& l = xs[left];
+        const Span& r = xs[i];
+        const Vec   lt = {l.t,top}, rt = {r.t,top};
+        const Vec   lb = {l.b,bottom}, rb = {r.b,bottom};
+        if(r.t>l.t)
+          triangle(out,lt,rt,rb);
+        if(r.b>l.b)
+          triangle(out,lt,rb,lb);
+        }
+      }
+    top = bottom;
+    }
+  }
+
+void Tessellator::stroke(const Stroke& st, std::vector<Vec>& out) const {
+  if(st.width<=0.f)
+    return;
+  for(auto& c:contours)
+    strokeContour(&pts[c.begin],c.size,c.closed,st,out);
+  }
+
+void Tessellator::strokeContour(const Vec* src, size_t n, bool closed, const Stroke& st,
+                                std::vector<Vec>& out) const {
+  const float      hw = st.width*0.5f;
+  std::vector<Vec> p(src,src+n);
+  if(p.size()<2)
+    return;
+  if(p.size()==2)
+    closed = false;
+
+  if(!closed && st.cap==SquareCap) {
+    p.front() = p.front() - normalize(p[1]-p[0])*hw;
+    p.back()  = p.back()  + normalize(p[p.size()-1]-p[p.size()-2])*hw;
+    }
+
+  const size_t cnt  = p.size();
+  const size_t segs = closed ? cnt : cnt-1;
+  for(size_t i=0; i<segs; ++i) {
+    const Vec& a  = p[i];
+    const Vec& b  = p[(i+1)%cnt];
+    const Vec  d  = normalize(b-a);
+    const Vec  nr = Vec{-d.y,d.x}*hw;
+    triangle(out,a+nr,b+nr,b-nr);
+    triangle(out,a+nr,b-nr,a-nr);
+    }
+
+  const size_t jBegin = closed ? 0   : 1;
+  const size_t jEnd   = closed ? cnt : cnt-1;
+  for(size_t j=jBegin; j<jEnd; ++j) {
+    const Vec&  pt = p[j];
+    const Vec   d0 = normalize(pt-p[(j+cnt-1)%cnt]);
+    const Vec   d1 = normalize(p[(j+1)%cnt]-pt);
+    const float cr = cross(d0,d1);
+    if(std::abs(cr)<1e-6f && dot(d0,d1)>0.f)
+      continue;
+
+    // offsets on the outer side of the turn
+    Vec o0 = Vec{-d0.y,d0.x}*hw;
+    Vec o1 = Vec{-d1.y,d1.x}*hw;
+    if(cr>0.f) {
+      o0 = o0*-1.f;
+      o1 = o1*-1.f;
+      }
+
+    triangle(out,pt,pt+o0,pt+o1);
+    if(st.join==RoundJoin) {
+      arc(pt,o0,o1,hw,cross(o0,o1)>0.f,out);
+      }
+    else if(st.join==MiterJoin) {
+      const Vec   m    = o0+o1;
+      const float cosH = std::sqrt(dot(m,m))/(2.f*hw);
+      if(cosH>0.f && 1.f/cosH<=st.miterLimit)
+        triangle(out,pt+o0,pt+normalize(m)*(hw/cosH),pt+o1);
+      }
+    }
+
+  if(!closed && st.cap==RoundCap) {
+    const Vec d0 = normalize(p[1]-p[0]);
+    const Vec d1 = normalize(p[cnt-1]-p[cnt-2]);
+    const Vec n0 = Vec{-d0.y,d0.x}*hw;
+    const Vec n1 = Vec{-d1.y,d1.x}*hw;
+    arc(p.front(),n0,n0*-1.f,hw,true,out);
+    arc(p.back(), n1*-1.f,n1,hw,true,out);
+    }
+  }
+
+void Tessellator::arc(const Vec& c, const Vec& from, const Vec& to, float r,
+                      bool ccw, std::vector<Vec>& out) const {
+  const float a0 = std::atan2(from.y,from.x);
+  float       a1 = std::atan2(to.y,  to.x);
+  if(ccw) {
+    while(a1<a0)
+      a1 += 2.f*Pi;
+    } else {
+    while(a1>a0)
+      a1 -= 2.f*Pi;
+    }
+
+  // step, that keeps chord within tolerance of the circle
+  float da = Pi*0.5f;
+  if(r>tolerance)
+    da = std::max(2.f*std::acos(1.f-tolerance/r),0.01f);
+  const int steps = std::max(1,int(std::ceil(std::abs(a1-a0)/da)));
+
+  Vec prev = c+from;
+  for(int i=1; i<=steps; ++i) {
+    const float a   = a0+(a1-a0)*float(i)/float(steps);
+    const Vec   cur = (i==steps) ? c+to : c+Vec{std::cos(a)*r,std::sin(a)*r};
+    triangle(out,c,prev,cur);
+    prev = cur;
+    }
+  }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Tempest {
+namespace Detail {
+
+// Converts paths, made of lines and cubic bezier segments, into triangle lists.
+// Curves are flattened adaptively: recursion stops, once control points are within tolerance of the chord.
+class Tessellator final {
+  public:
+    struct Vec {
+      float x = 0;
+      float y = 0;
+      };
+
+    enum FillRule : uint8_t {
+      NonZero,
+      EvenOdd,
+      };
+
+    enum LineJoin : uint8_t {
+      MiterJoin,
+      RoundJoin,
+      BevelJoin,
+      };
+
+    enum LineCap : uint8_t {
+      ButtCap,
+      RoundCap,
+      SquareCap,
+      };
+
+    struct Stroke {
+      float    width      = 1.f;
+      LineJoin join       = MiterJoin;
+      LineCap  cap        = ButtCap;
+      float    miterLimit = 4.f;
+      };
+
+    explicit Tessellator(float tolerance = 0.25f);
+
+    void   clear();
+    void   moveTo (const Vec& p);
+    void   lineTo (const Vec& p);
+    void   cubicTo(const Vec& c1, const Vec& c2, const Vec& p);
+    void   closePath();
+
+    size_t contourCount() const { return contours.size(); }
+    size_t pointCount()   const { return pts.size();      }
+
+    // append triangles (3 vertices each) to out
+    void   fill  (FillRule rule, std::vector<Vec>& out) const;
+    void   stroke(const Stroke& st, std::vector<Vec>& out) const;
+
+  private:
+    struct Contour {
+      size_t begin  = 0;
+      size_t size   = 0;
+      bool   closed = false;
+      };
+
+    struct Edge {
+      float x0=0, y0=0;
+      float x1=0, y1=0;
+      float dxdy = 0;
+      int   dir  = 0;
+
+      float xAt(float y) const { return x0+(y-y0)*dxdy; }
+      };
+
+    void   flatten(const Vec& p0, const Vec& c1, const Vec& c2, const Vec& p1, int level);
+    void   push(const Vec& p);
+
+    void   fillSlab(std::vector<const Edge*>& active, float y0, float y1,
+                    FillRule rule, std::vector<Vec>& out) const;
+    void   strokeContour(const Vec* p, size_t n, bool closed, const Stroke& st,
+                         std::vector<Vec>& out) const;
+    void   arc(const Vec& c, const Vec& from, const Vec& to, float r,
+               bool ccw, std::vector<Vec>& out) const;
+
+    float                tolerance = 0.25f;
+    std::vector<Vec>     pts;
+    std::vector<Contour> contours;
+  };
+
+}
+}
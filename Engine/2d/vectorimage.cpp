@@ -5,12 +5,66 @@
 #include <Tempest/Painter>
 #include <Tempest/Event>
 #include <Tempest/Encoder>
+#include <Tempest/File>
+#include <Tempest/Except>
+
+#include <cmath>
+#include <cstring>
 
 #define  NANOSVG_IMPLEMENTATION
 #include "thirdparty/nanosvg.h"
 
+#include "drawbatcher.h"
+#include "tessellator.h"
+
 using namespace Tempest;
 
+namespace {
+
+// Mesh cache: header, blocks, then raw vertex stream
+struct CacheHeader {
+  char     magic[4]   = {'T','V','I','M'};
+  uint32_t version    = 1;
+  uint32_t pointSize  = uint32_t(sizeof(PaintDevice::Point));
+  uint32_t w          = 0;
+  uint32_t h          = 0;
+  uint32_t blockCount = 0;
+  uint32_t pointCount = 0;
+  };
+
+struct CacheBlock {
+  uint32_t begin    = 0;
+  uint32_t size     = 0;
+  uint8_t  topology = 0;
+  uint8_t  blend    = 0;
+  uint8_t  padding[2] = {};
+  };
+
+}
+
+static void svgColor(const NSVGpaint& paint, float opacity, PaintDevice::Point& pt) {
+  uint32_t r=0, g=0, b=0, a=0;
+  auto mix = [&](uint32_t c) {
+    r +=  c      & 0xFF;
+    g += (c>>8 ) & 0xFF;
+    b += (c>>16) & 0xFF;
+    a += (c>>24) & 0xFF;
+    };
+
+  uint32_t cnt = 1;
+  if(paint.type==NSVG_PAINT_COLOR) {
+    mix(paint.color);
+    } else {
+    // gradients are approximated with average color of stops
+    cnt = uint32_t(std::max(paint.gradient->nstops,1));
+    for(int i=0; i<paint.gradient->nstops; ++i)
+      mix(paint.gradient->stops[i].color);
+    }
+
+  const float k = 1.f/(255.f*float(cnt));
+  pt.setColor(float(r)*k, float(g)*k, float(b)*k, float(a)*k*opacity);
+  }
+
 void VectorImage::beginPaint(bool clr, uint32_t w, uint32_t h) {
   if(clr || blocks.size()==0)
     clear();
@@ -45,6 +99,8 @@ void VectorImage::popState(size_t id) {
     blocks.back().begin =buf.size();
     blocks.back().size  =0;
     }
+  if(s.tex.sprite.pageId()!=nullptr)
+    addSpan(s.tex.sprite);
   stateStk.resize(id);
   }
 
@@ -71,12 +127,82 @@ void VectorImage::setState(const TexPtr &t, const Color&, TextureFormat frm, Cla
   blocks.back().hasImg=bool(t);
   }
 
-void VectorImage::setState(const Sprite &s, const Color&) {
-  Texture tex={TexPtr(),TextureFormat::Undefined,ClampMode::Repeat,s};
+void VectorImage::setState(const Sprite &s, const Color&, bool sdf) {
+  Texture tex={TexPtr(),TextureFormat::Undefined,ClampMode::Repeat,s,sdf};
   setState<Texture,&State::tex>(tex);
   blocks.back().hasImg=!s.isEmpty();
 
   slock.insert(s);
+  if(!s.isEmpty())
+    addSpan(s);
+  }
+
+void VectorImage::addSpan(const Sprite& s) {
+  if(!spans.empty()) {
+    auto& b = spans.back();
+    if(b.page==s.pageId() && b.rect==s.pageRect())
+      return;
+    if(b.begin==buf.size()) {
+      // no points painted with previous one
+      spans.pop_back();
+      return addSpan(s);
+      }
+    }
+  SpriteSpan sp;
+  sp.begin  = buf.size();
+  sp.sprite = s;
+  sp.rect   = s.pageRect();
+  sp.page   = s.pageId();
+  spans.push_back(std::move(sp));
+  }
+
+bool VectorImage::remap(std::vector<Block>& outBlocks, std::vector<Point>& outBuf) const {
+  bool moved = false;
+  for(auto& s:spans)
+    if(s.sprite.pageId()!=s.page || s.sprite.pageRect()!=s.rect) {
+      moved = true;
+      break;
+      }
+  if(!moved)
+    return false;
+
+  outBuf = buf;
+  outBlocks.clear();
+  size_t sp = 0;
+  for(auto& b:blocks) {
+    while(sp+1<spans.size() && spans[sp+1].begin<=b.begin)
+      ++sp;
+    if(!b.hasImg || b.tex.brush || b.size==0 || spans.empty() || spans[sp].begin>b.begin) {
+      outBlocks.push_back(b);
+      continue;
+      }
+    // block is split by sprite, as moved sprites may end up on different pages
+    const size_t end = b.begin+b.size;
+    for(size_t i=b.begin, s=sp; i<end; ++s) {
+      const size_t e   = (s+1<spans.size()) ? std::min(end,spans[s+1].begin) : end;
+      auto&        spn = spans[s];
+      const Rect   r   = spn.sprite.pageRect();
+      if(spn.sprite.pageId()!=spn.page || r!=spn.rect) {
+        // uv -> texel of old page -> texel of new page
+        for(size_t p=i; p<e; ++p) {
+          auto& pt = outBuf[p];
+          pt.u = (pt.u*float(spn.rect.w) - float(spn.rect.x) + float(r.x))/float(r.w);
+          pt.v = (pt.v*float(spn.rect.h) - float(spn.rect.y) + float(r.y))/float(r.h);
+          }
+        }
+
+      Block nb = b;
+      nb.begin      = i;
+      nb.size       = e-i;
+      nb.tex.sprite = spn.sprite;
+      auto* last = outBlocks.empty() ? nullptr : &outBlocks.back();
+      if(last!=nullptr && static_cast<const State&>(*last)==nb && last->hasImg && last->begin+last->size==nb.begin)
+        last->size += nb.size; else
+        outBlocks.push_back(nb);
+      i = e;
+      }
+    }
+  return true;
   }
 
 void VectorImage::setTopology(Topology t) {
@@ -93,6 +219,7 @@ void VectorImage::clear() {
   blocks.back()=Block();
   stateStk.clear();
   slock.clear();
+  spans.clear();
   }
 
 void VectorImage::addPoint(const PaintDevice::Point &p) {
@@ -112,7 +239,22 @@ void VectorImage::commitPoints() {
 
 const RenderPipeline& VectorImage::pipelineOf(Device& dev, const VectorImage::Block& b) const {
   const RenderPipeline* p;
-  if(b.hasImg) {
+  if(b.hasImg && b.tex.sdf) {
+    if(b.tp==Triangles){
+      if(b.blend==NoBlend)
+        p=&dev.builtin().sdf().brush; else
+      if(b.blend==Alpha)
+        p=&dev.builtin().sdf().brushB; else
+        p=&dev.builtin().sdf().brushA;
+      } else {
+      if(b.blend==NoBlend)
+        p=&dev.builtin().sdf().pen; else
+      if(b.blend==Alpha)
+        p=&dev.builtin().sdf().penB; else
+        p=&dev.builtin().sdf().penA;
+      }
+    }
+  else if(b.hasImg) {
     if(b.tp==Triangles){
       if(b.blend==NoBlend)
         p=&dev.builtin().texture2d().brush; else
@@ -144,25 +286,122 @@ const RenderPipeline& VectorImage::pipelineOf(Device& dev, const VectorImage::Bl
   return *p;
   }
 
-bool VectorImage::load(const char *file) {
-  NSVGimage* image = nsvgParseFromFile(file,"px",96);
+bool VectorImage::load(const char *path) {
+  try {
+    RFile f(path);
+    return load(f);
+    }
+  catch(...) {
+    return false;
+    }
+  }
+
+bool VectorImage::load(IDevice& input) {
+  try {
+    std::vector<char> data(input.size()+1);
+    data.resize(input.read(data.data(),data.size()-1)+1);
+    data.back() = '\0';
+
+    const size_t size = data.size()-1;
+    CacheHeader  hdr;
+    if(size>=sizeof(hdr) && std::memcmp(data.data(),hdr.magic,sizeof(hdr.magic))==0)
+      return loadCache(data.data(),size);
+    return loadSvg(data.data());
+    }
+  catch(...) {
+    return false;
+    }
+  }
+
+bool VectorImage::load(const char* path, const char* cache) {
+  try {
+    RFile             f(cache);
+    std::vector<char> data(f.size());
+    data.resize(f.read(data.data(),data.size()));
+
+    CacheHeader hdr;
+    if(data.size()>=sizeof(hdr) && std::memcmp(data.data(),hdr.magic,sizeof(hdr.magic))==0 &&
+       loadCache(data.data(),data.size()))
+      return true;
+    }
+  catch(...) {
+    // no cache yet
+    }
+
+  if(!load(path))
+    return false;
+  try {
+    save(cache);
+    }
+  catch(...) {
+    // read-only location: image is still usable
+    }
+  return true;
+  }
+
+bool VectorImage::loadSvg(char* data) {
+  NSVGimage* image = nsvgParse(data,"px",96);
   if(image==nullptr)
     return false;
 
   try {
     VectorImage img;
-    //PaintEvent  event(img,int(image->width),int(image->height));
-    //Painter     p(event);
+    img.clear();
+    img.info.w = uint32_t(std::ceil(image->width));
+    img.info.h = uint32_t(std::ceil(image->height));
+    img.setBlend(Alpha);
+
+    const float invW = image->width >0 ? 2.f/image->width  : 0.f;
+    const float invH = image->height>0 ? 2.f/image->height : 0.f;
+
+    Detail::Tessellator                   tess;
+    std::vector<Detail::Tessellator::Vec> trig;
+    PaintDevice::Point                    pt;
+    auto emit = [&]() {
+      for(auto& v:trig) {
+        pt.x = v.x*invW-1.f;
+        pt.y = v.y*invH-1.f;
+        img.addPoint(pt);
+        }
+      trig.clear();
+      };
 
     for(NSVGshape* shape=image->shapes; shape!=nullptr; shape=shape->next) {
+      if((shape->flags & NSVG_FLAGS_VISIBLE)==0)
+        continue;
+
+      tess.clear();
       for(NSVGpath* path=shape->paths; path!=nullptr; path=path->next) {
-        for(int i=0; i<path->npts-1; i+=3) {
-          const float* p = &path->pts[i*2];
-          //drawCubicBez(p[0],p[1], p[2],p[3], p[4],p[5], p[6],p[7]);
+        const float* p = path->pts;
+        tess.moveTo({p[0],p[1]});
+        for(int i=0; i+3<path->npts; i+=3) {
+          p = &path->pts[i*2];
+          tess.cubicTo({p[2],p[3]}, {p[4],p[5]}, {p[6],p[7]});
           }
+        if(path->closed)
+          tess.closePath();
+        }
+
+      if(shape->fill.type!=NSVG_PAINT_NONE) {
+        auto rule = shape->fillRule==NSVG_FILLRULE_EVENODD ? Detail::Tessellator::EvenOdd : Detail::Tessellator::NonZero;
+        tess.fill(rule,trig);
+        svgColor(shape->fill,shape->opacity,pt);
+        emit();
+        }
+
+      if(shape->stroke.type!=NSVG_PAINT_NONE && shape->strokeWidth>0.f) {
+        Detail::Tessellator::Stroke st;
+        st.width      = shape->strokeWidth;
+        st.join       = Detail::Tessellator::LineJoin(shape->strokeLineJoin);
+        st.cap        = Detail::Tessellator::LineCap (shape->strokeLineCap);
+        st.miterLimit = shape->miterLimit;
+        tess.stroke(st,trig);
+        svgColor(shape->stroke,shape->opacity,pt);
+        emit();
         }
       }
 
+    img.commitPoints();
     *this=std::move(img);
     }
   catch(...){
@@ -173,22 +412,168 @@ bool VectorImage::load(const char *file) {
   return true;
   }
 
+bool VectorImage::loadCache(const char* data, size_t size) {
+  CacheHeader hdr, ref;
+  std::memcpy(&hdr,data,sizeof(hdr));
+  if(hdr.version!=ref.version || hdr.pointSize!=ref.pointSize)
+    return false;
+
+  const size_t blkSize = size_t(hdr.blockCount)*sizeof(CacheBlock);
+  const size_t ptSize  = size_t(hdr.pointCount)*sizeof(Point);
+  if(size!=sizeof(hdr)+blkSize+ptSize)
+    return false;
+
+  VectorImage img;
+  img.clear();
+  img.info.w = hdr.w;
+  img.info.h = hdr.h;
+  img.blocks.resize(std::max<size_t>(hdr.blockCount,1));
+
+  const char* blk = data+sizeof(hdr);
+  for(size_t i=0; i<hdr.blockCount; ++i) {
+    CacheBlock cb;
+    std::memcpy(&cb,blk+i*sizeof(CacheBlock),sizeof(cb));
+    if(size_t(cb.begin)+cb.size>hdr.pointCount)
+      return false;
+    // corrupted or written by newer version: reject, instead of casting unknown value to enum
+    if(cb.topology>uint8_t(Triangles) || cb.blend>uint8_t(Add))
+      return false;
+    auto& b = img.blocks[i];
+    b.begin = cb.begin;
+    b.size  = cb.size;
+    b.tp    = Topology(cb.topology);
+    b.blend = Blend(cb.blend);
+    }
+
+  img.buf.resize(hdr.pointCount);
+  std::memcpy(img.buf.data(),blk+blkSize,ptSize);
+
+  *this=std::move(img);
+  return true;
+  }
+
+void VectorImage::save(const char* path) const {
+  WFile f(path);
+  save(f);
+  }
+
+void VectorImage::save(ODevice& output) const {
+  CacheHeader hdr;
+  hdr.w          = info.w;
+  hdr.h          = info.h;
+  hdr.blockCount = uint32_t(blocks.size());
+  hdr.pointCount = uint32_t(buf.size());
+
+  std::vector<CacheBlock> blk(blocks.size());
+  for(size_t i=0; i<blocks.size(); ++i) {
+    auto& b = blocks[i];
+    if(b.hasImg)
+      throw std::system_error(Tempest::SystemErrc::UnableToSaveAsset);
+    blk[i].begin    = uint32_t(b.begin);
+    blk[i].size     = uint32_t(b.size);
+    blk[i].topology = uint8_t(b.tp);
+    blk[i].blend    = uint8_t(b.blend);
+    }
+
+  const size_t blkSize = blk.size()*sizeof(CacheBlock);
+  const size_t ptSize  = buf.size()*sizeof(Point);
+  if(output.write(&hdr,sizeof(hdr))!=sizeof(hdr) ||
+     output.write(blk.data(),blkSize)!=blkSize ||
+     output.write(buf.data(),ptSize)!=ptSize)
+    throw std::system_error(Tempest::SystemErrc::UnableToSaveAsset);
+  }
+
 
 void VectorImage::Mesh::update(Device& dev, const VectorImage& src, BufferHeap heap) {
-  if(vbo.size()==src.buf.size())
-    vbo.update(src.buf); else
-    vbo=dev.vbo(heap,src.buf);
+  // sprites, that were moved by TextureAtlas::compact() after painting, need remapped copy of geometry
+  std::vector<VectorImage::Block> remapBlocks;
+  std::vector<Point>              remapBuf;
+  const bool                      moved     = src.remap(remapBlocks,remapBuf);
+  const auto&                     srcBlocks = moved ? remapBlocks : src.blocks;
+  const auto&                     srcBuf    = moved ? remapBuf    : src.buf;
+
+  // draw state of each block; blocks with equal state share a key
+  std::vector<Detail::DrawBatcher::Item> items(srcBlocks.size());
+  std::vector<const RenderPipeline*>     pso  (srcBlocks.size());
+  std::vector<size_t>                    states;
+  auto isSameState = [&](size_t l, size_t r) {
+    auto& a = srcBlocks[l];
+    auto& b = srcBlocks[r];
+    if(pso[l]!=pso[r] || a.hasImg!=b.hasImg)
+      return false;
+    return !a.hasImg || (a.tex==b.tex && a.tex.frm==b.tex.frm && a.tex.clamp==b.tex.clamp);
+    };
+
+  st = Stats();
+
+  for(size_t i=0; i<srcBlocks.size(); ++i) {
+    auto& b  = srcBlocks[i];
+    auto& it = items[i];
+    pso[i]   = &src.pipelineOf(dev,b);
+    it.begin = b.begin;
+    it.size  = b.size;
+    if(b.size==0)
+      continue;
 
-  blocks.resize(src.blocks.size());
+    const Point* pt = &srcBuf[b.begin];
+    it.x0 = it.x1 = pt[0].x;
+    it.y0 = it.y1 = pt[0].y;
+    for(size_t r=1; r<b.size; ++r) {
+      it.x0 = std::min(it.x0,pt[r].x);
+      it.y0 = std::min(it.y0,pt[r].y);
+      it.x1 = std::max(it.x1,pt[r].x);
+      it.y1 = std::max(it.y1,pt[r].y);
+      }
+    if(b.tp==Lines) {
+      // 1px line may rasterize one pixel past its end points; coordinates are in [-1..1]
+      it.padX = src.info.w>0 ? 2.f/float(src.info.w) : 2.f;
+      it.padY = src.info.h>0 ? 2.f/float(src.info.h) : 2.f;
+      }
+
+    it.key = uint32_t(states.size());
+    for(size_t r=0; r<states.size(); ++r)
+      if(isSameState(states[r],i)) {
+        it.key = uint32_t(r);
+        break;
+        }
+    if(it.key==states.size())
+      states.push_back(i);
+    st.blocks++;
+    }
+
+  Detail::DrawBatcher batcher;
+  batcher.build(items);
+  auto& batches = batcher.batches();
+  auto& order   = batcher.order();
+
+  st.drawCalls = batches.size();
+
+  if(batcher.isReordered()) {
+    std::vector<Point> stream;
+    stream.reserve(srcBuf.size());
+    for(auto id:order) {
+      auto bg = srcBuf.begin()+ptrdiff_t(items[id].begin);
+      stream.insert(stream.end(),bg,bg+ptrdiff_t(items[id].size));
+      }
+    if(vbo.size()==stream.size())
+      vbo.update(stream); else
+      vbo=dev.vbo(heap,stream);
+    } else {
+    if(vbo.size()==srcBuf.size())
+      vbo.update(srcBuf); else
+      vbo=dev.vbo(heap,srcBuf);
+    }
 
+  blocks.resize(batches.size());
   for(size_t i=0;i<blocks.size();++i){
-    auto& b  = src.blocks[i];
-    auto& ux = blocks[i];
+    const size_t id = order[batches[i].first];
+    auto&        b  = srcBlocks[id];
+    auto&        ux = blocks[i];
 
-    ux.begin = b.begin;
-    ux.size  = b.size;
+    ux.begin = batches[i].begin;
+    ux.size  = batches[i].size;
 
-    auto& p = src.pipelineOf(dev,b);
+    auto& p = *pso[id];
     if(ux.desc.isEmpty() || ux.pipeline!=&p){
       ux.desc     = dev.descriptors(p.layout());
       ux.pipeline = &p;
@@ -13,14 +13,23 @@ namespace Tempest {
 template<class T>
 class Encoder;
 
+class IDevice;
+class ODevice;
+
 class VectorImage : public Tempest::PaintDevice {
   public:
     VectorImage()=default;
 
     class Mesh {
       public:
-        void update(Device& dev, const VectorImage& src, BufferHeap heap = BufferHeap::Upload);
-        void draw  (Encoder<CommandBuffer>& cmd) const;
+        struct Stats {
+          size_t blocks    = 0; // non-empty state blocks of source image
+          size_t drawCalls = 0; // after merging blocks of same state
+          };
+
+        void  update(Device& dev, const VectorImage& src, BufferHeap heap = BufferHeap::Upload);
+        void  draw  (Encoder<CommandBuffer>& cmd) const;
+        Stats stats () const { return st; }
 
       private:
         struct Block {
@@ -34,12 +43,20 @@ class VectorImage : public Tempest::PaintDevice {
           };
         Tempest::VertexBuffer<Point> vbo;
         std::vector<Block>           blocks;
+        Stats                        st;
       };
 
     uint32_t w() const { return info.w; }
     uint32_t h() const { return info.h; }
 
+    // SVG file, or mesh cache, written by save()
     bool     load(const char* path);
+    bool     load(IDevice& input);
+    // mesh cache, if it is valid; otherwise SVG file is tessellated again and cache is rewritten
+    bool     load(const char* path, const char* cache);
+    // binary cache of tessellated geometry; textured content can't be saved
+    void     save(const char* path) const;
+    void     save(ODevice& output) const;
     void     clear() override;
 
   private:
@@ -53,7 +70,7 @@ class VectorImage : public Tempest::PaintDevice {
     void   popState(size_t id) override;
 
     void   setState(const TexPtr& t, const Color& c, TextureFormat frm, ClampMode clamp) override;
-    void   setState(const Sprite& s, const Color& c) override;
+    void   setState(const Sprite& s, const Color& c, bool sdf) override;
     void   setTopology(Topology t) override;
     void   setBlend(const Blend b) override;
 
@@ -78,9 +95,10 @@ class VectorImage : public Tempest::PaintDevice {
       TextureFormat frm;
       ClampMode     clamp;
       Sprite        sprite; //TODO: dangling sprites
+      bool          sdf = false;
 
       bool     operator==(const Texture& t) const {
-        return brush==t.brush && sprite.pageId()==t.sprite.pageId();
+        return brush==t.brush && sprite.pageId()==t.sprite.pageId() && sdf==t.sdf;
         }
       };
 
@@ -107,12 +125,21 @@ class VectorImage : public Tempest::PaintDevice {
       bool           hasImg = false;
       };
 
+    // sprite, painted from point `begin` on, and its place in atlas at paint time
+    struct SpriteSpan {
+      size_t         begin = 0;
+      Sprite         sprite;
+      Rect           rect;
+      void*          page  = nullptr;
+      };
+
     Topology                    topology=Triangles;
 
     std::vector<State>          stateStk;
     std::vector<Block>          blocks;
     std::vector<Point>          buf;
     SpriteLock                  slock;
+    std::vector<SpriteSpan>     spans;
 
     struct Info {
       uint32_t w=0,h=0;
@@ -121,6 +148,11 @@ class VectorImage : public Tempest::PaintDevice {
     size_t paintScope = 0;
 
     const RenderPipeline& pipelineOf(Device& dev, const Block& b) const;
+    void   addSpan(const Sprite& s);
+    bool   remap(std::vector<Block>& outBlocks, std::vector<Point>& outBuf) const;
+
+    bool   loadSvg  (char* data);
+    bool   loadCache(const char* data, size_t size);
 
     template<class T,T State::*param>
     void setState(const T& t);
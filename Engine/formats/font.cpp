@@ -5,11 +5,13 @@
 #include <Tempest/Platform>
 #include <Tempest/Log>
 #include "../utility/utf8_helper.h"
+#include "glyphcache.h"
+#include "textruncache.h"
 #include "thirdparty/stb_truetype.h"
 
-#include <unordered_map>
-#include <bitset>
 #include <algorithm>
+#include <cassert>
+#include <thread>
 
 #ifdef __WINDOWS__
 #include <Shlobj.h>
@@ -19,17 +21,6 @@ using namespace Tempest;
 
 namespace Tempest {
 namespace Detail {
-  template<size_t lvl>
-  struct Bucket {
-    std::unique_ptr<Bucket<lvl-1>> next[256];
-    };
-
-  template<>
-  struct Bucket<1> {
-    FontElement::Letter     letter[256];
-    std::bitset<256>        ex;
-    };
-
   static std::string getFontFolderPath() {
 #ifdef __WINDOWS__
     char   path[MAX_PATH]={};
@@ -51,65 +42,12 @@ namespace Detail {
 
 }
 
-struct FontElement::LetterTable {
-  struct Chunk {
-    uint32_t          size=0;
-    Detail::Bucket<3> next[256];
-    };
-
-  std::vector<Chunk> chunk;
-
-  Letter& at(float sz,char32_t ch){
-    return *implFind(sz,ch,true);
-    }
-
-  Letter* find(float sz,char32_t ch){
-    return implFind(sz,ch,false);
-    }
-
-  Letter* implFind(float sz,char32_t ch,bool create){
-    uint32_t size = uint32_t(sz*100);
-
-    for(auto& i:chunk)
-      if(i.size==size)
-        return implFind(i,uint32_t(ch),create);
-
-    chunk.emplace_back();
-    chunk.back().size=size;
-    return implFind(chunk.back(),uint32_t(ch),create);
-    }
-
-  Letter* implFind(Chunk& c,uint32_t ch,bool create){
-    uint8_t* key = reinterpret_cast<uint8_t*>(&ch);
-    auto&    b   = c.next[*key];
-    return implFind(b,key+1,create);
-    }
-
-  template<size_t lvl>
-  Letter* implFind(Detail::Bucket<lvl>& b,const uint8_t* k,bool create){
-    auto& ptr = b.next[*k];
-    if(ptr==nullptr && create)
-      ptr.reset(new Detail::Bucket<lvl-1>());
-    if(ptr==nullptr)
-      return nullptr;
-    return implFind(*b.next[*k],k+1,create);
-    }
-
-  Letter* implFind(Detail::Bucket<1>& b,const uint8_t* pk,bool create){
-    auto k = *pk;
-    if(!b.ex[k]){
-      if(create){
-        b.ex[k]=true;
-        return &b.letter[k];
-        }
-      return nullptr;
-      }
-    return &b.letter[k];
-    }
-  };
-
 struct FontElement::Impl {
-  enum { MIN_BUF_SZ=512 };
+  enum { MIN_BUF_SZ=512, MIN_PRELOAD_BATCH=32 };
+  // distance fields are rasterized once, at reference size, and scaled on draw
+  enum { SDF_SIZE=48, SDF_PADDING=4, SDF_ONEDGE=128 };
+  // cache-key tag of distance-field letters; unicode code-points never reach this bit
+  static constexpr char32_t SdfTag = 0x80000000;
 
   template<class CharT>
   Impl(const CharT *filename) {
@@ -195,30 +133,129 @@ struct FontElement::Impl {
     return gbm.pixels;
     }
 
-  static const Letter& nullLater(){
-    static const Letter l;
-    return l;
+  // rasterization output of preload workers
+  struct Raster {
+    char32_t             ch    = 0;
+    float                size  = 0;
+    int                  w=0, h=0, dx=0, dy=0, ax=0;
+    float                scale = 0;
+    std::vector<uint8_t> pixels;
+    };
+
+  // thread-safe: uses only immutable font data and own output buffer
+  void rasterize(Raster& r, bool sdf) const {
+    r.scale = stbtt_ScaleForPixelHeight(&info,r.size);
+    if(!(r.scale>0.f))
+      return;
+
+    const int index = stbtt_FindGlyphIndex(&info,int(r.ch));
+    stbtt_GetGlyphHMetrics(&info,index,&r.ax,nullptr);
+
+    if(sdf) {
+      uint8_t* bitmap = stbtt_GetGlyphSDF(&info,r.scale,index,SDF_PADDING,SDF_ONEDGE,float(SDF_ONEDGE)/float(SDF_PADDING),
+                                          &r.w,&r.h,&r.dx,&r.dy);
+      if(bitmap!=nullptr) {
+        r.pixels.assign(bitmap,bitmap+size_t(r.w*r.h));
+        stbtt_FreeSDF(bitmap,info.userdata);
+        }
+      return;
+      }
+
+    int ix0=0,ix1=0,iy0=0,iy1=0;
+    stbtt_GetGlyphBitmapBoxSubpixel(&info,index,r.scale,r.scale,0.f,0.f,&ix0,&iy0,&ix1,&iy1);
+    r.w  = (ix1 - ix0);
+    r.h  = (iy1 - iy0);
+    r.dx = ix0;
+    r.dy = iy0;
+    if(r.w>0 && r.h>0) {
+      r.pixels.resize(size_t(r.w*r.h));
+      stbtt_MakeGlyphBitmapSubpixel(&info,r.pixels.data(),r.w,r.h,r.w,r.scale,r.scale,0.f,0.f,index);
+      }
     }
 
-  const Letter& letter(char32_t ch,float size,TextureAtlas* tex) {
+  void preload(const std::u32string_view chars, const float* sizes, size_t sizeCount, TextureAtlas& tex) {
+    if(this->size==0)
+      return;
+
+    // distance fields do not depend on size - rasterize reference once, then scale
+    const bool sdf = (mode==GlyphMode::Sdf);
+    std::vector<Raster> job;
+    for(size_t s=0; s<(sdf ? 1 : sizeCount); ++s) {
+      const float sz = sdf ? float(SDF_SIZE) : sizes[s];
+      for(auto ch:chars) {
+        Letter cc;
+        if(map.find(Cache::key(sz,sdf ? (ch|SdfTag) : ch),cc) && cc.hasView)
+          continue;
+        job.emplace_back();
+        job.back().ch   = ch;
+        job.back().size = sz;
+        }
+      }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+      for(size_t i=next.fetch_add(1); i<job.size(); i=next.fetch_add(1))
+        rasterize(job[i],sdf);
+      };
+    const size_t hw    = std::max<size_t>(std::thread::hardware_concurrency(),1);
+    const size_t thCnt = std::min(hw,(job.size()+MIN_PRELOAD_BATCH-1)/MIN_PRELOAD_BATCH);
+    std::vector<std::thread> th;
+    for(size_t i=1; i<thCnt; ++i)
+      th.emplace_back(worker);
+    worker();
+    for(auto& i:th)
+      i.join();
+
+    // batch insert: dirty atlas regions are uploaded together, on next use of the page
+    std::vector<Sprite> spr(job.size());
     {
-    std::lock_guard<std::mutex> guard(syncMap);
-    auto cc=map.find(size,ch);
-    if(cc!=nullptr){
-      if(cc->hasView || tex==nullptr)
-        return *cc;
+    std::lock_guard<std::mutex> guard(syncMem);
+    for(size_t i=0; i<job.size(); ++i)
+      if(!job[i].pixels.empty())
+        spr[i] = tex.load(job[i].pixels.data(),uint32_t(job[i].w),uint32_t(job[i].h),TextureFormat::R8);
+    }
+
+    for(size_t i=0; i<job.size(); ++i) {
+      auto& r = job[i];
+      if((r.w<=0 || r.h<=0) && r.ax==0)
+        continue; // missing glyph - fallback font is resolved lazily
+      Letter lt;
+      lt.view    = std::move(spr[i]);
+      lt.size    = Size(r.w,r.h);
+      lt.dpos    = Point(r.dx,r.dy);
+      lt.advance = Point(int(r.ax*r.scale),int(lineGap*r.scale));
+      lt.hasView = true;
+      lt.sdf     = sdf;
+      const size_t cost = letterCost(lt);
+      map.insert(Cache::key(r.size,sdf ? (r.ch|SdfTag) : r.ch),std::move(lt),cost);
+      }
+
+    if(sdf) {
+      for(size_t s=0; s<sizeCount; ++s)
+        for(auto ch:chars)
+          letterSdf(ch,sizes[s],tex);
       }
     }
 
+  Letter letter(char32_t ch,float size,TextureAtlas* tex) {
+    if(tex!=nullptr && mode==GlyphMode::Sdf)
+      return letterSdf(ch,size,*tex);
+
+    Letter cc;
+    if(map.find(Cache::key(size,ch),cc)){
+      if(cc.hasView || tex==nullptr)
+        return cc;
+      }
+
     if(this->size==0)
-      return nullLater();
+      return Letter();
     return allocLetter(ch,size,tex,false);
     }
 
-  const Letter& allocLetter(char32_t ch,float size,TextureAtlas* tex,bool fallback) {
+  Letter allocLetter(char32_t ch,float size,TextureAtlas* tex,bool fallback) {
     const float scale = stbtt_ScaleForPixelHeight(&info,size); //size/(ascent-descent);
     if(!(scale>0.f))
-      return nullLater();
+      return Letter();
 
     int w=0,h=0,dx=0,dy=0;
     int ax=0;
@@ -245,38 +282,123 @@ struct FontElement::Impl {
     if((w<=0 || h<=0) && ax==0) {
       if(!fallback)
         return allocFallbackLetter(ch,size,tex);
-      return nullLater();
+      return Letter();
       }
 
-    std::lock_guard<std::mutex> guard(syncMap);
-    Letter& lt = map.at(size,ch);
+    Letter lt;
     lt.view    = std::move(spr);
     lt.size    = Size(w,h);
     lt.dpos    = Point(dx,dy);
     lt.advance = Point(int(ax*scale),int(lineGap*scale));
     lt.hasView = (tex!=nullptr);
-    return lt;
+    const size_t cost = letterCost(lt);
+    return map.insert(Cache::key(size,ch),std::move(lt),cost);
+    }
+
+  Letter letterSdf(char32_t ch,float size,TextureAtlas& tex) {
+    Letter cc;
+    if(map.find(Cache::key(size,ch|SdfTag),cc))
+      return cc;
+    if(this->size==0)
+      return Letter();
+
+    Letter ref;
+    if(!map.find(Cache::key(float(SDF_SIZE),ch|SdfTag),ref))
+      ref = allocSdfLetter(ch,tex,false);
+    if(size==float(SDF_SIZE) || !ref.hasView)
+      return ref;
+
+    // same atlas sprite for every size - only metrics are scaled
+    const float k  = size/float(SDF_SIZE);
+    const auto  g  = letter(ch,size,nullptr);
+    Letter      lt;
+    lt.view    = ref.view;
+    lt.size    = Size(int(std::ceil(float(ref.size.w)*k)),int(std::ceil(float(ref.size.h)*k)));
+    lt.dpos    = Point(int(std::floor(float(ref.dpos.x)*k)),int(std::floor(float(ref.dpos.y)*k)));
+    lt.advance = g.advance;
+    lt.hasView = true;
+    lt.sdf     = true;
+    return map.insert(Cache::key(size,ch|SdfTag),std::move(lt),0);
     }
 
-  const Letter& allocFallbackLetter(char32_t ch,float size,TextureAtlas* tex) {
+  Letter allocSdfLetter(char32_t ch,TextureAtlas& tex,bool fallback) {
+    const float scale = stbtt_ScaleForPixelHeight(&info,float(SDF_SIZE));
+    if(!(scale>0.f))
+      return Letter();
+
+    int w=0,h=0,dx=0,dy=0;
+    int ax=0;
+
+    const int index = stbtt_FindGlyphIndex(&info,int(ch));
+    stbtt_GetGlyphHMetrics(&info,index,&ax,nullptr);
+
+    Sprite spr;
+    {
+    std::lock_guard<std::mutex> guard(syncMem);
+    uint8_t* bitmap = stbtt_GetGlyphSDF(&info,scale,index,SDF_PADDING,SDF_ONEDGE,float(SDF_ONEDGE)/float(SDF_PADDING),
+                                        &w,&h,&dx,&dy);
+    if(bitmap!=nullptr) {
+      spr = tex.load(bitmap,uint32_t(w),uint32_t(h),TextureFormat::R8);
+      stbtt_FreeSDF(bitmap,info.userdata);
+      }
+    }
+
+    if((w<=0 || h<=0) && ax==0) {
+      if(!fallback)
+        return allocFallbackSdfLetter(ch,tex);
+      return Letter();
+      }
+
+    Letter lt;
+    lt.view    = std::move(spr);
+    lt.size    = Size(w,h);
+    lt.dpos    = Point(dx,dy);
+    lt.advance = Point(int(ax*scale),int(lineGap*scale));
+    lt.hasView = true;
+    lt.sdf     = true;
+    const size_t cost = letterCost(lt);
+    return map.insert(Cache::key(float(SDF_SIZE),ch|SdfTag),std::move(lt),cost);
+    }
+
+  Impl& fallbackFont() {
+    std::lock_guard<std::mutex> guard(syncFallback);
+    if(fallback==nullptr){
+      fallback.reset(new Impl(Detail::getFallbackFont().c_str()));
+      if(stbtt_InitFont(&fallback->info,fallback->data,0)==0)
+        throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
+      }
+    return *fallback;
+    }
+
+  Letter allocFallbackLetter(char32_t ch,float size,TextureAtlas* tex) {
     try {
-      std::lock_guard<std::mutex> guard(syncMap);
-      if(fallback==nullptr){
-        fallback.reset(new Impl(Detail::getFallbackFont().c_str()));
-        if(stbtt_InitFont(&fallback->info,fallback->data,0)==0)
-          throw std::system_error(Tempest::SystemErrc::UnableToLoadAsset);
-        }
+      Letter lf = fallbackFont().allocLetter(ch,size,tex,true);
+      const size_t cost = letterCost(lf);
+      return map.insert(Cache::key(size,ch),std::move(lf),cost);
+      }
+    catch (...) {
+      return Letter();
+      }
+    }
 
-      Letter  lf = fallback->allocLetter(ch,size,tex,true);
-      Letter& lt = map.at(size,ch);
-      lt = lf;
-      return lt;
+  Letter allocFallbackSdfLetter(char32_t ch,TextureAtlas& tex) {
+    try {
+      Letter lf = fallbackFont().allocSdfLetter(ch,tex,true);
+      const size_t cost = letterCost(lf);
+      return map.insert(Cache::key(float(SDF_SIZE),ch|SdfTag),std::move(lf),cost);
       }
     catch (...) {
-      return nullLater();
+      return Letter();
       }
     }
 
+  static size_t letterCost(const Letter& l) {
+    if(!l.hasView)
+      return 0;
+    // atlas pages are RGBA8
+    return size_t(l.size.w)*size_t(l.size.h)*4;
+    }
+
   Metrics       metrics(float size) const {
     if(this->size==0)
       return Metrics();
@@ -297,8 +419,11 @@ struct FontElement::Impl {
   Metrics        metrics0;
   int            lineGap=0;
 
-  std::mutex                           syncMap;
-  LetterTable                          map;
+  using Cache = Detail::GlyphCache<Letter>;
+  Cache                                map;
+  Detail::TextRunCache                 runs;
+  std::atomic<GlyphMode>               mode{GlyphMode::Bitmap};
+  std::mutex                           syncFallback;
   std::unique_ptr<Impl>                fallback;
   };
 
@@ -336,24 +461,40 @@ FontElement::FontElement(const void* data, size_t size)
   :ptr(std::make_shared<Impl>(data,size)) {
   }
 
-const FontElement::LetterGeometry& FontElement::letterGeometry(char32_t ch, float size) const { //FIXME: UB?
-  return reinterpret_cast<const LetterGeometry&>(ptr->letter(ch,size,nullptr));
+FontElement::LetterGeometry FontElement::letterGeometry(char32_t ch, float size) const {
+  const Letter l = ptr->letter(ch,size,nullptr);
+  LetterGeometry g;
+  g.size    = l.size;
+  g.dpos    = l.dpos;
+  g.advance = l.advance;
+  return g;
   }
 
-const FontElement::Letter& FontElement::letter(char32_t ch, float size, TextureAtlas &tex) const {
+FontElement::Letter FontElement::letter(char32_t ch, float size, TextureAtlas &tex) const {
   return ptr->letter(ch,size,&tex);
   }
 
 Size FontElement::textSize(const char *text, float fontSize) const {
+  if(text==nullptr)
+    return Size();
+
+  Detail::TextRunCache::Key k;
+  k.kind = Detail::TextRunCache::Extent;
+  k.text = text;
+  k.size = fontSize;
+  if(auto run = ptr->runs.find(k))
+    return run->size;
+
   Utf8Iterator i(text);
 
-  Size ret;
-  int  minY = 0;
+  Detail::TextRun run;
+  Size&           ret  = run.size;
+  int             minY = 0;
   while(i.hasData()){
     char32_t c = i.next();
     if(c=='\0')
-      return ret;
-    auto& g = letterGeometry(c,fontSize);
+      break;
+    auto g = letterGeometry(c,fontSize);
 
     ret.h = std::max(ret.h,-g.dpos.y);
     minY  = std::min(minY, -g.dpos.y-g.size.h);
@@ -361,7 +502,7 @@ Size FontElement::textSize(const char *text, float fontSize) const {
     }
 
   ret.h+=minY;
-  return ret;
+  return ptr->runs.insert(k,std::move(run))->size;
   }
 
 bool FontElement::isEmpty() const {
@@ -372,6 +513,48 @@ FontElement::Metrics FontElement::metrics(float size) const {
   return ptr->metrics(size);
   }
 
+void FontElement::preload(TextureAtlas& tex, std::u32string_view chars, const std::vector<float>& sizes) const {
+  ptr->preload(chars,sizes.data(),sizes.size(),tex);
+  }
+
+void FontElement::setGlyphMode(GlyphMode m) {
+  if(ptr->mode.exchange(m)!=m)
+    ptr->runs.clear();
+  }
+
+FontElement::GlyphMode FontElement::glyphMode() const {
+  return ptr->mode;
+  }
+
+void FontElement::setCacheBudget(size_t bytes) {
+  ptr->map.setBudget(bytes);
+  }
+
+size_t FontElement::cacheBudget() const {
+  return ptr->map.memoryBudget();
+  }
+
+size_t FontElement::cacheMemoryUsage() const {
+  return ptr->map.memoryUsage();
+  }
+
+void FontElement::setTextCacheCapacity(size_t runs) {
+  ptr->runs.setCapacity(runs);
+  }
+
+FontElement::TextCacheStats FontElement::textCacheStats() const {
+  auto st = ptr->runs.stats();
+  TextCacheStats ret;
+  ret.hits   = st.hits;
+  ret.misses = st.misses;
+  ret.runs   = st.size;
+  return ret;
+  }
+
+Detail::TextRunCache& FontElement::runCache() const {
+  return ptr->runs;
+  }
+
 template<class CharT>
 Font::Font(const CharT *file,std::true_type)
   : fnt{{file,nullptr},{nullptr,nullptr}}{
@@ -433,27 +616,90 @@ Font::Metrics Font::metrics() const {
   return fnt[bold][italic].metrics(size);
   }
 
-const Font::LetterGeometry &Font::letterGeometry(char16_t ch) const {
+void Font::preload(TextureAtlas& tex, std::u32string_view chars) const {
+  // Painter rasterizes at integer sizes
+  preload(tex,chars,{std::ceil(size)});
+  }
+
+void Font::preload(TextureAtlas& tex, std::u32string_view chars, const std::vector<float>& sizes) const {
+  fnt[bold][italic].preload(tex,chars,sizes);
+  }
+
+void Font::preload(TextureAtlas& tex, char32_t first, char32_t last, const std::vector<float>& sizes) const {
+  if(last<first)
+    return;
+  std::u32string chars(size_t(last-first)+1,U'\0');
+  for(size_t i=0; i<chars.size(); ++i)
+    chars[i] = char32_t(first+i);
+  preload(tex,chars,sizes);
+  }
+
+void Font::setGlyphMode(GlyphMode m) {
+  for(auto& i:fnt)
+    for(auto& f:i)
+      f.setGlyphMode(m);
+  }
+
+Font::GlyphMode Font::glyphMode() const {
+  return fnt[bold][italic].glyphMode();
+  }
+
+void Font::setCacheBudget(size_t bytes) {
+  for(auto& i:fnt)
+    for(auto& f:i)
+      f.setCacheBudget(bytes);
+  }
+
+void Font::setTextCacheCapacity(size_t runs) {
+  for(auto& i:fnt)
+    for(auto& f:i)
+      f.setTextCacheCapacity(runs);
+  }
+
+Font::TextCacheStats Font::textCacheStats() const {
+  // styles may share same font element
+  const FontElement::Impl* visited[4] = {};
+  size_t                   cnt        = 0;
+
+  TextCacheStats ret;
+  for(auto& i:fnt)
+    for(auto& f:i) {
+      if(std::find(visited,visited+cnt,f.ptr.get())!=visited+cnt)
+        continue;
+      visited[cnt++] = f.ptr.get();
+      auto st = f.textCacheStats();
+      ret.hits   += st.hits;
+      ret.misses += st.misses;
+      ret.runs   += st.runs;
+      }
+  return ret;
+  }
+
+Detail::TextRunCache& Font::runCache() const {
+  return fnt[bold][italic].runCache();
+  }
+
+Font::LetterGeometry Font::letterGeometry(char16_t ch) const {
   return fnt[bold][italic].letterGeometry(ch,size);
   }
 
-const Font::LetterGeometry &Font::letterGeometry(char32_t ch) const {
+Font::LetterGeometry Font::letterGeometry(char32_t ch) const {
   return fnt[bold][italic].letterGeometry(ch,size);
   }
 
-const Font::Letter &Font::letter(char16_t ch, TextureAtlas &tex) const {
+Font::Letter Font::letter(char16_t ch, TextureAtlas &tex) const {
   return fnt[bold][italic].letter(ch,size,tex);
   }
 
-const Font::Letter &Font::letter(char32_t ch, TextureAtlas &tex) const {
+Font::Letter Font::letter(char32_t ch, TextureAtlas &tex) const {
   return fnt[bold][italic].letter(ch,size,tex);
   }
 
-const Font::Letter &Font::letter(char16_t ch, Painter &p) const {
+Font::Letter Font::letter(char16_t ch, Painter &p) const {
   return letter(ch,p.ta);
   }
 
-const Font::Letter &Font::letter(char32_t ch, Painter &p) const {
+Font::Letter Font::letter(char32_t ch, Painter &p) const {
   return letter(ch,p.ta);
   }
 
@@ -466,10 +712,25 @@ Size Font::textSize(const std::string &text) const {
   }
 
 Size Font::textSize(int maxW, const char* txt) const {
-  Size ret;
   if(txt==nullptr)
-    return ret;
+    return Size();
 
+  Detail::TextRunCache::Key k;
+  k.kind = Detail::TextRunCache::WrapExtent;
+  k.text = txt;
+  k.size = size;
+  k.w    = maxW;
+  auto& cache = runCache();
+  if(auto run = cache.find(k))
+    return run->size;
+
+  Detail::TextRun run;
+  run.size = implTextSize(maxW,txt);
+  return cache.insert(k,std::move(run))->size;
+  }
+
+Size Font::implTextSize(int maxW, const char* txt) const {
+  Size ret;
   const int pSz = int(std::ceil(pixelSize()));
 
   Utf8Iterator i(txt);
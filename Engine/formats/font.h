@@ -5,12 +5,18 @@
 #include <Tempest/Sprite>
 
 #include <string>
+#include <string_view>
 #include <memory>
+#include <vector>
 
 namespace Tempest {
 
 class Painter;
 
+namespace Detail {
+class TextRunCache;
+}
+
 class FontElement final {
   public:
     FontElement();
@@ -21,6 +27,11 @@ class FontElement final {
     FontElement(const std::u16string& file);
     FontElement(const void* data, size_t size);
 
+    enum GlyphMode : uint8_t {
+      Bitmap,
+      Sdf,
+      };
+
     class LetterGeometry final {
       public:
         Tempest::Size  size;
@@ -33,16 +44,25 @@ class FontElement final {
         int descent=0;
       };
 
+    class TextCacheStats final {
+      public:
+        size_t hits  =0;
+        size_t misses=0;
+        size_t runs  =0;
+      };
+
     class Letter final {
       public:
         Tempest::Size   size;
         Tempest::Point  dpos, advance;
         Tempest::Sprite view;
         bool            hasView=false;
+        bool            sdf    =false;
       };
 
-    const LetterGeometry& letterGeometry(char32_t ch, float size) const;
-    const Letter&         letter(char32_t ch,float size,TextureAtlas& tex) const;
+    LetterGeometry        letterGeometry(char32_t ch, float size) const;
+    Letter                letter(char32_t ch,float size,TextureAtlas& tex) const;
+    void                  preload(TextureAtlas& tex, std::u32string_view chars, const std::vector<float>& sizes) const;
 
     Size                  textSize(const char* text, float fontSize) const;
     Size                  textSize(const char* text, int maxW, float fontSize) const;
@@ -50,13 +70,26 @@ class FontElement final {
 
     Metrics               metrics(float size) const;
 
+    void                  setGlyphMode(GlyphMode m);
+    GlyphMode             glyphMode() const;
+
+    void                  setCacheBudget(size_t bytes);
+    size_t                cacheBudget() const;
+    size_t                cacheMemoryUsage() const;
+
+    void                  setTextCacheCapacity(size_t runs);
+    TextCacheStats        textCacheStats() const;
+
   private:
     template<class CharT>
     FontElement(const CharT* file,std::true_type);
 
-    struct LetterTable;
+    Detail::TextRunCache& runCache() const;
+
     struct Impl;
     std::shared_ptr<Impl> ptr;
+
+  friend class Font;
   };
 
 class Font final {
@@ -64,6 +97,8 @@ class Font final {
     using LetterGeometry = FontElement::LetterGeometry;
     using Letter         = FontElement::Letter;
     using Metrics        = FontElement::Metrics;
+    using TextCacheStats = FontElement::TextCacheStats;
+    using GlyphMode      = FontElement::GlyphMode;
 
     Font()=default;
     Font(const char*           file);
@@ -84,15 +119,25 @@ class Font final {
 
     bool  isEmpty() const;
 
+    void      setGlyphMode(GlyphMode m);
+    GlyphMode glyphMode() const;
+
     Metrics               metrics() const;
+    void                  setCacheBudget(size_t bytes);
+    void                  setTextCacheCapacity(size_t runs);
+    TextCacheStats        textCacheStats() const;
+
+    LetterGeometry        letterGeometry(char16_t ch) const;
+    LetterGeometry        letterGeometry(char32_t ch) const;
+    Letter                letter(char16_t ch,TextureAtlas& tex) const;
+    Letter                letter(char32_t ch,TextureAtlas& tex) const;
 
-    const LetterGeometry& letterGeometry(char16_t ch) const;
-    const LetterGeometry& letterGeometry(char32_t ch) const;
-    const Letter&         letter(char16_t ch,TextureAtlas& tex) const;
-    const Letter&         letter(char32_t ch,TextureAtlas& tex) const;
+    Letter                letter(char16_t ch,Painter& tex) const;
+    Letter                letter(char32_t ch,Painter& tex) const;
 
-    const Letter&         letter(char16_t ch,Painter& tex) const;
-    const Letter&         letter(char32_t ch,Painter& tex) const;
+    void                  preload(TextureAtlas& tex, std::u32string_view chars) const;
+    void                  preload(TextureAtlas& tex, std::u32string_view chars, const std::vector<float>& sizes) const;
+    void                  preload(TextureAtlas& tex, char32_t first, char32_t last, const std::vector<float>& sizes) const;
 
     Size                  textSize(const char* text) const;
     Size                  textSize(const std::string& text) const;
@@ -104,9 +149,14 @@ class Font final {
     template<class CharT>
     Font(const CharT* file,std::true_type);
 
+    Detail::TextRunCache& runCache() const;
+    Size                  implTextSize(int maxW, const char* text) const;
+
     FontElement fnt[2][2];
     float       size   = 18.f;
     uint8_t     bold   = 0;
     uint8_t     italic = 0;
+
+  friend class Painter;
   };
 }
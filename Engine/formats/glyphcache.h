@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// Hashed (size, codepoint) cache with approximate-LRU eviction and memory budget.
+// Lookups are lock-free and return copy of value: nodes are recycled, but never deallocated before
+// the cache itself, entries touched since last eviction pass are never evicted, and evicted or replaced
+// entries are recycled only by eviction pass, that sees no reader inside of find.
+template<class Value>
+class GlyphCache final {
+  public:
+    enum : size_t {
+      DEFAULT_BUDGET = 16*1024*1024,
+      };
+
+    GlyphCache() {
+      table.store(allocTable(minCapacity),std::memory_order_relaxed);
+      }
+    GlyphCache(const GlyphCache&)=delete;
+
+    static uint64_t key(float size, char32_t ch) {
+      if(size==0.f)
+        size = 0.f; // -0
+      uint32_t bits = 0;
+      std::memcpy(&bits,&size,sizeof(bits));
+      return (uint64_t(bits)<<32) | uint64_t(uint32_t(ch));
+      }
+
+    bool find(uint64_t k, Value& out) {
+      readers.fetch_add(1);
+      bool ret = false;
+      const Table* t = table.load();
+      for(size_t i=hash(k)&t->mask, n=0; n<=t->mask; i=(i+1)&t->mask, ++n) {
+        Node* nx = t->slot[i].load(std::memory_order_acquire);
+        if(nx==nullptr)
+          break;
+        if(nx->key.load(std::memory_order_acquire)!=k)
+          continue;
+        nx->stamp.store(clock.load(std::memory_order_relaxed),std::memory_order_relaxed);
+        // node is pinned by `readers`: not recycled, until copy is done
+        out = nx->val;
+        ret = true;
+        break;
+        }
+      readers.fetch_sub(1,std::memory_order_release);
+      return ret;
+      }
+
+    Value insert(uint64_t k, Value&& v, size_t cost) {
+      std::lock_guard<std::mutex> guard(sync);
+      Node* nx = allocNode();
+      nx->val   = std::move(v);
+      nx->cost  = cost + sizeof(Node);
+      nx->stamp.store(clock.load(std::memory_order_relaxed),std::memory_order_relaxed);
+      nx->key.store(k,std::memory_order_release);
+
+      if((used+1)*2>capacity) {
+        size_t cap = capacity;
+        while((live+1)*4>cap)
+          cap *= 2;
+        rehash(cap);
+        }
+      place(nx);
+
+      usage += nx->cost;
+      if(usage>budget)
+        evict(budget - budget/4);
+      return nx->val;
+      }
+
+    void setBudget(size_t b) {
+      std::lock_guard<std::mutex> guard(sync);
+      budget = b;
+      if(usage>budget)
+        evict(budget);
+      }
+
+    size_t memoryBudget() const {
+      std::lock_guard<std::mutex> guard(sync);
+      return budget;
+      }
+
+    size_t memoryUsage() const {
+      std::lock_guard<std::mutex> guard(sync);
+      return usage;
+      }
+
+    size_t size() const {
+      std::lock_guard<std::mutex> guard(sync);
+      return live;
+      }
+
+  private:
+    enum : size_t {
+      minCapacity = 64,
+      };
+    static constexpr uint64_t NoKey = uint64_t(-1);
+
+    struct Node {
+      std::atomic<uint64_t> key  {NoKey};
+      std::atomic<uint32_t> stamp{0};
+      size_t                cost = 0;
+      Value                 val;
+      };
+
+    struct Table {
+      std::unique_ptr<std::atomic<Node*>[]> slot;
+      size_t                                mask = 0;
+      };
+
+    static size_t hash(uint64_t k) {
+      k ^= k >> 33;
+      k *= 0xff51afd7ed558ccdull;
+      k ^= k >> 33;
+      return size_t(k);
+      }
+
+    Table* allocTable(size_t cap) {
+      std::unique_ptr<Table> t(new Table());
+      t->slot.reset(new std::atomic<Node*>[cap]);
+      t->mask = cap-1;
+      for(size_t i=0; i<cap; ++i)
+        t->slot[i].store(nullptr,std::memory_order_relaxed);
+      capacity = cap;
+      used     = 0;
+      tables.emplace_back(std::move(t));
+      return tables.back().get();
+      }
+
+    Node* allocNode() {
+      if(!freeList.empty()) {
+        Node* n = freeList.back();
+        freeList.pop_back();
+        return n;
+        }
+      nodes.emplace_back();
+      return &nodes.back();
+      }
+
+    static Node* tombstone() {
+      static Node t;
+      return &t;
+      }
+
+    void place(Node* nx) {
+      Table*         t    = table.load(std::memory_order_relaxed);
+      const uint64_t k    = nx->key.load(std::memory_order_relaxed);
+      size_t         tomb = size_t(-1);
+      for(size_t i=hash(k)&t->mask;; i=(i+1)&t->mask) {
+        Node* cur = t->slot[i].load(std::memory_order_relaxed);
+        if(cur==nullptr) {
+          if(tomb==size_t(-1)) {
+            tomb = i;
+            ++used;
+            }
+          t->slot[tomb].store(nx,std::memory_order_release);
+          ++live;
+          return;
+          }
+        if(cur==tombstone()) {
+          if(tomb==size_t(-1))
+            tomb = i;
+          continue;
+          }
+        if(cur->key.load(std::memory_order_relaxed)==k) {
+          t->slot[i].store(nx,std::memory_order_release);
+          retire(cur);
+          return;
+          }
+        }
+      }
+
+    void erase(Node* n) {
+      Table*         t = table.load(std::memory_order_relaxed);
+      const uint64_t k = n->key.load(std::memory_order_relaxed);
+      for(size_t i=hash(k)&t->mask;; i=(i+1)&t->mask) {
+        Node* cur = t->slot[i].load(std::memory_order_relaxed);
+        if(cur==nullptr)
+          return;
+        if(cur==n) {
+          // keep slot occupied, so probe chains are not broken for concurrent readers
+          t->slot[i].store(tombstone(),std::memory_order_release);
+          return;
+          }
+        }
+      }
+
+    void rehash(size_t cap) {
+      Table* prev = table.load(std::memory_order_relaxed);
+      Table* next = allocTable(cap);
+      for(size_t i=0; i<=prev->mask; ++i) {
+        Node* n = prev->slot[i].load(std::memory_order_relaxed);
+        if(n==nullptr || n==tombstone())
+          continue;
+        const uint64_t k = n->key.load(std::memory_order_relaxed);
+        for(size_t id=hash(k)&next->mask;; id=(id+1)&next->mask) {
+          if(next->slot[id].load(std::memory_order_relaxed)==nullptr) {
+            next->slot[id].store(n,std::memory_order_relaxed);
+            ++used;
+            break;
+            }
+          }
+        }
+      table.store(next);
+      // readers may still walk an old table - drop old ones only, when nobody is inside of find
+      if(readers.load()==0)
+        tables.erase(tables.begin(),tables.end()-1);
+      }
+
+    void retire(Node* n) {
+      usage  -= n->cost;
+      n->cost = 0; // not linked to table anymore
+      retired.push_back(n);
+      }
+
+    void release(Node* n) {
+      n->key.store(NoKey,std::memory_order_relaxed);
+      n->val  = Value();
+      n->cost = 0;
+      freeList.push_back(n);
+      }
+
+    void evict(size_t target) {
+      const uint32_t now = clock.fetch_add(1,std::memory_order_relaxed);
+      // nodes were unlinked by previous pass, so only reader, that is inside of find now, may hold one
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(readers.load()==0) {
+        for(auto n:retired)
+          release(n);
+        retired.clear();
+        }
+
+      // stamps are updated concurrently by readers - sort by snapshot of them
+      std::vector<std::pair<uint32_t,Node*>> lru;
+      lru.reserve(live);
+      for(auto& n:nodes) {
+        if(n.key.load(std::memory_order_relaxed)==NoKey || n.cost==0)
+          continue;
+        const uint32_t age = now - n.stamp.load(std::memory_order_relaxed);
+        if(age==0)
+          continue; // in use by current pass
+        lru.emplace_back(age,&n);
+        }
+      std::sort(lru.begin(),lru.end(),[](const std::pair<uint32_t,Node*>& a, const std::pair<uint32_t,Node*>& b){
+        return a.first > b.first;
+        });
+
+      for(auto& i:lru) {
+        if(usage<=target)
+          break;
+        erase(i.second);
+        retire(i.second);
+        --live;
+        }
+
+      // compact tombstones, if table is mostly dead
+      if(live*4<used)
+        rehash(std::max<size_t>(minCapacity,capacity/2));
+      }
+
+    mutable std::mutex                  sync;
+    std::atomic<Table*>                 table{nullptr};
+    std::atomic<uint32_t>               clock{0};
+    std::atomic<uint32_t>               readers{0};
+    std::vector<std::unique_ptr<Table>> tables;
+    std::deque<Node>                    nodes;
+    std::vector<Node*>                  freeList;
+    std::vector<Node*>                  retired;
+
+    size_t                              capacity = 0;
+    size_t                              used     = 0;
+    size_t                              live     = 0;
+    size_t                              usage    = 0;
+    size_t                              budget   = DEFAULT_BUDGET;
+  };
+
+}
+}
@@ -0,0 +1,109 @@
+#include "textruncache.h"
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+uint64_t TextRunCache::hash(const Key& k) {
+  // FNV-1a
+  uint64_t h = 0xcbf29ce484222325ull;
+  auto mix = [&h](const void* data, size_t size) {
+    auto b = reinterpret_cast<const uint8_t*>(data);
+    for(size_t i=0; i<size; ++i) {
+      h ^= b[i];
+      h *= 0x100000001b3ull;
+      }
+    };
+  mix(&k.kind,      sizeof(k.kind));
+  mix(k.text.data(),k.text.size());
+  mix(&k.size,      sizeof(k.size));
+  mix(&k.rasterSize,sizeof(k.rasterSize));
+  mix(&k.w,         sizeof(k.w));
+  mix(&k.h,         sizeof(k.h));
+  mix(&k.flags,     sizeof(k.flags));
+  mix(&k.atlas,     sizeof(k.atlas));
+  return h;
+  }
+
+bool TextRunCache::isSame(const Entry& e, const Key& k) {
+  return e.kind==k.kind && e.size==k.size && e.rasterSize==k.rasterSize &&
+         e.w==k.w && e.h==k.h && e.flags==k.flags && e.atlas==k.atlas &&
+         e.text==k.text;
+  }
+
+std::shared_ptr<const TextRun> TextRunCache::find(const Key& k) {
+  const uint64_t h = hash(k);
+
+  std::lock_guard<std::mutex> guard(sync);
+  auto it = index.find(h);
+  if(it==index.end() || !isSame(*it->second,k)) {
+    ++misses;
+    return nullptr;
+    }
+  ++hits;
+  lru.splice(lru.begin(),lru,it->second);
+  return it->second->run;
+  }
+
+std::shared_ptr<const TextRun> TextRunCache::insert(const Key& k, TextRun&& run) {
+  const uint64_t h   = hash(k);
+  auto           ret = std::make_shared<const TextRun>(std::move(run));
+
+  std::lock_guard<std::mutex> guard(sync);
+  auto it = index.find(h);
+  if(it!=index.end()) {
+    // same key, or hash collision - latest run wins
+    lru.erase(it->second);
+    index.erase(it);
+    }
+
+  if(maxRuns==0)
+    return ret;
+
+  shrink(maxRuns-1);
+  lru.emplace_front();
+  Entry& e     = lru.front();
+  e.hash       = h;
+  e.kind       = k.kind;
+  e.text       = std::string(k.text);
+  e.size       = k.size;
+  e.rasterSize = k.rasterSize;
+  e.w          = k.w;
+  e.h          = k.h;
+  e.flags      = k.flags;
+  e.atlas      = k.atlas;
+  e.run        = ret;
+  index[h]     = lru.begin();
+  return ret;
+  }
+
+void TextRunCache::clear() {
+  std::lock_guard<std::mutex> guard(sync);
+  shrink(0);
+  }
+
+void TextRunCache::setCapacity(size_t runs) {
+  std::lock_guard<std::mutex> guard(sync);
+  maxRuns = runs;
+  shrink(maxRuns);
+  }
+
+size_t TextRunCache::capacity() const {
+  std::lock_guard<std::mutex> guard(sync);
+  return maxRuns;
+  }
+
+TextRunCache::Stats TextRunCache::stats() const {
+  std::lock_guard<std::mutex> guard(sync);
+  Stats s;
+  s.hits   = hits;
+  s.misses = misses;
+  s.size   = lru.size();
+  return s;
+  }
+
+void TextRunCache::shrink(size_t sz) {
+  while(lru.size()>sz) {
+    index.erase(lru.back().hash);
+    lru.pop_back();
+    }
+  }
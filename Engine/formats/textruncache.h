@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Tempest/Point>
+#include <Tempest/Size>
+#include <Tempest/Sprite>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Tempest {
+
+class TextureAtlas;
+
+namespace Detail {
+
+// Laid out text: pen positions come from logical-size geometry, views and raster metrics
+// from letters rasterized at Key::rasterSize. No texture coordinates are stored: views are resolved
+// to atlas page on each draw, so run stays valid after TextureAtlas::compact()
+class TextRun final {
+  public:
+    struct Glyph {
+      Tempest::Point  pos;
+      Tempest::Point  dpos;
+      Tempest::Size   size;
+      Tempest::Sprite view;
+      bool            sdf = false;
+      };
+
+    std::vector<Glyph> glyph;
+    Tempest::Size      size;
+  };
+
+class TextRunCache final {
+  public:
+    enum : size_t {
+      DEFAULT_CAPACITY = 1024,
+      };
+
+    enum Kind : uint8_t {
+      Extent,
+      WrapExtent,
+      Draw,
+      Draw16,
+      DrawRect,
+      };
+
+    struct Key {
+      Kind                kind       = Extent;
+      std::string_view    text;
+      float               size       = 0;
+      float               rasterSize = 0;
+      int                 w          = 0;
+      int                 h          = 0;
+      uint32_t            flags      = 0;
+      const TextureAtlas* atlas      = nullptr;
+      };
+
+    struct Stats {
+      size_t hits   = 0;
+      size_t misses = 0;
+      size_t size   = 0;
+      };
+
+    TextRunCache() = default;
+    TextRunCache(const TextRunCache&) = delete;
+
+    std::shared_ptr<const TextRun> find  (const Key& k);
+    std::shared_ptr<const TextRun> insert(const Key& k, TextRun&& run);
+
+    void   clear();
+    void   setCapacity(size_t runs);
+    size_t capacity() const;
+    Stats  stats() const;
+
+  private:
+    struct Entry {
+      uint64_t                       hash = 0;
+      Kind                           kind = Extent;
+      std::string                    text;
+      float                          size       = 0;
+      float                          rasterSize = 0;
+      int                            w          = 0;
+      int                            h          = 0;
+      uint32_t                       flags      = 0;
+      const TextureAtlas*            atlas      = nullptr;
+      std::shared_ptr<const TextRun> run;
+      };
+
+    static uint64_t hash(const Key& k);
+    static bool     isSame(const Entry& e, const Key& k);
+    void            shrink(size_t sz);
+
+    mutable std::mutex                                      sync;
+    std::list<Entry>                                        lru;
+    std::unordered_map<uint64_t,std::list<Entry>::iterator> index;
+    size_t                                                  maxRuns = DEFAULT_CAPACITY;
+    size_t                                                  hits    = 0;
+    size_t                                                  misses  = 0;
+  };
+
+}
+}
@@ -1,6 +1,7 @@
 #include "abstractgraphicsapi.h"
 
 #include <Tempest/Except>
+#include <Tempest/Pixmap>
 
 using namespace Tempest;
 
@@ -96,10 +97,29 @@ void AbstractGraphicsApi::CommandBuffer::begin(bool tranfer) {
   begin();
   }
 
+bool AbstractGraphicsApi::CommandBuffer::beginParallelRendering(const AttachmentDesc*, size_t, uint32_t, uint32_t,
+                                                                 const TextureFormat*, Texture**, Swapchain**, const uint32_t*,
+                                                                 CommandBuffer**, size_t) {
+  return false;
+  }
+
 void AbstractGraphicsApi::CommandBuffer::setDebugMarker(std::string_view tag) {
   (void)tag;
   }
 
+void AbstractGraphicsApi::CommandBuffer::beginTimer(std::string_view) {
+  // NOP by default
+  }
+
+void AbstractGraphicsApi::CommandBuffer::endTimer() {
+  // NOP by default
+  }
+
+const std::vector<GpuTiming>& AbstractGraphicsApi::CommandBuffer::timings() const {
+  static const std::vector<GpuTiming> empty;
+  return empty;
+  }
+
 void AbstractGraphicsApi::CommandBuffer::dispatchMesh(size_t x, size_t y, size_t z) {
   throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
   }
@@ -117,6 +137,76 @@ AbstractGraphicsApi::AccelerationStructure*
   throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
   }
 
+void AbstractGraphicsApi::updateTexture(Device* d, PTexture& t, const Pixmap& p, const Rect* rgn, size_t rgnCount) {
+  // generic path: no partial uploads - replace whole texture
+  (void)rgn;
+  (void)rgnCount;
+  const uint32_t mipCnt = t.handler!=nullptr ? t.handler->mipCount() : 1;
+  d->waitIdle();
+  t = createTexture(d,p,p.format(),mipCnt);
+  }
+
+AbstractGraphicsApi::PTexture AbstractGraphicsApi::composeTexture(Device* d, const Pixmap& p, const TextureCopy* cp, size_t cpCount) {
+  // generic path: no GPU-side copies - upload whole texture
+  (void)cp;
+  (void)cpCount;
+  return createTexture(d,p,p.format(),1);
+  }
+
+void AbstractGraphicsApi::retireTexture(Device* d, PTexture& t) {
+  d->waitIdle();
+  t = PTexture();
+  }
+
+std::vector<uint8_t> AbstractGraphicsApi::pipelineCacheData(Device*) {
+  return {};
+  }
+
+bool AbstractGraphicsApi::loadPipelineCache(Device*, const void*, size_t) {
+  return false;
+  }
+
+AbstractGraphicsApi::CommandBuffer* AbstractGraphicsApi::createComputeCommandBuffer(Device* d) {
+  return createCommandBuffer(d);
+  }
+
+uint64_t AbstractGraphicsApi::submitAsync(Device* d, CommandBuffer* cmd, Fence* fence) {
+  submit(d,cmd,fence);
+  return 0;
+  }
+
+void AbstractGraphicsApi::submit(Device* d, CommandBuffer* cmd, uint64_t /*wait*/, Fence* fence) {
+  submit(d,cmd,fence);
+  }
+
+void AbstractGraphicsApi::setAsyncPipelines(Device*, bool) {
+  // NOP by default
+  }
+
+void AbstractGraphicsApi::precompile(Device*, Pipeline*, const TextureFormat*, size_t) {
+  // NOP by default
+  }
+
+std::vector<GpuHeapBudget> AbstractGraphicsApi::memoryBudget(Device*) {
+  return {};
+  }
+
+size_t AbstractGraphicsApi::defragment(Device*, size_t) {
+  return 0;
+  }
+
+uint32_t AbstractGraphicsApi::bindlessId(Device*, Texture*) {
+  return uint32_t(-1);
+  }
+
+uint32_t AbstractGraphicsApi::bindlessId(Device*, Buffer*) {
+  return uint32_t(-1);
+  }
+
+uint32_t AbstractGraphicsApi::bindlessId(Device*, const Sampler&) {
+  return uint32_t(-1);
+  }
+
 void AbstractGraphicsApi::Desc::ssboBarriers(Detail::ResourceState&, PipelineStage) {
   // NOP by default
   }
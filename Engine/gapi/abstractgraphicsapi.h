@@ -9,6 +9,7 @@
 #include <memory>
 #include <atomic>
 #include <vector>
+#include <string>
 #include <string_view>
 
 #include "../utility/dptr.h"
@@ -311,6 +312,37 @@ namespace Tempest {
     uint32_t firstInstance = 0;
     };
 
+  // GPU time of Encoder::beginTimer/endTimer scope. Scopes of one recording form a tree, in order of beginTimer calls
+  struct GpuTiming final {
+    std::string name;
+    uint32_t    parent   = uint32_t(-1); // enclosing scope; -1 for top-level
+    uint32_t    depth    = 0;
+    double      begin    = 0;            // milliseconds, since first scope of recording
+    double      duration = 0;            // milliseconds; 0, if device has no timestamp queries
+
+    // pipeline statistics of render passes within scope; 0, if not supported
+    uint64_t    inputPrimitives    = 0;
+    uint64_t    vsInvocations      = 0;
+    uint64_t    clippingPrimitives = 0;
+    uint64_t    fsInvocations      = 0;
+    };
+
+  // Point on timeline of async compute queue, see Device::submitAsync. 0 - nothing to wait for
+  struct SyncPoint final {
+    uint64_t value = 0;
+    };
+
+  // Memory heap of device. Without VK_EXT_memory_budget (or an equivalent), `budget` is the heap size
+  // and `usage` counts engine allocations only
+  struct GpuHeapBudget final {
+    uint64_t size        = 0;
+    uint64_t budget      = 0; // how much process can allocate, before it hits memory pressure
+    uint64_t usage       = 0; // how much process has allocated, including other allocators and driver
+    uint64_t allocated   = 0; // pages of engine allocator
+    uint64_t used        = 0; // part of allocator pages, that is in use by resources
+    bool     deviceLocal = false;
+    };
+
   enum class AccessOp : uint8_t {
     Discard,
     Preserve,
@@ -413,6 +445,7 @@ namespace Tempest {
             BasicPoint<int,3> maxGroupSize    = {128,128,64};
             int               maxInvocations  = 128;
             size_t            maxSharedMemory = 16*1024;
+            bool              asyncQueue      = false; // Device::submitAsync runs on dedicated compute queue
             } compute;
 
           struct {
@@ -425,6 +458,7 @@ namespace Tempest {
 
           struct {
             bool     nonUniformIndexing = false;
+            bool     bindlessHeap       = false; // Device::bindlessId is supported
             uint32_t maxStorage         = 500000;
             uint32_t maxTexture         = 500000;
             uint32_t maxSamplers        = 2048;
@@ -567,6 +601,7 @@ namespace Tempest {
         ResourceAccess prev      = ResourceAccess::None;
         ResourceAccess next      = ResourceAccess::None;
         bool           discard   = false;
+        QueueOwnership ownership = QueueOwnership::None;
         };
       struct CommandBuffer:NoCopy {
         virtual ~CommandBuffer()=default;
@@ -576,6 +611,13 @@ namespace Tempest {
                                     const TextureFormat* frm,
                                     AbstractGraphicsApi::Texture** att,
                                     AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId) = 0;
+        // render pass, recorded by `count` secondary command buffers, owned by this one; false, if not supported
+        virtual bool beginParallelRendering(const AttachmentDesc* desc, size_t descSize,
+                                            uint32_t w, uint32_t h,
+                                            const TextureFormat* frm,
+                                            AbstractGraphicsApi::Texture** att,
+                                            AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId,
+                                            CommandBuffer** secondary, size_t count);
         virtual void endRendering() = 0;
 
         virtual void barrier(const BarrierDesc* desc, size_t cnt) = 0;
@@ -604,6 +646,11 @@ namespace Tempest {
         virtual void setScissor (const Rect& r)=0;
         virtual void setDebugMarker(std::string_view tag);
 
+        virtual void beginTimer(std::string_view name);
+        virtual void endTimer();
+        // timings of previous recording of this command buffer
+        virtual const std::vector<GpuTiming>& timings() const;
+
         virtual void draw        (const Buffer* vbo, size_t stride, size_t offset, size_t vertexCount,
                                   size_t firstInstance, size_t instanceCount) = 0;
         virtual void drawIndexed (const Buffer* vbo, size_t stride, size_t voffset,
@@ -626,6 +673,12 @@ namespace Tempest {
       using PShader       = Detail::DSharedPtr<Shader*>;
       using PPipelineLay  = Detail::DSharedPtr<PipelineLay*>;
 
+      struct TextureCopy {
+        PTexture src;
+        Rect     rgn;
+        Point    at;
+        };
+
       virtual std::vector<Props> devices() const = 0;
 
     protected:
@@ -657,6 +710,13 @@ namespace Tempest {
       virtual PTexture   createTexture(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) = 0;
       virtual PTexture   createStorage(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) = 0;
       virtual PTexture   createStorage(Device* d, const uint32_t w, const uint32_t h, const uint32_t depth, uint32_t mips, TextureFormat frm) = 0;
+      // replaces `t` with texture of `p`; only regions `rgn` differ from content of `t`
+      virtual void       updateTexture(Device* d, PTexture& t, const Pixmap& p, const Rect* rgn, size_t rgnCount);
+      // texture of `p`, with regions `cp` copied from other textures on GPU; rest is cleared.
+      // Content of `p` must match copied regions: generic path uploads it.
+      virtual PTexture   composeTexture(Device* d, const Pixmap& p, const TextureCopy* cp, size_t cpCount);
+      // releases `t`, once commands submitted so far are complete
+      virtual void       retireTexture(Device* d, PTexture& t);
 
       virtual AccelerationStructure* createBottomAccelerationStruct(Device* d, const RtGeometry* geom, size_t geomSize);
       virtual AccelerationStructure* createTopAccelerationStruct(Device* d, const RtInstance* geom, AccelerationStructure*const* as, size_t geomSize);
@@ -668,8 +728,34 @@ namespace Tempest {
       virtual void       present  (Device *d, Swapchain* sw)=0;
       virtual void       submit   (Device *d, CommandBuffer*  cmd, Fence* fence)=0;
 
+      // async compute: command buffer of `createComputeCommandBuffer` is submitted to compute queue and returns point
+      // on it's timeline; `submit` with non-zero `wait` makes graphics queue wait for it. Defaults to graphics queue
+      virtual CommandBuffer*
+                         createComputeCommandBuffer(Device* d);
+      virtual uint64_t   submitAsync(Device *d, CommandBuffer* cmd, Fence* fence);
+      virtual void       submit     (Device *d, CommandBuffer* cmd, uint64_t wait, Fence* fence);
+
       virtual void       getCaps  (Device *d, Props& caps)=0;
 
+      // serialized pipeline cache; empty, if backend has no persistent cache
+      virtual std::vector<uint8_t>
+                         pipelineCacheData(Device* d);
+      virtual bool       loadPipelineCache(Device* d, const void* data, size_t size);
+
+      // background compilation of render-target specific pipeline variants; no-op, if backend has none
+      virtual void       setAsyncPipelines(Device* d, bool enable);
+      virtual void       precompile(Device* d, Pipeline* p, const TextureFormat* frm, size_t count);
+
+      // memory heaps state; empty, if backend doesn't track it
+      virtual std::vector<GpuHeapBudget>
+                         memoryBudget(Device* d);
+      virtual size_t     defragment(Device* d, size_t maxBytes);
+
+      // index of resource in device-wide bindless heap; uint32_t(-1), if heap is not supported
+      virtual uint32_t   bindlessId(Device* d, Texture* t);
+      virtual uint32_t   bindlessId(Device* d, Buffer*  b);
+      virtual uint32_t   bindlessId(Device* d, const Sampler& smp);
+
     friend class Tempest::Device;
     };
 }
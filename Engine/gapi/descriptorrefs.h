@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace Tempest {
+namespace Detail {
+
+// Reverse index from resource handle to cached descriptor sets, that refer to it.
+// Destruction of resource marks only its own sets as stale, so reused handle never matches them.
+// S has `std::atomic<bool> stale`; set must be unlinked, before it's destroyed.
+template<class S>
+class DescriptorRefs {
+  public:
+    void link(S& set, const uint64_t* handles, size_t cnt) {
+      std::lock_guard<std::mutex> guard(sync);
+      size_t i=0;
+      try {
+        for(; i<cnt; ++i)
+          refs.emplace(handles[i],&set);
+        }
+      catch(...) {
+        implUnlink(set,handles,i);
+        throw;
+        }
+      }
+
+    void unlink(S& set, const uint64_t* handles, size_t cnt) {
+      std::lock_guard<std::mutex> guard(sync);
+      implUnlink(set,handles,cnt);
+      }
+
+    // resource is about to be destroyed: sets, that refer to it, must not be reused
+    void invalidate(uint64_t handle) {
+      if(handle==0)
+        return;
+      std::lock_guard<std::mutex> guard(sync);
+      auto rg = refs.equal_range(handle);
+      for(auto r=rg.first; r!=rg.second; ++r)
+        r->second->stale.store(true);
+      refs.erase(rg.first,rg.second);
+      }
+
+    size_t size() const {
+      std::lock_guard<std::mutex> guard(sync);
+      return refs.size();
+      }
+
+  private:
+    mutable std::mutex                   sync;
+    std::unordered_multimap<uint64_t,S*> refs;
+
+    void implUnlink(S& set, const uint64_t* handles, size_t cnt) {
+      for(size_t i=0; i<cnt; ++i) {
+        // entry is gone already, if handle was invalidated
+        auto rg = refs.equal_range(handles[i]);
+        for(auto r=rg.first; r!=rg.second; ++r)
+          if(r->second==&set) {
+            refs.erase(r);
+            break;
+            }
+        }
+      }
+  };
+
+}
+}
@@ -1,17 +1,27 @@
 #pragma once
 
 #include <cstdint>
-#include <forward_list>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include <algorithm>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace Tempest {
 namespace Detail {
 
+// Two-level segregated fit (TLSF) sub-allocator of device memory pages.
+// Every heap has own lock and free-lists, shared across all of it's pages; blocks only merge with physical neighbours in same page.
+// Allocation and free are O(1), block nodes are pooled.
 template<class MemoryProvider>
 class DeviceAllocator {
   struct Page;
   struct Block;
+  struct Heap;
   public:
     enum {
       DEFAULT_PAGE_SIZE=128*1024*1024
@@ -24,233 +34,565 @@ class DeviceAllocator {
     DeviceAllocator(const DeviceAllocator&)=delete;
 
     ~DeviceAllocator(){
-      for(auto& i:pages)
-        device.free(i.memory,i.size,i.typeId);
+      for(auto& h:heaps)
+        for(auto& i:h->pages)
+          release(i);
       }
 
     struct Allocation {
       Page*  page  =nullptr;
       size_t offset=0,size=0;
+      Block* block =nullptr;
+      };
+
+    struct Stats {
+      uint32_t heapId      = 0;
+      size_t   pages       = 0;
+      size_t   total       = 0;
+      size_t   allocated   = 0;
+      size_t   free        = 0;
+      size_t   freeBlocks  = 0;
+      size_t   largestFree = 0;
+
+      // 0 - all free space is one block; close to 1 - free space is scattered in small blocks
+      double   fragmentation() const { return free==0 ? 0.0 : 1.0 - double(largestFree)/double(free); }
+      };
+
+    struct Move {
+      Allocation from, to;
+      void*      owner = nullptr;
       };
 
     Allocation alloc(size_t size, size_t align, uint32_t heapId, uint32_t typeId, bool hostVisible) {
-      std::lock_guard<std::mutex> guard(sync);
-      for(auto& i:pages){
-        if(i.heapId==heapId && i.allocated+size<=i.allSize){
-          auto ret=i.alloc(size,align,device);
-          if(ret.page!=nullptr)
-            return ret;
-          }
-        }
-      return rawAlloc(size,align,heapId,typeId,hostVisible,false);
+      Heap& h = heap(heapId);
+      std::lock_guard<std::mutex> guard(h.sync);
+      if(Block* b = h.find(size,align))
+        return h.alloc(*b,size,align);
+      return rawAlloc(h,size,align,typeId,hostVisible,false);
       }
 
     void free(const Allocation& a){
-      std::lock_guard<std::mutex> guard(sync);
-      a.page->free(a);
-      if(a.page->allocated==0){
-        device.free(a.page->memory,a.page->size,a.page->typeId);
-        pages.remove(*a.page);
+      Page& pg = *a.page;
+      Heap& h  = *pg.heap;
+      std::lock_guard<std::mutex> guard(h.sync);
+      if(pg.dedicated)
+        pg.allocated = 0; else
+        h.free(*a.block);
+      if(pg.allocated==0){
+        if(!pg.dedicated)
+          h.removeFree(*pg.first); // whole page is one free block at this point
+        h.delBlock(pg.first);
+        release(pg);
+        h.pages.remove_if([&pg](const Page& p){ return &p==&pg; });
         }
       }
 
     Allocation dedicatedAlloc(size_t size, size_t align, uint32_t heapId, uint32_t typeId, bool hostVisible) {
-      std::lock_guard<std::mutex> guard(sync);
-      return rawAlloc(size,align,heapId,typeId,hostVisible,true);
+      Heap& h = heap(heapId);
+      std::lock_guard<std::mutex> guard(h.sync);
+      return rawAlloc(h,size,align,typeId,hostVisible,true);
       }
 
     void setDefaultPageSize(uint32_t sz) {
       defPageSize = sz;
       }
 
+    // resource, that owns allocation; only owned allocations can be relocated by defragment()
+    void setOwner(const Allocation& a, void* owner) {
+      if(a.block==nullptr)
+        return;
+      std::lock_guard<std::mutex> guard(a.page->heap->sync);
+      a.block->owner = owner;
+      }
+
+    // Picks sparsely used pages (allocated <= maxOccupancy of the page), and reserves new place for their content
+    // in other pages of the same heap. Picked pages are excluded from new allocations, until endDefragment().
+    // `alignment(owner)` returns alignment of owned allocation, or 0, if it can't be relocated.
+    // Caller copies data of every move and frees `from` - page is released, once last allocation is gone.
+    template<class Fn>
+    std::vector<Move> defragment(size_t maxBytes, double maxOccupancy, Fn alignment) {
+      std::vector<Move> ret;
+      std::lock_guard<std::mutex> guard(sync);
+      for(auto& h:heaps) {
+        std::lock_guard<std::mutex> hGuard(h->sync);
+        if(!h->defragment(ret,maxBytes,maxOccupancy,alignment))
+          break;
+        }
+      return ret;
+      }
+
+    // returns pages, that are not released by defragment(), back to use
+    void endDefragment() {
+      std::lock_guard<std::mutex> guard(sync);
+      for(auto& h:heaps) {
+        std::lock_guard<std::mutex> hGuard(h->sync);
+        for(auto& p:h->pages)
+          if(p.evacuating)
+            h->restore(p);
+        }
+      }
+
+    std::vector<Stats> stats() {
+      std::vector<Stats> ret;
+      std::lock_guard<std::mutex> guard(sync);
+      ret.reserve(heaps.size());
+      for(auto& h:heaps) {
+        std::lock_guard<std::mutex> hGuard(h->sync);
+        ret.push_back(h->stats());
+        }
+      return ret;
+      }
+
   private:
-    Allocation rawAlloc(size_t size, size_t align, uint32_t heapId, uint32_t typeId, bool hostVisible, bool dedicated){
+    Heap& heap(uint32_t heapId) {
+      std::lock_guard<std::mutex> guard(sync);
+      for(auto& i:heaps)
+        if(i->heapId==heapId)
+          return *i;
+      heaps.emplace_back(new Heap(heapId));
+      return *heaps.back();
+      }
+
+    Allocation rawAlloc(Heap& h, size_t size, size_t align, uint32_t typeId, bool hostVisible, bool dedicated){
       const uint32_t pgSize = (dedicated ? uint32_t(size) : std::max<uint32_t>(defPageSize,uint32_t(size)));
-      Page pg(pgSize);
-      pg.memory      = device.alloc(pg.allSize,typeId);
-      pg.typeId      = typeId;
-      pg.heapId      = heapId;
-      pg.hostVisible = hostVisible;
-      if(pg.memory==null)
+      Memory memory = device.alloc(pgSize,typeId);
+      if(memory==null)
         return Allocation();
+
+      Page* pg = nullptr;
       try {
-        pages.push_front(Page(0));
+        pg = &h.pages.emplace_front();
+        pg->first = h.newBlock();
         }
       catch(...){
-        device.free(pg.memory,pg.size,pg.typeId);
+        if(pg!=nullptr)
+          h.pages.pop_front();
+        device.free(memory,pgSize,typeId);
         throw;
         }
-      pages.front() = std::move(pg);
-      return pages.front().alloc(size,align,device);
+
+      pg->memory      = memory;
+      pg->heap        = &h;
+      pg->typeId      = typeId;
+      pg->heapId      = h.heapId;
+      pg->allSize     = pgSize;
+      pg->hostVisible = hostVisible;
+      pg->dedicated   = dedicated;
+      if(hostVisible)
+        pg->mapped = map(memory,pgSize);
+
+      Block& b = *pg->first;
+      b.page   = pg;
+      b.offset = 0;
+      b.size   = pgSize;
+
+      if(dedicated) {
+        b.free        = false;
+        pg->allocated = pgSize;
+
+        Allocation a;
+        a.page   = pg;
+        a.offset = 0;
+        a.size   = size;
+        a.block  = &b;
+        return a;
+        }
+
+      h.insertFree(b);
+      return h.alloc(b,size,align); // offset 0 satisfies any alignment
       }
 
-    void       freeDevMemory(Memory mem){
-      return device.free(mem);
+    // host-visible pages are mapped once for the whole page lifetime, if provider can map memory
+    void*      map(Memory mem, size_t size) {
+      return implMap(device,mem,size,0);
       }
 
-    MemoryProvider&         device;
-    std::mutex              sync;
-    std::forward_list<Page> pages;
-    uint32_t                defPageSize = DEFAULT_PAGE_SIZE;
+    void       release(Page& pg) {
+      if(pg.mapped!=nullptr)
+        implUnmap(device,pg.memory,0);
+      pg.mapped = nullptr;
+      device.free(pg.memory,pg.allSize,pg.typeId);
+      }
+
+    // map/unmap are optional in MemoryProvider: int-overload is picked, if method exists
+    template<class D>
+    static auto implMap(D& d, Memory mem, size_t size, int) -> decltype(d.map(mem,size)) { return d.map(mem,size); }
+    template<class D>
+    static void* implMap(D&, Memory, size_t, long) { return nullptr; }
+
+    template<class D>
+    static auto implUnmap(D& d, Memory mem, int) -> decltype(d.unmap(mem),void()) { d.unmap(mem); }
+    template<class D>
+    static void implUnmap(D&, Memory, long) {}
+
+    MemoryProvider&                    device;
+    std::mutex                         sync;
+    std::vector<std::unique_ptr<Heap>> heaps;
+    uint32_t                           defPageSize = DEFAULT_PAGE_SIZE;
   };
 
 template<class MemoryProvider>
 struct DeviceAllocator<MemoryProvider>::Block {
-  Block*   next  =nullptr;
-  uint32_t size  =0;
-  uint32_t offset=0;
+  Page*    page     = nullptr;
+  Block*   prevPhys = nullptr;
+  Block*   nextPhys = nullptr;
+  Block*   prevFree = nullptr;
+  Block*   nextFree = nullptr;
+  void*    owner    = nullptr;
+  uint32_t offset   = 0;
+  uint32_t size     = 0;
+  bool     free     = false;
   };
 
 template<class MemoryProvider>
-struct DeviceAllocator<MemoryProvider>::Page : Block {
-  using    Block::next;
-  using    Block::size;
-  using    Block::offset;
-
+struct DeviceAllocator<MemoryProvider>::Page {
   Memory     memory = null;
+  void*      mapped = nullptr;
   std::mutex mmapSync;
+  Heap*      heap        = nullptr;
+  Block*     first       = nullptr;
   uint32_t   typeId      = 0;
   uint32_t   heapId      = 0;
   uint32_t   allSize     = 0;
   uint32_t   allocated   = 0;
   bool       hostVisible = false;
+  bool       dedicated   = false;
+  bool       evacuating  = false; // free blocks are not in free-lists
+  };
 
-  Page(uint32_t sz) noexcept {
-    size   =sz;
-    allSize=sz;
+template<class MemoryProvider>
+struct DeviceAllocator<MemoryProvider>::Heap {
+  // second level splits every power of two into 16 lists; sizes below 16 units are mapped linearly
+  enum : uint32_t {
+    SlBits    = 4,
+    SlCount   = 1u << SlBits,
+    FlCount   = 32 - SlBits + 1,
+    PoolChunk = 256,
+    };
+
+  explicit Heap(uint32_t heapId):heapId(heapId){}
+  Heap(const Heap&) = delete;
+
+  const uint32_t                      heapId;
+  std::mutex                          sync;
+  std::list<Page>                     pages;
+
+  uint32_t                            flMap = 0;
+  uint32_t                            slMap[FlCount] = {};
+  Block*                              lists[FlCount][SlCount] = {};
+
+  Block*                              pool = nullptr;
+  std::vector<std::unique_ptr<Block[]>> chunks;
+
+  // index of highest/lowest set bit; v must be non-zero
+  static uint32_t msb(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long i = 0;
+    if(_BitScanReverse(&i,uint32_t(v>>32)))
+      return uint32_t(i)+32;
+    _BitScanReverse(&i,uint32_t(v));
+    return uint32_t(i);
+#else
+    return uint32_t(63 - __builtin_clzll(v));
+#endif
     }
 
-  Page(Page&& p) noexcept {
-    std::swap(next,p.next);
-    size  =p.size;
-    offset=p.offset;
-    std::swap(memory,p.memory);
-    typeId      = p.typeId;
-    heapId      = p.heapId;
-    allSize     = p.allSize;
-    hostVisible = p.hostVisible;
+  static uint32_t lsb(uint32_t v) {
+#if defined(_MSC_VER)
+    unsigned long i = 0;
+    _BitScanForward(&i,v);
+    return uint32_t(i);
+#else
+    return uint32_t(__builtin_ctz(v));
+#endif
     }
 
-  ~Page(){
-    Block* b=next;
-    while(b!=nullptr){
-      Block* p=b->next;
-      delete b;
-      b=p;
+  static void mapping(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    if(size<SlCount) {
+      fl = 0;
+      sl = uint32_t(size);
+      return;
       }
+    const uint32_t f = msb(size);
+    fl = f - SlBits + 1;
+    sl = uint32_t(size >> (f-SlBits)) - SlCount;
     }
 
-  Page& operator=(Page&& p) noexcept {
-    std::swap(next,p.next);
-    size  =p.size;
-    offset=p.offset;
-    std::swap(memory,p.memory);
-    typeId      = p.typeId;
-    heapId      = p.heapId;
-    allSize     = p.allSize;
-    hostVisible = p.hostVisible;
-    return *this;
-    }
-
-  bool operator==(const Page& other) const noexcept {
-    return memory==other.memory;
+  Block* find(size_t size, size_t align) const {
+    // round up to the next list, so any block from it is large enough
+    uint64_t need = uint64_t(std::max<size_t>(size,1)) + (align>1 ? align-1 : 0);
+    if(need>=SlCount)
+      need += (uint64_t(1) << (msb(need)-SlBits)) - 1;
+
+    uint32_t fl = 0, sl = 0;
+    mapping(need,fl,sl);
+    if(fl>=FlCount)
+      return nullptr;
+
+    uint32_t slm = slMap[fl] & (~0u << sl);
+    if(slm==0) {
+      const uint32_t flm = (fl+1<FlCount) ? (flMap & (~0u << (fl+1))) : 0;
+      if(flm==0)
+        return nullptr;
+      fl  = lsb(flm);
+      slm = slMap[fl];
+      }
+    sl = lsb(slm);
+    return lists[fl][sl];
     }
 
-  Allocation alloc(size_t size,size_t align,MemoryProvider& /*prov*/) noexcept {
-    Block*   b=this;
-    while(b!=nullptr) {
-      if(size<=b->size) {
-        size_t padding=b->offset%align;
-        if(padding==0)
-          return alloc(*b,size);
-
-        padding=align-padding;
-        if(size+padding==b->size) {
-          return alloc(*b,size,padding);
-          } else
-        if(size+padding<b->size){
-          Block* bp=new(std::nothrow) Block();
-          if(bp!=nullptr){
-            bp->next=b->next;
-            b->next =bp;
-
-            bp->size  =uint32_t(b->size-padding);
-            bp->offset=uint32_t(b->offset+padding);
-            b->size   =uint32_t(padding);
-
-            return alloc(*bp,size);
-            }
-          }
-        }
-      b=b->next;
+  Allocation alloc(Block& b, size_t size, size_t align) {
+    removeFree(b);
+    size = std::max<size_t>(size,1);
+
+    const uint32_t pad = uint32_t((align - b.offset%align)%align);
+    if(pad>0) {
+      // prevPhys is never free: neighbouring free blocks are always merged
+      Block& p = *newBlock();
+      p.page     = b.page;
+      p.offset   = b.offset;
+      p.size     = pad;
+      link(b.prevPhys,&p,&b);
+      b.offset  += pad;
+      b.size    -= pad;
+      insertFree(p);
       }
-    return Allocation{};
-    }
 
-  Allocation alloc(Block& b,size_t size) noexcept {
-    Allocation a;
-    a.offset=b.offset;
-    a.page  =this;
-    a.size  =size;
+    if(b.size>size) {
+      Block& r = *newBlock();
+      r.page   = b.page;
+      r.offset = b.offset + uint32_t(size);
+      r.size   = b.size   - uint32_t(size);
+      link(&b,&r,b.nextPhys);
+      b.size   = uint32_t(size);
+      insertFree(r);
+      }
 
-    b.offset +=uint32_t(size);
-    b.size   -=uint32_t(size);
-    allocated+=uint32_t(size);
-    return a;
-    }
+    b.free  = false;
+    b.owner = nullptr; // block may be left over from relocatable allocation
+    b.page->allocated += b.size;
 
-  Allocation alloc(Block& b,size_t size,size_t padding) noexcept {
     Allocation a;
-    a.offset=b.offset+padding;
-    a.page  =this;
-    a.size  =size;
-
-    uint32_t sz=uint32_t(size+padding);
-    b.offset +=sz;
-    b.size   -=sz;
-    allocated+=uint32_t(size);
+    a.page   = b.page;
+    a.offset = b.offset;
+    a.size   = size;
+    a.block  = &b;
     return a;
     }
 
-  void free(const Allocation& a) noexcept {
-    allocated -= uint32_t(a.size);
-
-    Block* b=this;
-    while(b!=nullptr && (b->offset+b->size)<a.offset)
-      b=b->next;
+  void free(Block& b) {
+    b.page->allocated -= b.size;
+    b.free  = true;
+    b.owner = nullptr;
+
+    Block* blk = &b;
+    if(Block* p = blk->prevPhys; p!=nullptr && p->free) {
+      removeFree(*p);
+      p->size    += blk->size;
+      unlink(*blk);
+      delBlock(blk);
+      blk = p;
+      }
+    if(Block* n = blk->nextPhys; n!=nullptr && n->free) {
+      removeFree(*n);
+      blk->size  += n->size;
+      unlink(*n);
+      delBlock(n);
+      }
+    if(blk->prevPhys==nullptr)
+      blk->page->first = blk;
+    insertFree(*blk);
+    }
 
-    if(b->offset+b->size==a.offset){
-      b->size+=uint32_t(a.size);
-      mergeWithNext(b);
+  void insertFree(Block& b) {
+    if(b.page->evacuating) {
+      b.free = true;
       return;
       }
-    if(b->offset==a.offset+a.size){
-      b->offset=uint32_t(a.offset);
-      b->size +=uint32_t(a.size);
+    uint32_t fl = 0, sl = 0;
+    mapping(b.size,fl,sl);
+    b.free     = true;
+    b.prevFree = nullptr;
+    b.nextFree = lists[fl][sl];
+    if(b.nextFree!=nullptr)
+      b.nextFree->prevFree = &b;
+    lists[fl][sl] = &b;
+    slMap[fl] |= (1u << sl);
+    flMap     |= (1u << fl);
+    }
+
+  void removeFree(Block& b) {
+    if(b.page->evacuating) {
+      b.free = false;
       return;
       }
+    uint32_t fl = 0, sl = 0;
+    mapping(b.size,fl,sl);
+    if(b.prevFree!=nullptr)
+      b.prevFree->nextFree = b.nextFree; else
+      lists[fl][sl] = b.nextFree;
+    if(b.nextFree!=nullptr)
+      b.nextFree->prevFree = b.prevFree;
+    b.prevFree = nullptr;
+    b.nextFree = nullptr;
+    b.free     = false;
+    if(lists[fl][sl]==nullptr) {
+      slMap[fl] &= ~(1u << sl);
+      if(slMap[fl]==0)
+        flMap &= ~(1u << fl);
+      }
+    }
 
-    Block* r=new(std::nothrow) Block();
-    if(r==nullptr)
-      return; // no error, but sort of leak in Page
-    *r=*b;
-    b->next  =r;
-    b->size  =uint32_t(a.size);
-    b->offset=uint32_t(a.offset);
+  static void link(Block* prev, Block* b, Block* next) {
+    b->prevPhys = prev;
+    b->nextPhys = next;
+    if(prev!=nullptr)
+      prev->nextPhys = b; else
+      b->page->first = b;
+    if(next!=nullptr)
+      next->prevPhys = b;
     }
 
-  void mergeWithNext(Block* b) noexcept {
-    while(b->next!=nullptr){
-      if(b->offset+b->size==b->next->offset){
-        auto rm=b->next;
-        b->size+=b->next->size;
-        b->next=b->next->next;
-        delete rm;
-        } else {
-        return;
+  static void unlink(Block& b) {
+    if(b.prevPhys!=nullptr)
+      b.prevPhys->nextPhys = b.nextPhys;
+    if(b.nextPhys!=nullptr)
+      b.nextPhys->prevPhys = b.prevPhys;
+    }
+
+  template<class Fn>
+  bool defragment(std::vector<Move>& out, size_t& maxBytes, double maxOccupancy, Fn& alignment) {
+    if(pages.size()<2)
+      return true;
+
+    std::vector<Page*> sparse;
+    for(auto& p:pages) {
+      if(p.dedicated || p.evacuating || p.allocated==0)
+        continue;
+      if(double(p.allocated) <= double(p.allSize)*maxOccupancy)
+        sparse.push_back(&p);
+      }
+    std::sort(sparse.begin(),sparse.end(),[](const Page* l, const Page* r){ return l->allocated<r->allocated; });
+
+    // exclude all picked pages first, so nothing is relocated into a page that is going away
+    size_t cnt = 0;
+    for(auto p:sparse) {
+      if(p->allocated>maxBytes || !isMovable(*p,alignment))
+        continue;
+      maxBytes -= p->allocated;
+      evacuate(*p);
+      sparse[cnt++] = p;
+      }
+    sparse.resize(cnt);
+
+    for(auto p:sparse) {
+      const size_t first = out.size();
+      bool         ok    = true;
+      for(Block* b=p->first; b!=nullptr && ok; b=b->nextPhys) {
+        if(b->free)
+          continue;
+        const size_t align = alignment(b->owner);
+        Block*       dst   = find(b->size,align);
+        if(dst==nullptr) {
+          ok = false;
+          break;
+          }
+        Move m;
+        m.from.page   = p;
+        m.from.offset = b->offset;
+        m.from.size   = b->size;
+        m.from.block  = b;
+        m.to          = alloc(*dst,b->size,align);
+        m.to.block->owner = b->owner;
+        m.owner       = b->owner;
+        out.push_back(m);
+        }
+      if(!ok) {
+        // not enough space in other pages: roll back this page and stop with this heap
+        for(size_t i=first; i<out.size(); ++i)
+          free(*out[i].to.block);
+        out.resize(first);
+        for(auto r:sparse)
+          if(r->evacuating && (r==p || !hasMoves(out,*r))) {
+            maxBytes += r->allocated;
+            restore(*r);
+            }
+        return maxBytes>0;
         }
       }
+    return maxBytes>0;
+    }
+
+  template<class Fn>
+  static bool isMovable(const Page& p, Fn& alignment) {
+    for(Block* b=p.first; b!=nullptr; b=b->nextPhys) {
+      if(b->free)
+        continue;
+      if(b->owner==nullptr || alignment(b->owner)==0)
+        return false;
+      }
+    return true;
+    }
+
+  static bool hasMoves(const std::vector<Move>& mv, const Page& p) {
+    for(auto& i:mv)
+      if(i.from.page==&p)
+        return true;
+    return false;
+    }
+
+  void evacuate(Page& p) {
+    for(Block* b=p.first; b!=nullptr; b=b->nextPhys)
+      if(b->free) {
+        removeFree(*b);
+        b->free = true;
+        }
+    p.evacuating = true;
+    }
+
+  void restore(Page& p) {
+    p.evacuating = false;
+    for(Block* b=p.first; b!=nullptr; b=b->nextPhys)
+      if(b->free)
+        insertFree(*b);
+    }
+
+  Block* newBlock() {
+    if(pool==nullptr) {
+      std::unique_ptr<Block[]> c(new Block[PoolChunk]);
+      for(uint32_t i=0; i<PoolChunk; ++i) {
+        c[i].nextFree = pool;
+        pool = &c[i];
+        }
+      chunks.emplace_back(std::move(c));
+      }
+    Block* b = pool;
+    pool = b->nextFree;
+    *b = Block();
+    return b;
+    }
+
+  void delBlock(Block* b) {
+    b->nextFree = pool;
+    pool = b;
+    }
+
+  Stats stats() const {
+    Stats st;
+    st.heapId = heapId;
+    for(auto& p:pages) {
+      st.pages     += 1;
+      st.total     += p.allSize;
+      st.allocated += p.allocated;
+      }
+    for(uint32_t fl=0; fl<FlCount; ++fl)
+      for(uint32_t sl=0; sl<SlCount; ++sl)
+        for(Block* b=lists[fl][sl]; b!=nullptr; b=b->nextFree) {
+          st.free       += b->size;
+          st.freeBlocks += 1;
+          st.largestFree = std::max<size_t>(st.largestFree,b->size);
+          }
+    return st;
     }
   };
 }}
-
@@ -77,6 +77,13 @@ inline ResourceAccess operator & (ResourceAccess a,const ResourceAccess& b) {
   return ResourceAccess(uint32_t(a)&uint32_t(b));
   }
 
+// queue family ownership transfer, between graphics and async compute queue
+enum class QueueOwnership : uint8_t {
+  None,
+  ToCompute,
+  ToGraphics,
+  };
+
 enum NonUniqResId : uint32_t {
   I_None = 0x0,
   };
@@ -0,0 +1,130 @@
+#include "framegraphplan.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+bool FrameGraphPlan::Desc::operator ==(const Desc& other) const {
+  return kind==other.kind && format==other.format && w==other.w && h==other.h;
+  }
+
+uint32_t FrameGraphPlan::addTransient(const Desc& d) {
+  Resource r;
+  r.desc = d;
+  resources.push_back(r);
+  return uint32_t(resources.size()-1);
+  }
+
+uint32_t FrameGraphPlan::addImported(Kind k) {
+  Resource r;
+  r.desc.kind = k;
+  r.imported  = true;
+  resources.push_back(r);
+  return uint32_t(resources.size()-1);
+  }
+
+uint32_t FrameGraphPlan::addPass(bool sideEffect) {
+  Pass p;
+  p.sideEffect = sideEffect;
+  passes.emplace_back(std::move(p));
+  return uint32_t(passes.size()-1);
+  }
+
+void FrameGraphPlan::setSideEffect(uint32_t pass) {
+  passes[pass].sideEffect = true;
+  }
+
+void FrameGraphPlan::read(uint32_t pass, uint32_t res) {
+  auto& rd = passes[pass].read;
+  if(std::find(rd.begin(),rd.end(),res)==rd.end())
+    rd.push_back(res);
+  }
+
+void FrameGraphPlan::write(uint32_t pass, uint32_t res) {
+  auto& wr = passes[pass].write;
+  if(std::find(wr.begin(),wr.end(),res)==wr.end())
+    wr.push_back(res);
+  }
+
+void FrameGraphPlan::clear() {
+  passes.clear();
+  resources.clear();
+  physDesc.clear();
+  }
+
+void FrameGraphPlan::compile() {
+  cull();
+  computeLifetimes();
+  alias();
+  }
+
+void FrameGraphPlan::cull() {
+  // backward walk: pass is alive, if it has side effects, writes imported resource,
+  // or writes content, that is read by alive pass later on
+  std::vector<bool> needed(resources.size(),false);
+  for(size_t i=passes.size(); i>0; --i) {
+    auto& p = passes[i-1];
+    p.alive = p.sideEffect;
+    for(auto r:p.write)
+      if(resources[r].imported || needed[r])
+        p.alive = true;
+    if(!p.alive)
+      continue;
+    for(auto r:p.write)
+      needed[r] = false; // older content is overwritten here
+    for(auto r:p.read)
+      needed[r] = true;
+    }
+  }
+
+void FrameGraphPlan::computeLifetimes() {
+  for(auto& r:resources) {
+    r.first    = NoId;
+    r.last     = NoId;
+    r.physical = NoId;
+    }
+
+  for(uint32_t i=0; i<passes.size(); ++i) {
+    auto& p = passes[i];
+    if(!p.alive)
+      continue;
+    for(auto* list:{&p.read, &p.write}) {
+      for(auto id:*list) {
+        auto& r = resources[id];
+        if(r.first==NoId)
+          r.first = i;
+        r.last = i;
+        }
+      }
+    }
+  }
+
+void FrameGraphPlan::alias() {
+  std::vector<uint32_t> order;
+  for(uint32_t i=0; i<resources.size(); ++i)
+    if(!resources[i].imported && resources[i].first!=NoId)
+      order.push_back(i);
+  std::stable_sort(order.begin(),order.end(),[this](uint32_t a, uint32_t b){
+    return resources[a].first<resources[b].first;
+    });
+
+  // greedy interval assignment: first physical resource, that is compatible and free by now
+  std::vector<uint32_t> busyUntil;
+  physDesc.clear();
+  for(auto id:order) {
+    auto& r = resources[id];
+    for(uint32_t i=0; i<physDesc.size(); ++i) {
+      if(physDesc[i]!=r.desc || busyUntil[i]>=r.first)
+        continue;
+      r.physical   = i;
+      busyUntil[i] = r.last;
+      break;
+      }
+    if(r.physical!=NoId)
+      continue;
+    r.physical = uint32_t(physDesc.size());
+    physDesc.push_back(r.desc);
+    busyUntil.push_back(r.last);
+    }
+  }
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+
+#include <cstdint>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// Dependency analysis of FrameGraph: culling of passes, lifetimes and aliasing of transient resources.
+// Passes run in order of declaration. `write` replaces content of resource; read-modify-write is declared with both.
+class FrameGraphPlan {
+  public:
+    enum : uint32_t {
+      NoId = uint32_t(-1),
+      };
+
+    enum Kind : uint8_t {
+      K_Attachment,
+      K_ZBuffer,
+      K_Buffer,
+      };
+
+    struct Desc {
+      Kind          kind   = K_Attachment;
+      TextureFormat format = TextureFormat::Undefined;
+      uint32_t      w      = 0;
+      uint32_t      h      = 0;
+
+      bool operator == (const Desc& other) const;
+      bool operator != (const Desc& other) const { return !(*this==other); }
+      };
+
+    uint32_t    addTransient(const Desc& d);
+    uint32_t    addImported (Kind k);
+    uint32_t    addPass     (bool sideEffect);
+    void        setSideEffect(uint32_t pass);
+    void        read        (uint32_t pass, uint32_t res);
+    void        write       (uint32_t pass, uint32_t res);
+
+    void        compile();
+    void        clear();
+
+    size_t      passCount()     const { return passes.size();    }
+    size_t      resourceCount() const { return resources.size(); }
+    bool        isCulled  (uint32_t pass) const { return !passes[pass].alive; }
+    bool        isImported(uint32_t res)  const { return resources[res].imported; }
+    Kind        kind      (uint32_t res)  const { return resources[res].desc.kind; }
+
+    // alive passes, that use resource first and last; NoId, if resource is not used
+    uint32_t    firstUse  (uint32_t res)  const { return resources[res].first; }
+    uint32_t    lastUse   (uint32_t res)  const { return resources[res].last;  }
+
+    // transients of same description and non-overlapping lifetimes share one physical resource
+    uint32_t    physical  (uint32_t res)  const { return resources[res].physical; }
+    size_t      physicalCount()           const { return physDesc.size(); }
+    const Desc& physicalDesc(uint32_t id) const { return physDesc[id]; }
+
+  private:
+    struct Pass {
+      std::vector<uint32_t> read;
+      std::vector<uint32_t> write;
+      bool                  sideEffect = false;
+      bool                  alive      = false;
+      };
+
+    struct Resource {
+      Desc                  desc;
+      bool                  imported = false;
+      uint32_t              first    = NoId;
+      uint32_t              last     = NoId;
+      uint32_t              physical = NoId;
+      };
+
+    void cull();
+    void computeLifetimes();
+    void alias();
+
+    std::vector<Pass>      passes;
+    std::vector<Resource>  resources;
+    std::vector<Desc>      physDesc;
+  };
+
+}
+}
@@ -0,0 +1,120 @@
+#include "gputimerscopes.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+void GpuTimerScopes::begin(uint32_t tsCap, uint32_t statCap) {
+  tsCapacity   = tsCap;
+  statCapacity = statCap;
+  ready        = true;
+  overflow     = false;
+  tsCount      = 0;
+  statCount    = 0;
+  activePass   = NoQuery;
+  scopes.clear();
+  stack.clear();
+  statOwner.clear();
+  }
+
+uint32_t GpuTimerScopes::beginScope(std::string_view name) {
+  Scope s;
+  s.name   = std::string(name);
+  s.parent = stack.empty() ? NoQuery : stack.back();
+  s.depth  = uint32_t(stack.size());
+
+  if(ready && tsCapacity>0) {
+    if(tsCount+2<=tsCapacity) {
+      s.tsBegin = tsCount;
+      s.tsEnd   = tsCount+1;
+      tsCount  += 2;
+      } else {
+      overflow = true;
+      }
+    }
+
+  const uint32_t ret = s.tsBegin;
+  stack.push_back(uint32_t(scopes.size()));
+  scopes.emplace_back(std::move(s));
+  return ret;
+  }
+
+uint32_t GpuTimerScopes::endScope() {
+  if(stack.empty())
+    return NoQuery;
+  const uint32_t ret = scopes[stack.back()].tsEnd;
+  stack.pop_back();
+  return ret;
+  }
+
+uint32_t GpuTimerScopes::beginPass() {
+  // statistics queries can't nest, so there is one per render pass, accounted to innermost scope
+  if(!ready || statCapacity==0 || stack.empty())
+    return NoQuery;
+  if(statCount>=statCapacity) {
+    overflow = true;
+    return NoQuery;
+    }
+  activePass = statCount;
+  ++statCount;
+  statOwner.push_back(stack.back());
+  return activePass;
+  }
+
+uint32_t GpuTimerScopes::endPass() {
+  const uint32_t ret = activePass;
+  activePass = NoQuery;
+  return ret;
+  }
+
+void GpuTimerScopes::resolve(const uint64_t* ts, const uint64_t* st, double tsToMs, std::vector<GpuTiming>& out) {
+  out.clear();
+  if(scopes.empty())
+    return;
+
+  uint64_t t0 = uint64_t(-1);
+  if(ts!=nullptr) {
+    for(auto& s:scopes)
+      if(s.tsBegin!=NoQuery)
+        t0 = std::min(t0,ts[s.tsBegin]);
+    }
+
+  out.resize(scopes.size());
+  for(size_t i=0; i<scopes.size(); ++i) {
+    auto& s = scopes[i];
+    auto& r = out[i];
+    r.name   = std::move(s.name);
+    r.parent = s.parent;
+    r.depth  = s.depth;
+    if(ts!=nullptr && s.tsBegin!=NoQuery && ts[s.tsEnd]>=ts[s.tsBegin]) {
+      r.begin    = double(ts[s.tsBegin]-t0)*tsToMs;
+      r.duration = double(ts[s.tsEnd]-ts[s.tsBegin])*tsToMs;
+      }
+    }
+  scopes.clear();
+
+  if(st==nullptr)
+    return;
+  for(size_t i=0; i<statCount; ++i) {
+    auto& r = out[statOwner[i]];
+    auto  v = &st[i*StatCount];
+    r.inputPrimitives    += v[0];
+    r.vsInvocations      += v[1];
+    r.clippingPrimitives += v[2];
+    r.fsInvocations      += v[3];
+    }
+
+  // children always follow parent
+  for(size_t i=out.size(); i>0;) {
+    --i;
+    auto& r = out[i];
+    if(r.parent==NoQuery)
+      continue;
+    auto& p = out[r.parent];
+    p.inputPrimitives    += r.inputPrimitives;
+    p.vsInvocations      += r.vsInvocations;
+    p.clippingPrimitives += r.clippingPrimitives;
+    p.fsInvocations      += r.fsInvocations;
+    }
+  }
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "abstractgraphicsapi.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// Scope tree and query slots of one recording, for backend timestamp and pipeline-statistics query pools.
+// Timestamp pair and statistics slot are handed out, only while pools are reset in current recording;
+// recording, that runs out of slots, sets `overflow`, so backend can grow pools on next begin.
+class GpuTimerScopes {
+  public:
+    enum : uint32_t {
+      NoQuery   = uint32_t(-1),
+      StatCount = 4,
+      };
+
+    // start of recording; capacity 0 - no pool of that type
+    void     begin(uint32_t tsCapacity, uint32_t statCapacity);
+    // closes scopes, left open at the end of recording; fn(ts) writes end timestamp
+    template<class Fn>
+    void     end(Fn&& fn) {
+      while(!stack.empty()) {
+        uint32_t ts = endScope();
+        if(ts!=NoQuery)
+          fn(ts);
+        }
+      ready = false;
+      }
+
+    // timestamp index for start of scope, NoQuery if none
+    uint32_t beginScope(std::string_view name);
+    // timestamp index for end of scope, NoQuery if none
+    uint32_t endScope();
+
+    // statistics query of render pass, accounted to innermost scope, NoQuery if none
+    uint32_t beginPass();
+    uint32_t endPass();
+
+    bool     isReady()    const { return ready; }
+    bool     isOverflow() const { return overflow; }
+    bool     isEmpty()    const { return scopes.empty(); }
+    uint32_t timestampCount() const { return tsCount; }
+    uint32_t statisticsCount() const { return statCount; }
+
+    // ts: timestampCount() values, or null; st: StatCount values per statistics query, or null
+    void     resolve(const uint64_t* ts, const uint64_t* st, double tsToMs, std::vector<GpuTiming>& out);
+
+  private:
+    struct Scope {
+      std::string name;
+      uint32_t    parent  = NoQuery;
+      uint32_t    depth   = 0;
+      uint32_t    tsBegin = NoQuery;
+      uint32_t    tsEnd   = NoQuery;
+      };
+
+    uint32_t                 tsCapacity   = 0;
+    uint32_t                 statCapacity = 0;
+    uint32_t                 tsCount      = 0;
+    uint32_t                 statCount    = 0;
+    bool                     ready        = false; // pools are reset in current recording
+    bool                     overflow     = false;
+    uint32_t                 activePass   = NoQuery;
+
+    std::vector<Scope>       scopes;
+    std::vector<uint32_t>    stack;
+    std::vector<uint32_t>    statOwner;
+  };
+
+}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Tempest {
+namespace Detail {
+
+// Hashed cache of shared objects; lookups take shared lock, only miss takes exclusive one.
+// Object, that had no lookup for `maxIdle` frames and is not referenced outside of cache, is evicted.
+template<class T>
+class IdleCache {
+  public:
+    explicit IdleCache(uint64_t maxIdle):maxIdle(maxIdle){}
+    IdleCache(const IdleCache&) = delete;
+
+    // match(const T&) compares full key of object with given hash; mk() creates missing one
+    template<class Match, class Make>
+    std::shared_ptr<T> find(uint64_t hash, Match&& match, Make&& mk) {
+      const uint64_t f = frame.load();
+      {
+        std::shared_lock<std::shared_mutex> guard(sync);
+        if(auto ret = implFind(hash,match,f))
+          return ret;
+      }
+
+      std::lock_guard<std::shared_mutex> guard(sync);
+      if(auto ret = implFind(hash,match,f))
+        return ret;
+
+      std::shared_ptr<T> ret = mk();
+      auto it = val.emplace(std::piecewise_construct,std::forward_as_tuple(hash),std::forward_as_tuple());
+      it->second.val = ret;
+      it->second.lastUse.store(f);
+      return ret;
+      }
+
+    // called once per frame: every `maxIdle` frames drops idle objects through release(T&)
+    template<class Fn>
+    void nextFrame(Fn&& release) {
+      const uint64_t f = frame.fetch_add(1)+1;
+      if(f%maxIdle!=0)
+        return;
+      evict([this,f](const Entry& e){
+        // referenced by recorded command buffer, that may be submitted again
+        return e.val.use_count()==1 && f-e.lastUse.load()>=maxIdle;
+        },release);
+      }
+
+    // drops objects, for which pred(T&) is true
+    template<class Pred, class Fn>
+    void erase(Pred&& pred, Fn&& release) {
+      evict([&pred](const Entry& e){ return pred(*e.val); },release);
+      }
+
+    template<class Fn>
+    void forEach(Fn&& fn) {
+      std::lock_guard<std::shared_mutex> guard(sync);
+      for(auto& i:val)
+        fn(*i.second.val);
+      }
+
+    size_t size() const {
+      std::shared_lock<std::shared_mutex> guard(sync);
+      return val.size();
+      }
+
+  private:
+    struct Entry {
+      std::shared_ptr<T>    val;
+      // frame of last lookup; written under shared lock
+      std::atomic<uint64_t> lastUse{0};
+      };
+
+    template<class Match>
+    std::shared_ptr<T> implFind(uint64_t hash, Match& match, uint64_t f) {
+      auto rg = val.equal_range(hash);
+      for(auto i=rg.first; i!=rg.second; ++i)
+        if(match(*i->second.val)) {
+          i->second.lastUse.store(f);
+          return i->second.val;
+          }
+      return nullptr;
+      }
+
+    template<class Pred, class Fn>
+    void evict(Pred&& pred, Fn& release) {
+      std::lock_guard<std::shared_mutex> guard(sync);
+      for(auto i=val.begin(); i!=val.end();) {
+        if(!pred(i->second)) {
+          ++i;
+          continue;
+          }
+        release(*i->second.val);
+        i = val.erase(i);
+        }
+      }
+
+    const uint64_t                         maxIdle;
+    std::atomic<uint64_t>                  frame{0};
+    mutable std::shared_mutex              sync;
+    std::unordered_multimap<uint64_t,Entry> val;
+  };
+
+}
+}
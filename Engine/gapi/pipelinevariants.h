@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// Instances of one pipeline for different framebuffer layouts, compiled inline or by background worker.
+// I has `val` handle and `state` (I::Ready, I::Pending, I::Failed).
+template<class I>
+class PipelineVariants {
+  public:
+    using Handle = decltype(I::val);
+
+    // Finds instance, for which match(i) is true; missing one is created from mk(val).
+    // async: queues compile(), through enqueue(), and returns null handle until it's complete.
+    // Instance, that failed in background, is compiled inline once more, to report the actual error.
+    template<class Match, class Make, class Compile, class Enqueue>
+    Handle get(bool async, Match&& match, Make&& mk, Compile&& compile, Enqueue&& enqueue) {
+      std::unique_lock<std::mutex> guard(sync);
+      for(;;) {
+        auto i = find(match);
+        if(i==inst.end())
+          break;
+        if(i->state==I::Ready)
+          return i->val;
+        if(i->state==I::Failed) {
+          inst.erase(i);
+          async = false;
+          break;
+          }
+        if(async)
+          return Handle();
+        // in flight on worker: wait for it, rather than compile a duplicate
+        ready.wait(guard);
+        }
+
+      if(async) {
+        inst.emplace_back(mk(Handle()));
+        inst.back().state = I::Pending;
+        enqueue();
+        return Handle();
+        }
+
+      Handle val = compile();
+      inst.emplace_back(mk(val));
+      return val;
+      }
+
+    // Result of background compile; returns false, if instance was replaced and `val` is not stored.
+    template<class Match>
+    bool complete(Match&& match, Handle val, bool ok) {
+      bool stored = false;
+      {
+        std::lock_guard<std::mutex> guard(sync);
+        for(auto& i:inst)
+          if(i.state==I::Pending && match(i)) {
+            i.val   = val;
+            i.state = ok ? I::Ready : I::Failed;
+            stored  = true;
+            break;
+            }
+      }
+      ready.notify_all();
+      return stored;
+      }
+
+    std::vector<I>          inst;
+
+  private:
+    template<class Match>
+    auto find(Match& match) {
+      for(auto i=inst.begin(); i!=inst.end(); ++i)
+        if(match(*i))
+          return i;
+      return inst.end();
+      }
+
+    std::mutex              sync;
+    std::condition_variable ready;
+  };
+
+}
+}
@@ -3,24 +3,33 @@
 #include <Tempest/Point>
 
 #include <vector>
+#include <map>
+#include <set>
 #include <cstdint>
 #include <cstddef>
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <algorithm>
 
 namespace Tempest {
 
+// Atlas-page allocator: skyline bottom-left packing, plus guillotine reuse of released rectangles.
+// Page, that has no allocations left, is reset to empty skyline.
+// compact() repacks live allocations into fewer pages; nodes are moved in place, so handles stay valid.
 template<class MemoryProvider>
 class RectAllocator {
   private:
     struct Page;
     struct Node;
-    template<class T>
-    struct Allocator;
 
   public:
     using Memory=typename MemoryProvider::DeviceMemory;
 
+    enum : uint32_t {
+      DefaultPageSize = 512,
+      };
+
     explicit RectAllocator(MemoryProvider& device):device(device){}
 
     RectAllocator(const RectAllocator&)=delete;
@@ -30,94 +39,207 @@ class RectAllocator {
       Allocation()=default;
 
       Allocation(Allocation&& a)
-        :owner(a.owner),node(a.node),pId(a.pId){
+        :owner(a.owner),node(a.node){
         a.owner=nullptr;
         a.node =nullptr;
-        a.pId  =0;
         }
 
-      Allocation(const Allocation& a):owner(a.owner),node(a.node),pId(a.pId) {
+      Allocation(const Allocation& a):owner(a.owner),node(a.node) {
         if(node!=nullptr)
           node->addref();
         }
 
       ~Allocation(){
         if(node!=nullptr)
-          node->decref();
+          node->decref(*owner);
         }
 
       Allocation& operator=(const Allocation& a){
         if(a.node!=nullptr)
           a.node->addref();
         if(node!=nullptr)
-          node->decref();
+          node->decref(*owner);
         owner=a.owner;
         node =a.node;
-        pId  =a.pId;
         return *this;
         }
 
       Allocation& operator=(Allocation&& a){
         std::swap(owner,a.owner);
         std::swap(node ,a.node);
-        std::swap(pId  ,a.pId);
         return *this;
         }
 
       Memory& memory(){
-        return owner->pages[pId].memory;
+        return node->page->memory;
         }
 
       const Memory& memory() const {
-        return owner->pages[pId].memory;
+        return node->page->memory;
         }
 
       Rect pageRect() const {
-        auto& p=owner->pages[pId];
-        return Rect(int(node->x),int(node->y),int(p.root->w),int(p.root->h));
+        auto& p=*node->page;
+        return Rect(int(node->x),int(node->y),int(p.w),int(p.h));
         }
 
       Point pos() const {
-        return Point(node->x,node->y);
+        return Point(int(node->x),int(node->y));
         }
 
       void* pageId() const {
-        return owner==nullptr ? nullptr : &owner->pages[pId];
+        return owner==nullptr ? nullptr : node->page;
+        }
+
+      // fn(memory) under allocator lock: content of page is written by alloc and compact concurrently
+      template<class Fn>
+      void access(Fn&& fn) const {
+        std::lock_guard<std::mutex> guard(owner->sync);
+        fn(node->page->memory);
         }
 
       RectAllocator* owner=nullptr;
       Node*          node =nullptr;
-      size_t         pId  =0;
+      };
+
+    struct Stats {
+      size_t   pageCount       = 0;
+      size_t   allocationCount = 0;
+      uint64_t usedArea        = 0;
+      uint64_t totalArea       = 0;
+
+      float    occupancy() const { return totalArea==0 ? 0.f : float(double(usedArea)/double(totalArea)); }
       };
 
     Allocation alloc(uint32_t iw,uint32_t ih) {
+      return alloc(iw,ih,[](Memory&,const Point&){});
+      }
+
+    // init(memory,pos) fills allocated rectangle, before allocator lock is released
+    template<class Fn>
+    Allocation alloc(uint32_t iw,uint32_t ih,Fn&& init) {
       if(iw==0 || ih==0)
         return Allocation();
 
-      for(size_t i=0;i<pages.size();++i){
-        auto a=alloc(pages[i],i,iw,ih);
-        if(a.owner)
-          return a;
+      std::lock_guard<std::mutex> guard(sync);
+      for(auto& p:pages){
+        if(Node* n=alloc(*p,iw,ih))
+          return emplace(n,init);
         }
-      const uint32_t w=std::max(iw,defPageSize);
-      const uint32_t h=std::max(ih,defPageSize);
+      const uint32_t w=std::max(iw,pageSize);
+      const uint32_t h=std::max(ih,pageSize);
 
-      pages.emplace_back(*this,w,h);
-      auto a=alloc(pages.back(),pages.size()-1,iw,ih);
-      if(a.owner)
-        return a;
+      pages.emplace_back(new Page(*this,w,h));
+      if(Node* n=alloc(*pages.back(),iw,ih))
+        return emplace(n,init);
       pages.pop_back();
       throw std::bad_alloc();
       }
 
+    void setDefaultPageSize(uint32_t sz) {
+      std::lock_guard<std::mutex> guard(sync);
+      pageSize = std::max<uint32_t>(sz,1);
+      }
+
+    uint32_t defaultPageSize() const {
+      return pageSize;
+      }
+
+    template<class Fn>
+    size_t compact(Fn&& move) {
+      return compact(move,[](){});
+      }
+
+    // Repacks all live allocations into minimal set of pages, tallest first.
+    // move(srcMemory,srcRect,dstMemory,dstPos) is invoked for each allocation, then flush(), before old pages are freed.
+    // Returns number of released pages; nothing is changed, if repacking does not save any page.
+    template<class Fn, class Flush>
+    size_t compact(Fn&& move, Flush&& flush) {
+      std::lock_guard<std::mutex> guard(sync);
+
+      std::vector<Node*> nodes;
+      for(auto& p:pages)
+        for(Node* n=p->nodes; n!=nullptr; n=n->next)
+          nodes.push_back(n);
+      std::sort(nodes.begin(),nodes.end(),[](const Node* a, const Node* b){
+        if(a->h!=b->h)
+          return a->h>b->h;
+        return a->w>b->w;
+        });
+
+      struct Place {
+        size_t   layout = 0;
+        uint32_t x      = 0;
+        uint32_t y      = 0;
+        };
+      std::vector<Layout> layout;
+      std::vector<Place>  where(nodes.size());
+      for(size_t i=0; i<nodes.size(); ++i) {
+        const Node& n  = *nodes[i];
+        Place&      pl = where[i];
+        bool        ok = false;
+        for(pl.layout=0; pl.layout<layout.size(); ++pl.layout)
+          if((ok=place(layout[pl.layout],n.w,n.h,pl.x,pl.y)))
+            break;
+        if(ok)
+          continue;
+        layout.emplace_back(std::max(n.w,pageSize),std::max(n.h,pageSize));
+        pl.layout = layout.size()-1;
+        place(layout.back(),n.w,n.h,pl.x,pl.y);
+        }
+
+      if(layout.size()>=pages.size())
+        return 0;
+
+      std::vector<std::unique_ptr<Page>> next;
+      next.reserve(layout.size());
+      for(auto& l:layout) {
+        next.emplace_back(new Page(*this,l.w,l.h));
+        static_cast<Layout&>(*next.back()) = std::move(l);
+        }
+
+      for(size_t i=0; i<nodes.size(); ++i) {
+        Node&  n   = *nodes[i];
+        Page&  dst = *next[where[i].layout];
+        // refcount==0: node is waiting for the lock to be released; no need to preserve content
+        if(n.refcount.load(std::memory_order_acquire)>0)
+          move(n.page->memory,Rect(int(n.x),int(n.y),int(n.w),int(n.h)),
+               dst.memory,Point(int(where[i].x),int(where[i].y)));
+        n.page->unlink(n);
+        n.x    = where[i].x;
+        n.y    = where[i].y;
+        n.page = &dst;
+        dst.link(n);
+        }
+      flush();
+
+      const size_t freed = pages.size()-next.size();
+      pages.swap(next);
+      return freed;
+      }
+
+    Stats stats() const {
+      std::lock_guard<std::mutex> guard(sync);
+      Stats s;
+      s.pageCount = pages.size();
+      for(auto& p:pages) {
+        s.allocationCount += p->live;
+        s.usedArea        += p->usedArea;
+        s.totalArea       += uint64_t(p->w)*uint64_t(p->h);
+        }
+      return s;
+      }
+
   private:
-    MemoryProvider&   device;
-    std::vector<Page> pages;
-    uint32_t          defPageSize=512; //TODO: get-set
+    MemoryProvider&                    device;
+    std::vector<std::unique_ptr<Page>> pages;
+    uint32_t                           pageSize=DefaultPageSize;
+    mutable std::mutex                 sync;
+    std::vector<size_t>                window; // scratch of allocSkyline
 
     struct Node {
       Node()=default;
-      Node(uint32_t x,uint32_t y,uint32_t w,uint32_t h,Node* owner):x(x),y(y),w(w),h(h),owner(owner){}
+      Node(uint32_t x,uint32_t y,uint32_t w,uint32_t h,Page* page):x(x),y(y),w(w),h(h),page(page){}
 
       std::atomic<uint32_t> refcount{};
 
@@ -125,235 +247,300 @@ class RectAllocator {
       uint32_t y=0;
       uint32_t w=0;
       uint32_t h=0;
+      Page*    page=nullptr;
+      // live nodes of the page, for compact()
+      Node*    prev=nullptr;
+      Node*    next=nullptr;
 
-      static Allocator<Node>& allocator(){
-        static Allocator<Node> alloc;
-        return alloc;
+      void addref() {
+        refcount.fetch_add(1,std::memory_order_acq_rel);
         }
 
-      static void* operator new(size_t){
-        static Allocator<Node>& alloc=allocator();
-        void* ret = alloc.alloc();
-        if(!ret)
-          throw std::bad_alloc();
-        return ret;
+      // page is read under lock only: compact() may move node concurrently
+      void decref(RectAllocator& owner) {
+        if(refcount.fetch_sub(1,std::memory_order_acq_rel)!=1)
+          return;
+        {
+        std::lock_guard<std::mutex> guard(owner.sync);
+        page->release(*this);
+        }
+        delete this;
         }
 
-      static void operator delete(void* ptr){
-        static Allocator<Node>& alloc=allocator();
-        return alloc.free(reinterpret_cast<Node*>(ptr));
+      Point pos() const { return Point(int(x),int(y)); }
+      };
+
+    struct FreeRect {
+      uint32_t x=0, y=0, w=0, h=0;
+      };
+
+    struct FreeSpan {
+      uint32_t w=0, x=0, y=0;
+
+      bool operator < (const FreeSpan& r) const {
+        if(w!=r.w)
+          return w<r.w;
+        if(y!=r.y)
+          return y<r.y;
+        return x<r.x;
         }
+      };
 
-      Node*    owner=nullptr;
-      Node*    sub[3]={};
+    // released rectangles, grouped by height and sorted by width
+    struct FreeList {
+      std::map<uint32_t,std::set<FreeSpan>> byHeight;
 
-      void     remove(Node* n){
-        if(sub[0]==n)
-          sub[0]=nullptr;
-        else if(sub[1]==n)
-          sub[1]=nullptr;
-        else if(sub[2]==n)
-          sub[2]=nullptr;
+      void clear() { byHeight.clear(); }
+
+      uint32_t maxHeight() const { return byHeight.empty() ? 0 : byHeight.rbegin()->first; }
+
+      void insert(const FreeRect& r) {
+        byHeight[r.h].insert(FreeSpan{r.w,r.x,r.y});
         }
 
-      bool hasLeafs() const {
-        return sub[0]!=nullptr || sub[1]!=nullptr || sub[2]!=nullptr;
+      // best fit: shortest, then narrowest rectangle, that is large enough
+      bool take(uint32_t pw, uint32_t ph, FreeRect& out) {
+        for(auto it=byHeight.lower_bound(ph); it!=byHeight.end(); ++it) {
+          auto& set = it->second;
+          auto  sp  = set.lower_bound(FreeSpan{pw,0,0});
+          if(sp==set.end())
+            continue;
+          out = FreeRect{sp->x,sp->y,sp->w,it->first};
+          set.erase(sp);
+          if(set.empty())
+            byHeight.erase(it);
+          return true;
+          }
+        return false;
         }
+      };
 
-      void addref() {
-        refcount.fetch_add(1,std::memory_order_acq_rel);
+    struct Segment {
+      uint32_t x=0, y=0, w=0;
+      };
+
+    // packing state of page
+    struct Layout {
+      Layout(uint32_t w,uint32_t h):w(w),h(h) {
+        reset();
         }
 
-      void decref() {
-        Node* nx=this;
-        if(nx->refcount.fetch_sub(1,std::memory_order_acq_rel)!=1)
-          return;
+      void reset() {
+        skyline.assign(1,Segment{0,0,w});
+        skyMinY = 0;
+        freeRects.clear();
+        failW = uint32_t(-1);
+        failH = uint32_t(-1);
+        }
 
-        Node* ow=nx->owner;
-        while(true) {
-          ow->remove(nx);
-          nx=ow;
-          if(nx==nullptr || nx->hasLeafs())
-            return;
-          ow = nx->owner;
-          }
-        delete this;
+      bool mayFit(uint32_t pw, uint32_t ph) const {
+        if(pw>w || ph>h || (pw>=failW && ph>=failH))
+          return false;
+        // neither lowest skyline segment nor tallest released rectangle has enough height
+        return skyMinY+ph<=h || freeRects.maxHeight()>=ph;
         }
 
-      Point pos() const { return Point(x,y); }
+      uint32_t             w = 0;
+      uint32_t             h = 0;
+      size_t               live     = 0;
+      uint64_t             usedArea = 0;
+      std::vector<Segment> skyline;
+      uint32_t             skyMinY  = 0;
+      FreeList             freeRects;
+      // smallest known request, that does not fit - skip page for anything not smaller
+      uint32_t             failW = uint32_t(-1);
+      uint32_t             failH = uint32_t(-1);
       };
 
-    struct Page {
+    struct Page : Layout {
       Page(RectAllocator& owner,uint32_t w,uint32_t h)
-        :owner(owner),root(new Node(0,0,w,h,nullptr)) {
+        :Layout(w,h),owner(owner) {
         memory = owner.device.alloc(w,h);// std::bad_alloc, if error
         }
 
-      Page(Page&&)=default;
+      Page(const Page&)=delete;
 
       ~Page(){
         // memory!=null; 100%!!
         owner.device.free(memory);
         }
 
-      RectAllocator&        owner;
-      std::unique_ptr<Node> root;
-      Memory                memory={};
-      };
-
-    Allocation alloc(Page& p,size_t page,uint32_t pw,uint32_t ph) {
-      return alloc(*p.root,page,pw,ph);
-      }
+      void link(Node& n) {
+        n.prev = nullptr;
+        n.next = nodes;
+        if(nodes!=nullptr)
+          nodes->prev = &n;
+        nodes = &n;
+        }
 
-    Allocation alloc(Node& n,size_t page,uint32_t pw,uint32_t ph){
-      if(n.refcount.load(std::memory_order_acquire)>0)
-        return Allocation();
+      void unlink(Node& n) {
+        if(n.prev!=nullptr)
+          n.prev->next = n.next; else
+          nodes        = n.next;
+        if(n.next!=nullptr)
+          n.next->prev = n.prev;
+        n.prev = nullptr;
+        n.next = nullptr;
+        }
 
-      if(n.sub[0] || n.sub[1] || n.sub[2]){
-        if(n.w<pw || n.h<ph)
-          return Allocation();
-        Allocation a;
-        if(n.sub[0])
-          a=alloc(*n.sub[0],page,pw,ph);
-        if(a.owner==nullptr && n.sub[1])
-          a=alloc(*n.sub[1],page,pw,ph);
-        if(a.owner==nullptr && n.sub[2])
-          a=alloc(*n.sub[2],page,pw,ph);
-        return a;
-        }
-
-      if(pw<n.w && ph<n.h){
-        const uint32_t sq1 = (n.w-pw)*(n.h);
-        const uint32_t sq2 = (n.w)*(n.h-ph);
-
-        std::unique_ptr<Node> sub0(new Node(n.x,n.y,pw,ph,&n));
-        std::unique_ptr<Node> sub1;
-        std::unique_ptr<Node> sub2;
-
-        if(sq1<sq2) {
-          sub1.reset(new Node(n.x+pw,n.y,   n.w-pw,n.h,   &n));
-          sub2.reset(new Node(n.x,   n.y+ph,pw,    n.h-ph,&n));
-          } else {
-          sub1.reset(new Node(n.x,   n.y+ph,n.w,   n.h-ph,&n));
-          sub2.reset(new Node(n.x+pw,n.y,   n.w-pw,ph,    &n));
+      void release(Node& n) {
+        unlink(n);
+        this->live--;
+        this->usedArea -= uint64_t(n.w)*uint64_t(n.h);
+        if(this->live==0) {
+          this->reset();
+          return;
           }
-
-        n.sub[0] = sub0.release();
-        n.sub[1] = sub1.release();
-        n.sub[2] = sub2.release();
-
-        return emplace(n.sub[0],page);
+        this->freeRects.insert(FreeRect{n.x,n.y,n.w,n.h});
+        this->failW = uint32_t(-1);
+        this->failH = uint32_t(-1);
         }
 
-      if(pw==n.w && ph<n.h) {
-        std::unique_ptr<Node> sub0(new Node(n.x, n.y,    pw, ph,     &n));
-        std::unique_ptr<Node> sub1(new Node(n.x, n.y+ph, pw, n.h-ph, &n));
-
-        n.sub[0] = sub0.release();
-        n.sub[1] = sub1.release();
-
-        return emplace(n.sub[0],page);
-        }
+      RectAllocator& owner;
+      Node*          nodes  = nullptr;
+      Memory         memory = {};
+      };
 
-      if(pw<n.w && ph==n.h){
-        std::unique_ptr<Node> sub0(new Node(n.x,    n.y, pw,     ph, &n));
-        std::unique_ptr<Node> sub1(new Node(n.x+pw, n.y, n.w-pw, ph, &n));
+    Node* alloc(Page& p,uint32_t pw,uint32_t ph) {
+      uint32_t x=0, y=0;
+      if(!place(p,pw,ph,x,y))
+        return nullptr;
+      Node* n = new Node(x,y,pw,ph,&p);
+      p.link(*n);
+      return n;
+      }
 
-        n.sub[0] = sub0.release();
-        n.sub[1] = sub1.release();
+    bool place(Layout& p,uint32_t pw,uint32_t ph,uint32_t& x,uint32_t& y) {
+      if(!p.mayFit(pw,ph))
+        return false;
 
-        return emplace(n.sub[0],page);
+      if(!allocFree(p,pw,ph,x,y) && !allocSkyline(p,pw,ph,x,y)) {
+        if(uint64_t(pw)*ph < uint64_t(p.failW)*p.failH) {
+          p.failW = pw;
+          p.failH = ph;
+          }
+        return false;
         }
 
-      if(pw==n.w && ph==n.h)
-        return emplace(&n,page);
-
-      return Allocation();
+      p.live++;
+      p.usedArea += uint64_t(pw)*uint64_t(ph);
+      return true;
       }
 
-    Allocation emplace(Node* nx,size_t page) {
-      Allocation a;
-      a.owner = this;
-      a.node  = nx;
-      a.pId   = page;
-
-      nx->addref();
-      return a;
+    // best fit among released rectangles; remainder is split guillotine-style
+    bool allocFree(Layout& p,uint32_t pw,uint32_t ph,uint32_t& x,uint32_t& y) {
+      FreeRect r;
+      if(!p.freeRects.take(pw,ph,r))
+        return false;
+
+      x = r.x;
+      y = r.y;
+
+      // split along shorter leftover axis, to keep bigger leftover piece
+      const uint32_t dw = r.w-pw, dh = r.h-ph;
+      FreeRect right, bottom;
+      if(dw<dh) {
+        right  = FreeRect{r.x+pw, r.y,    dw,  ph};
+        bottom = FreeRect{r.x,    r.y+ph, r.w, dh};
+        } else {
+        right  = FreeRect{r.x+pw, r.y,    dw,  r.h};
+        bottom = FreeRect{r.x,    r.y+ph, pw,  dh};
+        }
+      if(right.w>0 && right.h>0)
+        p.freeRects.insert(right);
+      if(bottom.w>0 && bottom.h>0)
+        p.freeRects.insert(bottom);
+      return true;
       }
 
-    template<class T>
-    struct Block {
-      Block*                next=nullptr;
-      std::atomic<uint32_t> mask{};
-      T                     val[32]={};
-
-      T* alloc() noexcept {
-        uint32_t v = mask.load(std::memory_order_acquire);
-        for(uint32_t i=0;i<32;){
-          uint32_t id=(1<<i);
-          if((v&id) == 0) {
-            if(mask.compare_exchange_strong(v,(v|id),std::memory_order_acq_rel,std::memory_order_acquire)) {
-              return &val[i];
-              }
-            } else {
-            ++i;
-            continue;
-            }
+    // bottom-left skyline: choose position with lowest top edge, then least width.
+    // Segments under [x, x+pw) form sliding window, so highest of them comes from monotonic queue: O(segments)
+    bool allocSkyline(Layout& p,uint32_t pw,uint32_t ph,uint32_t& x,uint32_t& y) {
+      auto&  sk      = p.skyline;
+      size_t best    = size_t(-1);
+      uint32_t bestY = 0, bestTop = uint32_t(-1), bestW = uint32_t(-1);
+
+      // window [i,r) covers `covered` pixels; window[head..] - indices of it, with decreasing y
+      size_t   r = 0, head = 0;
+      uint32_t covered = 0;
+      window.clear();
+      for(size_t i=0; i<sk.size(); ++i) {
+        if(sk[i].x+pw>p.w)
+          break;
+        for(; covered<pw; ++r) {
+          while(window.size()>head && sk[window.back()].y<=sk[r].y)
+            window.pop_back();
+          window.push_back(r);
+          covered += sk[r].w;
+          }
+        const uint32_t top = sk[window[head]].y;
+        covered -= sk[i].w;
+        if(window[head]==i)
+          ++head;
+        if(top+ph>p.h)
+          continue;
+        if(top+ph<bestTop || (top+ph==bestTop && sk[i].w<bestW)) {
+          best    = i;
+          bestY   = top;
+          bestTop = top+ph;
+          bestW   = sk[i].w;
           }
-        return nullptr;
-        }
-
-      bool free(T* t) noexcept {
-        if(t<val)
-          return false;
-        ptrdiff_t i=t-val;
-        if(i>=32)
-          return false;
-        uint32_t id=(1<<i);
-        mask.fetch_and(~id,std::memory_order_release);
-        return true;
         }
-      };
-
-    template<class T>
-    struct Allocator {
-      Block<T> node;
 
-      ~Allocator(){
-        Block<T>* cur=node.next;
-        while( cur!=nullptr ) {
-          auto p = cur->next;
-          delete cur;
-          cur=p;
+      if(best==size_t(-1))
+        return false;
+
+      x = sk[best].x;
+      y = bestY;
+
+      sk.insert(sk.begin()+ptrdiff_t(best),Segment{x,bestY+ph,pw});
+      // cut segments covered by new one
+      for(size_t i=best+1; i<sk.size();) {
+        auto&          s   = sk[i];
+        const uint32_t end = x+pw;
+        if(s.x>=end)
+          break;
+        const uint32_t shrink = end-s.x;
+        if(shrink>=s.w) {
+          sk.erase(sk.begin()+ptrdiff_t(i));
+          continue;
           }
+        s.x += shrink;
+        s.w -= shrink;
+        break;
         }
-
-      T* alloc() noexcept {
-        Block<T>* cur=&node;
-        while( true ) {
-          if(T* ptr=cur->alloc())
-            return ptr;
-          if(cur->next==nullptr) {
-            auto p=new(std::nothrow) Block<T>();
-            if(p==nullptr)
-              return nullptr;
-            cur->next=p;
-            return cur->next->alloc();
-            } else {
-            cur=cur->next;
-            }
+      // merge neighbours of same height
+      for(size_t i=0; i+1<sk.size();) {
+        if(sk[i].y==sk[i+1].y) {
+          sk[i].w += sk[i+1].w;
+          sk.erase(sk.begin()+ptrdiff_t(i+1));
+          } else {
+          ++i;
           }
         }
+      p.skyMinY = sk[0].y;
+      for(auto& s:sk)
+        p.skyMinY = std::min(p.skyMinY,s.y);
+      return true;
+      }
 
-      void free(T* ptr) noexcept {
-        Block<T>* cur=&node;
-        while( cur!=nullptr ) {
-          if(cur->free(ptr))
-            return;
-          cur=cur->next;
-          }
+    template<class Fn>
+    Allocation emplace(Node* nx,Fn& init) {
+      try {
+        init(nx->page->memory,nx->pos());
         }
-      };
+      catch(...) {
+        nx->page->release(*nx);
+        delete nx;
+        throw;
+        }
+      Allocation a;
+      a.owner = this;
+      a.node  = nx;
+
+      nx->addref();
+      return a;
+      }
   };
 
 }
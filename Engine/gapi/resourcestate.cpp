@@ -38,6 +38,8 @@ void ResourceState::setRenderpass(AbstractGraphicsApi::CommandBuffer& cmd,
 
 void ResourceState::setLayout(AbstractGraphicsApi::Swapchain& s, uint32_t id, ResourceAccess lay, bool discard) {
   ImgState& img   = findImg(nullptr,&s,id,ResourceAccess::Present,discard);
+  if(!img.outdated)
+    imgOutdated.push_back(uint32_t(&img-imgState.data()));
   img.next     = lay;
   img.discard  = discard;
   img.outdated = true;
@@ -49,6 +51,8 @@ void ResourceState::setLayout(AbstractGraphicsApi::Texture& a, ResourceAccess la
     def = ResourceAccess::DepthReadOnly;
 
   ImgState& img = findImg(&a,nullptr,0,def,discard);
+  if(!img.outdated)
+    imgOutdated.push_back(uint32_t(&img-imgState.data()));
   img.next     = lay;
   img.discard  = discard;
   img.outdated = true;
@@ -57,18 +61,19 @@ void ResourceState::setLayout(AbstractGraphicsApi::Texture& a, ResourceAccess la
 void ResourceState::setLayout(const AbstractGraphicsApi::Buffer& a, ResourceAccess lay) {
   ResourceAccess def = ResourceAccess::UavReadWriteAll;
   BufState&      buf = findBuf(&a,def);
+  if(!buf.outdated)
+    bufOutdated.push_back(uint32_t(&buf-bufState.data()));
   buf.next     = lay;
   buf.outdated = true;
   }
 
 void ResourceState::forceLayout(AbstractGraphicsApi::Texture& img) {
-  for(auto& i:imgState) {
-    if(i.sw==nullptr && i.id==0 && i.img==&img) {
-      i.last     = i.next;
-      i.outdated = false;
-      return;
-      }
-    }
+  auto it = imgIndex.find(ImgKey{&img,0});
+  if(it==imgIndex.end())
+    return;
+  auto& i = imgState[it->second];
+  i.last     = i.next;
+  i.outdated = false; // stays in imgOutdated; skipped by flush
   }
 
 void ResourceState::onTranferUsage(NonUniqResId read, NonUniqResId write, bool host) {
@@ -82,6 +87,16 @@ void ResourceState::onUavUsage(NonUniqResId read, NonUniqResId write, PipelineSt
   }
 
 void ResourceState::onUavUsage(const Usage& u, PipelineStage st, bool host) {
+  if(deferred) {
+    auto* last = deferredUav.empty() ? nullptr : &deferredUav.back();
+    // repeated read-only usage doesn't change anything; common case for draws with same descriptors
+    if(last!=nullptr && u.write==NonUniqResId::I_None && last->usage.write==NonUniqResId::I_None &&
+       last->usage.read==u.read && last->stage==st && last->host==host)
+      return;
+    deferredUav.push_back({u,st,host});
+    return;
+    }
+
   const ResourceAccess rd[PipelineStage::S_Count] = {ResourceAccess::TransferSrc, ResourceAccess::Indirect, ResourceAccess::RtAsRead,  ResourceAccess::UavReadComp,  ResourceAccess::UavReadGr};
   const ResourceAccess wr[PipelineStage::S_Count] = {ResourceAccess::TransferDst, ResourceAccess::None,     ResourceAccess::RtAsWrite, ResourceAccess::UavWriteComp, ResourceAccess::UavWriteGr};
   const ResourceAccess hv = (host ? ResourceAccess::TransferHost : ResourceAccess::None);
@@ -119,6 +134,60 @@ void ResourceState::onUavUsage(const Usage& u, PipelineStage st, bool host) {
     }
   }
 
+void ResourceState::join(ResourceState& secondary) {
+  // replay in recording order: same barriers, as if commands were recorded inline
+  for(auto& i:secondary.deferredUav)
+    onUavUsage(i.usage,i.stage,i.host);
+  secondary.deferredUav.clear();
+  }
+
+void ResourceState::onQueueUsage(const AbstractGraphicsApi::Buffer& buf) {
+  for(auto& i:queueRes)
+    if(i.buf==&buf)
+      return;
+  QueueRes r;
+  r.buf = &buf;
+  r.lay = ResourceAccess::UavReadWriteAll;
+  queueRes.push_back(r);
+  }
+
+void ResourceState::onQueueUsage(AbstractGraphicsApi::Texture& img, ResourceAccess lay) {
+  for(auto& i:queueRes)
+    if(i.img==&img)
+      return;
+  QueueRes r;
+  r.img = &img;
+  r.lay = lay;
+  queueRes.push_back(r);
+  }
+
+void ResourceState::queueOwnership(AbstractGraphicsApi::CommandBuffer& cmd, QueueOwnership dir) {
+  AbstractGraphicsApi::BarrierDesc barrier[MaxBarriers];
+  uint8_t                          barrierCnt = 0;
+
+  for(auto& i:queueRes) {
+    auto& b = barrier[barrierCnt];
+    b           = AbstractGraphicsApi::BarrierDesc();
+    b.buffer    = i.buf;
+    b.texture   = i.img;
+    b.mip       = uint32_t(-1);
+    b.prev      = i.lay; // no layout transition: handoff only
+    b.next      = i.lay;
+    b.ownership = dir;
+    ++barrierCnt;
+
+    if(barrierCnt==MaxBarriers) {
+      emitBarriers(cmd,barrier,barrierCnt);
+      barrierCnt = 0;
+      }
+    }
+  emitBarriers(cmd,barrier,barrierCnt);
+  }
+
+void ResourceState::clearQueueUsage() {
+  queueRes.clear();
+  }
+
 void ResourceState::joinWriters(PipelineStage st) {
   ResourceState::Usage u = {NonUniqResId(-1), NonUniqResId::I_None, false};
   onUavUsage(u, st);
@@ -135,10 +204,12 @@ void ResourceState::flush(AbstractGraphicsApi::CommandBuffer& cmd) {
   AbstractGraphicsApi::BarrierDesc barrier[MaxBarriers];
   uint8_t                          barrierCnt = 0;
 
-  for(auto& i:imgState) {
+  for(auto id:imgOutdated) {
+    auto& i = imgState[id];
     if(!i.outdated)
       continue;
     auto& b = barrier[barrierCnt];
+    b           = AbstractGraphicsApi::BarrierDesc();
     b.swapchain = i.sw;
     b.swId      = i.id;
     b.texture   = i.img;
@@ -156,10 +227,14 @@ void ResourceState::flush(AbstractGraphicsApi::CommandBuffer& cmd) {
       }
     }
 
-  for(auto& i:bufState) {
+  imgOutdated.clear();
+
+  for(auto id:bufOutdated) {
+    auto& i = bufState[id];
     if(!i.outdated)
       continue;
     auto& b = barrier[barrierCnt];
+    b           = AbstractGraphicsApi::BarrierDesc();
     b.buffer    = i.buf;
     b.prev      = i.last;
     b.next      = i.next;
@@ -172,10 +247,11 @@ void ResourceState::flush(AbstractGraphicsApi::CommandBuffer& cmd) {
       barrierCnt = 0;
       }
     }
+  bufOutdated.clear();
 
   if(uavSrcBarrier!=ResourceAccess::None) {
     auto& b = barrier[barrierCnt];
-    b.buffer = nullptr;
+    b        = AbstractGraphicsApi::BarrierDesc();
     b.prev   = uavSrcBarrier;
     b.next   = uavDstBarrier;
     ++barrierCnt;
@@ -196,20 +272,25 @@ void ResourceState::finalize(AbstractGraphicsApi::CommandBuffer& cmd) {
   for(auto& i:imgState) {
     if(i.sw==nullptr)
       continue;
+    if(!i.outdated)
+      imgOutdated.push_back(uint32_t(&i-imgState.data()));
     i.next     = ResourceAccess::Present;
     i.outdated = true;
     }
   for(auto& i:bufState) {
     if(i.buf==nullptr)
       continue;
+    if(!i.outdated)
+      bufOutdated.push_back(uint32_t(&i-bufState.data()));
     i.next     = ResourceAccess::UavReadWriteAll;
     i.outdated = true;
     }
   flush(cmd);
-  imgState.reserve(imgState.size());
+  // clear() keeps capacity and hash buckets for next command buffer
   imgState.clear();
-  bufState.reserve(bufState.size());
   bufState.clear();
+  imgIndex.clear();
+  bufIndex.clear();
   uavSrcBarrier = ResourceAccess::None;
   uavDstBarrier = ResourceAccess::None;
 
@@ -229,11 +310,11 @@ void ResourceState::fillReads() {
 
 ResourceState::ImgState& ResourceState::findImg(AbstractGraphicsApi::Texture* img, AbstractGraphicsApi::Swapchain* sw, uint32_t id,
                                                 ResourceAccess def, bool discard) {
-  auto nativeImg = img;
-  for(auto& i:imgState) {
-    if(i.sw==sw && i.id==id && i.img==nativeImg)
-      return i;
-    }
+  const ImgKey key = {img!=nullptr ? static_cast<const void*>(img) : static_cast<const void*>(sw), id};
+  auto it = imgIndex.find(key);
+  if(it!=imgIndex.end())
+    return imgState[it->second];
+
   ImgState s={};
   s.sw       = sw;
   s.id       = id;
@@ -242,20 +323,22 @@ ResourceState::ImgState& ResourceState::findImg(AbstractGraphicsApi::Texture* im
   s.next     = ResourceAccess::Sampler;
   s.discard  = discard;
   s.outdated = false;
+  imgIndex.emplace(key,uint32_t(imgState.size()));
   imgState.push_back(s);
   return imgState.back();
   }
 
 ResourceState::BufState& ResourceState::findBuf(const AbstractGraphicsApi::Buffer* buf, ResourceAccess def) {
-  for(auto& i:bufState) {
-    if(i.buf==buf)
-      return i;
-    }
+  auto it = bufIndex.find(buf);
+  if(it!=bufIndex.end())
+    return bufState[it->second];
+
   BufState s={};
   s.buf      = buf;
   s.last     = def;
   s.next     = ResourceAccess::UavRead;
   s.outdated = false;
+  bufIndex.emplace(buf,uint32_t(bufState.size()));
   bufState.push_back(s);
   return bufState.back();
   }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Tempest/AbstractGraphicsApi>
+#include <unordered_map>
 #include <vector>
 
 namespace Tempest {
@@ -30,6 +31,18 @@ class ResourceState {
     void onUavUsage    (const ResourceState::Usage& uavUsage, PipelineStage st, bool host = false);
     void forceLayout   (AbstractGraphicsApi::Texture&   a);
 
+    // secondary command buffer state: uav usage is only logged, to be replayed into primary by `join`
+    void setDeferred   (bool d) { deferred = d; }
+    void join          (ResourceState& secondary);
+
+    // async compute: resources, that command buffer borrows from graphics queue, in layout they rest in
+    void onQueueUsage  (const AbstractGraphicsApi::Buffer& buf);
+    void onQueueUsage  (AbstractGraphicsApi::Texture& img, ResourceAccess lay);
+    bool hasQueueUsage () const { return !queueRes.empty(); }
+    // ownership barriers of borrowed resources; release and acquire halves are emitted with same direction
+    void queueOwnership(AbstractGraphicsApi::CommandBuffer& cmd, QueueOwnership dir);
+    void clearQueueUsage();
+
     void joinWriters(PipelineStage st);
     void clearReaders();
     void flush      (AbstractGraphicsApi::CommandBuffer& cmd);
@@ -55,13 +68,29 @@ class ResourceState {
       bool                               outdated = false;
       };
 
+    struct ImgKey {
+      const void* res = nullptr; // texture or swapchain
+      uint32_t    id  = 0;
+      bool operator == (const ImgKey& other) const { return res==other.res && id==other.id; }
+      };
+
+    struct ImgKeyHash {
+      size_t operator()(const ImgKey& k) const { return std::hash<const void*>()(k.res) ^ (size_t(k.id)*0x9E3779B97F4A7C15ull); }
+      };
+
     void      fillReads();
     ImgState& findImg(AbstractGraphicsApi::Texture* img, AbstractGraphicsApi::Swapchain* sw, uint32_t id, ResourceAccess def, bool discard);
     BufState& findBuf(const AbstractGraphicsApi::Buffer*  buf, ResourceAccess def);
     void      emitBarriers(AbstractGraphicsApi::CommandBuffer& cmd, AbstractGraphicsApi::BarrierDesc* desc, size_t cnt);
 
+    // per command buffer: index into state vectors and list of outdated entries, to keep flush cost
+    // proportional to number of transitions, not number of tracked resources
     std::vector<ImgState> imgState;
     std::vector<BufState> bufState;
+    std::unordered_map<ImgKey,uint32_t,ImgKeyHash>                   imgIndex;
+    std::unordered_map<const AbstractGraphicsApi::Buffer*,uint32_t> bufIndex;
+    std::vector<uint32_t> imgOutdated;
+    std::vector<uint32_t> bufOutdated;
 
     struct Stage {
       NonUniqResId depend[PipelineStage::S_Count];
@@ -70,6 +99,21 @@ class ResourceState {
     Stage                 uavWrite[PipelineStage::S_Count] = {};
     ResourceAccess        uavSrcBarrier = ResourceAccess::None;
     ResourceAccess        uavDstBarrier = ResourceAccess::None;
+
+    struct DeferredUav {
+      Usage                 usage;
+      PipelineStage         stage = PipelineStage::S_First;
+      bool                  host  = false;
+      };
+    bool                     deferred = false;
+    std::vector<DeferredUav> deferredUav;
+
+    struct QueueRes {
+      const AbstractGraphicsApi::Buffer* buf = nullptr;
+      AbstractGraphicsApi::Texture*      img = nullptr;
+      ResourceAccess                     lay = ResourceAccess::None;
+      };
+    std::vector<QueueRes>    queueRes;
   };
 
 }
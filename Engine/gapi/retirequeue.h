@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// Items, released while commands in flight still may refer to them.
+// Released items wait in current frame; seal() closes it with a mark (fence), that is submitted after them.
+// recycle() hands back items of frames, which mark is complete, in order of submission.
+template<class T, class Mark>
+class RetireQueue {
+  public:
+    void   push(const T& t) { current.push_back(t); }
+    // nothing to seal
+    bool   empty() const { return current.empty(); }
+    size_t inFlight() const { return frames.size(); }
+
+    void seal(const Mark& m) {
+      frames.emplace_back();
+      auto& f = frames.back();
+      f.mark  = m;
+      f.items = std::move(current);
+      current.clear();
+      }
+
+    // done(mark) tests completion; items of complete frame go to fn(item), and its mark to free(mark)
+    template<class Done, class Fn, class Free>
+    void recycle(Done&& done, Fn&& fn, Free&& free) {
+      while(!frames.empty() && done(frames.front().mark)) {
+        auto& f = frames.front();
+        for(auto& i:f.items)
+          fn(i);
+        free(f.mark);
+        frames.pop_front();
+        }
+      }
+
+  private:
+    struct Frame {
+      Mark           mark = {};
+      std::vector<T> items;
+      };
+
+    std::vector<T>    current;
+    std::deque<Frame> frames;
+  };
+
+}
+}
@@ -75,6 +75,10 @@ static uint32_t declaredVarSize(spirv_cross::Compiler& comp, const spirv_cross::
   return 0;
   }
 
+static bool isBindless(spirv_cross::Compiler& comp, const spirv_cross::Resource& r) {
+  return comp.get_decoration(r.id, spv::DecorationDescriptorSet)==ShaderReflection::BindlessSet;
+  }
+
 void ShaderReflection::getVertexDecl(std::vector<Decl::ComponentType>& data, spirv_cross::Compiler& comp) {
   if(comp.get_execution_model()!=spv::ExecutionModelVertex)
     return;
@@ -112,6 +116,8 @@ void ShaderReflection::getBindings(std::vector<Binding>&  lay,
 
   spirv_cross::ShaderResources resources = comp.get_shader_resources();
   for(auto &resource : resources.sampled_images) {
+    if(isBindless(comp,resource))
+      continue;
     auto&    t       = typeFromVariable(comp, resource.id);
     unsigned binding = comp.get_decoration(resource.id, spv::DecorationBinding);
     Binding b;
@@ -125,6 +131,8 @@ void ShaderReflection::getBindings(std::vector<Binding>&  lay,
     lay.push_back(b);
     }
   for(auto &resource : resources.separate_images) {
+    if(isBindless(comp,resource))
+      continue;
     auto&    t       = typeFromVariable(comp, resource.id);
     unsigned binding = comp.get_decoration(resource.id, spv::DecorationBinding);
     Binding b;
@@ -138,6 +146,8 @@ void ShaderReflection::getBindings(std::vector<Binding>&  lay,
     lay.push_back(b);
     }
   for(auto &resource : resources.separate_samplers) {
+    if(isBindless(comp,resource))
+      continue;
     auto&    t       = typeFromVariable(comp, resource.id);
     unsigned binding = comp.get_decoration(resource.id, spv::DecorationBinding);
     Binding b;
@@ -150,6 +160,8 @@ void ShaderReflection::getBindings(std::vector<Binding>&  lay,
     lay.push_back(b);
     }
   for(auto &resource : resources.uniform_buffers) {
+    if(isBindless(comp,resource))
+      continue;
     auto&    t       = typeFromVariable(comp, resource.id);
     unsigned binding = comp.get_decoration(resource.id, spv::DecorationBinding);
     auto     sz      = declaredSize(comp,t);
@@ -164,6 +176,8 @@ void ShaderReflection::getBindings(std::vector<Binding>&  lay,
     lay.push_back(b);
     }
   for(auto &resource : resources.storage_buffers) {
+    if(isBindless(comp,resource))
+      continue;
     auto&    t        = typeFromVariable(comp, resource.id);
     unsigned binding  = comp.get_decoration(resource.id, spv::DecorationBinding);
     auto     readonly = comp.get_buffer_block_flags(resource.id);
@@ -180,6 +194,8 @@ void ShaderReflection::getBindings(std::vector<Binding>&  lay,
     lay.push_back(b);
     }
   for(auto &resource : resources.storage_images) {
+    if(isBindless(comp,resource))
+      continue;
     auto&    t       = typeFromVariable(comp, resource.id);
     unsigned binding = comp.get_decoration(resource.id, spv::DecorationBinding);
     Binding b;
@@ -193,6 +209,8 @@ void ShaderReflection::getBindings(std::vector<Binding>&  lay,
     lay.push_back(b);
     }
   for(auto &resource : resources.acceleration_structures) {
+    if(isBindless(comp,resource))
+      continue;
     auto&    t       = typeFromVariable(comp, resource.id);
     unsigned binding = comp.get_decoration(resource.id, spv::DecorationBinding);
     Binding b;
@@ -40,6 +40,11 @@ class ShaderReflection final {
       Mesh    =1<<7,
       };
 
+    enum : uint32_t {
+      // descriptor set of device-wide bindless heap; not part of pipeline layout reflection
+      BindlessSet = 2,
+      };
+
     struct Binding {
       uint32_t        layout       = 0;
       Class           cls          = Ubo;
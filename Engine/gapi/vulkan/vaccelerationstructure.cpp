@@ -240,6 +240,7 @@ VTopAccelerationStructure::VTopAccelerationStructure(VDevice& dx, const RtInstan
 
 VTopAccelerationStructure::~VTopAccelerationStructure() {
   auto device = owner.device.impl;
+  owner.descRefs.invalidate(uint64_t(impl));
   owner.vkDestroyAccelerationStructure(device,impl,nullptr);
   }
 
@@ -32,6 +32,13 @@ void VAllocator::setDevice(VDevice &d) {
   dev             = d.device.impl;
   provider.device = &d;
   samplers.setDevice(d);
+
+  VkPhysicalDeviceMemoryProperties mem = {};
+  vkGetPhysicalDeviceMemoryProperties(d.physicalDevice,&mem);
+  coherentTypes = 0;
+  for(uint32_t i=0; i<mem.memoryTypeCount; ++i)
+    if(mem.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+      coherentTypes |= (1u << i);
   }
 
 VDevice* VAllocator::device() {
@@ -84,6 +91,17 @@ void VAllocator::Provider::free(VAllocator::Provider::DeviceMemory m, size_t siz
   lastType = typeId;
   }
 
+void* VAllocator::Provider::map(DeviceMemory m, size_t /*size*/) {
+  void* ret = nullptr;
+  if(vkMapMemory(device->device.impl,m,0,VK_WHOLE_SIZE,0,&ret)!=VK_SUCCESS)
+    return nullptr; // fallback to map on every access
+  return ret;
+  }
+
+void VAllocator::Provider::unmap(DeviceMemory m) {
+  vkUnmapMemory(device->device.impl,m);
+  }
+
 static size_t GCD(size_t n1, size_t n2) {
   if(n1==1 || n2==1)
     return 1;
@@ -190,9 +208,20 @@ VBuffer VAllocator::alloc(const void *mem, size_t size, MemUsage usage, BufferHe
     if(!ret.page.page)
       continue;
 
-    if(!commit(ret.page.page->memory,ret.page.page->mmapSync,ret.impl,ret.page.offset,mem,size)) {
+    if(!commit(ret.page,ret.impl,mem,size)) {
       throw std::system_error(Tempest::GraphicsErrc::OutOfHostMemory);
       }
+
+    ret.usage = createInfo.usage;
+    ret.size  = size;
+
+    // device-local buffers, that can't be referenced by descriptor sets, are relocatable
+    const VkBufferUsageFlags pinned = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                      VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR;
+    if(bufHeap==BufferHeap::Device && !memId.hostVisible && (createInfo.usage & pinned)==0) {
+      ret.relocatable = true;
+      setOwner(ret);
+      }
     return ret;
     }
 
@@ -230,7 +259,7 @@ VTexture VAllocator::alloc(const Pixmap& pm, uint32_t mip, VkFormat format) {
     ret.alloc = nullptr;
     throw std::system_error(Tempest::GraphicsErrc::OutOfHostMemory);
     }
-  if(!commit(ret.page.page->memory,ret.page.page->mmapSync,ret.impl,ret.page.offset)) {
+  if(!commit(ret.page,ret.impl)) {
     ret.alloc = nullptr;
     throw std::system_error(Tempest::GraphicsErrc::OutOfHostMemory);
     }
@@ -279,7 +308,7 @@ VTexture VAllocator::alloc(const uint32_t w, const uint32_t h, const uint32_t d,
     ret.alloc = nullptr;
     throw std::system_error(Tempest::GraphicsErrc::OutOfHostMemory);
     }
-  if(!commit(ret.page.page->memory,ret.page.page->mmapSync,ret.impl,ret.page.offset)) {
+  if(!commit(ret.page,ret.impl)) {
     ret.alloc = nullptr;
     throw std::system_error(Tempest::GraphicsErrc::OutOfHostMemory);
     }
@@ -398,8 +427,45 @@ void VAllocator::alignRange(VkMappedMemoryRange& rgn, size_t nonCoherentAtomSize
     rgn.size += nonCoherentAtomSize-rgn.size%nonCoherentAtomSize;
   }
 
+bool VAllocator::isCoherent(const Allocation& page) const {
+  return (coherentTypes & (1u << page.page->typeId))!=0;
+  }
+
+void VAllocator::flush(const Allocation& page, size_t offset, size_t size) {
+  if(isCoherent(page))
+    return;
+  VkMappedMemoryRange rgn={};
+  rgn.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  rgn.memory = page.page->memory;
+  rgn.offset = page.offset+offset;
+  rgn.size   = size;
+  size_t shift = 0;
+  alignRange(rgn,provider.device->props.nonCoherentAtomSize,shift);
+  vkFlushMappedMemoryRanges(dev,1,&rgn);
+  }
+
+void VAllocator::invalidate(const Allocation& page, size_t offset, size_t size) {
+  if(isCoherent(page))
+    return;
+  VkMappedMemoryRange rgn={};
+  rgn.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+  rgn.memory = page.page->memory;
+  rgn.offset = page.offset+offset;
+  rgn.size   = size;
+  size_t shift = 0;
+  alignRange(rgn,provider.device->props.nonCoherentAtomSize,shift);
+  vkInvalidateMappedMemoryRanges(dev,1,&rgn);
+  }
+
 bool VAllocator::fill(VBuffer& dest, uint32_t mem, size_t offset, size_t size) {
   auto& page = dest.page;
+  if(T_LIKELY(page.page->mapped!=nullptr)) {
+    auto data = reinterpret_cast<uint8_t*>(page.page->mapped) + page.offset + offset;
+    std::fill_n(reinterpret_cast<uint32_t*>(data), size/sizeof(uint32_t), mem);
+    flush(page,offset,size);
+    return true;
+    }
+
   void* data = nullptr;
 
   VkMappedMemoryRange rgn={};
@@ -425,6 +491,13 @@ bool VAllocator::fill(VBuffer& dest, uint32_t mem, size_t offset, size_t size) {
 
 bool VAllocator::update(VBuffer &dest, const void *mem, size_t offset, size_t size) {
   auto& page = dest.page;
+  if(T_LIKELY(page.page->mapped!=nullptr)) {
+    auto data = reinterpret_cast<uint8_t*>(page.page->mapped) + page.offset + offset;
+    std::memcpy(data, mem, size);
+    flush(page,offset,size);
+    return true;
+    }
+
   void* data = nullptr;
 
   VkMappedMemoryRange rgn={};
@@ -450,6 +523,13 @@ bool VAllocator::update(VBuffer &dest, const void *mem, size_t offset, size_t si
 
 bool VAllocator::read(VBuffer &src, void *mem, size_t offset, size_t size) {
   auto& page = src.page;
+  if(T_LIKELY(page.page->mapped!=nullptr)) {
+    auto data = reinterpret_cast<const uint8_t*>(page.page->mapped) + page.offset + offset;
+    invalidate(page,offset,size);
+    std::memcpy(mem, data, size);
+    return true;
+    }
+
   void* data = nullptr;
 
   VkMappedMemoryRange rgn={};
@@ -472,11 +552,103 @@ bool VAllocator::read(VBuffer &src, void *mem, size_t offset, size_t size) {
   return true;
   }
 
+void VAllocator::setOwner(VBuffer& buf) {
+  allocator.setOwner(buf.page,&buf);
+  }
+
+void VAllocator::clearOwner(VBuffer& buf) {
+  allocator.setOwner(buf.page,nullptr);
+  }
+
+size_t VAllocator::defragment(size_t maxBytes) {
+  auto& dx = *provider.device;
+
+  auto moves = allocator.defragment(maxBytes,DefragOccupancy,[this](void* owner) -> size_t {
+    MemRequirements rq = {};
+    getMemoryRequirements(rq,reinterpret_cast<VBuffer*>(owner)->impl);
+    return LCM(rq.alignment,provider.device->props.nonCoherentAtomSize);
+    });
+  if(moves.empty()) {
+    allocator.endDefragment();
+    return 0;
+    }
+
+  std::vector<VBuffer> dst;
+  dst.reserve(moves.size());
+  try {
+    for(auto& m:moves) {
+      auto& src = *reinterpret_cast<VBuffer*>(m.owner);
+
+      VkBufferCreateInfo createInfo={};
+      createInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      createInfo.size        = src.size;
+      createInfo.usage       = src.usage;
+      createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+      VBuffer b;
+      b.alloc     = this;
+      b.page      = m.to;
+      b.nonUniqId = src.nonUniqId;
+      m.to.page   = nullptr; // owned by `b` from now on
+      dst.emplace_back(std::move(b));
+
+      vkAssert(vkCreateBuffer(dev,&createInfo,nullptr,&dst.back().impl));
+      if(!commit(dst.back().page,dst.back().impl,nullptr,0))
+        throw std::system_error(Tempest::GraphicsErrc::OutOfHostMemory);
+      }
+    }
+  catch(...) {
+    for(auto& m:moves)
+      if(m.to.page!=nullptr)
+        allocator.free(m.to);
+    dst.clear();
+    allocator.endDefragment();
+    throw;
+    }
+
+  // pending updates go to old location first
+  dx.uploadRing.flush();
+  auto cmd = dx.dataMgr().get();
+  cmd->begin(true);
+  for(size_t i=0; i<moves.size(); ++i) {
+    auto& src = *reinterpret_cast<VBuffer*>(moves[i].owner);
+    cmd->copy(dst[i],0,src,0,src.size);
+    }
+  cmd->end();
+  dx.dataMgr().submitAndWait(std::move(cmd));
+
+  size_t bytes = 0;
+  for(size_t i=0; i<moves.size(); ++i) {
+    auto& src = *reinterpret_cast<VBuffer*>(moves[i].owner);
+    std::swap(src.impl,dst[i].impl);
+    std::swap(src.page,dst[i].page); // new block is already owned by `src`
+    bytes += src.size;
+    }
+  dst.clear(); // old buffers and their place in sparse pages
+  allocator.endDefragment();
+  return bytes;
+  }
+
 VkSampler VAllocator::updateSampler(const Tempest::Sampler &s) {
   return samplers.get(s);
   }
 
-bool VAllocator::commit(VkDeviceMemory dmem, std::mutex &mmapSync, VkBuffer dest, size_t pageOffset, const void* mem, size_t size) {
+bool VAllocator::commit(Allocation& page, VkBuffer dest, const void* mem, size_t size) {
+  VkDeviceMemory dmem       = page.page->memory;
+  size_t         pageOffset = page.offset;
+
+  std::lock_guard<std::mutex> g(page.page->mmapSync); // on practice bind requires external sync
+  if(vkBindBufferMemory(dev,dest,dmem,pageOffset)!=VK_SUCCESS)
+    return false;
+  if(mem==nullptr)
+    return true;
+
+  if(page.page->mapped!=nullptr) {
+    std::memcpy(reinterpret_cast<uint8_t*>(page.page->mapped)+pageOffset, mem, size);
+    flush(page,0,size);
+    return true;
+    }
+
   VkMappedMemoryRange rgn={};
   rgn.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
   rgn.memory = dmem;
@@ -485,25 +657,19 @@ bool VAllocator::commit(VkDeviceMemory dmem, std::mutex &mmapSync, VkBuffer dest
   size_t shift = 0;
   alignRange(rgn,provider.device->props.nonCoherentAtomSize,shift);
 
-  std::lock_guard<std::mutex> g(mmapSync); // on practice bind requires external sync
-  if(vkBindBufferMemory(dev,dest,dmem,pageOffset)!=VK_SUCCESS)
+  void* data=nullptr;
+  if(vkMapMemory(dev,dmem,rgn.offset,rgn.size,0,&data)!=VK_SUCCESS)
     return false;
-  if(mem!=nullptr) {
-    void* data=nullptr;
-    if(vkMapMemory(dev,dmem,pageOffset,rgn.size,0,&data)!=VK_SUCCESS)
-      return false;
-    data = reinterpret_cast<uint8_t*>(data)+shift;
-    std::memcpy(data, mem, size);
-    vkFlushMappedMemoryRanges(dev,1,&rgn);
-    vkUnmapMemory(dev,dmem);
-    }
-
+  data = reinterpret_cast<uint8_t*>(data)+shift;
+  std::memcpy(data, mem, size);
+  vkFlushMappedMemoryRanges(dev,1,&rgn);
+  vkUnmapMemory(dev,dmem);
   return true;
   }
 
-bool VAllocator::commit(VkDeviceMemory dmem, std::mutex& mmapSync, VkImage dest, size_t offset) {
-  std::lock_guard<std::mutex> g(mmapSync); // on practice bind requires external sync
-  return vkBindImageMemory(dev, dest, dmem, offset)==VkResult::VK_SUCCESS;
+bool VAllocator::commit(Allocation& page, VkImage dest) {
+  std::lock_guard<std::mutex> g(page.page->mmapSync); // on practice bind requires external sync
+  return vkBindImageMemory(dev, dest, page.page->memory, page.offset)==VkResult::VK_SUCCESS;
   }
 
 #endif
@@ -26,6 +26,8 @@ class VAllocator {
 
       DeviceMemory alloc(size_t size, uint32_t typeId);
       void         free(DeviceMemory m, size_t size, uint32_t typeId);
+      void*        map  (DeviceMemory m, size_t size);
+      void         unmap(DeviceMemory m);
       };
 
     struct MemRequirements {
@@ -44,6 +46,7 @@ class VAllocator {
     VDevice* device();
 
     using Allocation=typename Tempest::Detail::DeviceAllocator<Provider>::Allocation;
+    using Stats     =typename Tempest::Detail::DeviceAllocator<Provider>::Stats;
 
     VBuffer  alloc(const void *mem, size_t size, MemUsage usage, BufferHeap bufHeap);
     VTexture alloc(const Pixmap &pm, uint32_t mip, VkFormat format);
@@ -57,8 +60,20 @@ class VAllocator {
 
     VkSampler updateSampler(const Sampler& s);
 
+    std::vector<Stats> stats() { return allocator.stats(); }
+
+    // Moves relocatable buffers out of sparsely used pages and releases those pages; returns bytes moved.
+    // Device must be idle: relocated buffers get a new VkBuffer handle.
+    size_t   defragment(size_t maxBytes);
+    void     setOwner(VBuffer& buf);
+    void     clearOwner(VBuffer& buf);
+
   private:
+    // pages filled up to this ratio are evacuated by defragment()
+    static constexpr double           DefragOccupancy = 0.25;
+
     VkDevice                          dev=nullptr;
+    uint32_t                          coherentTypes=0;
     Provider                          provider;
     VSamplerCache                     samplers;
     Detail::DeviceAllocator<Provider> allocator{provider};
@@ -66,11 +81,14 @@ class VAllocator {
     void getMemoryRequirements   (MemRequirements& out, VkBuffer buf);
     void getImgMemoryRequirements(MemRequirements& out, VkImage  img);
     void alignRange(VkMappedMemoryRange& rgn, size_t nonCoherentAtomSize, size_t &shift);
+    bool isCoherent(const Allocation& page) const;
+    void flush     (const Allocation& page, size_t offset, size_t size);
+    void invalidate(const Allocation& page, size_t offset, size_t size);
 
     Allocation allocMemory(const MemRequirements& rq, const uint32_t heapId, const uint32_t typeId, bool hostVisible);
 
-    bool commit(VkDeviceMemory dev, std::mutex& mmapSync, VkBuffer dest, size_t offset, const void *mem, size_t size);
-    bool commit(VkDeviceMemory dev, std::mutex& mmapSync, VkImage  dest, size_t offset);
+    bool commit(Allocation& page, VkBuffer dest, const void *mem, size_t size);
+    bool commit(Allocation& page, VkImage  dest);
   };
 
 }}
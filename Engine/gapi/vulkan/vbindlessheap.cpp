@@ -0,0 +1,234 @@
+#if defined(TEMPEST_BUILD_VULKAN)
+
+#include "vbindlessheap.h"
+
+#include "vdevice.h"
+#include "vbuffer.h"
+#include "vtexture.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+uint32_t VBindlessHeap::Slots::alloc() {
+  if(!freed.empty()) {
+    auto ret = freed.back();
+    freed.pop_back();
+    return ret;
+    }
+  if(next>=size)
+    throw std::system_error(Tempest::GraphicsErrc::OutOfVideoMemory);
+  return next++;
+  }
+
+VBindlessHeap::VBindlessHeap(VDevice& dev)
+  :dev(dev) {
+  }
+
+VBindlessHeap::~VBindlessHeap() {
+  VkDevice device = dev.device.impl;
+  recycle(true);
+  for(auto f:spareFences)
+    vkDestroyFence(device,f,nullptr);
+  if(pool!=VK_NULL_HANDLE)
+    vkDestroyDescriptorPool(device,pool,nullptr);
+  if(lay!=VK_NULL_HANDLE)
+    vkDestroyDescriptorSetLayout(device,lay,nullptr);
+  if(emptyLay!=VK_NULL_HANDLE)
+    vkDestroyDescriptorSetLayout(device,emptyLay,nullptr);
+  }
+
+void VBindlessHeap::init() {
+  VkDevice device = dev.device.impl;
+
+  textures.size = std::min<uint32_t>(MaxTextures, dev.props.descriptors.maxTexture);
+  samplers.size = std::min<uint32_t>(MaxSamplers, dev.props.descriptors.maxSamplers);
+  buffers .size = std::min<uint32_t>(MaxBuffers,  dev.props.descriptors.maxStorage);
+
+  VkDescriptorSetLayoutBinding bind[3] = {};
+  bind[0].binding         = 0;
+  bind[0].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+  bind[0].descriptorCount = textures.size;
+  bind[1].binding         = 1;
+  bind[1].descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
+  bind[1].descriptorCount = samplers.size;
+  bind[2].binding         = 2;
+  bind[2].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  bind[2].descriptorCount = buffers.size;
+  for(auto& b:bind)
+    b.stageFlags = VK_SHADER_STAGE_ALL;
+
+  // slots are filled on demand, while heap is bound to command buffers in flight
+  VkDescriptorBindingFlags flg[3] = {};
+  for(auto& f:flg)
+    f = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+  VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlags = {};
+  bindingFlags.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  bindingFlags.bindingCount  = 3;
+  bindingFlags.pBindingFlags = flg;
+
+  VkDescriptorSetLayoutCreateInfo info = {};
+  info.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  info.pNext        = &bindingFlags;
+  info.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+  info.bindingCount = 3;
+  info.pBindings    = bind;
+  vkAssert(vkCreateDescriptorSetLayout(device,&info,nullptr,&lay));
+
+  VkDescriptorSetLayoutCreateInfo empty = {};
+  empty.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  vkAssert(vkCreateDescriptorSetLayout(device,&empty,nullptr,&emptyLay));
+
+  VkDescriptorPoolSize poolSize[3] = {};
+  for(int i=0; i<3; ++i) {
+    poolSize[i].type            = bind[i].descriptorType;
+    poolSize[i].descriptorCount = bind[i].descriptorCount;
+    }
+
+  VkDescriptorPoolCreateInfo poolInfo = {};
+  poolInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  poolInfo.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+  poolInfo.maxSets       = 1;
+  poolInfo.poolSizeCount = 3;
+  poolInfo.pPoolSizes    = poolSize;
+  vkAssert(vkCreateDescriptorPool(device,&poolInfo,nullptr,&pool));
+
+  VkDescriptorSetAllocateInfo allocInfo = {};
+  allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocInfo.descriptorPool     = pool;
+  allocInfo.descriptorSetCount = 1;
+  allocInfo.pSetLayouts        = &lay;
+  vkAssert(vkAllocateDescriptorSets(device,&allocInfo,&set));
+  }
+
+uint32_t VBindlessHeap::id(VTexture& tex) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(tex.bindlessId!=NoId)
+    return tex.bindlessId;
+  recycle(false);
+
+  VkDescriptorImageInfo img = {};
+  img.imageView   = tex.view(ComponentMapping(),uint32_t(-1),tex.is3D);
+  img.imageLayout = tex.isStorageImage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+  const uint32_t ret = textures.alloc();
+  write(0,ret,&img,nullptr);
+  tex.bindlessId = ret;
+  return ret;
+  }
+
+uint32_t VBindlessHeap::id(VBuffer& buf) {
+  std::lock_guard<std::mutex> guard(sync);
+  if(buf.bindlessId!=NoId)
+    return buf.bindlessId;
+  recycle(false);
+
+  VkDescriptorBufferInfo info = {};
+  info.buffer = buf.impl;
+  info.offset = 0;
+  info.range  = VK_WHOLE_SIZE;
+
+  const uint32_t ret = buffers.alloc();
+  write(2,ret,nullptr,&info);
+  buf.bindlessId = ret;
+  return ret;
+  }
+
+uint32_t VBindlessHeap::id(VkSampler smp) {
+  std::lock_guard<std::mutex> guard(sync);
+  auto it = samplerId.find(smp);
+  if(it!=samplerId.end())
+    return it->second;
+
+  VkDescriptorImageInfo img = {};
+  img.sampler = smp;
+
+  const uint32_t ret = samplers.alloc();
+  write(1,ret,&img,nullptr);
+  samplerId[smp] = ret; // samplers are owned by allocator and never destroyed
+  return ret;
+  }
+
+void VBindlessHeap::release(VTexture& tex) {
+  // slot is left as is: it's partially bound and not accessed, until reused
+  std::lock_guard<std::mutex> guard(sync);
+  retired.push({0,tex.bindlessId});
+  tex.bindlessId = NoId;
+  }
+
+void VBindlessHeap::release(VBuffer& buf) {
+  std::lock_guard<std::mutex> guard(sync);
+  retired.push({2,buf.bindlessId});
+  buf.bindlessId = NoId;
+  }
+
+void VBindlessHeap::seal() {
+  std::lock_guard<std::mutex> guard(sync);
+  if(retired.empty())
+    return;
+  // empty submit: fence is signaled, when all work submitted to queue so far is complete
+  Mark m;
+  m.gfx = fence();
+  dev.graphicsQueue->submit(0,nullptr,m.gfx);
+  if(dev.computeQueue!=nullptr) {
+    m.comp = fence();
+    dev.computeQueue->submit(0,nullptr,m.comp);
+    }
+  retired.seal(m);
+  }
+
+VkFence VBindlessHeap::fence() {
+  if(!spareFences.empty()) {
+    auto ret = spareFences.back();
+    spareFences.pop_back();
+    return ret;
+    }
+  VkFenceCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  VkFence ret = VK_NULL_HANDLE;
+  vkAssert(vkCreateFence(dev.device.impl,&info,nullptr,&ret));
+  return ret;
+  }
+
+void VBindlessHeap::recycle(bool wait) {
+  VkDevice device = dev.device.impl;
+  auto done = [device,wait](const Mark& m) {
+    if(wait)
+      return true;
+    return vkGetFenceStatus(device,m.gfx)==VK_SUCCESS &&
+           (m.comp==VK_NULL_HANDLE || vkGetFenceStatus(device,m.comp)==VK_SUCCESS);
+    };
+  auto fn = [this](const Retired& r) {
+    auto& s = (r.binding==0 ? textures : buffers);
+    s.freed.push_back(r.id);
+    };
+  auto free = [this,device](const Mark& m) {
+    for(auto f:{m.gfx,m.comp}) {
+      if(f==VK_NULL_HANDLE)
+        continue;
+      vkResetFences(device,1,&f);
+      spareFences.push_back(f);
+      }
+    };
+  retired.recycle(done,fn,free);
+  }
+
+void VBindlessHeap::write(uint32_t binding, uint32_t id,
+                          const VkDescriptorImageInfo* img, const VkDescriptorBufferInfo* buf) {
+  VkWriteDescriptorSet wr = {};
+  wr.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  wr.dstSet          = set;
+  wr.dstBinding      = binding;
+  wr.dstArrayElement = id;
+  wr.descriptorCount = 1;
+  wr.descriptorType  = (binding==0 ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE :
+                        binding==1 ? VK_DESCRIPTOR_TYPE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+  wr.pImageInfo      = img;
+  wr.pBufferInfo     = buf;
+  vkUpdateDescriptorSets(dev.device.impl,1,&wr,0,nullptr);
+  }
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+#include "vulkan_sdk.h"
+#include "gapi/retirequeue.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+class VDevice;
+class VBuffer;
+class VTexture;
+
+// Device-wide update-after-bind descriptor set, with stable index per resource.
+// Bound by command buffer at `ShaderReflection::BindlessSet`:
+//   binding 0 - texture2D[], binding 1 - sampler[], binding 2 - storage buffer[]
+class VBindlessHeap {
+  public:
+    explicit VBindlessHeap(VDevice& dev);
+    VBindlessHeap(const VBindlessHeap&) = delete;
+    ~VBindlessHeap();
+
+    enum : uint32_t {
+      NoId        = uint32_t(-1),
+      MaxTextures = 65536,
+      MaxSamplers = 1024,
+      MaxBuffers  = 65536,
+      };
+
+    void                  init();
+    bool                  isEnabled() const { return set!=VK_NULL_HANDLE; }
+
+    // index of resource in heap; assigned on first call, released, when resource is destroyed
+    uint32_t              id(VTexture& tex);
+    uint32_t              id(VBuffer&  buf);
+    uint32_t              id(VkSampler smp);
+
+    // slot of destroyed resource is reused, once commands, submitted before it, are complete
+    void                  release(VTexture& tex);
+    void                  release(VBuffer&  buf);
+    // closes frame of released slots with fence on each queue, that binds heap; called after submit
+    void                  seal();
+
+    VkDescriptorSetLayout lay      = VK_NULL_HANDLE;
+    VkDescriptorSetLayout emptyLay = VK_NULL_HANDLE; // fills descriptor sets, that are not in use, below heap set
+    VkDescriptorSet       set      = VK_NULL_HANDLE;
+
+  private:
+    struct Slots {
+      uint32_t              size = 0;
+      uint32_t              next = 0;
+      std::vector<uint32_t> freed;
+
+      uint32_t              alloc();
+      };
+
+    struct Retired {
+      uint32_t              binding = 0;
+      uint32_t              id      = 0;
+      };
+
+    struct Mark {
+      VkFence               gfx  = VK_NULL_HANDLE;
+      VkFence               comp = VK_NULL_HANDLE;
+      };
+
+    VkFence               fence();
+    void                  recycle(bool wait);
+    void                  write(uint32_t binding, uint32_t id, const VkDescriptorImageInfo* img, const VkDescriptorBufferInfo* buf);
+
+    VDevice&              dev;
+    VkDescriptorPool      pool = VK_NULL_HANDLE;
+
+    std::mutex            sync;
+    Slots                 textures, samplers, buffers;
+    RetireQueue<Retired,Mark> retired;
+    std::vector<VkFence>  spareFences;
+    std::unordered_map<VkSampler,uint32_t> samplerId;
+  };
+
+}
+}
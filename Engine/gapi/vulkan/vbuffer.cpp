@@ -14,17 +14,35 @@ VBuffer::VBuffer(VBuffer &&other) {
   }
 
 VBuffer::~VBuffer() {
-  if(impl!=VK_NULL_HANDLE)
-    vkDestroyBuffer(alloc->device()->device.impl,impl,nullptr);
-  if(alloc!=nullptr)
+  if(impl!=VK_NULL_HANDLE) {
+    auto& dx = *alloc->device();
+    if((usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))!=0)
+      dx.descRefs.invalidate(uint64_t(impl)); // handle may be reused, while still referenced by cached descriptor set
+    if(bindlessId!=VBindlessHeap::NoId)
+      dx.bindless.release(*this);
+    vkDestroyBuffer(dx.device.impl,impl,nullptr);
+    }
+  if(alloc!=nullptr) {
+    // defragment() must not see dead buffer as owner of the block
+    if(relocatable)
+      alloc->clearOwner(*this);
     alloc->free(page);
+    }
   }
 
 VBuffer& VBuffer::operator=(VBuffer&& other) {
   std::swap(impl,      other.impl);
   std::swap(nonUniqId, other.nonUniqId);
+  std::swap(bindlessId,other.bindlessId);
   std::swap(alloc,     other.alloc);
   std::swap(page,      other.page);
+  std::swap(usage,     other.usage);
+  std::swap(size,      other.size);
+  std::swap(relocatable, other.relocatable);
+  if(relocatable)
+    alloc->setOwner(*this);
+  if(other.relocatable)
+    other.alloc->setOwner(other);
   return *this;
   }
 
@@ -37,33 +55,47 @@ void VBuffer::update(const void* data, size_t off, size_t size) {
     return;
     }
 
-  if(off%4==0 && size%4==0) {
-    Detail::DSharedPtr<Buffer*> pBuf(this);
+  dx.dataMgr().waitFor(this); // write-after-write case
+  if(dx.uploadRing.push(*this,off,data,size))
+    return; // submitted along with next command buffer
+  dx.uploadRing.flush(); // older batched update of this buffer must land first
 
-    auto cmd = dx.dataMgr().get();
-    cmd->begin(true);
-    cmd->hold(pBuf); // NOTE: VBuffer may be deleted, before copy is finished
-    cmd->copy(*this, off, data, size);
-    cmd->end();
+  auto stage = dx.dataMgr().allocStagingMemory(data,size,MemUsage::TransferSrc,BufferHeap::Upload);
 
-    dx.dataMgr().waitFor(this); // write-after-write case
-    dx.dataMgr().submit(std::move(cmd));
+  Detail::DSharedPtr<Buffer*> pStage(new Detail::VBuffer(std::move(stage)));
+  Detail::DSharedPtr<Buffer*> pBuf  (this);
+
+  auto cmd = dx.dataMgr().get();
+  cmd->begin(true);
+  cmd->hold(pBuf); // NOTE: VBuffer may be deleted, before copy is finished
+  cmd->hold(pStage);
+  cmd->copy(*this, off, *pStage.handler, 0, size);
+  cmd->end();
+
+  dx.dataMgr().submit(std::move(cmd));
+  }
+
+void VBuffer::initialize(const void* data, size_t size) {
+  auto& dx = *alloc->device();
+
+  if(page.page->hostVisible || dx.transferQueue==nullptr || size<StreamThreshold) {
+    update(data,0,size);
     return;
     }
 
+  // fresh buffer is not in use by graphics queue yet: copy it on transfer queue
   auto stage = dx.dataMgr().allocStagingMemory(data,size,MemUsage::TransferSrc,BufferHeap::Upload);
 
   Detail::DSharedPtr<Buffer*> pStage(new Detail::VBuffer(std::move(stage)));
   Detail::DSharedPtr<Buffer*> pBuf  (this);
 
   auto cmd = dx.dataMgr().get();
-  cmd->begin(true);
-  cmd->hold(pBuf); // NOTE: VBuffer may be deleted, before copy is finished
+  cmd->beginStreaming();
+  cmd->hold(pBuf);
   cmd->hold(pStage);
-  cmd->copy(*this, off, *pStage.handler, 0, size);
+  cmd->streamCopy(*this, 0, *reinterpret_cast<VBuffer*>(pStage.handler), 0, size);
   cmd->end();
 
-  dx.dataMgr().waitFor(this); // write-after-write case
   dx.dataMgr().submit(std::move(cmd));
   }
 
@@ -76,6 +108,8 @@ void VBuffer::read(void* out, size_t off, size_t size) {
     return;
     }
 
+  dx.uploadRing.flush();
+
   auto  stage = dx.dataMgr().allocStagingMemory(nullptr,size,MemUsage::TransferDst,BufferHeap::Readback);
 
   auto cmd = dx.dataMgr().get();
@@ -100,6 +134,7 @@ void VBuffer::fill(uint32_t data, size_t off, size_t size) {
 
   if(off%4==0 && size%4==0) {
     Detail::DSharedPtr<Buffer*> pBuf(this);
+    dx.uploadRing.flush(); // keep order with batched updates
 
     auto cmd = dx.dataMgr().get();
     cmd->begin(true);
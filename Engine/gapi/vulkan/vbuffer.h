@@ -18,6 +18,7 @@ class VBuffer : public AbstractGraphicsApi::Buffer {
 
     void fill  (uint32_t    data, size_t off, size_t size);
     void update(const void* data, size_t off, size_t size) override;
+    void initialize(const void* data, size_t size);
     void read  (      void* data, size_t off, size_t size) override;
 
     bool                   isHostVisible() const;
@@ -25,11 +26,22 @@ class VBuffer : public AbstractGraphicsApi::Buffer {
     VkDeviceAddress        toDeviceAddress(VDevice& owner) const;
     VkBuffer               impl      = VK_NULL_HANDLE;
     NonUniqResId           nonUniqId = NonUniqResId::I_None;
+    uint32_t               bindlessId = uint32_t(-1);
 
   private:
+    enum : size_t {
+      // smaller uploads are not worth of queue ownership transfer
+      StreamThreshold = 256*1024,
+      };
+
     VAllocator*            alloc=nullptr;
     VAllocator::Allocation page={};
 
+    VkBufferUsageFlags     usage       = 0;
+    size_t                 size        = 0;
+    // set for buffers, that can be relocated by defragmentation
+    bool                   relocatable = false;
+
   friend class VAllocator;
   };
 
@@ -4,6 +4,7 @@
 
 #include <Tempest/DescriptorSet>
 #include <Tempest/Attachment>
+#include <Tempest/Except>
 
 #include "vdevice.h"
 #include "vcommandpool.h"
@@ -142,6 +143,45 @@ static void toStage(VDevice& dev, VkPipelineStageFlags2KHR& stage, VkAccessFlagB
   access = VkAccessFlagBits2KHR(acc);
   }
 
+static void toComputeQueue(VkPipelineStageFlags2KHR& stage, VkAccessFlags2KHR& access) {
+  // graphics stages are not supported by compute-only queue
+  const VkPipelineStageFlags2KHR st = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT |
+                                      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT |
+                                      VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+  const VkAccessFlags2KHR        ac = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT |
+                                      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                                      VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+                                      VK_ACCESS_HOST_READ_BIT | VK_ACCESS_HOST_WRITE_BIT |
+                                      VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT |
+                                      VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+  if(stage==VK_PIPELINE_STAGE_NONE_KHR)
+    return;
+  stage  &= st;
+  access &= ac;
+  if(stage==0) {
+    stage  = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    access = VK_ACCESS_NONE_KHR;
+    }
+  }
+
+static void toQueueFamily(const VDevice& dev, uint32_t& src, uint32_t& dst, QueueOwnership own) {
+  switch(own) {
+    case QueueOwnership::None:
+      src = VK_QUEUE_FAMILY_IGNORED;
+      dst = VK_QUEUE_FAMILY_IGNORED;
+      break;
+    case QueueOwnership::ToCompute:
+      src = dev.graphicsQueue->family;
+      dst = dev.computeQueue->family;
+      break;
+    case QueueOwnership::ToGraphics:
+      src = dev.computeQueue->family;
+      dst = dev.graphicsQueue->family;
+      break;
+    }
+  }
+
 static VkImageLayout toLayout(ResourceAccess rs) {
   if(rs==ResourceAccess::None)
     return VK_IMAGE_LAYOUT_UNDEFINED;
@@ -186,6 +226,10 @@ VCommandBuffer::VCommandBuffer(VDevice& device, VkCommandPoolCreateFlags flags)
   :device(device), pool(device,flags) {
   }
 
+VCommandBuffer::VCommandBuffer(VDevice& device, VkCommandPoolCreateFlags flags, uint32_t queueFamily)
+  :device(device), pool(device,flags,queueFamily) {
+  }
+
 VCommandBuffer::~VCommandBuffer() {
   if(impl!=nullptr) {
     vkFreeCommandBuffers(device.device.impl,pool.impl,1,&impl);
@@ -223,11 +267,14 @@ void VCommandBuffer::reset() {
 
   swapchainSync.reserve(swapchainSync.size());
   swapchainSync.clear();
+  fboRefs.clear();
   }
 
 void VCommandBuffer::begin(bool tranfer) {
-  state  = Idle;
-  curVbo = VK_NULL_HANDLE;
+  state          = Idle;
+  curVbo         = VK_NULL_HANDLE;
+  heapLayout     = VK_NULL_HANDLE;
+  heapCompLayout = VK_NULL_HANDLE;
   if(chunks.size()>0)
     reset();
 
@@ -243,6 +290,9 @@ void VCommandBuffer::begin(bool tranfer) {
     beginInfo.pInheritanceInfo = nullptr;
     vkAssert(vkBeginCommandBuffer(impl,&beginInfo));
     }
+
+  if(timers!=nullptr)
+    timers->begin(impl);
   }
 
 void VCommandBuffer::begin() {
@@ -254,6 +304,8 @@ void VCommandBuffer::end() {
     device.vkCmdDebugMarkerEnd(impl);
     isDbgRegion = false;
     }
+  if(timers!=nullptr)
+    timers->end(impl);
   swapchainSync.reserve(swapchainSync.size());
   resState.finalize(*this);
   state = NoRecording;
@@ -270,6 +322,59 @@ void VCommandBuffer::beginRendering(const AttachmentDesc* desc, size_t descSize,
                                     const TextureFormat* frm,
                                     AbstractGraphicsApi::Texture** att,
                                     AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId) {
+  implBeginRendering(desc,descSize,width,height,frm,att,sw,imgId,true);
+  if(timers!=nullptr)
+    timers->beginPass(impl);
+
+  // setup dynamic state
+  // https://www.khronos.org/registry/vulkan/specs/1.1-extensions/html/vkspec.html#pipelines-dynamic-state
+  setViewport(Rect(0,0,int32_t(width),int32_t(height)));
+  setScissor (Rect(0,0,int32_t(width),int32_t(height)));
+  }
+
+bool VCommandBuffer::beginParallelRendering(const AttachmentDesc* desc, size_t descSize,
+                                            uint32_t width, uint32_t height,
+                                            const TextureFormat* frm,
+                                            AbstractGraphicsApi::Texture** att,
+                                            AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId,
+                                            AbstractGraphicsApi::CommandBuffer** out, size_t count) {
+  // no pipeline statistics for parallel pass: only vkCmdExecuteCommands is allowed in primary
+  implBeginRendering(desc,descSize,width,height,frm,att,sw,imgId,false);
+
+  VkCommandBufferInheritanceRenderingInfoKHR dyn = {};
+  VkCommandBufferInheritanceInfo             inh = {};
+  inh.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  if(device.props.hasDynRendering) {
+    dyn.sType                   = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    dyn.viewMask                = passDyn.viewMask;
+    dyn.colorAttachmentCount    = passDyn.colorAttachmentCount;
+    dyn.pColorAttachmentFormats = passDyn.colorFrm;
+    dyn.depthAttachmentFormat   = passDyn.depthAttachmentFormat;
+    dyn.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+    dyn.rasterizationSamples    = VK_SAMPLE_COUNT_1_BIT;
+    inh.pNext                   = &dyn;
+    } else {
+    inh.renderPass              = pass->pass;
+    inh.subpass                 = 0;
+    inh.framebuffer             = VK_NULL_HANDLE;
+    }
+
+  while(secondary.size()<count)
+    secondary.emplace_back(new VSecondaryCommandBuffer(device));
+  for(size_t i=0; i<count; ++i) {
+    secondary[i]->beginSecondary(*this,inh,width,height);
+    out[i] = secondary[i].get();
+    }
+  secondaryCount = count;
+  return true;
+  }
+
+void VCommandBuffer::implBeginRendering(const AttachmentDesc* desc, size_t descSize,
+                                        uint32_t width, uint32_t height,
+                                        const TextureFormat* frm,
+                                        AbstractGraphicsApi::Texture** att,
+                                        AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId,
+                                        bool inlineContent) {
   for(size_t i=0; i<descSize; ++i) {
     if(sw[i]!=nullptr)
       addDependency(*reinterpret_cast<VSwapchain*>(sw[i]),imgId[i]);
@@ -289,7 +394,7 @@ void VCommandBuffer::beginRendering(const AttachmentDesc* desc, size_t descSize,
 
     VkRenderingInfoKHR info = {};
     info.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
-    info.flags                = 0;
+    info.flags                = inlineContent ? 0 : VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR;
     info.renderArea.offset    = {0, 0};
     info.renderArea.extent    = {width,height};
     info.layerCount           = 1;
@@ -360,6 +465,8 @@ void VCommandBuffer::beginRendering(const AttachmentDesc* desc, size_t descSize,
     auto fbo = device.fboMap.find(desc,descSize, att,sw,imgId,width,height);
     auto fb  = fbo.get();
     pass = fbo->pass;
+    if(fboRefs.empty() || fboRefs.back()!=fbo)
+      fboRefs.push_back(fbo);
 
     VkClearValue clr[MaxFramebufferAttachments];
     for(size_t i=0; i<descSize; ++i) {
@@ -383,21 +490,16 @@ void VCommandBuffer::beginRendering(const AttachmentDesc* desc, size_t descSize,
     info.clearValueCount   = uint32_t(descSize);
     info.pClearValues      = clr;
 
-    vkCmdBeginRenderPass(impl, &info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(impl, &info, inlineContent ? VK_SUBPASS_CONTENTS_INLINE : VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
     }
   state = RenderPass;
-
-  // setup dynamic state
-  // https://www.khronos.org/registry/vulkan/specs/1.1-extensions/html/vkspec.html#pipelines-dynamic-state
-  setViewport(Rect(0,0,int32_t(width),int32_t(height)));
-
-  VkRect2D scissor = {};
-  scissor.offset = {0, 0};
-  scissor.extent = {width, height};
-  vkCmdSetScissor(impl,0,1,&scissor);
   }
 
 void VCommandBuffer::endRendering() {
+  if(secondaryCount>0)
+    executeSecondary();
+  if(timers!=nullptr)
+    timers->endPass(impl);
   if(device.props.hasDynRendering) {
     device.vkCmdEndRenderingKHR(impl);
     } else {
@@ -406,18 +508,56 @@ void VCommandBuffer::endRendering() {
   state = PostRenderPass;
   }
 
+void VCommandBuffer::executeSecondary() {
+  for(size_t i=0; i<secondaryCount; ++i)
+    if(secondary[i]->isRecording())
+      throw ConcurentRecordingException();
+
+  SmallArray<VkCommandBuffer,16> flat(secondaryCount);
+  for(size_t i=0; i<secondaryCount; ++i) {
+    auto& s = *secondary[i];
+    resState.join(s.resState);
+    flat[i] = s.impl;
+    }
+  vkCmdExecuteCommands(impl,uint32_t(secondaryCount),flat.get());
+  secondaryCount = 0;
+
+  // bound state of primary is undefined after vkCmdExecuteCommands
+  curVbo         = VK_NULL_HANDLE;
+  curUniforms    = nullptr;
+  heapLayout     = VK_NULL_HANDLE;
+  heapCompLayout = VK_NULL_HANDLE;
+  }
+
 void VCommandBuffer::setPipeline(AbstractGraphicsApi::Pipeline& p) {
   VPipeline& px   = reinterpret_cast<VPipeline&>(p);
   curDrawPipeline = &px;
   vboStride       = px.defaultStride;
   pipelineLayout  = px.pipelineLayout; // if `px` is runtime-sized, we still need a dummy layout for push-constants
+  psoPending      = false;
 
-  VkPipeline v    = device.props.hasDynRendering ? px.instance(passDyn,pipelineLayout,vboStride)
-                                                 : px.instance(pass,   pipelineLayout,vboStride);
   if(!px.isRuntimeSized())
+    bindGraphicsPipeline(px);
+  bindHeap(VK_PIPELINE_BIND_POINT_GRAPHICS,heapLayout);
+  }
+
+void VCommandBuffer::bindGraphicsPipeline(VPipeline& px) {
+  const bool async = device.asyncPso.load(std::memory_order_relaxed);
+  VkPipeline v     = device.props.hasDynRendering ? px.instance(passDyn,pipelineLayout,vboStride,async)
+                                                  : px.instance(pass,   pipelineLayout,vboStride,async);
+  // still compiling in background: draws are dropped, until pipeline is ready
+  psoPending = (v==VK_NULL_HANDLE);
+  if(!psoPending)
     vkCmdBindPipeline(impl,VK_PIPELINE_BIND_POINT_GRAPHICS,v);
   }
 
+void VCommandBuffer::bindHeap(VkPipelineBindPoint bp, VkPipelineLayout& boundLay) {
+  if(!device.bindless.isEnabled() || boundLay==pipelineLayout)
+    return;
+  vkCmdBindDescriptorSets(impl,bp,pipelineLayout,ShaderReflection::BindlessSet,1,&device.bindless.set,0,nullptr);
+  boundLay = pipelineLayout;
+  }
+
 void VCommandBuffer::setBytes(AbstractGraphicsApi::Pipeline& p, const void* data, size_t size) {
   VPipeline&        px=reinterpret_cast<VPipeline&>(p);
   assert(size<=px.pushSize);
@@ -434,15 +574,14 @@ void VCommandBuffer::setUniforms(AbstractGraphicsApi::Pipeline &p, AbstractGraph
   if(T_UNLIKELY(pipelineLayout!=lay)) {
     pipelineLayout = lay;
 
-    auto&      px = *curDrawPipeline;
-    VkPipeline v  = device.props.hasDynRendering ? px.instance(passDyn,pipelineLayout,vboStride)
-                                                 : px.instance(pass,   pipelineLayout,vboStride);
-    vkCmdBindPipeline(impl,VK_PIPELINE_BIND_POINT_GRAPHICS,v);
+    bindGraphicsPipeline(*curDrawPipeline);
     }
 
+  VkDescriptorSet desc = ux.resolve();
   vkCmdBindDescriptorSets(impl,VK_PIPELINE_BIND_POINT_GRAPHICS,
-                          pipelineLayout,0,1,&ux.impl,
+                          pipelineLayout,0,1,&desc,
                           0,nullptr);
+  bindHeap(VK_PIPELINE_BIND_POINT_GRAPHICS,heapLayout);
   }
 
 void VCommandBuffer::setComputePipeline(AbstractGraphicsApi::CompPipeline& p) {
@@ -452,6 +591,7 @@ void VCommandBuffer::setComputePipeline(AbstractGraphicsApi::CompPipeline& p) {
   pipelineLayout = px.pipelineLayout;
   if(!px.isRuntimeSized())
     vkCmdBindPipeline(impl,VK_PIPELINE_BIND_POINT_COMPUTE,px.impl);
+  bindHeap(VK_PIPELINE_BIND_POINT_COMPUTE,heapCompLayout);
   }
 
 void VCommandBuffer::dispatch(size_t x, size_t y, size_t z) {
@@ -491,9 +631,11 @@ void VCommandBuffer::setUniforms(AbstractGraphicsApi::CompPipeline& p, AbstractG
     vkCmdBindPipeline(impl,VK_PIPELINE_BIND_POINT_COMPUTE,pso);
     }
 
+  VkDescriptorSet desc = ux.resolve();
   vkCmdBindDescriptorSets(impl,VK_PIPELINE_BIND_POINT_COMPUTE,
-                          pipelineLayout,0,1,&ux.impl,
+                          pipelineLayout,0,1,&desc,
                           0,nullptr);
+  bindHeap(VK_PIPELINE_BIND_POINT_COMPUTE,heapCompLayout);
   }
 
 void VCommandBuffer::draw(const AbstractGraphicsApi::Buffer* ivbo, size_t stride, size_t voffset, size_t vsize,
@@ -502,6 +644,8 @@ void VCommandBuffer::draw(const AbstractGraphicsApi::Buffer* ivbo, size_t stride
   if(T_LIKELY(vbo!=nullptr)) {
     bindVbo(*vbo,stride);
     }
+  if(T_UNLIKELY(psoPending))
+    return;
   vkCmdDraw(impl, uint32_t(vsize), uint32_t(instanceCount), uint32_t(voffset), uint32_t(firstInstance));
   }
 
@@ -513,11 +657,15 @@ void VCommandBuffer::drawIndexed(const AbstractGraphicsApi::Buffer* ivbo, size_t
   if(T_LIKELY(vbo!=nullptr)) {
     bindVbo(*vbo,stride);
     }
+  if(T_UNLIKELY(psoPending))
+    return;
   vkCmdBindIndexBuffer(impl, ibo.impl, 0, nativeFormat(cls));
   vkCmdDrawIndexed    (impl, uint32_t(isize), uint32_t(instanceCount), uint32_t(ioffset), int32_t(voffset), uint32_t(firstInstance));
   }
 
 void VCommandBuffer::drawIndirect(const AbstractGraphicsApi::Buffer& indirect, size_t offset) {
+  if(T_UNLIKELY(psoPending))
+    return;
   const VBuffer& ind = reinterpret_cast<const VBuffer&>(indirect);
 
   // block future writers
@@ -527,10 +675,14 @@ void VCommandBuffer::drawIndirect(const AbstractGraphicsApi::Buffer& indirect, s
   }
 
 void VCommandBuffer::dispatchMesh(size_t x, size_t y, size_t z) {
+  if(T_UNLIKELY(psoPending))
+    return;
   device.vkCmdDrawMeshTasks(impl, uint32_t(x), uint32_t(y), uint32_t(z));
   }
 
 void VCommandBuffer::dispatchMeshIndirect(const AbstractGraphicsApi::Buffer& indirect, size_t offset) {
+  if(T_UNLIKELY(psoPending))
+    return;
   const VBuffer& ind = reinterpret_cast<const VBuffer&>(indirect);
 
   // block future writers
@@ -542,11 +694,8 @@ void VCommandBuffer::dispatchMeshIndirect(const AbstractGraphicsApi::Buffer& ind
 void VCommandBuffer::bindVbo(const VBuffer& vbo, size_t stride) {
   if(curVbo!=vbo.impl) {
     if(T_UNLIKELY(vboStride!=stride)) {
-      auto& px = *curDrawPipeline;
       vboStride = stride;
-      VkPipeline v  = device.props.hasDynRendering ? px.instance(passDyn,pipelineLayout,vboStride)
-                                                   : px.instance(pass,   pipelineLayout,vboStride);
-      vkCmdBindPipeline(impl,VK_PIPELINE_BIND_POINT_GRAPHICS,v);
+      bindGraphicsPipeline(*curDrawPipeline);
       }
     VkBuffer     buffers[1] = {vbo.impl};
     VkDeviceSize offsets[1] = {0};
@@ -591,6 +740,27 @@ void VCommandBuffer::setDebugMarker(std::string_view tag) {
     }
   }
 
+void VCommandBuffer::beginTimer(std::string_view name) {
+  if(timers==nullptr) {
+    timers.reset(new VTimerQuery(device));
+    // queries have to be reset outside of render pass; otherwise available from next recording
+    if(state!=RenderPass)
+      timers->begin(impl);
+    }
+  timers->beginScope(impl,name);
+  }
+
+void VCommandBuffer::endTimer() {
+  if(timers!=nullptr)
+    timers->endScope(impl);
+  }
+
+const std::vector<GpuTiming>& VCommandBuffer::timings() const {
+  if(timers==nullptr)
+    return AbstractGraphicsApi::CommandBuffer::timings();
+  return timers->timings();
+  }
+
 void VCommandBuffer::copy(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest, const AbstractGraphicsApi::Buffer &srcBuf, size_t offsetSrc, size_t size) {
   auto& src = reinterpret_cast<const VBuffer&>(srcBuf);
   auto& dst = reinterpret_cast<VBuffer&>(dstBuf);
@@ -605,6 +775,20 @@ void VCommandBuffer::copy(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest
   vkCmdCopyBuffer(impl, src.impl, dst.impl, 1, &copyRegion);
   }
 
+void VCommandBuffer::copy(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest, VkBuffer src, size_t offsetSrc, size_t size) {
+  auto& dst = reinterpret_cast<VBuffer&>(dstBuf);
+
+  // src is host-written staging memory, not tracked by resState
+  resState.onTranferUsage(NonUniqResId::I_None, dst.nonUniqId, dst.isHostVisible());
+  resState.flush(*this);
+
+  VkBufferCopy copyRegion = {};
+  copyRegion.dstOffset = offsetDest;
+  copyRegion.srcOffset = offsetSrc;
+  copyRegion.size      = size;
+  vkCmdCopyBuffer(impl, src, dst.impl, 1, &copyRegion);
+  }
+
 void VCommandBuffer::copy(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest, const void* src, size_t size) {
   auto& dst    = reinterpret_cast<VBuffer&>(dstBuf);
   auto  srcBuf = reinterpret_cast<const uint8_t*>(src);
@@ -640,7 +824,9 @@ void VCommandBuffer::fill(AbstractGraphicsApi::Texture& dstTex, uint32_t val) {
   rgn.baseMipLevel   = 0;
   rgn.levelCount     = VK_REMAINING_MIP_LEVELS;
   rgn.layerCount     = VK_REMAINING_ARRAY_LAYERS;
-  vkCmdClearColorImage(impl, dst.impl, VK_IMAGE_LAYOUT_GENERAL, &v, 1, &rgn);
+
+  VkImageLayout layout = dst.isStorageImage ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  vkCmdClearColorImage(impl, dst.impl, layout, &v, 1, &rgn);
   }
 
 void VCommandBuffer::fill(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest, uint32_t val, size_t size) {
@@ -654,6 +840,11 @@ void VCommandBuffer::fill(AbstractGraphicsApi::Buffer& dstBuf, size_t offsetDest
 
 void VCommandBuffer::copy(AbstractGraphicsApi::Texture& dstTex, size_t width, size_t height, size_t mip,
                           const AbstractGraphicsApi::Buffer& srcBuf, size_t offset) {
+  copy(dstTex,0,0,width,height,mip,srcBuf,offset);
+  }
+
+void VCommandBuffer::copy(AbstractGraphicsApi::Texture& dstTex, size_t x, size_t y, size_t width, size_t height, size_t mip,
+                          const AbstractGraphicsApi::Buffer& srcBuf, size_t offset) {
   auto& src = reinterpret_cast<const VBuffer&>(srcBuf);
   auto& dst = reinterpret_cast<VTexture&>(dstTex);
 
@@ -665,7 +856,7 @@ void VCommandBuffer::copy(AbstractGraphicsApi::Texture& dstTex, size_t width, si
   region.imageSubresource.mipLevel = uint32_t(mip);
   region.imageSubresource.baseArrayLayer = 0;
   region.imageSubresource.layerCount = 1;
-  region.imageOffset = {0, 0, 0};
+  region.imageOffset = {int32_t(x), int32_t(y), 0};
   region.imageExtent = {
       uint32_t(width),
       uint32_t(height),
@@ -677,6 +868,31 @@ void VCommandBuffer::copy(AbstractGraphicsApi::Texture& dstTex, size_t width, si
   vkCmdCopyBufferToImage(impl, src.impl, dst.impl, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
   }
 
+void VCommandBuffer::copy(AbstractGraphicsApi::Texture& dstTex, size_t x, size_t y,
+                          const AbstractGraphicsApi::Texture& srcTex, size_t srcX, size_t srcY,
+                          size_t width, size_t height, size_t mip) {
+  auto& src = reinterpret_cast<const VTexture&>(srcTex);
+  auto& dst = reinterpret_cast<VTexture&>(dstTex);
+
+  VkImageCopy region = {};
+  region.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.srcSubresource.mipLevel       = uint32_t(mip);
+  region.srcSubresource.baseArrayLayer = 0;
+  region.srcSubresource.layerCount     = 1;
+  region.srcOffset                     = {int32_t(srcX), int32_t(srcY), 0};
+  region.dstSubresource                = region.srcSubresource;
+  region.dstOffset                     = {int32_t(x), int32_t(y), 0};
+  region.extent = {
+      uint32_t(width),
+      uint32_t(height),
+      1
+  };
+
+  resState.onTranferUsage(src.nonUniqId, dst.nonUniqId, false);
+  resState.flush(*this);
+  vkCmdCopyImage(impl, src.impl, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst.impl, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+  }
+
 void VCommandBuffer::copyNative(AbstractGraphicsApi::Buffer&        dst, size_t offset,
                                 const AbstractGraphicsApi::Texture& src, size_t width, size_t height, size_t mip) {
   auto& nSrc = reinterpret_cast<const VTexture&>(src);
@@ -868,6 +1084,11 @@ void VCommandBuffer::barrier(const AbstractGraphicsApi::BarrierDesc* desc, size_
       toStage(device, srcStageMask, srcAccessMask, b.prev, true);
       toStage(device, dstStageMask, dstAccessMask, b.next, false);
 
+      if(computeQueue) {
+        toComputeQueue(srcStageMask, srcAccessMask);
+        toComputeQueue(dstStageMask, dstAccessMask);
+        }
+
       memBarrier.sType          = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR;
       memBarrier.srcStageMask  |= srcStageMask;
       memBarrier.srcAccessMask |= srcAccessMask;
@@ -879,25 +1100,31 @@ void VCommandBuffer::barrier(const AbstractGraphicsApi::BarrierDesc* desc, size_
       ++bufCount;
 
       bx.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
-      bx.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
-      bx.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
       bx.buffer                = reinterpret_cast<const VBuffer&>(*b.buffer).impl;
       bx.offset                = 0;
       bx.size                  = VK_WHOLE_SIZE;
+      toQueueFamily(device, bx.srcQueueFamilyIndex, bx.dstQueueFamilyIndex, b.ownership);
 
       toStage(device, bx.srcStageMask, bx.srcAccessMask, b.prev, true);
       toStage(device, bx.dstStageMask, bx.dstAccessMask, b.next, false);
+      if(computeQueue) {
+        toComputeQueue(bx.srcStageMask, bx.srcAccessMask);
+        toComputeQueue(bx.dstStageMask, bx.dstAccessMask);
+        }
       } else {
       auto& bx = imgBarrier[imgCount];
       ++imgCount;
 
       bx.sType                 = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
-      bx.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
-      bx.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
       bx.image                 = toVkResource(b);
+      toQueueFamily(device, bx.srcQueueFamilyIndex, bx.dstQueueFamilyIndex, b.ownership);
 
       toStage(device, bx.srcStageMask, bx.srcAccessMask, b.prev, true);
       toStage(device, bx.dstStageMask, bx.dstAccessMask, b.next, false);
+      if(computeQueue) {
+        toComputeQueue(bx.srcStageMask, bx.srcAccessMask);
+        toComputeQueue(bx.dstStageMask, bx.dstAccessMask);
+        }
 
       bx.oldLayout             = toLayout(b.prev);
       bx.newLayout             = toLayout(b.next);
@@ -1051,8 +1278,10 @@ void VCommandBuffer::newChunk() {
   beginInfo.pInheritanceInfo = nullptr;
   vkAssert(vkBeginCommandBuffer(impl,&beginInfo));
 
-  curVbo      = VK_NULL_HANDLE;
-  curUniforms = nullptr;
+  curVbo         = VK_NULL_HANDLE;
+  curUniforms    = nullptr;
+  heapLayout     = VK_NULL_HANDLE;
+  heapCompLayout = VK_NULL_HANDLE;
   }
 
 template<class T>
@@ -1102,6 +1331,173 @@ void VCommandBuffer::addDependency(VSwapchain& s, size_t imgId) {
   }
 
 
+VSecondaryCommandBuffer::VSecondaryCommandBuffer(VDevice& device)
+  :VCommandBuffer(device) {
+  resState.setDeferred(true);
+  }
+
+void VSecondaryCommandBuffer::beginSecondary(const VCommandBuffer& primary, const VkCommandBufferInheritanceInfo& inh,
+                                             uint32_t w, uint32_t h) {
+  state           = RenderPass;
+  pass            = primary.pass;
+  passDyn         = primary.passDyn;
+  passDyn.pColorAttachmentFormats = passDyn.colorFrm;
+  curDrawPipeline = nullptr;
+  curUniforms     = nullptr;
+  curVbo          = VK_NULL_HANDLE;
+  vboStride       = 0;
+  pipelineLayout  = VK_NULL_HANDLE;
+  psoPending      = false;
+  heapLayout      = VK_NULL_HANDLE;
+  heapCompLayout  = VK_NULL_HANDLE;
+
+  if(impl==nullptr) {
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool        = pool.impl;
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = 1;
+    vkAssert(vkAllocateCommandBuffers(device.device.impl,&allocInfo,&impl));
+    } else {
+    vkAssert(vkResetCommandPool(device.device.impl,pool.impl,0));
+    }
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = &inh;
+  vkAssert(vkBeginCommandBuffer(impl,&beginInfo));
+
+  // dynamic state is not inherited
+  setViewport(Rect(0,0,int32_t(w),int32_t(h)));
+  setScissor (Rect(0,0,int32_t(w),int32_t(h)));
+  }
+
+void VSecondaryCommandBuffer::end() {
+  if(isDbgRegion) {
+    device.vkCmdDebugMarkerEnd(impl);
+    isDbgRegion = false;
+    }
+  vkAssert(vkEndCommandBuffer(impl));
+  state = NoRecording;
+  }
+
+void VSecondaryCommandBuffer::beginTimer(std::string_view) {
+  // queries are owned by primary command buffer
+  }
+
+void VSecondaryCommandBuffer::endTimer() {
+  }
+
+VComputeCommandBuffer::VComputeCommandBuffer(VDevice& device)
+  :VCommandBuffer(device,VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,device.computeQueue->family),
+   graphicsPool(device,VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT) {
+  computeQueue = true;
+  }
+
+VComputeCommandBuffer::~VComputeCommandBuffer() {
+  if(handoff)
+    device.dropHandoff(ret);
+  if(acquire!=VK_NULL_HANDLE)
+    vkFreeCommandBuffers(device.device.impl,pool.impl,1,&acquire);
+  for(auto cmd:{release, ret})
+    if(cmd!=VK_NULL_HANDLE)
+      vkFreeCommandBuffers(device.device.impl,graphicsPool.impl,1,&cmd);
+  }
+
+void VComputeCommandBuffer::begin(bool tranfer) {
+  if(handoff)
+    device.dropHandoff(ret);
+  handoff = false;
+  resState.clearQueueUsage();
+  VCommandBuffer::begin(tranfer);
+  }
+
+void VComputeCommandBuffer::end() {
+  if(isDbgRegion) {
+    device.vkCmdDebugMarkerEnd(impl);
+    isDbgRegion = false;
+    }
+  if(timers!=nullptr)
+    timers->end(impl);
+  resState.finalize(*this);
+
+  // borrowed resources are returned in same layout, as they were taken
+  handoff = resState.hasQueueUsage();
+  if(handoff)
+    resState.queueOwnership(*this,QueueOwnership::ToGraphics);
+  state = NoRecording;
+  pushChunk();
+
+  if(handoff) {
+    recordHandoff(release,graphicsPool.impl,false,QueueOwnership::ToCompute);
+    recordHandoff(acquire,pool.impl,        true, QueueOwnership::ToCompute);
+    recordHandoff(ret,    graphicsPool.impl,false,QueueOwnership::ToGraphics);
+    }
+  resState.clearQueueUsage();
+  }
+
+void VComputeCommandBuffer::beginRendering(const AttachmentDesc*, size_t, uint32_t, uint32_t,
+                                           const TextureFormat*, AbstractGraphicsApi::Texture**,
+                                           AbstractGraphicsApi::Swapchain**, const uint32_t*) {
+  throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  }
+
+bool VComputeCommandBuffer::beginParallelRendering(const AttachmentDesc*, size_t, uint32_t, uint32_t,
+                                                   const TextureFormat*, AbstractGraphicsApi::Texture**,
+                                                   AbstractGraphicsApi::Swapchain**, const uint32_t*,
+                                                   AbstractGraphicsApi::CommandBuffer**, size_t) {
+  return false;
+  }
+
+void VComputeCommandBuffer::setUniforms(AbstractGraphicsApi::CompPipeline& p, AbstractGraphicsApi::Desc& u) {
+  VCommandBuffer::setUniforms(p,u);
+  reinterpret_cast<VDescriptorArray&>(u).queueUsage(resState);
+  }
+
+void VComputeCommandBuffer::dispatchIndirect(const AbstractGraphicsApi::Buffer& indirect, size_t offset) {
+  resState.onQueueUsage(indirect);
+  VCommandBuffer::dispatchIndirect(indirect,offset);
+  }
+
+void VComputeCommandBuffer::generateMipmap(AbstractGraphicsApi::Texture&, uint32_t, uint32_t, uint32_t) {
+  // blit is not supported by compute queue
+  throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+  }
+
+void VComputeCommandBuffer::recordHandoff(VkCommandBuffer& cmd, VkCommandPool cmdPool, bool compute, QueueOwnership dir) {
+  if(cmd==VK_NULL_HANDLE) {
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool        = cmdPool;
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    vkAssert(vkAllocateCommandBuffers(device.device.impl,&allocInfo,&cmd));
+    }
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  vkAssert(vkBeginCommandBuffer(cmd,&beginInfo));
+
+  // barriers are recorded into `impl`, with stages of target queue
+  const bool q = computeQueue;
+  std::swap(impl,cmd);
+  computeQueue = compute;
+  resState.queueOwnership(*this,dir);
+  std::swap(impl,cmd);
+  computeQueue = q;
+
+  vkAssert(vkEndCommandBuffer(cmd));
+  }
+
+bool VMeshCommandBuffer::beginParallelRendering(const AttachmentDesc*, size_t, uint32_t, uint32_t,
+                                                const TextureFormat*, AbstractGraphicsApi::Texture**,
+                                                AbstractGraphicsApi::Swapchain**, const uint32_t*,
+                                                AbstractGraphicsApi::CommandBuffer**, size_t) {
+  // emulated mesh shaders stitch task/mesh chunks around the pass; not possible from secondary command buffers
+  return false;
+  }
+
 void VMeshCommandBuffer::pushChunk() {
   if(cbTask!=nullptr) {
     auto& ms = *device.meshHelper;
@@ -1221,21 +1617,22 @@ void VMeshCommandBuffer::setUniforms(AbstractGraphicsApi::Pipeline& p, AbstractG
     return;
 
   VDescriptorArray& ux=reinterpret_cast<VDescriptorArray&>(u);
+  VkDescriptorSet   desc = ux.resolve();
   if(px.taskPipeline()!=VK_NULL_HANDLE) {
     vkCmdBindDescriptorSets(cbTask,VK_PIPELINE_BIND_POINT_COMPUTE,
                             px.taskPipelineLayout(),0,
-                            1,&ux.impl,
+                            1,&desc,
                             0,nullptr);
     }
   vkCmdBindDescriptorSets(cbMesh,VK_PIPELINE_BIND_POINT_COMPUTE,
                           px.meshPipelineLayout(),0,
-                          1,&ux.impl,
+                          1,&desc,
                           0,nullptr);
   }
 
 void VMeshCommandBuffer::dispatchMesh(size_t x, size_t y, size_t z) {
   VPipeline& px = reinterpret_cast<VPipeline&>(*curDrawPipeline);
-  if(px.meshPipeline()==VK_NULL_HANDLE)
+  if(px.meshPipeline()==VK_NULL_HANDLE || psoPending)
     return;
 
   auto& ms = *device.meshHelper;
@@ -7,6 +7,7 @@
 #include "vcommandpool.h"
 #include "vframebuffermap.h"
 #include "vswapchain.h"
+#include "vtimerquery.h"
 
 #include "../utility/smallarray.h"
 
@@ -17,6 +18,7 @@ class VDevice;
 class VCommandPool;
 
 class VDescriptorArray;
+class VSecondaryCommandBuffer;
 class VPipeline;
 class VBuffer;
 class VTexture;
@@ -33,6 +35,7 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
 
     VCommandBuffer()=delete;
     VCommandBuffer(VDevice &device, VkCommandPoolCreateFlags flags=VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VCommandBuffer(VDevice &device, VkCommandPoolCreateFlags flags, uint32_t queueFamily);
     ~VCommandBuffer();
 
     using AbstractGraphicsApi::CommandBuffer::barrier;
@@ -49,12 +52,22 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
                         const TextureFormat* frm,
                         AbstractGraphicsApi::Texture** att,
                         AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId) override;
+    bool beginParallelRendering(const AttachmentDesc* desc, size_t descSize,
+                                uint32_t w, uint32_t h,
+                                const TextureFormat* frm,
+                                AbstractGraphicsApi::Texture** att,
+                                AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId,
+                                AbstractGraphicsApi::CommandBuffer** secondary, size_t count) override;
     void endRendering() override;
 
     void setViewport(const Rect& r) override;
     void setScissor (const Rect& r) override;
     void setDebugMarker(std::string_view tag) override;
 
+    void beginTimer(std::string_view name) override;
+    void endTimer() override;
+    const std::vector<GpuTiming>& timings() const override;
+
     void setPipeline(AbstractGraphicsApi::Pipeline& p) override;
     void setBytes   (AbstractGraphicsApi::Pipeline& p, const void* data, size_t size) override;
     void setUniforms(AbstractGraphicsApi::Pipeline& p, AbstractGraphicsApi::Desc &u) override;
@@ -82,8 +95,12 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     void generateMipmap(AbstractGraphicsApi::Texture& image, uint32_t texWidth, uint32_t texHeight, uint32_t mipLevels) override;
 
     void copy(AbstractGraphicsApi::Texture& dest, size_t width, size_t height, size_t mip, const AbstractGraphicsApi::Buffer&  src, size_t offset);
+    void copy(AbstractGraphicsApi::Texture& dest, size_t x, size_t y, size_t width, size_t height, size_t mip, const AbstractGraphicsApi::Buffer& src, size_t offset);
+    void copy(AbstractGraphicsApi::Texture& dest, size_t x, size_t y, const AbstractGraphicsApi::Texture& src, size_t srcX, size_t srcY,
+              size_t width, size_t height, size_t mip);
     void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, const AbstractGraphicsApi::Buffer& src, size_t offsetSrc, size_t size);
     void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, const void* src, size_t size);
+    void copy(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, VkBuffer src, size_t offsetSrc, size_t size);
     void fill(AbstractGraphicsApi::Texture& dest, uint32_t val);
     void fill(AbstractGraphicsApi::Buffer&  dest, size_t offsetDest, uint32_t val, size_t size);
 
@@ -105,6 +122,10 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
       };
     Detail::SmallList<Chunk,32>    chunks;
     std::vector<VSwapchain::Sync*> swapchainSync;
+    // framebuffers, used by recorded commands; kept alive in VFramebufferMap, until command buffer is reset
+    std::vector<std::shared_ptr<VFramebufferMap::Fbo>> fboRefs;
+
+    bool isAsyncCompute() const { return computeQueue; }
 
   protected:
     void addDependency(VSwapchain& s, size_t imgId);
@@ -116,7 +137,17 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     virtual void pushChunk();
     virtual void newChunk();
 
+    void implBeginRendering(const AttachmentDesc* desc, size_t descSize,
+                            uint32_t w, uint32_t h,
+                            const TextureFormat* frm,
+                            AbstractGraphicsApi::Texture** att,
+                            AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId,
+                            bool inlineContent);
+    void executeSecondary();
+
     void bindVbo(const VBuffer& vbo, size_t stride);
+    void bindGraphicsPipeline(VPipeline& px);
+    void bindHeap(VkPipelineBindPoint bp, VkPipelineLayout& boundLay);
 
     struct PipelineInfo:VkPipelineRenderingCreateInfoKHR {
       VkFormat colorFrm[MaxFramebufferAttachments];
@@ -136,14 +167,89 @@ class VCommandBuffer:public AbstractGraphicsApi::CommandBuffer {
     VkBuffer                                curVbo          = VK_NULL_HANDLE;
     size_t                                  vboStride       = 0;
     VkPipelineLayout                        pipelineLayout  = VK_NULL_HANDLE;
+    bool                                    psoPending      = false;
+    // layouts, bindless heap was bound with; rebinding set 0 with other layout disturbs it
+    VkPipelineLayout                        heapLayout      = VK_NULL_HANDLE;
+    VkPipelineLayout                        heapCompLayout  = VK_NULL_HANDLE;
 
     bool                                    isDbgRegion = false;
+    std::unique_ptr<VTimerQuery>            timers;
+    // recorded for compute-only queue: graphics stages are stripped from barriers
+    bool                                    computeQueue = false;
+
+    // secondary command buffers of current parallel render pass; kept between recordings
+    std::vector<std::unique_ptr<VSecondaryCommandBuffer>> secondary;
+    size_t                                  secondaryCount  = 0;
+
+  friend class VSecondaryCommandBuffer;
+  };
+
+// Records part of parallel render pass, on it's own command pool;
+// executed by primary command buffer in order, when render pass ends.
+class VSecondaryCommandBuffer:public VCommandBuffer {
+  public:
+    explicit VSecondaryCommandBuffer(VDevice& device);
+
+    void beginSecondary(const VCommandBuffer& primary, const VkCommandBufferInheritanceInfo& inh, uint32_t w, uint32_t h);
+    void end() override;
+
+    void beginTimer(std::string_view name) override;
+    void endTimer() override;
+  };
+
+// Records for async compute queue. Resources of dispatches are borrowed from graphics queue:
+// ownership is released by graphics queue before submit, and returned at the end of command buffer,
+// to be acquired by graphics submit, that waits for it's sync point.
+class VComputeCommandBuffer:public VCommandBuffer {
+  public:
+    explicit VComputeCommandBuffer(VDevice& device);
+    ~VComputeCommandBuffer();
+
+    void begin(bool tranfer) override;
+    void end() override;
+
+    void beginRendering(const AttachmentDesc* desc, size_t descSize,
+                        uint32_t w, uint32_t h,
+                        const TextureFormat* frm,
+                        AbstractGraphicsApi::Texture** att,
+                        AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId) override;
+    bool beginParallelRendering(const AttachmentDesc* desc, size_t descSize,
+                                uint32_t w, uint32_t h,
+                                const TextureFormat* frm,
+                                AbstractGraphicsApi::Texture** att,
+                                AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId,
+                                AbstractGraphicsApi::CommandBuffer** secondary, size_t count) override;
+
+    void setUniforms(AbstractGraphicsApi::CompPipeline& p, AbstractGraphicsApi::Desc &u) override;
+    void dispatchIndirect(const AbstractGraphicsApi::Buffer& indirect, size_t offset) override;
+    void generateMipmap(AbstractGraphicsApi::Texture& image, uint32_t texWidth, uint32_t texHeight, uint32_t mipLevels) override;
+
+    bool            hasHandoff() const { return handoff; }
+    VkCommandBuffer releaseCmd() const { return release; }
+    VkCommandBuffer acquireCmd() const { return acquire; }
+    VkCommandBuffer returnCmd()  const { return ret;     }
+
+  private:
+    void recordHandoff(VkCommandBuffer& cmd, VkCommandPool pool, bool compute, QueueOwnership dir);
+
+    VCommandPool    graphicsPool;
+    VkCommandBuffer release = VK_NULL_HANDLE; // graphics queue -> compute, on graphics queue
+    VkCommandBuffer acquire = VK_NULL_HANDLE; // graphics queue -> compute, on compute queue
+    VkCommandBuffer ret     = VK_NULL_HANDLE; // compute queue -> graphics, on graphics queue
+    bool            handoff = false;
   };
 
 class VMeshCommandBuffer:public VCommandBuffer {
   public:
     using VCommandBuffer::VCommandBuffer;
 
+    bool beginParallelRendering(const AttachmentDesc* desc, size_t descSize,
+                                uint32_t w, uint32_t h,
+                                const TextureFormat* frm,
+                                AbstractGraphicsApi::Texture** att,
+                                AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId,
+                                AbstractGraphicsApi::CommandBuffer** secondary, size_t count) override;
+
     void pushChunk() override;
 
     void setPipeline(AbstractGraphicsApi::Pipeline& p) override;
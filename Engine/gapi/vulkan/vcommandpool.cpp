@@ -9,10 +9,14 @@
 using namespace Tempest::Detail;
 
 VCommandPool::VCommandPool(VDevice& device,VkCommandPoolCreateFlags flags)
+  :VCommandPool(device,flags,device.props.graphicsFamily) {
+  }
+
+VCommandPool::VCommandPool(VDevice& device, VkCommandPoolCreateFlags flags, uint32_t queueFamily)
   :device(device.device.impl) {
   VkCommandPoolCreateInfo poolInfo = {};
   poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-  poolInfo.queueFamilyIndex = device.props.graphicsFamily;
+  poolInfo.queueFamilyIndex = queueFamily;
   poolInfo.flags            = flags;
 
   vkAssert(vkCreateCommandPool(device.device.impl,&poolInfo,nullptr,&impl));
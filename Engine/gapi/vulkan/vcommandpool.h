@@ -11,6 +11,7 @@ class VDevice;
 class VCommandPool {
   public:
     VCommandPool(VDevice &device, VkCommandPoolCreateFlags flags=VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VCommandPool(VDevice &device, VkCommandPoolCreateFlags flags, uint32_t queueFamily);
     VCommandPool(VCommandPool&& other);
     ~VCommandPool();
 
@@ -11,6 +11,9 @@
 
 #include "utility/smallarray.h"
 
+#include <algorithm>
+#include <cstring>
+
 using namespace Tempest;
 using namespace Tempest::Detail;
 
@@ -31,44 +34,25 @@ VDescriptorArray::VDescriptorArray(VDevice& device, VPipelineLay& vlay)
       runtimeArrays[i] = lx.arraySize;
       }
     } else {
-    std::lock_guard<Detail::SpinLock> guard(vlay.sync);
-    for(auto& i:vlay.pool) {
-      if(i.freeCount==0)
-        continue;
-      impl = allocDescSet(i.impl,lay.handler->impl);
-      if(impl!=VK_NULL_HANDLE) {
-        pool=&i;
-        pool->freeCount--;
-        return;
-        }
-      }
-
-    vlay.pool.emplace_back();
-    auto& b = vlay.pool.back();
-    b.impl  = allocPool(vlay);
-    impl    = allocDescSet(b.impl,lay.handler->impl);
-    if(impl==VK_NULL_HANDLE)
-      throw std::bad_alloc();
-    pool = &b;
-    pool->freeCount--;
+    // descriptor set is assigned on bind, see resolve()
+    data   .resize(vlay.descCount);
+    written.resize(vlay.descCount);
     }
   }
 
 VDescriptorArray::~VDescriptorArray() {
-  if(impl==VK_NULL_HANDLE)
+  if(cached) {
+    auto& l = *lay.handler;
+    std::lock_guard<Detail::SpinLock> guard(l.sync);
+    release(l,cachedSet);
+    }
+
+  if(impl==VK_NULL_HANDLE || dedicatedPool==VK_NULL_HANDLE)
     return;
 
   VkDevice dev = device.device.impl;
-  if(dedicatedPool!=VK_NULL_HANDLE) {
-    vkFreeDescriptorSets(dev,dedicatedPool,1,&impl);
-    vkDestroyDescriptorPool(dev,dedicatedPool,nullptr);
-    } else {
-    Detail::VPipelineLay* layImpl = lay.handler;
-    std::lock_guard<Detail::SpinLock> guard(layImpl->sync);
-
-    vkFreeDescriptorSets(dev,pool->impl,1,&impl);
-    pool->freeCount++;
-    }
+  vkFreeDescriptorSets(dev,dedicatedPool,1,&impl);
+  vkDestroyDescriptorPool(dev,dedicatedPool,nullptr);
   }
 
 VkDescriptorPool VDescriptorArray::allocPool(const VPipelineLay& lay) {
@@ -137,9 +121,8 @@ VkDescriptorSet VDescriptorArray::allocDescSet(VkDescriptorPool pool, VkDescript
   }
 
 void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Texture* t, const Sampler& smp, uint32_t mipLevel) {
-  VkDevice  dev = device.device.impl;
   VTexture& tex = *reinterpret_cast<VTexture*>(t);
-  if(impl==VK_NULL_HANDLE) {
+  if(impl==VK_NULL_HANDLE && isRuntimeSized()) {
     reallocSet(id, 0);
     }
 
@@ -167,17 +150,16 @@ void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Texture* t, const Sam
   descriptorWrite.descriptorCount = 1;
   descriptorWrite.pImageInfo      = &imageInfo;
 
-  vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+  write(descriptorWrite);
 
   uav[id].tex     = t;
   uavUsage.durty |= (tex.nonUniqId!=0);
   }
 
 void VDescriptorArray::set(size_t id, Tempest::AbstractGraphicsApi::Buffer* b, size_t offset) {
-  VkDevice dev  = device.device.impl;
   VBuffer* buf  = reinterpret_cast<VBuffer*>(b);
   auto&    slot = lay.handler->lay[id];
-  if(impl==VK_NULL_HANDLE) {
+  if(impl==VK_NULL_HANDLE && isRuntimeSized()) {
     reallocSet(id, 0);
     }
 
@@ -203,14 +185,13 @@ void VDescriptorArray::set(size_t id, Tempest::AbstractGraphicsApi::Buffer* b, s
   descriptorWrite.descriptorCount = 1;
   descriptorWrite.pBufferInfo     = &bufferInfo;
 
-  vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+  write(descriptorWrite);
 
   uav[id].buf     = b;
   uavUsage.durty |= (buf!=nullptr && buf->nonUniqId!=0);
   }
 
 void VDescriptorArray::set(size_t id, const Sampler& smp) {
-  VkDevice dev = device.device.impl;
   VkDescriptorImageInfo imageInfo = {};
   imageInfo.sampler = device.allocator.updateSampler(smp);
 
@@ -223,11 +204,10 @@ void VDescriptorArray::set(size_t id, const Sampler& smp) {
   descriptorWrite.descriptorCount = 1;
   descriptorWrite.pImageInfo      = &imageInfo;
 
-  vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+  write(descriptorWrite);
   }
 
 void VDescriptorArray::set(size_t id, AbstractGraphicsApi::AccelerationStructure* tlas) {
-  VkDevice                dev    = device.device.impl;
   VAccelerationStructure* memory = reinterpret_cast<VAccelerationStructure*>(tlas);
 
   VkWriteDescriptorSetAccelerationStructureKHR descriptorAccelerationStructureInfo{};
@@ -244,12 +224,11 @@ void VDescriptorArray::set(size_t id, AbstractGraphicsApi::AccelerationStructure
   descriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
   descriptorWrite.descriptorCount = 1;
 
-  vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+  write(descriptorWrite);
   // uavUsage.durty = true;
   }
 
 void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Texture** t, size_t cnt, const Sampler& smp, uint32_t mipLevel) {
-  VkDevice dev = device.device.impl;
   auto&    l   = lay.handler->lay[id];
   if(l.runtimeSized) {
     const uint32_t rSz = ((cnt+ALLOC_GRANULARITY-1u) & (~(ALLOC_GRANULARITY-1u)));
@@ -297,11 +276,10 @@ void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Texture** t, size_t c
   descriptorWrite.descriptorCount = uint32_t(cnt);
   descriptorWrite.pImageInfo      = imageInfo.get();
 
-  vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+  write(descriptorWrite);
   }
 
 void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Buffer** b, size_t cnt) {
-  VkDevice dev = device.device.impl;
   auto&    l   = lay.handler->lay[id];
   if(l.runtimeSized) {
     const uint32_t rSz = ((cnt+ALLOC_GRANULARITY-1u) & (~(ALLOC_GRANULARITY-1u)));
@@ -349,11 +327,13 @@ void VDescriptorArray::set(size_t id, AbstractGraphicsApi::Buffer** b, size_t cn
   descriptorWrite.descriptorCount = uint32_t(cnt);
   descriptorWrite.pBufferInfo     = bufInfo.get();
 
-  vkUpdateDescriptorSets(dev, 1, &descriptorWrite, 0, nullptr);
+  write(descriptorWrite);
   }
 
 void VDescriptorArray::ssboBarriers(ResourceState& res, PipelineStage st) {
   auto& lay = this->lay.handler->lay;
+  // same set can be used by secondary command buffers, recorded in parallel
+  std::lock_guard<Detail::SpinLock> guard(syncData);
   if(T_UNLIKELY(uavUsage.durty)) {
     uavUsage.read  = NonUniqResId::I_None;
     uavUsage.write = NonUniqResId::I_None;
@@ -373,10 +353,284 @@ void VDescriptorArray::ssboBarriers(ResourceState& res, PipelineStage st) {
   res.onUavUsage(uavUsage,st);
   }
 
+void VDescriptorArray::queueUsage(ResourceState& res) {
+  std::lock_guard<Detail::SpinLock> guard(syncData);
+  for(size_t i=0; i<lay.handler->lay.size(); ++i) {
+    if(uav[i].buf!=nullptr)
+      res.onQueueUsage(*uav[i].buf);
+    if(uav[i].tex!=nullptr) {
+      // same layout, as in toWriteLayout
+      auto& t = *reinterpret_cast<VTexture*>(uav[i].tex);
+      if(nativeIsDepthFormat(t.format))
+        res.onQueueUsage(t,ResourceAccess::DepthReadOnly); else
+      if(t.isStorageImage)
+        res.onQueueUsage(t,ResourceAccess::UavReadWriteAll); else
+        res.onQueueUsage(t,ResourceAccess::Sampler);
+      }
+    }
+  }
+
+VkDescriptorSet VDescriptorArray::resolve() {
+  if(isRuntimeSized())
+    return impl;
+
+  std::lock_guard<Detail::SpinLock> guard(syncData);
+  if(!durty)
+    return impl;
+
+  auto& l = *lay.handler;
+  std::lock_guard<Detail::SpinLock> g(l.sync);
+  auto it = acquire(l);
+  if(cached)
+    release(l,cachedSet);
+  cachedSet = it;
+  cached    = true;
+  impl      = it->impl;
+  durty     = false;
+  return impl;
+  }
+
 bool VDescriptorArray::isRuntimeSized() const {
   return runtimeArrays.size()>0;
   }
 
+void VDescriptorArray::write(const VkWriteDescriptorSet& wr) {
+  if(isRuntimeSized()) {
+    vkUpdateDescriptorSets(device.device.impl, 1, &wr, 0, nullptr);
+    return;
+    }
+
+  auto&    l     = *lay.handler;
+  uint32_t begin = l.descOffset[wr.dstBinding] + wr.dstArrayElement;
+  uint32_t end   = wr.dstBinding+1<l.descOffset.size() ? l.descOffset[wr.dstBinding+1] : l.descCount;
+  uint32_t cnt   = std::min(wr.descriptorCount, end>begin ? end-begin : 0u);
+
+  auto tlas = reinterpret_cast<const VkWriteDescriptorSetAccelerationStructureKHR*>(wr.pNext);
+
+  std::lock_guard<Detail::SpinLock> guard(syncData);
+  for(uint32_t i=0; i<cnt; ++i) {
+    auto& d = data[begin+i];
+    std::memset(&d,0,sizeof(d));
+    if(wr.pImageInfo!=nullptr)
+      d.image  = wr.pImageInfo[i];
+    else if(wr.pBufferInfo!=nullptr)
+      d.buffer = wr.pBufferInfo[i];
+    else if(tlas!=nullptr)
+      d.tlas   = tlas->pAccelerationStructures[i];
+    written[begin+i] = 1;
+    }
+  durty = true;
+  }
+
+uint64_t VDescriptorArray::contentHash() const {
+  // FNV-1a
+  uint64_t h = 0xcbf29ce484222325ull;
+  auto     d = reinterpret_cast<const uint8_t*>(data.data());
+  for(size_t i=0; i<data.size()*sizeof(Descriptor); ++i) {
+    h ^= d[i];
+    h *= 0x100000001b3ull;
+    }
+  for(auto w:written) {
+    h ^= w;
+    h *= 0x100000001b3ull;
+    }
+  return h;
+  }
+
+void VDescriptorArray::contentRefs(VPipelineLay& l, std::vector<uint64_t>& refs) const {
+  for(size_t i=0; i<l.lay.size(); ++i) {
+    uint32_t begin = l.descOffset[i];
+    uint32_t end   = i+1<l.lay.size() ? l.descOffset[i+1] : l.descCount;
+    for(uint32_t at=begin; at<end; ++at) {
+      if(written[at]==0)
+        continue;
+      auto& d = data[at];
+      switch(l.lay[i].cls) {
+        case ShaderReflection::Ubo:
+        case ShaderReflection::SsboR:
+        case ShaderReflection::SsboRW:
+          refs.push_back(uint64_t(d.buffer.buffer));
+          break;
+        case ShaderReflection::Texture:
+        case ShaderReflection::Image:
+        case ShaderReflection::ImgR:
+        case ShaderReflection::ImgRW:
+          refs.push_back(uint64_t(d.image.imageView));
+          break;
+        case ShaderReflection::Tlas:
+          refs.push_back(uint64_t(d.tlas));
+          break;
+        case ShaderReflection::Sampler:
+        case ShaderReflection::Push:
+        case ShaderReflection::Count:
+          // samplers are owned by allocator and never destroyed
+          break;
+        }
+      }
+    }
+  std::sort(refs.begin(),refs.end());
+  refs.erase(std::unique(refs.begin(),refs.end()),refs.end());
+  }
+
+VDescriptorArray::CacheIt VDescriptorArray::acquire(VPipelineLay& l) {
+  const uint64_t hash = contentHash();
+
+  auto rg = l.setIndex.equal_range(hash);
+  for(auto i=rg.first; i!=rg.second;) {
+    auto it = i->second;
+    ++i;
+    // stale set refers to handle of destroyed resource, that may be reused by now
+    if(it->stale.load()) {
+      if(it->ref==0)
+        evict(l,it);
+      continue;
+      }
+    if(it->written!=written)
+      continue;
+    if(!data.empty() && std::memcmp(it->data.data(),data.data(),data.size()*sizeof(Descriptor))!=0)
+      continue;
+    if(it->ref==0)
+      l.liveSets.splice(l.liveSets.end(),l.idleSets,it);
+    it->ref++;
+    return it;
+    }
+
+  // CachedSet is not movable: construct in place and drop it, if anything fails
+  l.liveSets.emplace_back();
+  auto it = std::prev(l.liveSets.end());
+  auto& s = *it;
+  try {
+    s.data    = data;
+    s.written = written;
+    contentRefs(l,s.refs);
+    l.setIndex.reserve(l.setIndex.size()+1);
+    device.descRefs.link(s,s.refs.data(),s.refs.size());
+    }
+  catch(...) {
+    l.liveSets.erase(it);
+    throw;
+    }
+
+  for(auto& i:l.pool) {
+    if(i.freeCount==0)
+      continue;
+    s.impl = allocDescSet(i.impl,l.impl);
+    if(s.impl!=VK_NULL_HANDLE) {
+      s.pool = &i;
+      break;
+      }
+    }
+  if(s.impl==VK_NULL_HANDLE) {
+    try {
+      l.pool.emplace_back();
+      auto& b = l.pool.back();
+      b.impl  = allocPool(l);
+      s.impl  = allocDescSet(b.impl,l.impl);
+      if(s.impl==VK_NULL_HANDLE)
+        throw std::bad_alloc();
+      s.pool = &b;
+      }
+    catch(...) {
+      device.descRefs.unlink(s,s.refs.data(),s.refs.size());
+      l.liveSets.erase(it);
+      throw;
+      }
+    }
+  s.pool->freeCount--;
+
+  writeSet(l,s.impl);
+  s.hash = hash;
+  s.ref  = 1;
+  l.setIndex.emplace(hash,it);
+  return it;
+  }
+
+void VDescriptorArray::release(VPipelineLay& l, CacheIt it) {
+  if(--it->ref>0)
+    return;
+  // not referenced anymore, but content still can be reused by next bind
+  l.idleSets.splice(l.idleSets.begin(),l.liveSets,it);
+  if(it->stale.load()) {
+    evict(l,it);
+    return;
+    }
+  while(l.idleSets.size()>VPipelineLay::IDLE_SETS)
+    evict(l,std::prev(l.idleSets.end()));
+  }
+
+void VDescriptorArray::evict(VPipelineLay& l, CacheIt it) {
+  auto rg = l.setIndex.equal_range(it->hash);
+  for(auto i=rg.first; i!=rg.second; ++i)
+    if(&*i->second==&*it) {
+      l.setIndex.erase(i);
+      break;
+      }
+  device.descRefs.unlink(*it,it->refs.data(),it->refs.size());
+  vkFreeDescriptorSets(device.device.impl,it->pool->impl,1,&it->impl);
+  it->pool->freeCount++;
+  l.idleSets.erase(it);
+  }
+
+void VDescriptorArray::writeSet(VPipelineLay& l, VkDescriptorSet set) {
+  VkDevice dev = device.device.impl;
+  if(data.empty())
+    return;
+
+  if(l.updTemplate!=VK_NULL_HANDLE && std::all_of(written.begin(),written.end(),[](uint8_t w){ return w!=0; })) {
+    device.vkUpdateDescriptorSetWithTemplate(dev,set,l.updTemplate,data.data());
+    return;
+    }
+
+  // partially written set: one write per continuous range
+  SmallArray<VkWriteDescriptorSet,32>                         wr(data.size());
+  SmallArray<VkWriteDescriptorSetAccelerationStructureKHR,32> as(data.size());
+  uint32_t cnt = 0;
+  for(size_t i=0; i<l.lay.size(); ++i) {
+    auto&    lx    = l.lay[i];
+    uint32_t begin = l.descOffset[i];
+    uint32_t end   = i+1<l.lay.size() ? l.descOffset[i+1] : l.descCount;
+    for(uint32_t at=begin; at<end;) {
+      if(written[at]==0) {
+        ++at;
+        continue;
+        }
+      uint32_t len = 1;
+      // acceleration structures are not strided
+      while(lx.cls!=ShaderReflection::Tlas && at+len<end && written[at+len]!=0)
+        ++len;
+
+      auto& w = wr[cnt];
+      w = {};
+      w.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      w.dstSet          = set;
+      w.dstBinding      = uint32_t(i);
+      w.dstArrayElement = at-begin;
+      w.descriptorType  = nativeFormat(lx.cls);
+      w.descriptorCount = len;
+      switch(lx.cls) {
+        case ShaderReflection::Ubo:
+        case ShaderReflection::SsboR:
+        case ShaderReflection::SsboRW:
+          w.pBufferInfo = &data[at].buffer;
+          break;
+        case ShaderReflection::Tlas:
+          as[cnt] = {};
+          as[cnt].sType                      = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+          as[cnt].accelerationStructureCount = len;
+          as[cnt].pAccelerationStructures    = &data[at].tlas;
+          w.pNext = &as[cnt];
+          break;
+        default:
+          w.pImageInfo = &data[at].image;
+          break;
+        }
+      at += len;
+      ++cnt;
+      }
+    }
+  vkUpdateDescriptorSets(dev, cnt, wr.get(), 0, nullptr);
+  }
+
 void VDescriptorArray::addPoolSize(VkDescriptorPoolSize *p, size_t &sz, uint32_t cnt, VkDescriptorType elt) {
   for(size_t i=0; i<sz; ++i){
     if(p[i].type==elt) {
@@ -30,16 +30,30 @@ class VDescriptorArray : public AbstractGraphicsApi::Desc {
     void                      set(size_t id, AbstractGraphicsApi::Buffer**  buf, size_t cnt) override;
 
     void                      ssboBarriers(Detail::ResourceState& res, PipelineStage st) override;
+    // resources, that async compute borrows from graphics queue; arrays are not tracked
+    void                      queueUsage(Detail::ResourceState& res);
 
     bool                      isRuntimeSized() const;
     VkPipelineLayout          pipelineLayout() { return dedicatedLayout; }
 
+    // descriptor set to bind: looked up in layout cache by content, if it was changed since last bind
+    VkDescriptorSet           resolve();
+
     VkDescriptorSet           impl             = VK_NULL_HANDLE;
 
   private:
+    using Descriptor = VPipelineLay::Descriptor;
+    using CacheIt    = VPipelineLay::CacheIt;
+
     VDevice&                  device;
     DSharedPtr<VPipelineLay*> lay;
-    VPipelineLay::Pool*       pool = nullptr;
+
+    Detail::SpinLock          syncData;
+    std::vector<Descriptor>   data;
+    std::vector<uint8_t>      written;
+    bool                      durty  = true;
+    bool                      cached = false;
+    CacheIt                   cachedSet;
 
     VkPipelineLayout          dedicatedLayout = VK_NULL_HANDLE;
     VkDescriptorPool          dedicatedPool   = VK_NULL_HANDLE;
@@ -56,6 +70,14 @@ class VDescriptorArray : public AbstractGraphicsApi::Desc {
     VkDescriptorSet           allocDescSet(VkDescriptorPool pool, VkDescriptorSetLayout lay);
     static void               addPoolSize(VkDescriptorPoolSize* p, size_t& sz, uint32_t cnt, VkDescriptorType elt);
     void                      reallocSet(size_t id, uint32_t oldRuntimeSz);
+
+    void                      write(const VkWriteDescriptorSet& wr);
+    uint64_t                  contentHash() const;
+    void                      contentRefs(VPipelineLay& l, std::vector<uint64_t>& refs) const;
+    CacheIt                   acquire(VPipelineLay& l);
+    void                      release(VPipelineLay& l, CacheIt it);
+    void                      evict(VPipelineLay& l, CacheIt it);
+    void                      writeSet(VPipelineLay& l, VkDescriptorSet set);
   };
 
 }}
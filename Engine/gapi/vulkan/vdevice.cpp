@@ -10,6 +10,7 @@
 
 #include <Tempest/Log>
 #include <Tempest/Platform>
+#include <algorithm>
 #include <cstring>
 #include <array>
 
@@ -38,7 +39,7 @@ VDevice::autoDevice::~autoDevice() {
   }
 
 VDevice::VDevice(VulkanInstance &api, std::string_view gpuName)
-  :instance(api.instance), fboMap(*this) {
+  :instance(api.instance), fboMap(*this), uploadRing(*this), bindless(*this) {
   uint32_t deviceCount = 0;
   vkEnumeratePhysicalDevices(api.instance, &deviceCount, nullptr);
 
@@ -60,7 +61,13 @@ VDevice::VDevice(VulkanInstance &api, std::string_view gpuName)
 
 VDevice::~VDevice(){
   vkDeviceWaitIdle(device.impl);
+  recycleRetired(true);
+  for(auto f:spareFences)
+    vkDestroyFence(device.impl,f,nullptr);
   data.reset();
+  for(auto s:{transferTimeline, computeTimeline, graphicsTimeline})
+    if(s!=VK_NULL_HANDLE)
+      vkDestroySemaphore(device.impl,s,nullptr);
   }
 
 void VDevice::implInit(VulkanInstance &api, VkPhysicalDevice pdev) {
@@ -72,7 +79,10 @@ void VDevice::implInit(VulkanInstance &api, VkPhysicalDevice pdev) {
 
   physicalDevice = pdev;
   allocator.setDevice(*this);
+  psoCache.init(*this);
   data.reset(new DataMgr(*this));
+  if(props.descriptors.bindlessHeap)
+    bindless.init();
   }
 
 VkSurfaceKHR VDevice::createSurface(void* hwnd) {
@@ -122,6 +132,8 @@ void VDevice::deviceQueueProps(VulkanInstance::VkProp& prop, VkPhysicalDevice de
   uint32_t graphics  = uint32_t(-1);
   uint32_t present   = uint32_t(-1);
   uint32_t universal = uint32_t(-1);
+  uint32_t transfer  = uint32_t(-1);
+  uint32_t compute   = uint32_t(-1);
 
   for(uint32_t i=0;i<queueFamilyCount;++i) {
     const auto& queueFamily = queueFamilies[i];
@@ -150,6 +162,11 @@ void VDevice::deviceQueueProps(VulkanInstance::VkProp& prop, VkPhysicalDevice de
       present = i;
     if(presentSupport && graphicsSupport)
       universal = i;
+    // dedicated copy engine: transfer-only family
+    if((queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT))==VK_QUEUE_TRANSFER_BIT)
+      transfer = i;
+    if((queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))==VK_QUEUE_COMPUTE_BIT && compute==uint32_t(-1))
+      compute = i;
     }
 
   if(universal!=uint32_t(-1)) {
@@ -159,6 +176,8 @@ void VDevice::deviceQueueProps(VulkanInstance::VkProp& prop, VkPhysicalDevice de
 
   prop.graphicsFamily = graphics;
   prop.presentFamily  = present;
+  prop.transferFamily = transfer;
+  prop.computeFamily  = compute;
   }
 
 bool VDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
@@ -198,10 +217,13 @@ VDevice::SwapChainSupport VDevice::querySwapChainSupport(VkPhysicalDevice device
   }
 
 void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
-  std::array<uint32_t,2>  uniqueQueueFamilies = {props.graphicsFamily, props.presentFamily};
+  // transfer and compute queues hand resources over to graphics queue with timeline semaphore
+  const uint32_t          transferFamily      = props.hasTimelineSemaphore ? props.transferFamily : uint32_t(-1);
+  const uint32_t          computeFamily       = props.hasTimelineSemaphore ? props.computeFamily  : uint32_t(-1);
+  std::array<uint32_t,4>  uniqueQueueFamilies = {props.graphicsFamily, props.presentFamily, transferFamily, computeFamily};
   float                   queuePriority       = 1.0f;
   size_t                  queueCnt            = 0;
-  VkDeviceQueueCreateInfo qinfo[3]={};
+  VkDeviceQueueCreateInfo qinfo[4]={};
   for(size_t i=0;i<uniqueQueueFamilies.size();++i) {
     auto&    q      = queues[queueCnt];
     uint32_t family = uniqueQueueFamilies[i];
@@ -210,7 +232,7 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
 
     bool nonUnique=false;
     for(size_t r=0;r<queueCnt;++r)
-      if(q.family==family)
+      if(queues[r].family==family)
         nonUnique = true;
     if(nonUnique)
       continue;
@@ -268,6 +290,15 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
     rqExt.push_back(VK_KHR_MAINTENANCE_1_EXTENSION_NAME);
     //rqExt.push_back(VK_EXT_IMAGE_2D_VIEW_OF_3D_EXTENSION_NAME);
     }
+  if(props.hasMemoryBudget) {
+    rqExt.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+  if(props.hasDescUpdTemplate) {
+    rqExt.push_back(VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+    }
+  if(props.hasTimelineSemaphore) {
+    rqExt.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    }
 
 
   VkPhysicalDeviceFeatures supportedFeatures={};
@@ -279,6 +310,7 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
   deviceFeatures.tessellationShader   = supportedFeatures.tessellationShader;
   deviceFeatures.geometryShader       = supportedFeatures.geometryShader;
   deviceFeatures.fillModeNonSolid     = supportedFeatures.fillModeNonSolid;
+  deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
 
   deviceFeatures.vertexPipelineStoresAndAtomics = supportedFeatures.vertexPipelineStoresAndAtomics;
   deviceFeatures.fragmentStoresAndAtomics       = supportedFeatures.fragmentStoresAndAtomics;
@@ -328,6 +360,9 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
     VkPhysicalDeviceVulkanMemoryModelFeatures memoryFeatures = {};
     memoryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_MEMORY_MODEL_FEATURES;
 
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
     if(props.hasSync2) {
       sync2.pNext = features.pNext;
       features.pNext = &sync2;
@@ -371,6 +406,10 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
       memoryFeatures.pNext = features.pNext;
       features.pNext = &memoryFeatures;
       }
+    if(props.hasTimelineSemaphore) {
+      timelineFeatures.pNext = features.pNext;
+      features.pNext = &timelineFeatures;
+      }
 
     auto vkGetPhysicalDeviceFeatures2 = PFN_vkGetPhysicalDeviceFeatures2(vkGetInstanceProcAddr(instance,"vkGetPhysicalDeviceFeatures2KHR"));
 
@@ -400,6 +439,29 @@ void VDevice::createLogicalDevice(VulkanInstance &api, VkPhysicalDevice pdev) {
       graphicsQueue = &queues[i];
     if(queues[i].family==props.presentFamily)
       presentQueue = &queues[i];
+    if(queues[i].family==transferFamily)
+      transferQueue = &queues[i];
+    if(queues[i].family==computeFamily)
+      computeQueue = &queues[i];
+    }
+
+  if(transferQueue!=nullptr) {
+    transferTimeline = createTimeline();
+    }
+  if(computeQueue!=nullptr) {
+    computeTimeline  = createTimeline();
+    graphicsTimeline = createTimeline();
+    props.compute.asyncQueue = true;
+    }
+
+  if(props.hasMemoryBudget) {
+    vkGetPhysicalDeviceMemoryProperties2 = PFN_vkGetPhysicalDeviceMemoryProperties2KHR(vkGetInstanceProcAddr(instance,"vkGetPhysicalDeviceMemoryProperties2KHR"));
+    }
+
+  if(props.hasDescUpdTemplate) {
+    vkCreateDescriptorUpdateTemplate  = PFN_vkCreateDescriptorUpdateTemplateKHR (vkGetDeviceProcAddr(device.impl,"vkCreateDescriptorUpdateTemplateKHR"));
+    vkDestroyDescriptorUpdateTemplate = PFN_vkDestroyDescriptorUpdateTemplateKHR(vkGetDeviceProcAddr(device.impl,"vkDestroyDescriptorUpdateTemplateKHR"));
+    vkUpdateDescriptorSetWithTemplate = PFN_vkUpdateDescriptorSetWithTemplateKHR(vkGetDeviceProcAddr(device.impl,"vkUpdateDescriptorSetWithTemplateKHR"));
     }
 
   if(props.hasMemRq2) {
@@ -500,6 +562,40 @@ void VDevice::allocMeshletHelper() {
     meshHelper.reset(new VMeshletHelper(*this));
   }
 
+std::vector<GpuHeapBudget> VDevice::memoryBudget() {
+  std::vector<GpuHeapBudget> ret(memoryProperties.memoryHeapCount);
+  for(uint32_t i=0; i<memoryProperties.memoryHeapCount; ++i) {
+    ret[i].size        = memoryProperties.memoryHeaps[i].size;
+    ret[i].budget      = memoryProperties.memoryHeaps[i].size;
+    ret[i].deviceLocal = (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT);
+    }
+
+  // allocator heap id is memory type id *2 (+1 for optimal tiling images)
+  for(auto& s:allocator.stats()) {
+    auto& h = ret[memoryProperties.memoryTypes[s.heapId/2].heapIndex];
+    h.allocated += s.total;
+    h.used      += s.allocated;
+    }
+
+  if(vkGetPhysicalDeviceMemoryProperties2!=nullptr) {
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {};
+    budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2KHR mem = {};
+    mem.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+    mem.pNext = &budget;
+    vkGetPhysicalDeviceMemoryProperties2(physicalDevice,&mem);
+    for(size_t i=0; i<ret.size(); ++i) {
+      ret[i].budget = budget.heapBudget[i];
+      ret[i].usage  = budget.heapUsage[i];
+      }
+    } else {
+    for(auto& i:ret)
+      i.usage = i.allocated;
+    }
+  return ret;
+  }
+
 void VDevice::waitIdle() {
   waitIdleSync(queues,sizeof(queues)/sizeof(queues[0]));
   }
@@ -517,7 +613,10 @@ void VDevice::waitIdleSync(VDevice::Queue* q, size_t n) {
     }
   }
 
-void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
+void VDevice::submit(VCommandBuffer& cmd, VFence* sync, uint64_t waitCompute) {
+  if(computeTimeline==VK_NULL_HANDLE)
+    waitCompute = 0;
+
   size_t waitCnt = 0;
   for(auto& s:cmd.swapchainSync) {
     if(s->state!=Detail::VSwapchain::S_Pending)
@@ -526,7 +625,10 @@ void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
     ++waitCnt;
     }
 
-  SmallArray<VkSemaphore, 32> wait(waitCnt);
+  // timeline of async compute goes last, after swapchain semaphores
+  const size_t                semCnt = waitCnt + (waitCompute>0 ? 1 : 0);
+  SmallArray<VkSemaphore, 32> wait(semCnt);
+  SmallArray<uint64_t,    32> waitValue(semCnt);
   size_t                      waitId  = 0;
   for(auto& s:cmd.swapchainSync) {
     if(s->state!=Detail::VSwapchain::S_Draw0)
@@ -535,6 +637,16 @@ void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
     wait[waitId] = s->acquire;
     ++waitId;
     }
+  if(waitCompute>0) {
+    wait     [waitCnt] = computeTimeline;
+    waitValue[waitCnt] = waitCompute;
+    }
+
+  // ownership of resources, returned by compute queue, is acquired ahead of recorded commands
+  std::vector<VkCommandBuffer> handoff;
+  if(waitCompute>0)
+    takeHandoff(waitCompute,handoff);
+  const size_t cmdCnt = handoff.size() + cmd.chunks.size();
 
   VkFence fence = VK_NULL_HANDLE;
   if(sync!=nullptr) {
@@ -543,58 +655,340 @@ void VDevice::submit(VCommandBuffer& cmd, VFence* sync) {
     }
 
   if(vkQueueSubmit2!=nullptr) {
-    SmallArray<VkSemaphoreSubmitInfoKHR, 32> wait2(waitCnt);
-    for(size_t i=0; i<waitCnt; ++i) {
+    SmallArray<VkSemaphoreSubmitInfoKHR, 32> wait2(semCnt);
+    for(size_t i=0; i<semCnt; ++i) {
       wait2[i].sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO_KHR;
       wait2[i].pNext       = nullptr;
       wait2[i].semaphore   = wait[i];
-      wait2[i].value       = 0;
-      wait2[i].stageMask   = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+      wait2[i].value       = waitValue[i];
+      wait2[i].stageMask   = (i<waitCnt ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
       wait2[i].deviceIndex = 0;
       }
-    SmallArray<VkCommandBufferSubmitInfoKHR,MaxCmdChunks> flat(cmd.chunks.size());
+    SmallArray<VkCommandBufferSubmitInfoKHR,MaxCmdChunks> flat(cmdCnt);
+    for(size_t i=0; i<cmdCnt; ++i) {
+      flat[i].sType      = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO_KHR;
+      flat[i].pNext      = nullptr;
+      flat[i].deviceMask = 0;
+      }
+    for(size_t i=0; i<handoff.size(); ++i)
+      flat[i].commandBuffer = handoff[i];
     auto node = cmd.chunks.begin();
     for(size_t i=0; i<cmd.chunks.size(); ++i) {
-      flat[i].sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO_KHR;
-      flat[i].pNext         = nullptr;
-      flat[i].commandBuffer = node->val[i%cmd.chunks.chunkSize].impl;
-      flat[i].deviceMask    = 0;
+      flat[handoff.size()+i].commandBuffer = node->val[i%cmd.chunks.chunkSize].impl;
       if(i+1==cmd.chunks.chunkSize)
         node = node->next;
       }
 
     VkSubmitInfo2KHR submitInfo = {};
     submitInfo.sType                  = VK_STRUCTURE_TYPE_SUBMIT_INFO_2_KHR;
-    submitInfo.commandBufferInfoCount = uint32_t(cmd.chunks.size());
+    submitInfo.commandBufferInfoCount = uint32_t(cmdCnt);
     submitInfo.pCommandBufferInfos    = flat.get();
-    submitInfo.waitSemaphoreInfoCount = uint32_t(waitCnt);
+    submitInfo.waitSemaphoreInfoCount = uint32_t(semCnt);
     submitInfo.pWaitSemaphoreInfos    = wait2.get();
 
     graphicsQueue->submit(1,&submitInfo,fence,vkQueueSubmit2);
     } else {
-    SmallArray<VkPipelineStageFlags, 32> waitStages(waitCnt);
-    for(size_t i=0; i<waitCnt; ++i) {
+    SmallArray<VkPipelineStageFlags, 32> waitStages(semCnt);
+    for(size_t i=0; i<semCnt; ++i) {
       // NOTE: our sw images are draw-only
-      waitStages[i] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+      waitStages[i] = (i<waitCnt ? VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
       }
 
-    SmallArray<VkCommandBuffer,MaxCmdChunks> flat(cmd.chunks.size());
+    SmallArray<VkCommandBuffer,MaxCmdChunks> flat(cmdCnt);
+    for(size_t i=0; i<handoff.size(); ++i)
+      flat[i] = handoff[i];
     auto node = cmd.chunks.begin();
     for(size_t i=0; i<cmd.chunks.size(); ++i) {
-      flat[i] = node->val[i%cmd.chunks.chunkSize].impl;
+      flat[handoff.size()+i] = node->val[i%cmd.chunks.chunkSize].impl;
       if(i+1==cmd.chunks.chunkSize)
         node = node->next;
       }
+
+    // values of binary semaphores are ignored
+    VkTimelineSemaphoreSubmitInfoKHR timeline = {};
+    timeline.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    timeline.waitSemaphoreValueCount = uint32_t(semCnt);
+    timeline.pWaitSemaphoreValues    = waitValue.get();
+
     VkSubmitInfo submitInfo = {};
     submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = uint32_t(cmd.chunks.size());
+    submitInfo.pNext              = (waitCompute>0 ? &timeline : nullptr);
+    submitInfo.commandBufferCount = uint32_t(cmdCnt);
     submitInfo.pCommandBuffers    = flat.get();
-    submitInfo.waitSemaphoreCount = uint32_t(waitCnt);
+    submitInfo.waitSemaphoreCount = uint32_t(semCnt);
     submitInfo.pWaitSemaphores    = wait.get();
     submitInfo.pWaitDstStageMask  = waitStages.get();
 
     graphicsQueue->submit(1,&submitInfo,fence);
     }
+  sealRetired();
+  }
+
+void VDevice::submit(VUploadCommandBuffer& cmd, VFence* sync) {
+  if(!cmd.isStreaming()) {
+    submit(static_cast<VCommandBuffer&>(cmd),sync);
+    return;
+    }
+
+  VkFence fence = VK_NULL_HANDLE;
+  if(sync!=nullptr) {
+    sync->reset();
+    fence = sync->impl;
+    }
+
+  SmallArray<VkCommandBuffer,MaxCmdChunks> flat(cmd.chunks.size());
+  auto node = cmd.chunks.begin();
+  for(size_t i=0; i<cmd.chunks.size(); ++i) {
+    flat[i] = node->val[i%cmd.chunks.chunkSize].impl;
+    if(i+1==cmd.chunks.chunkSize)
+      node = node->next;
+    }
+
+  // timeline values must be signaled in order of submission
+  std::lock_guard<std::mutex> guard(transferSync);
+  const uint64_t        value = ++transferTick;
+  const VkCommandBuffer xfer  = cmd.transferCmd();
+
+  VkTimelineSemaphoreSubmitInfoKHR signalValue = {};
+  signalValue.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+  signalValue.signalSemaphoreValueCount = 1;
+  signalValue.pSignalSemaphoreValues    = &value;
+
+  VkSubmitInfo copyInfo = {};
+  copyInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  copyInfo.pNext                = &signalValue;
+  copyInfo.commandBufferCount   = 1;
+  copyInfo.pCommandBuffers      = &xfer;
+  copyInfo.signalSemaphoreCount = 1;
+  copyInfo.pSignalSemaphores    = &transferTimeline;
+  transferQueue->submit(1,&copyInfo,VK_NULL_HANDLE);
+
+  // acquire of ownership on graphics queue; fence covers both submissions
+  const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+  VkTimelineSemaphoreSubmitInfoKHR waitValue = {};
+  waitValue.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+  waitValue.waitSemaphoreValueCount = 1;
+  waitValue.pWaitSemaphoreValues    = &value;
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext              = &waitValue;
+  submitInfo.commandBufferCount = uint32_t(cmd.chunks.size());
+  submitInfo.pCommandBuffers    = flat.get();
+  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.pWaitSemaphores    = &transferTimeline;
+  submitInfo.pWaitDstStageMask  = &waitStage;
+  graphicsQueue->submit(1,&submitInfo,fence);
+  sealRetired();
+  }
+
+void VDevice::submit(VComputeCommandBuffer& cmd, VFence* sync) {
+  if(computeQueue==nullptr) {
+    submit(static_cast<VCommandBuffer&>(cmd),sync);
+    return;
+    }
+
+  // graphics queue waits for compute right away and takes resources back; fence covers both queues
+  const uint64_t value = submitAsync(cmd,nullptr);
+
+  std::vector<VkCommandBuffer> handoff;
+  takeHandoff(value,handoff);
+
+  VkFence fence = VK_NULL_HANDLE;
+  if(sync!=nullptr) {
+    sync->reset();
+    fence = sync->impl;
+    }
+
+  const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+  VkTimelineSemaphoreSubmitInfoKHR waitValue = {};
+  waitValue.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+  waitValue.waitSemaphoreValueCount = 1;
+  waitValue.pWaitSemaphoreValues    = &value;
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext              = &waitValue;
+  submitInfo.commandBufferCount = uint32_t(handoff.size());
+  submitInfo.pCommandBuffers    = handoff.data();
+  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.pWaitSemaphores    = &computeTimeline;
+  submitInfo.pWaitDstStageMask  = &waitStage;
+  graphicsQueue->submit(1,&submitInfo,fence);
+  sealRetired();
+  }
+
+uint64_t VDevice::submitAsync(VComputeCommandBuffer& cmd, VFence* sync) {
+  if(computeQueue==nullptr) {
+    submit(static_cast<VCommandBuffer&>(cmd),sync);
+    return 0;
+    }
+
+  VkFence fence = VK_NULL_HANDLE;
+  if(sync!=nullptr) {
+    sync->reset();
+    fence = sync->impl;
+    }
+
+  const bool handoff = cmd.hasHandoff();
+  const size_t cmdCnt = cmd.chunks.size() + (handoff ? 1 : 0);
+
+  SmallArray<VkCommandBuffer,MaxCmdChunks> flat(cmdCnt);
+  size_t                                   flatId = 0;
+  if(handoff)
+    flat[flatId++] = cmd.acquireCmd();
+  auto node = cmd.chunks.begin();
+  for(size_t i=0; i<cmd.chunks.size(); ++i) {
+    flat[flatId++] = node->val[i%cmd.chunks.chunkSize].impl;
+    if(i+1==cmd.chunks.chunkSize)
+      node = node->next;
+    }
+
+  // timeline values must be signaled in order of submission
+  std::lock_guard<std::mutex> guard(computeSync);
+  uint64_t release = 0;
+  if(handoff) {
+    // graphics queue releases borrowed resources, after all work submitted so far
+    release = ++graphicsTick;
+    const VkCommandBuffer rel = cmd.releaseCmd();
+
+    VkTimelineSemaphoreSubmitInfoKHR signalValue = {};
+    signalValue.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+    signalValue.signalSemaphoreValueCount = 1;
+    signalValue.pSignalSemaphoreValues    = &release;
+
+    VkSubmitInfo releaseInfo = {};
+    releaseInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    releaseInfo.pNext                = &signalValue;
+    releaseInfo.commandBufferCount   = 1;
+    releaseInfo.pCommandBuffers      = &rel;
+    releaseInfo.signalSemaphoreCount = 1;
+    releaseInfo.pSignalSemaphores    = &graphicsTimeline;
+    graphicsQueue->submit(1,&releaseInfo,VK_NULL_HANDLE);
+    }
+
+  const uint64_t             value     = ++computeTick;
+  const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+  VkTimelineSemaphoreSubmitInfoKHR timeline = {};
+  timeline.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+  timeline.waitSemaphoreValueCount   = (handoff ? 1 : 0);
+  timeline.pWaitSemaphoreValues      = &release;
+  timeline.signalSemaphoreValueCount = 1;
+  timeline.pSignalSemaphoreValues    = &value;
+
+  VkSubmitInfo submitInfo = {};
+  submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext                = &timeline;
+  submitInfo.commandBufferCount   = uint32_t(cmdCnt);
+  submitInfo.pCommandBuffers      = flat.get();
+  submitInfo.waitSemaphoreCount   = (handoff ? 1 : 0);
+  submitInfo.pWaitSemaphores      = &graphicsTimeline;
+  submitInfo.pWaitDstStageMask    = &waitStage;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores    = &computeTimeline;
+  computeQueue->submit(1,&submitInfo,fence);
+
+  if(handoff) {
+    Handoff h;
+    h.value = value;
+    h.ret   = cmd.returnCmd();
+    pendingHandoff.push_back(h);
+    }
+  sealRetired();
+  return value;
+  }
+
+void VDevice::dropHandoff(VkCommandBuffer ret) {
+  std::lock_guard<std::mutex> guard(computeSync);
+  pendingHandoff.erase(std::remove_if(pendingHandoff.begin(),pendingHandoff.end(),[ret](const Handoff& h){
+    return h.ret==ret;
+    }),pendingHandoff.end());
+  }
+
+void VDevice::retire(const DSharedPtr<AbstractGraphicsApi::Texture*>& t) {
+  std::lock_guard<std::mutex> guard(retireSync);
+  retired.push(t);
+  }
+
+void VDevice::sealRetired() {
+  bindless.seal();
+
+  std::lock_guard<std::mutex> guard(retireSync);
+  recycleRetired(false);
+  if(retired.empty())
+    return;
+  // empty submit: fence is signaled, when all work submitted to queue so far is complete
+  RetireMark m;
+  m.gfx = retireFence();
+  graphicsQueue->submit(0,nullptr,m.gfx);
+  if(computeQueue!=nullptr) {
+    m.comp = retireFence();
+    computeQueue->submit(0,nullptr,m.comp);
+    }
+  retired.seal(m);
+  }
+
+void VDevice::recycleRetired(bool wait) {
+  VkDevice dev  = device.impl;
+  auto     done = [dev,wait](const RetireMark& m) {
+    if(wait)
+      return true;
+    return vkGetFenceStatus(dev,m.gfx)==VK_SUCCESS &&
+           (m.comp==VK_NULL_HANDLE || vkGetFenceStatus(dev,m.comp)==VK_SUCCESS);
+    };
+  auto fn   = [](DSharedPtr<AbstractGraphicsApi::Texture*>& t) {
+    t = DSharedPtr<AbstractGraphicsApi::Texture*>();
+    };
+  auto free = [this,dev](const RetireMark& m) {
+    for(auto f:{m.gfx,m.comp}) {
+      if(f==VK_NULL_HANDLE)
+        continue;
+      vkResetFences(dev,1,&f);
+      spareFences.push_back(f);
+      }
+    };
+  retired.recycle(done,fn,free);
+  }
+
+VkFence VDevice::retireFence() {
+  if(!spareFences.empty()) {
+    auto ret = spareFences.back();
+    spareFences.pop_back();
+    return ret;
+    }
+  VkFenceCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  VkFence ret = VK_NULL_HANDLE;
+  vkAssert(vkCreateFence(device.impl,&info,nullptr,&ret));
+  return ret;
+  }
+
+void VDevice::takeHandoff(uint64_t waitCompute, std::vector<VkCommandBuffer>& out) {
+  std::lock_guard<std::mutex> guard(computeSync);
+  for(auto& h:pendingHandoff)
+    if(h.value<=waitCompute)
+      out.push_back(h.ret);
+  pendingHandoff.erase(std::remove_if(pendingHandoff.begin(),pendingHandoff.end(),[waitCompute](const Handoff& h){
+    return h.value<=waitCompute;
+    }),pendingHandoff.end());
+  }
+
+VkSemaphore VDevice::createTimeline() {
+  VkSemaphoreTypeCreateInfoKHR type = {};
+  type.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+  type.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+  type.initialValue  = 0;
+
+  VkSemaphoreCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  info.pNext = &type;
+
+  VkSemaphore ret = VK_NULL_HANDLE;
+  vkAssert(vkCreateSemaphore(device.impl,&info,nullptr,&ret));
+  return ret;
   }
 
 void VDevice::Queue::waitIdle() {
@@ -4,19 +4,28 @@
 #include <Tempest/RenderState>
 #include <Tempest/AccelerationStructure>
 #include <stdexcept>
+#include <atomic>
 #include "gapi/vulkan/vbuffer.h"
 #include "vulkan_sdk.h"
 
 #include "vallocator.h"
 #include "vcommandbuffer.h"
+#include "vuploadcommandbuffer.h"
 #include "vswapchain.h"
 #include "vfence.h"
 #include "vulkanapi_impl.h"
 #include "vframebuffermap.h"
+#include "vpipelinecache.h"
+#include "vpipelinecompiler.h"
+#include "vuploadring.h"
+#include "vbindlessheap.h"
+#include "vpipelinelay.h"
 #include "exceptions/exception.h"
 #include "utility/compiller_hints.h"
 #include "gapi/shaderreflection.h"
 #include "gapi/uploadengine.h"
+#include "gapi/descriptorrefs.h"
+#include "gapi/retirequeue.h"
 
 namespace Tempest {
 namespace Detail {
@@ -340,14 +349,21 @@ class VDevice : public AbstractGraphicsApi::Device {
     VkPhysicalDevice        physicalDevice = nullptr;
     autoDevice              device;
 
-    Queue                   queues[3];
+    Queue                   queues[4];
     Queue*                  graphicsQueue = nullptr;
     Queue*                  presentQueue  = nullptr;
+    // dedicated copy engine; null, if there is no transfer-only family or timeline semaphores
+    Queue*                  transferQueue = nullptr;
+    // async compute; null, if there is no compute family without graphics or timeline semaphores
+    Queue*                  computeQueue  = nullptr;
 
     std::mutex              allocSync;
     VAllocator              allocator;
 
     VFramebufferMap         fboMap;
+    VPipelineCache          psoCache;
+    VPipelineCompiler       psoCompiler;
+    std::atomic_bool        asyncPso{false};
 
     std::mutex                      meshSync;
     std::unique_ptr<VMeshletHelper> meshHelper;
@@ -377,15 +393,35 @@ class VDevice : public AbstractGraphicsApi::Device {
     PFN_vkCmdDebugMarkerBeginEXT                vkCmdDebugMarkerBegin = nullptr;
     PFN_vkCmdDebugMarkerEndEXT                  vkCmdDebugMarkerEnd   = nullptr;
 
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR vkGetPhysicalDeviceMemoryProperties2 = nullptr;
+
+    PFN_vkCreateDescriptorUpdateTemplateKHR     vkCreateDescriptorUpdateTemplate  = nullptr;
+    PFN_vkDestroyDescriptorUpdateTemplateKHR    vkDestroyDescriptorUpdateTemplate = nullptr;
+    PFN_vkUpdateDescriptorSetWithTemplateKHR    vkUpdateDescriptorSetWithTemplate = nullptr;
+
+    // cached descriptor sets by referenced buffer, image-view and tlas handle
+    DescriptorRefs<VPipelineLay::CachedSet> descRefs;
+
     void                    waitIdle() override;
-    void                    submit(VCommandBuffer& cmd, VFence* sync);
+    void                    submit(VCommandBuffer& cmd, VFence* sync, uint64_t waitCompute = 0);
+    void                    submit(VUploadCommandBuffer& cmd, VFence* sync);
+    void                    submit(VComputeCommandBuffer& cmd, VFence* sync);
+    uint64_t                submitAsync(VComputeCommandBuffer& cmd, VFence* sync);
+    // forget ownership return of command buffer, that is recorded again
+    void                    dropHandoff(VkCommandBuffer ret);
+    // keeps texture alive, until commands, submitted so far and by next submit, are complete
+    void                    retire(const DSharedPtr<AbstractGraphicsApi::Texture*>& t);
+
+    std::vector<GpuHeapBudget> memoryBudget();
 
     VkSurfaceKHR            createSurface(void* hwnd);
     SwapChainSupport        querySwapChainSupport(VkSurfaceKHR surface) { return querySwapChainSupport(physicalDevice,surface); }
     MemIndex                memoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags props, VkImageTiling tiling) const;
 
-    using DataMgr = UploadEngine<VDevice,VCommandBuffer,VFence,VBuffer>;
+    using DataMgr = UploadEngine<VDevice,VUploadCommandBuffer,VFence,VBuffer>;
     DataMgr&                dataMgr() const { return *data; }
+    VUploadRing             uploadRing;
+    VBindlessHeap           bindless;
 
     VBuffer&                dummySsbo();
 
@@ -395,10 +431,42 @@ class VDevice : public AbstractGraphicsApi::Device {
     VkPhysicalDeviceMemoryProperties memoryProperties;
     std::unique_ptr<DataMgr>         data;
 
+    // signaled by transfer queue, waited by graphics queue
+    std::mutex              transferSync;
+    VkSemaphore             transferTimeline = VK_NULL_HANDLE;
+    uint64_t                transferTick     = 0;
+
+    struct Handoff {
+      uint64_t        value = 0;
+      VkCommandBuffer ret   = VK_NULL_HANDLE;
+      };
+    // computeTimeline is signaled by compute queue and waited by graphics queue, graphicsTimeline - other way around
+    std::mutex              computeSync;
+    VkSemaphore             computeTimeline  = VK_NULL_HANDLE;
+    VkSemaphore             graphicsTimeline = VK_NULL_HANDLE;
+    uint64_t                computeTick      = 0;
+    uint64_t                graphicsTick     = 0;
+    // ownership returns to graphics queue, executed by first submit, that waits for compute value
+    std::vector<Handoff>    pendingHandoff;
+
     std::mutex              syncSsbo;
     VBuffer                 dummySsboVal;
 
+    struct RetireMark {
+      VkFence gfx  = VK_NULL_HANDLE;
+      VkFence comp = VK_NULL_HANDLE;
+      };
+    std::mutex              retireSync;
+    RetireQueue<DSharedPtr<AbstractGraphicsApi::Texture*>,RetireMark> retired;
+    std::vector<VkFence>    spareFences;
+
     void                    waitIdleSync(Queue* q, size_t n);
+    // closes frame of retired resources, and of released bindless slots; called after submit
+    void                    sealRetired();
+    void                    recycleRetired(bool wait);
+    VkFence                 retireFence();
+    VkSemaphore             createTimeline();
+    void                    takeHandoff(uint64_t waitCompute, std::vector<VkCommandBuffer>& out);
 
     void                    implInit(VulkanInstance& api, VkPhysicalDevice pdev);
     void                    pickPhysicalDevice();
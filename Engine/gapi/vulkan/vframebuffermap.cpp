@@ -5,6 +5,8 @@
 #include "vdevice.h"
 #include "vtexture.h"
 
+#include <algorithm>
+
 using namespace Tempest;
 using namespace Tempest::Detail;
 
@@ -18,15 +20,19 @@ bool VFramebufferMap::RenderPass::isCompatible(const RenderPass& other) const {
   }
 
 bool VFramebufferMap::RenderPass::isSame(const Desc* d, size_t cnt) const {
-  return
-      descSize==cnt &&
-      std::memcmp(desc,d,cnt*sizeof(Desc))==0;
+  // per-field compare: padding of Desc is not initialized
+  if(descSize!=cnt)
+    return false;
+  for(size_t i=0; i<cnt; ++i)
+    if(desc[i]!=d[i])
+      return false;
+  return true;
   }
 
-bool VFramebufferMap::Fbo::isSame(const Desc* d, const VkImageView* v, size_t cnt) const {
+bool VFramebufferMap::Fbo::isSame(const Desc* d, const VkImageView* v, size_t cnt, uint32_t width, uint32_t height) const {
   return
-      descSize==cnt &&
-      std::memcmp(pass->desc,d,cnt*sizeof(Desc))==0 &&
+      w==width && h==height &&
+      pass->isSame(d,cnt) &&
       std::memcmp(view,v,cnt*sizeof(VkImageView))==0;
   }
 
@@ -45,13 +51,12 @@ VFramebufferMap::~VFramebufferMap() {
   if(device==VK_NULL_HANDLE)
     return;
 
-  for(auto& i:val) {
-    auto& v = *i;
+  val.forEach([device](Fbo& v){
     if(v.fbo!=VK_NULL_HANDLE)
       vkDestroyFramebuffer(device,v.fbo,nullptr);
-    }
+    });
   for(auto& i:rp) {
-    auto& v = *i;
+    auto& v = *i.second;
     if(v.pass!=VK_NULL_HANDLE)
       vkDestroyRenderPass(device,v.pass,nullptr);
     }
@@ -59,18 +64,42 @@ VFramebufferMap::~VFramebufferMap() {
 
 void VFramebufferMap::notifyDestroy(VkImageView img) {
   auto device = dev.device.impl;
+  val.erase([img](const Fbo& v){ return v.hasImg(img); },
+            [device](Fbo& v){ vkDestroyFramebuffer(device,v.fbo,nullptr); });
+  }
 
-  std::lock_guard<std::mutex> guard(syncFbo);
-  for(size_t i=0; i<val.size();) {
-    auto& v = *val[i];
-    if(!v.hasImg(img)) {
-      ++i;
-      continue;
-      }
-    vkDestroyFramebuffer(device,v.fbo,nullptr);
-    val[i] = std::move(val.back());
-    val.pop_back();
+void VFramebufferMap::nextFrame() {
+  auto device = dev.device.impl;
+  val.nextFrame([device](Fbo& v){ vkDestroyFramebuffer(device,v.fbo,nullptr); });
+  }
+
+uint64_t VFramebufferMap::hash(const Desc* desc, size_t cnt) {
+  // FNV-1a
+  uint64_t h = 0xcbf29ce484222325ull;
+  auto mix = [&h](uint64_t v) {
+    h ^= v;
+    h *= 0x100000001b3ull;
+    };
+  for(size_t i=0; i<cnt; ++i) {
+    mix(uint64_t(desc[i].load));
+    mix(uint64_t(desc[i].store));
+    mix(uint64_t(desc[i].frm));
     }
+  mix(cnt);
+  return h;
+  }
+
+uint64_t VFramebufferMap::hash(const Desc* desc, const VkImageView* view, size_t cnt, uint32_t w, uint32_t h) {
+  uint64_t ret = hash(desc,cnt);
+  auto mix = [&ret](uint64_t v) {
+    ret ^= v;
+    ret *= 0x100000001b3ull;
+    };
+  for(size_t i=0; i<cnt; ++i)
+    mix(std::hash<VkImageView>()(view[i]));
+  mix(w);
+  mix(h);
+  return ret;
   }
 
 std::shared_ptr<VFramebufferMap::Fbo> VFramebufferMap::find(const AttachmentDesc* desc, size_t descSize,
@@ -96,58 +125,63 @@ std::shared_ptr<VFramebufferMap::Fbo> VFramebufferMap::find(const AttachmentDesc
       }
     }
 
-  std::lock_guard<std::mutex> guard(syncFbo);
-  for(auto& i:val)
-    if(i->isSame(dx,view,descSize))
-      return i;
-
-  for(size_t i=0; i<descSize; ++i) {
-    if(sw[i]!=nullptr) {
-      auto& s = *reinterpret_cast<VSwapchain*>(sw[i]);
-      s.map = this;
-      } else {
-      auto& t = *reinterpret_cast<VTextureWithFbo*>(att[i]);
-      t.map = this;
+  auto match = [&](const Fbo& f){ return f.isSame(dx,view,descSize,w,h); };
+  auto mk    = [&]() {
+    for(size_t i=0; i<descSize; ++i) {
+      if(sw[i]!=nullptr) {
+        auto& s = *reinterpret_cast<VSwapchain*>(sw[i]);
+        s.map = this;
+        } else {
+        auto& t = *reinterpret_cast<VTextureWithFbo*>(att[i]);
+        t.map = this;
+        }
       }
-    }
-
-  val.push_back(std::make_shared<Fbo>());
-  try {
-    *val.back() = mkFbo(dx,view,descSize,w,h);
-    }
-  catch(...) {
-    val.pop_back();
-    throw;
-    }
-  return val.back();
+    auto ret = std::make_shared<Fbo>();
+    mkFbo(*ret,dx,view,descSize,w,h);
+    return ret;
+    };
+  return val.find(hash(dx,view,descSize,w,h),match,mk);
   }
 
-VFramebufferMap::Fbo VFramebufferMap::mkFbo(const Desc* desc, const VkImageView* view, size_t attCount, uint32_t w, uint32_t h) {
-  Fbo ret = {};
+void VFramebufferMap::mkFbo(Fbo& ret, const Desc* desc, const VkImageView* view, size_t attCount, uint32_t w, uint32_t h) {
   ret.pass = findRenderpass(desc,attCount);
   ret.fbo  = mkFramebuffer(view,attCount,w,h,ret.pass->pass);
 
   std::memcpy(ret.view,view,attCount*sizeof(VkImageView));
   ret.descSize = uint8_t(attCount);
-  return ret;
+  ret.w        = w;
+  ret.h        = h;
+  }
+
+std::shared_ptr<VFramebufferMap::RenderPass> VFramebufferMap::compatiblePass(const VkFormat* frm, size_t cnt) {
+  // load/store operations do not affect compatibility
+  Desc dx[MaxFramebufferAttachments];
+  for(size_t i=0; i<cnt; ++i)
+    dx[i].frm = frm[i];
+  return findRenderpass(dx,cnt);
   }
 
 std::shared_ptr<VFramebufferMap::RenderPass> VFramebufferMap::findRenderpass(const Desc* desc, size_t cnt) {
-  std::lock_guard<std::mutex> guard(syncRp);
-  for(auto& i:rp)
-    if(i->isSame(desc,cnt))
-      return i;
+  const uint64_t hx = hash(desc,cnt);
+  {
+    std::shared_lock<std::shared_mutex> guard(syncRp);
+    auto rg = rp.equal_range(hx);
+    for(auto i=rg.first; i!=rg.second; ++i)
+      if(i->second->isSame(desc,cnt))
+        return i->second;
+  }
+
+  std::lock_guard<std::shared_mutex> guard(syncRp);
+  auto rg = rp.equal_range(hx);
+  for(auto i=rg.first; i!=rg.second; ++i)
+    if(i->second->isSame(desc,cnt))
+      return i->second;
+
   auto ret = std::make_shared<RenderPass>();
-  rp.push_back(ret);
-  try {
-    ret->pass = mkRenderPass(desc,cnt);
-    }
-  catch(...) {
-    rp.pop_back();
-    throw;
-    }
+  ret->pass     = mkRenderPass(desc,cnt);
   ret->descSize = uint8_t(cnt);
-  std::memcpy(ret->desc,desc,cnt*sizeof(Desc));
+  std::copy(desc,desc+cnt,ret->desc);
+  rp.emplace(hx,ret);
   return ret;
   }
 
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "gapi/abstractgraphicsapi.h"
+#include "gapi/idlecache.h"
 #include "vulkan_sdk.h"
 
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace Tempest {
 
@@ -13,8 +17,15 @@ namespace Detail {
 
 class VDevice;
 
+// Cache of render passes and framebuffers for devices without dynamic rendering.
+// Lookups are hashed and take shared lock; framebuffers, that were not used for `MaxIdleFrames`
+// presents and are not referenced by any recorded command buffer, are destroyed.
 class VFramebufferMap {
   public:
+    enum : uint64_t {
+      MaxIdleFrames = 16,
+      };
+
     VFramebufferMap(VDevice& dev);
     ~VFramebufferMap();
 
@@ -22,6 +33,8 @@ class VFramebufferMap {
       AccessOp      load  = AccessOp::Discard;
       AccessOp      store = AccessOp::Discard;
       VkFormat      frm   = VK_FORMAT_UNDEFINED;
+      bool operator == (const Desc& other) const { return load==other.load && store==other.store && frm==other.frm; }
+      bool operator != (const Desc& other) const { return !(*this==other); }
       };
 
     struct RenderPass {
@@ -39,7 +52,10 @@ class VFramebufferMap {
 
       VkImageView    view[MaxFramebufferAttachments] = {};
       uint8_t        descSize = 0;
-      bool           isSame(const Desc* d, const VkImageView* view, size_t cnt) const;
+      uint32_t       w        = 0;
+      uint32_t       h        = 0;
+
+      bool           isSame(const Desc* d, const VkImageView* view, size_t cnt, uint32_t w, uint32_t h) const;
       bool           hasImg(VkImageView v) const;
       };
 
@@ -48,21 +64,27 @@ class VFramebufferMap {
                               AbstractGraphicsApi::Swapchain** sw, const uint32_t* imageId,
                               uint32_t w, uint32_t h);
     void                 notifyDestroy(VkImageView img);
+    // called once per present: advances frame counter and evicts idle framebuffers
+    void                 nextFrame();
+    // render pass, that is compatible with any framebuffer of given formats
+    std::shared_ptr<RenderPass> compatiblePass(const VkFormat* frm, size_t cnt);
 
   private:
     std::shared_ptr<RenderPass> findRenderpass(const Desc* desc, size_t cnt);
 
-    Fbo                mkFbo(const Desc* desc, const VkImageView* view, size_t attCount, uint32_t w, uint32_t h);
+    static uint64_t    hash(const Desc* desc, size_t cnt);
+    static uint64_t    hash(const Desc* desc, const VkImageView* view, size_t cnt, uint32_t w, uint32_t h);
+
+    void               mkFbo(Fbo& ret, const Desc* desc, const VkImageView* view, size_t attCount, uint32_t w, uint32_t h);
     VkRenderPass       mkRenderPass (const Desc* desc, size_t cnt);
     VkFramebuffer      mkFramebuffer(const VkImageView* view, size_t cnt, uint32_t w, uint32_t h, VkRenderPass rp);
 
     VDevice&           dev;
 
-    std::mutex         syncFbo;
-    std::vector<std::shared_ptr<Fbo>>        val;
+    IdleCache<Fbo>     val{MaxIdleFrames};
 
-    std::mutex         syncRp;
-    std::vector<std::shared_ptr<RenderPass>> rp;
+    std::shared_mutex  syncRp;
+    std::unordered_multimap<uint64_t,std::shared_ptr<RenderPass>> rp;
   };
 
 }
@@ -11,6 +11,8 @@
 #include <Tempest/PipelineLayout>
 #include <Tempest/RenderState>
 
+#include <array>
+
 using namespace Tempest;
 using namespace Tempest::Detail;
 
@@ -48,7 +50,7 @@ VPipeline::VPipeline(){
 VPipeline::VPipeline(VDevice& device, const RenderState& st, Topology tp,
                      const VPipelineLay& ulay,
                      const VShader** sh, size_t count)
-  : device(device.device.impl), st(st), tp(tp), runtimeSized(ulay.runtimeSized)  {
+  : device(device.device.impl), cache(&device.psoCache), compiler(&device.psoCompiler), st(st), tp(tp), runtimeSized(ulay.runtimeSized)  {
   try {
     for(size_t i=0; i<count; ++i)
       if(sh[i]!=nullptr)
@@ -92,7 +94,8 @@ VPipeline::VPipeline(VDevice& device, const RenderState& st, Topology tp,
         info.stage.module = reinterpret_cast<const VTaskShaderEmulated*>(ms)->compPass;
         info.stage.pName  = "main";
         info.layout       = this->ts.pipelineLayout;
-        vkAssert(vkCreateComputePipelines(device.device.impl, VK_NULL_HANDLE, 1, &info, nullptr, &this->ts.compuePipeline));
+        std::shared_lock<std::shared_mutex> guard(cache->sync);
+        vkAssert(vkCreateComputePipelines(device.device.impl, cache->impl, 1, &info, nullptr, &this->ts.compuePipeline));
 
         // cancel native task shading
         pushStageFlags &= ~VK_SHADER_STAGE_TASK_BIT_EXT;
@@ -114,7 +117,8 @@ VPipeline::VPipeline(VDevice& device, const RenderState& st, Topology tp,
         info.stage.module = reinterpret_cast<const VMeshShaderEmulated*>(ms)->compPass;
         info.stage.pName  = "main";
         info.layout       = this->ms.pipelineLayout;
-        vkAssert(vkCreateComputePipelines(device.device.impl, VK_NULL_HANDLE, 1, &info, nullptr, &this->ms.compuePipeline));
+        std::shared_lock<std::shared_mutex> guard(cache->sync);
+        vkAssert(vkCreateComputePipelines(device.device.impl, cache->impl, 1, &info, nullptr, &this->ms.compuePipeline));
 
         // cancel native mesh shading
         pushStageFlags &= ~VK_SHADER_STAGE_MESH_BIT_EXT;
@@ -129,49 +133,99 @@ VPipeline::VPipeline(VDevice& device, const RenderState& st, Topology tp,
   }
 
 VPipeline::~VPipeline() {
+  if(compiler!=nullptr)
+    compiler->cancel(this);
   cleanup();
   }
 
-VkPipeline VPipeline::instance(const std::shared_ptr<VFramebufferMap::RenderPass>& pass, VkPipelineLayout pLay, size_t stride) {
-  std::lock_guard<SpinLock> guard(sync);
+VkPipeline VPipeline::instance(const std::shared_ptr<VFramebufferMap::RenderPass>& pass, VkPipelineLayout pLay, size_t stride, bool async) {
+  return implInstance(instRp,pass,pLay,stride,async);
+  }
 
-  for(auto& i:instRp)
-    if(i.isCompatible(pass,pLay,stride))
-      return i.val;
-  VkPipeline val = VK_NULL_HANDLE;
-  try {
-    val = initGraphicsPipeline(device,pLay,pass.get(),nullptr,st,
-                               decl.get(),declSize,stride,
-                               tp,modules);
-    instRp.emplace_back(pass,pLay,stride,val);
-    }
-  catch(...) {
-    if(val!=VK_NULL_HANDLE)
-      vkDestroyPipeline(device,val,nullptr);
-    throw;
-    }
-  return instRp.back().val;
+VkPipeline VPipeline::instance(const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride, bool async) {
+  return implInstance(instDr,info,pLay,stride,async);
   }
 
-VkPipeline VPipeline::instance(const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride) {
-  std::lock_guard<SpinLock> guard(sync);
+void VPipeline::precompile(const std::shared_ptr<VFramebufferMap::RenderPass>& pass) {
+  if(runtimeSized)
+    return; // actual layout is known only at bind time
+  implInstance(instRp,pass,pipelineLayout,defaultStride,true);
+  }
 
-  for(auto& i:instDr)
-    if(i.isCompatible(info,pLay,stride))
-      return i.val;
-  VkPipeline val = VK_NULL_HANDLE;
-  try {
-    val = initGraphicsPipeline(device,pLay,nullptr,&info,st,
-                               decl.get(),declSize,stride,
-                               tp,modules);
-    instDr.emplace_back(info,pLay,stride,val);
-    }
-  catch(...) {
-    if(val!=VK_NULL_HANDLE)
-      vkDestroyPipeline(device,val,nullptr);
-    throw;
-    }
-  return instDr.back().val;
+void VPipeline::precompile(const VkPipelineRenderingCreateInfoKHR& info) {
+  if(runtimeSized)
+    return;
+  implInstance(instDr,info,pipelineLayout,defaultStride,true);
+  }
+
+template<class Key, class I>
+VkPipeline VPipeline::implInstance(PipelineVariants<I>& inst, const Key& lay, VkPipelineLayout pLay, size_t stride, bool async) {
+  if(compiler==nullptr)
+    async = false;
+
+  // failed background compile is retried inline, even in async mode: error is thrown to the caller
+  return inst.get(async,
+                  [&](const I& i)       { return i.isCompatible(lay,pLay,stride); },
+                  [&](VkPipeline val)   { return I(lay,pLay,stride,val); },
+                  [&]()                 { return compile(lay,pLay,stride); },
+                  [&]()                 { enqueue(inst,lay,pLay,stride); });
+  }
+
+void VPipeline::enqueue(PipelineVariants<InstRp>& inst, const std::shared_ptr<VFramebufferMap::RenderPass>& pass, VkPipelineLayout pLay, size_t stride) {
+  compiler->push(this,[this,&inst,pass,pLay,stride]() {
+    VkPipeline val = VK_NULL_HANDLE;
+    bool       ok  = true;
+    try {
+      val = compile(pass,pLay,stride);
+      }
+    catch(...) {
+      ok = false;
+      }
+    complete(inst,pass,pLay,stride,val,ok);
+    });
+  }
+
+void VPipeline::enqueue(PipelineVariants<InstDr>& inst, const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride) {
+  // job outlives `info`: keep own copy of formats
+  std::array<VkFormat,MaxFramebufferAttachments> colorFrm = {};
+  std::memcpy(colorFrm.data(), info.pColorAttachmentFormats, info.colorAttachmentCount*sizeof(VkFormat));
+
+  VkPipelineRenderingCreateInfoKHR key = info;
+  key.pNext = nullptr;
+  compiler->push(this,[this,&inst,key,colorFrm,pLay,stride]() mutable {
+    key.pColorAttachmentFormats = colorFrm.data();
+
+    VkPipeline val = VK_NULL_HANDLE;
+    bool       ok  = true;
+    try {
+      val = compile(key,pLay,stride);
+      }
+    catch(...) {
+      ok = false;
+      }
+    complete(inst,key,pLay,stride,val,ok);
+    });
+  }
+
+template<class Key, class I>
+void VPipeline::complete(PipelineVariants<I>& inst, const Key& lay, VkPipelineLayout pLay, size_t stride, VkPipeline val, bool ok) {
+  if(inst.complete([&](const I& i){ return i.isCompatible(lay,pLay,stride); },val,ok))
+    return;
+  // entry was replaced by synchronous compilation
+  if(val!=VK_NULL_HANDLE)
+    vkDestroyPipeline(device,val,nullptr);
+  }
+
+VkPipeline VPipeline::compile(const std::shared_ptr<VFramebufferMap::RenderPass>& pass, VkPipelineLayout pLay, size_t stride) {
+  return initGraphicsPipeline(device,pLay,pass.get(),nullptr,st,
+                              decl.get(),declSize,stride,
+                              tp,modules);
+  }
+
+VkPipeline VPipeline::compile(const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride) {
+  return initGraphicsPipeline(device,pLay,nullptr,&info,st,
+                              decl.get(),declSize,stride,
+                              tp,modules);
   }
 
 IVec3 VPipeline::workGroupSize() const {
@@ -215,9 +269,9 @@ void VPipeline::cleanup() {
 
   if(pipelineLayout!=VK_NULL_HANDLE)
     vkDestroyPipelineLayout(device,pipelineLayout,nullptr);
-  for(auto& i:instRp)
+  for(auto& i:instRp.inst)
     vkDestroyPipeline(device,i.val,nullptr);
-  for(auto& i:instDr)
+  for(auto& i:instDr.inst)
     vkDestroyPipeline(device,i.val,nullptr);
   }
 
@@ -248,6 +302,15 @@ VkPipelineLayout VPipeline::initLayout(VDevice& dev, const VPipelineLay& uboLay,
       }
     }
 
+  if(dev.bindless.isEnabled() && !isMeshCompPass) {
+    while(pipelineLayoutInfo.setLayoutCount<ShaderReflection::BindlessSet) {
+      pSetLayouts[pipelineLayoutInfo.setLayoutCount] = dev.bindless.emptyLay;
+      pipelineLayoutInfo.setLayoutCount++;
+      }
+    pSetLayouts[pipelineLayoutInfo.setLayoutCount] = dev.bindless.lay;
+    pipelineLayoutInfo.setLayoutCount++;
+    }
+
   if(uboLay.pb.size>0) {
     VkShaderStageFlags pushStageFlags = nativeFormat(uboLay.pb.stage);
     if(uboLay.msHelper!=VK_NULL_HANDLE) {
@@ -454,7 +517,8 @@ VkPipeline VPipeline::initGraphicsPipeline(VkDevice device, VkPipelineLayout lay
     }
 
   VkPipeline graphicsPipeline=VK_NULL_HANDLE;
-  vkAssert(vkCreateGraphicsPipelines(device,VK_NULL_HANDLE,1,&pipelineInfo,nullptr,&graphicsPipeline));
+  std::shared_lock<std::shared_mutex> guard(cache->sync);
+  vkAssert(vkCreateGraphicsPipelines(device,cache->impl,1,&pipelineInfo,nullptr,&graphicsPipeline));
   return graphicsPipeline;
   }
 
@@ -482,7 +546,8 @@ VCompPipeline::VCompPipeline(VDevice& dev, const VPipelineLay& ulay, const VShad
     info.layout       = pipelineLayout;
     if(ulay.runtimeSized)
       info.flags = VK_PIPELINE_CREATE_ALLOW_DERIVATIVES_BIT;
-    vkAssert(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &impl));
+    std::shared_lock<std::shared_mutex> guard(dev.psoCache.sync);
+    vkAssert(vkCreateComputePipelines(device, dev.psoCache.impl, 1, &info, nullptr, &impl));
     }
   catch(...) {
     vkDestroyPipelineLayout(device,pipelineLayout,nullptr);
@@ -522,7 +587,8 @@ VkPipeline VCompPipeline::instance(VkPipelineLayout pLay) {
     info.flags              = VK_PIPELINE_CREATE_DERIVATIVE_BIT;
     info.basePipelineHandle = impl;
     info.basePipelineIndex  = -1;
-    vkAssert(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &val));
+    std::shared_lock<std::shared_mutex> guard(dev.psoCache.sync);
+    vkAssert(vkCreateComputePipelines(device, dev.psoCache.impl, 1, &info, nullptr, &val));
 
     inst.emplace_back(pLay,val);
     }
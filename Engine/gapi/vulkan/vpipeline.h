@@ -7,7 +7,10 @@
 #include "../utility/dptr.h"
 #include "../utility/spinlock.h"
 #include "gapi/shaderreflection.h"
+#include "gapi/pipelinevariants.h"
 #include "vframebuffermap.h"
+#include "vpipelinecache.h"
+#include "vpipelinecompiler.h"
 #include "vshader.h"
 #include "vulkan_sdk.h"
 
@@ -26,6 +29,11 @@ class VPipeline : public AbstractGraphicsApi::Pipeline {
     ~VPipeline();
 
     struct Inst {
+      enum State : uint8_t {
+        Ready,
+        Pending, // queued to VPipelineCompiler
+        Failed,
+        };
       Inst(VkPipeline val, VkPipelineLayout pLay, size_t stride):val(val),pLay(pLay),stride(stride){}
       Inst(Inst&&)=default;
       Inst& operator = (Inst&&)=default;
@@ -33,6 +41,7 @@ class VPipeline : public AbstractGraphicsApi::Pipeline {
       VkPipeline       val;
       VkPipelineLayout pLay = VK_NULL_HANDLE;
       size_t           stride;
+      State            state = Ready;
       };
 
     VkPipelineLayout   pipelineLayout = VK_NULL_HANDLE;
@@ -40,8 +49,12 @@ class VPipeline : public AbstractGraphicsApi::Pipeline {
     uint32_t           pushSize       = 0;
     uint32_t           defaultStride  = 0;
 
-    VkPipeline         instance(const std::shared_ptr<VFramebufferMap::RenderPass>& lay, VkPipelineLayout pLay, size_t stride);
-    VkPipeline         instance(const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride);
+    // with async=true, missing instance is compiled in background and VK_NULL_HANDLE is returned until it's ready;
+    // instance, that failed in background, is compiled inline on next call, so the error is thrown
+    VkPipeline         instance(const std::shared_ptr<VFramebufferMap::RenderPass>& lay, VkPipelineLayout pLay, size_t stride, bool async = false);
+    VkPipeline         instance(const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride, bool async = false);
+    void               precompile(const std::shared_ptr<VFramebufferMap::RenderPass>& lay);
+    void               precompile(const VkPipelineRenderingCreateInfoKHR& info);
 
     IVec3              workGroupSize() const override;
     bool               isRuntimeSized() const { return runtimeSized; }
@@ -74,6 +87,8 @@ class VPipeline : public AbstractGraphicsApi::Pipeline {
       };
 
     VkDevice                               device=nullptr;
+    VPipelineCache*                        cache=nullptr;
+    VPipelineCompiler*                     compiler=nullptr;
     Tempest::RenderState                   st;
     size_t                                 declSize=0;
     DSharedPtr<const VShader*>             modules[5] = {};
@@ -88,13 +103,21 @@ class VPipeline : public AbstractGraphicsApi::Pipeline {
       };
     MeshEmulation                          ms, ts;
 
-    SpinLock                               sync;
-    std::vector<InstRp>                    instRp;
-    std::vector<InstDr>                    instDr;
+    PipelineVariants<InstRp>               instRp;
+    PipelineVariants<InstDr>               instDr;
 
     const VShader*                         findShader(ShaderReflection::Stage sh) const;
     void                                   cleanup();
 
+    template<class Key, class I>
+    VkPipeline                             implInstance(PipelineVariants<I>& inst, const Key& lay, VkPipelineLayout pLay, size_t stride, bool async);
+    template<class Key, class I>
+    void                                   complete(PipelineVariants<I>& inst, const Key& lay, VkPipelineLayout pLay, size_t stride, VkPipeline val, bool ok);
+    void                                   enqueue(PipelineVariants<InstRp>& inst, const std::shared_ptr<VFramebufferMap::RenderPass>& lay, VkPipelineLayout pLay, size_t stride);
+    void                                   enqueue(PipelineVariants<InstDr>& inst, const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride);
+    VkPipeline                             compile(const std::shared_ptr<VFramebufferMap::RenderPass>& lay, VkPipelineLayout pLay, size_t stride);
+    VkPipeline                             compile(const VkPipelineRenderingCreateInfoKHR& info, VkPipelineLayout pLay, size_t stride);
+
     VkPipeline                   initGraphicsPipeline(VkDevice device, VkPipelineLayout layout,
                                                       const VFramebufferMap::RenderPass* rpLay, const VkPipelineRenderingCreateInfoKHR* dynLay, const RenderState &st,
                                                       const Decl::ComponentType *decl, size_t declSize, size_t stride,
@@ -0,0 +1,112 @@
+#if defined(TEMPEST_BUILD_VULKAN)
+
+#include "vpipelinecache.h"
+
+#include "vdevice.h"
+
+#include <cstring>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+VPipelineCache::~VPipelineCache() {
+  if(impl!=VK_NULL_HANDLE)
+    vkDestroyPipelineCache(device,impl,nullptr);
+  }
+
+void VPipelineCache::init(VDevice& dev) {
+  device = dev.device.impl;
+
+  VkPhysicalDeviceProperties prop = {};
+  vkGetPhysicalDeviceProperties(dev.physicalDevice,&prop);
+  ref.vendorID      = prop.vendorID;
+  ref.deviceID      = prop.deviceID;
+  ref.driverVersion = prop.driverVersion;
+  std::memcpy(ref.uuid,prop.pipelineCacheUUID,VK_UUID_SIZE);
+
+  VkPipelineCacheCreateInfo info = {};
+  info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  vkAssert(vkCreatePipelineCache(device,&info,nullptr,&impl));
+  }
+
+std::vector<uint8_t> VPipelineCache::serialize() {
+  std::shared_lock<std::shared_mutex> guard(sync);
+
+  size_t size = 0;
+  vkAssert(vkGetPipelineCacheData(device,impl,&size,nullptr));
+
+  std::vector<uint8_t> ret(sizeof(Header)+size);
+  // cache may grow between calls; truncated data is still valid
+  VkResult code = vkGetPipelineCacheData(device,impl,&size,ret.data()+sizeof(Header));
+  if(code!=VK_INCOMPLETE)
+    vkAssert(code);
+  ret.resize(sizeof(Header)+size);
+
+  Header h = ref;
+  h.dataSize = size;
+  h.dataHash = hash(ret.data()+sizeof(Header),size);
+  std::memcpy(ret.data(),&h,sizeof(h));
+  return ret;
+  }
+
+bool VPipelineCache::merge(const void* data, size_t size) {
+  if(size<sizeof(Header))
+    return false;
+
+  Header h;
+  std::memcpy(&h,data,sizeof(h));
+  auto blob = reinterpret_cast<const uint8_t*>(data)+sizeof(Header);
+  if(!isCompatible(h) || h.dataSize!=size-sizeof(Header) || h.dataHash!=hash(blob,size_t(h.dataSize)))
+    return false;
+
+  // driver header must agree as well
+  struct {
+    uint32_t headerSize;
+    uint32_t headerVersion;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+    } vk = {};
+  if(h.dataSize<sizeof(vk))
+    return false;
+  std::memcpy(&vk,blob,sizeof(vk));
+  if(vk.headerVersion!=uint32_t(VK_PIPELINE_CACHE_HEADER_VERSION_ONE) || vk.vendorID!=ref.vendorID || vk.deviceID!=ref.deviceID ||
+     std::memcmp(vk.pipelineCacheUUID,ref.uuid,VK_UUID_SIZE)!=0)
+    return false;
+
+  VkPipelineCacheCreateInfo info = {};
+  info.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  info.initialDataSize = size_t(h.dataSize);
+  info.pInitialData    = blob;
+
+  VkPipelineCache src = VK_NULL_HANDLE;
+  if(vkCreatePipelineCache(device,&info,nullptr,&src)!=VK_SUCCESS)
+    return false;
+
+  VkResult ret = VK_SUCCESS;
+  {
+  std::unique_lock<std::shared_mutex> guard(sync);
+  ret = vkMergePipelineCaches(device,impl,1,&src);
+  }
+  vkDestroyPipelineCache(device,src,nullptr);
+  return ret==VK_SUCCESS;
+  }
+
+uint64_t VPipelineCache::hash(const uint8_t* data, size_t size) {
+  // FNV-1a
+  uint64_t h = 0xcbf29ce484222325ull;
+  for(size_t i=0; i<size; ++i) {
+    h ^= data[i];
+    h *= 0x100000001b3ull;
+    }
+  return h;
+  }
+
+bool VPipelineCache::isCompatible(const Header& h) const {
+  return std::memcmp(h.magic,ref.magic,sizeof(h.magic))==0 &&
+         h.version==ref.version &&
+         h.vendorID==ref.vendorID && h.deviceID==ref.deviceID && h.driverVersion==ref.driverVersion &&
+         std::memcmp(h.uuid,ref.uuid,VK_UUID_SIZE)==0;
+  }
+
+#endif
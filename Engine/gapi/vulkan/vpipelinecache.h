@@ -0,0 +1,52 @@
+#pragma once
+
+#include "vulkan_sdk.h"
+
+#include <shared_mutex>
+#include <vector>
+#include <cstdint>
+
+namespace Tempest {
+namespace Detail {
+
+class VDevice;
+
+// Device-wide VkPipelineCache. Serialized blob is prefixed with own header, that binds it to
+// driver version and pipelineCacheUUID, so stale or foreign data is never handed to the driver.
+class VPipelineCache {
+  public:
+    VPipelineCache() = default;
+    VPipelineCache(const VPipelineCache&) = delete;
+    ~VPipelineCache();
+
+    void                 init(VDevice& dev);
+
+    std::vector<uint8_t> serialize();
+    bool                 merge(const void* data, size_t size);
+
+    VkPipelineCache      impl = VK_NULL_HANDLE;
+    // shared: pipeline creation; exclusive: merge
+    std::shared_mutex    sync;
+
+  private:
+    struct Header {
+      char     magic[4]      = {'T','P','S','O'};
+      uint32_t version       = 1;
+      uint64_t dataSize      = 0;
+      uint64_t dataHash      = 0;
+      uint32_t vendorID      = 0;
+      uint32_t deviceID      = 0;
+      uint32_t driverVersion = 0;
+      uint8_t  uuid[VK_UUID_SIZE] = {};
+      uint32_t padding       = 0;
+      };
+
+    static uint64_t      hash(const uint8_t* data, size_t size);
+    bool                 isCompatible(const Header& h) const;
+
+    VkDevice             device = VK_NULL_HANDLE;
+    Header               ref;
+  };
+
+}
+}
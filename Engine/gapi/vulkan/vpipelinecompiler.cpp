@@ -0,0 +1,69 @@
+#if defined(TEMPEST_BUILD_VULKAN)
+
+#include "vpipelinecompiler.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static const size_t MaxCompilerThreads = 4;
+
+VPipelineCompiler::~VPipelineCompiler() {
+  {
+  std::lock_guard<std::mutex> guard(sync);
+  stop = true;
+  queue.clear();
+  }
+  work.notify_all();
+  for(auto& i:th)
+    i.join();
+  }
+
+void VPipelineCompiler::push(const void* owner, std::function<void()> fn) {
+  {
+  std::lock_guard<std::mutex> guard(sync);
+  if(th.empty()) {
+    // leave one core to the recording thread
+    const size_t hw  = std::thread::hardware_concurrency();
+    const size_t cnt = std::clamp<size_t>(hw>1 ? hw-1 : 1, 1, MaxCompilerThreads);
+    for(size_t i=0; i<cnt; ++i)
+      th.emplace_back(&VPipelineCompiler::worker,this);
+    }
+  queue.push_back(Job{owner,std::move(fn)});
+  }
+  work.notify_one();
+  }
+
+void VPipelineCompiler::cancel(const void* owner) {
+  std::unique_lock<std::mutex> guard(sync);
+  queue.erase(std::remove_if(queue.begin(),queue.end(),[owner](const Job& j){ return j.owner==owner; }),
+              queue.end());
+  done.wait(guard,[this,owner](){ return !isRunning(owner); });
+  }
+
+bool VPipelineCompiler::isRunning(const void* owner) const {
+  return std::find(running.begin(),running.end(),owner)!=running.end();
+  }
+
+void VPipelineCompiler::worker() {
+  std::unique_lock<std::mutex> guard(sync);
+  while(true) {
+    work.wait(guard,[this](){ return stop || !queue.empty(); });
+    if(stop)
+      return;
+
+    Job job = std::move(queue.front());
+    queue.pop_front();
+    running.push_back(job.owner);
+
+    guard.unlock();
+    job.fn();
+    guard.lock();
+
+    running.erase(std::find(running.begin(),running.end(),job.owner));
+    done.notify_all();
+    }
+  }
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+// Small worker pool for background pipeline compilation. Threads are started on first use.
+class VPipelineCompiler {
+  public:
+    VPipelineCompiler() = default;
+    VPipelineCompiler(const VPipelineCompiler&) = delete;
+    ~VPipelineCompiler();
+
+    void push(const void* owner, std::function<void()> fn);
+    // drops queued jobs of `owner` and waits for running ones; must be called before owner is destroyed
+    void cancel(const void* owner);
+
+  private:
+    struct Job {
+      const void*           owner = nullptr;
+      std::function<void()> fn;
+      };
+
+    void worker();
+    bool isRunning(const void* owner) const;
+
+    std::mutex               sync;
+    std::condition_variable  work;
+    std::condition_variable  done;
+    std::deque<Job>          queue;
+    std::vector<const void*> running;
+    std::vector<std::thread> th;
+    bool                     stop = false;
+  };
+
+}
+}
@@ -38,18 +38,26 @@ VPipelineLay::VPipelineLay(VDevice& dev, const std::vector<ShaderReflection::Bin
     runtimeArrays.resize(lay.size());
   impl = createDescLayout(runtimeArrays);
 
-  if(needMsHelper) {
-    try {
+  try {
+    if(needMsHelper)
       msHelper = createMsHelper();
-      }
-    catch(...) {
-      vkDestroyDescriptorSetLayout(dev.device.impl,impl,nullptr);
-      throw;
-      }
+    if(!runtimeSized)
+      createUpdTemplate();
+    }
+  catch(...) {
+    if(msHelper!=VK_NULL_HANDLE)
+      vkDestroyDescriptorSetLayout(dev.device.impl,msHelper,nullptr);
+    vkDestroyDescriptorSetLayout(dev.device.impl,impl,nullptr);
+    throw;
     }
   }
 
 VPipelineLay::~VPipelineLay() {
+  // descriptor sets are released along with pools
+  for(auto& i:idleSets)
+    dev.descRefs.unlink(i,i.refs.data(),i.refs.size());
+  if(updTemplate!=VK_NULL_HANDLE)
+    dev.vkDestroyDescriptorUpdateTemplate(dev.device.impl,updTemplate,nullptr);
   for(auto& i:pool)
     vkDestroyDescriptorPool(dev.device.impl,i.impl,nullptr);
   if(msHelper!=VK_NULL_HANDLE)
@@ -174,6 +182,40 @@ VkDescriptorSetLayout VPipelineLay::createMsHelper() const {
   return ret;
   }
 
+void VPipelineLay::createUpdTemplate() {
+  descOffset.resize(lay.size());
+  SmallArray<VkDescriptorUpdateTemplateEntryKHR,32> entry(lay.size());
+
+  uint32_t count = 0;
+  for(size_t i=0; i<lay.size(); ++i) {
+    auto& e = lay[i];
+    descOffset[i] = descCount;
+    if(e.stage==ShaderReflection::Stage(0) || e.cls==ShaderReflection::Push || e.arraySize==0)
+      continue;
+
+    auto& en = entry[count];
+    en.dstBinding      = e.layout;
+    en.dstArrayElement = 0;
+    en.descriptorCount = e.arraySize;
+    en.descriptorType  = nativeFormat(e.cls);
+    en.offset          = descCount*sizeof(Descriptor);
+    en.stride          = sizeof(Descriptor);
+    descCount += e.arraySize;
+    ++count;
+    }
+
+  if(!dev.props.hasDescUpdTemplate || count==0)
+    return;
+
+  VkDescriptorUpdateTemplateCreateInfoKHR info = {};
+  info.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+  info.descriptorUpdateEntryCount = count;
+  info.pDescriptorUpdateEntries   = entry.get();
+  info.templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+  info.descriptorSetLayout        = impl;
+  vkAssert(dev.vkCreateDescriptorUpdateTemplate(dev.device.impl,&info,nullptr,&updTemplate));
+  }
+
 void VPipelineLay::adjustSsboBindings() {
   for(auto& i:lay) {
     if(i.byteSize==0) {
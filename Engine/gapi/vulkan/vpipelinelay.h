@@ -4,8 +4,10 @@
 #include <Tempest/PipelineLayout>
 
 #include "vulkan_sdk.h"
+#include <atomic>
 #include <mutex>
 #include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "gapi/shaderreflection.h"
@@ -34,6 +36,16 @@ class VPipelineLay : public AbstractGraphicsApi::PipelineLay {
       VkPipelineLayout      pLay = VK_NULL_HANDLE;
       };
 
+    // one array element of descriptor set content, as consumed by update template
+    union Descriptor {
+      VkDescriptorImageInfo      image;
+      VkDescriptorBufferInfo     buffer;
+      VkAccelerationStructureKHR tlas;
+      };
+
+    // descriptor sets, shared by all VDescriptorArray with same content
+    struct CachedSet;
+
     size_t                descriptorsCount() override;
     size_t                sizeofBuffer(size_t layoutBind, size_t arraylen) const override;
 
@@ -47,10 +59,16 @@ class VPipelineLay : public AbstractGraphicsApi::PipelineLay {
     ShaderReflection::PushBlock pb;
     bool                        runtimeSized = false;
 
+    // location of each binding in flat descriptor data; not used for runtime-sized layouts
+    std::vector<uint32_t>         descOffset;
+    uint32_t                      descCount   = 0;
+    VkDescriptorUpdateTemplateKHR updTemplate = VK_NULL_HANDLE;
+
   private:
     enum {
       POOL_SIZE    = 512,
       // MAX_BINDLESS = 4096,
+      IDLE_SETS    = 128,
       };
 
     struct Pool {
@@ -62,19 +80,36 @@ class VPipelineLay : public AbstractGraphicsApi::PipelineLay {
       std::vector<uint32_t> runtimeArrays;
       };
 
+    using CacheIt = std::list<CachedSet>::iterator;
+
     Detail::SpinLock sync;
     std::list<Pool>  pool;
+    std::list<CachedSet> liveSets;
+    std::list<CachedSet> idleSets; // most recently used first
+    std::unordered_multimap<uint64_t,CacheIt> setIndex;
 
     Detail::SpinLock  syncLay;
     std::vector<DLay> dedicatedLay;
 
     VkDescriptorSetLayout createDescLayout(const std::vector<uint32_t>& runtimeArrays) const;
     VkDescriptorSetLayout createMsHelper() const;
+    void                  createUpdTemplate();
 
     void                  adjustSsboBindings();
 
   friend class VDescriptorArray;
   };
 
+struct VPipelineLay::CachedSet {
+  VkDescriptorSet         impl  = VK_NULL_HANDLE;
+  Pool*                   pool  = nullptr;
+  uint64_t                hash  = 0;
+  uint32_t                ref   = 0;
+  std::atomic<bool>       stale{false}; // set by VDevice::descRefs, when referenced resource is destroyed
+  std::vector<Descriptor> data;
+  std::vector<uint8_t>    written;
+  std::vector<uint64_t>   refs;         // unique buffer, image-view and tlas handles
+  };
+
 }
 }
@@ -415,6 +415,7 @@ void VSwapchain::present() {
 
   slot.imgId = uint32_t(-1);
   slot.state = S_Idle;
+  device.fboMap.nextFrame();
 
   auto tx = Application::tickCount();
   VkResult code = device.presentQueue->present(presentInfo);
@@ -19,12 +19,21 @@ VTexture::VTexture(VTexture&& other) {
   std::swap(isStorageImage, other.isStorageImage);
   std::swap(is3D,           other.is3D);
   std::swap(isFilterable,   other.isFilterable);
+  std::swap(bindlessId,     other.bindlessId);
   std::swap(extViews,       other.extViews);
   }
 
 VTexture::~VTexture() {
-  if(alloc!=nullptr)
+  if(alloc!=nullptr) {
+    auto& dx = *alloc->device();
+    // views may be reused, while still referenced by cached descriptor set
+    dx.descRefs.invalidate(uint64_t(imgView));
+    for(auto& i:extViews)
+      dx.descRefs.invalidate(uint64_t(i.v));
+    if(bindlessId!=VBindlessHeap::NoId)
+      dx.bindless.release(*this);
     alloc->free(*this);
+    }
   }
 
 VkImageView VTexture::view(const ComponentMapping& m, uint32_t mipLevel, bool is3D) {
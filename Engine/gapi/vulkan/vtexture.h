@@ -39,6 +39,7 @@ class VTexture : public AbstractGraphicsApi::Texture {
     bool                   isStorageImage = false;
     bool                   is3D           = false;
     bool                   isFilterable   = false;
+    uint32_t               bindlessId     = uint32_t(-1);
 
   protected:
     void createViews (VkDevice device);
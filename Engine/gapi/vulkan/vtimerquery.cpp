@@ -0,0 +1,147 @@
+#if defined(TEMPEST_BUILD_VULKAN)
+
+#include "vtimerquery.h"
+
+#include "vdevice.h"
+
+#include <algorithm>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static const VkQueryPipelineStatisticFlags statFlags =
+    VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+VTimerQuery::VTimerQuery(VDevice& dev)
+  :dev(dev) {
+  }
+
+VTimerQuery::~VTimerQuery() {
+  release();
+  }
+
+void VTimerQuery::begin(VkCommandBuffer cmd) {
+  resolve();
+
+  const bool overflow = scopes.isOverflow();
+  if(overflow || (timestamps==VK_NULL_HANDLE && stats==VK_NULL_HANDLE)) {
+    // previous submission is complete at this point - safe to recreate
+    const uint32_t ts = std::max<uint32_t>(InitialCount, overflow ? tsCapacity*2   : 0);
+    const uint32_t st = std::max<uint32_t>(InitialCount, overflow ? statCapacity*2 : 0);
+    release();
+    allocate(ts,st);
+    }
+
+  if(timestamps!=VK_NULL_HANDLE)
+    vkCmdResetQueryPool(cmd,timestamps,0,tsCapacity);
+  if(stats!=VK_NULL_HANDLE)
+    vkCmdResetQueryPool(cmd,stats,0,statCapacity);
+
+  scopes.begin(tsCapacity,statCapacity);
+  }
+
+void VTimerQuery::end(VkCommandBuffer cmd) {
+  scopes.end([this,cmd](uint32_t ts){
+    vkCmdWriteTimestamp(cmd,VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,timestamps,ts);
+    });
+  }
+
+void VTimerQuery::beginScope(VkCommandBuffer cmd, std::string_view name) {
+  const uint32_t ts = scopes.beginScope(name);
+  if(ts!=NoQuery)
+    vkCmdWriteTimestamp(cmd,VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,timestamps,ts);
+  }
+
+void VTimerQuery::endScope(VkCommandBuffer cmd) {
+  const uint32_t ts = scopes.endScope();
+  if(ts!=NoQuery)
+    vkCmdWriteTimestamp(cmd,VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,timestamps,ts);
+  }
+
+void VTimerQuery::beginPass(VkCommandBuffer cmd) {
+  const uint32_t id = scopes.beginPass();
+  if(id!=NoQuery)
+    vkCmdBeginQuery(cmd,stats,id,0);
+  }
+
+void VTimerQuery::endPass(VkCommandBuffer cmd) {
+  const uint32_t id = scopes.endPass();
+  if(id!=NoQuery)
+    vkCmdEndQuery(cmd,stats,id);
+  }
+
+void VTimerQuery::resolve() {
+  result.clear();
+  if(scopes.isEmpty())
+    return;
+
+  // no wait: if results are not there, command buffer was never submitted
+  const uint32_t        tsCount = scopes.timestampCount();
+  std::vector<uint64_t> ts(tsCount);
+  if(tsCount>0) {
+    VkResult code = vkGetQueryPoolResults(dev.device.impl,timestamps,0,tsCount,
+                                          ts.size()*sizeof(uint64_t),ts.data(),sizeof(uint64_t),
+                                          VK_QUERY_RESULT_64_BIT);
+    if(code!=VK_SUCCESS)
+      return;
+    }
+
+  const uint32_t        statCount = scopes.statisticsCount();
+  std::vector<uint64_t> st(statCount*StatCount);
+  bool                  hasStats  = false;
+  if(statCount>0) {
+    VkResult code = vkGetQueryPoolResults(dev.device.impl,stats,0,statCount,
+                                          st.size()*sizeof(uint64_t),st.data(),StatCount*sizeof(uint64_t),
+                                          VK_QUERY_RESULT_64_BIT);
+    hasStats = (code==VK_SUCCESS);
+    }
+
+  const double toMs = double(dev.props.timestampPeriod)*1e-6;
+  scopes.resolve(tsCount>0 ? ts.data() : nullptr, hasStats ? st.data() : nullptr, toMs, result);
+  }
+
+void VTimerQuery::allocate(uint32_t tsCap, uint32_t statCap) {
+  VkDevice device = dev.device.impl;
+
+  if(dev.props.timestampPeriod>0) {
+    VkQueryPoolCreateInfo info = {};
+    info.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+    info.queryCount = tsCap;
+    vkAssert(vkCreateQueryPool(device,&info,nullptr,&timestamps));
+    tsCapacity = tsCap;
+    }
+
+  if(dev.props.hasPipelineStats) {
+    VkQueryPoolCreateInfo info = {};
+    info.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    info.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    info.queryCount         = statCap;
+    info.pipelineStatistics = statFlags;
+    try {
+      vkAssert(vkCreateQueryPool(device,&info,nullptr,&stats));
+      }
+    catch(...) {
+      release();
+      throw;
+      }
+    statCapacity = statCap;
+    }
+  }
+
+void VTimerQuery::release() {
+  VkDevice device = dev.device.impl;
+  if(timestamps!=VK_NULL_HANDLE)
+    vkDestroyQueryPool(device,timestamps,nullptr);
+  if(stats!=VK_NULL_HANDLE)
+    vkDestroyQueryPool(device,stats,nullptr);
+  timestamps   = VK_NULL_HANDLE;
+  stats        = VK_NULL_HANDLE;
+  tsCapacity   = 0;
+  statCapacity = 0;
+  }
+
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+#include "vulkan_sdk.h"
+#include "gapi/gputimerscopes.h"
+
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+class VDevice;
+
+// Timestamp and pipeline-statistics queries of one command buffer.
+// Results are collected on next recording, when previous submission of command buffer is known to be complete.
+class VTimerQuery {
+  public:
+    VTimerQuery(VDevice& dev);
+    VTimerQuery(const VTimerQuery&) = delete;
+    ~VTimerQuery();
+
+    // called at start of new recording, outside of render pass
+    void begin(VkCommandBuffer cmd);
+    // closes scopes left open at the end of recording
+    void end(VkCommandBuffer cmd);
+
+    void beginScope(VkCommandBuffer cmd, std::string_view name);
+    void endScope(VkCommandBuffer cmd);
+
+    void beginPass(VkCommandBuffer cmd);
+    void endPass(VkCommandBuffer cmd);
+
+    const std::vector<GpuTiming>& timings() const { return result; }
+
+  private:
+    enum : uint32_t {
+      NoQuery      = GpuTimerScopes::NoQuery,
+      InitialCount = 64,
+      StatCount    = GpuTimerScopes::StatCount,
+      };
+
+    void resolve();
+    void allocate(uint32_t tsCapacity, uint32_t statCapacity);
+    void release();
+
+    VDevice&                 dev;
+    VkQueryPool              timestamps = VK_NULL_HANDLE;
+    VkQueryPool              stats      = VK_NULL_HANDLE;
+    uint32_t                 tsCapacity   = 0;
+    uint32_t                 statCapacity = 0;
+
+    GpuTimerScopes           scopes;
+    std::vector<GpuTiming>   result;
+  };
+
+}
+}
@@ -275,6 +275,15 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
   if(checkForExt(ext,VK_KHR_MAINTENANCE_1_EXTENSION_NAME)) {
     props.hasMaintenance1 = true;
     }
+  if(hasDeviceFeatures2 && checkForExt(ext,VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+    props.hasMemoryBudget = true;
+    }
+  if(checkForExt(ext,VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME)) {
+    props.hasDescUpdTemplate = true;
+    }
+  if(hasDeviceFeatures2 && checkForExt(ext,VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+    props.hasTimelineSemaphore = true;
+    }
   if(checkForExt(ext,VK_KHR_VULKAN_MEMORY_MODEL_EXTENSION_NAME)) {
     props.memoryModel = true;
     }
@@ -349,6 +358,9 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
     VkPhysicalDeviceVulkanMemoryModelFeatures memoryFeatures = {};
     memoryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_MEMORY_MODEL_FEATURES;
 
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures = {};
+    timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+
     if(props.hasSync2) {
       sync2.pNext = features.pNext;
       features.pNext = &sync2;
@@ -394,6 +406,10 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
       memoryFeatures.pNext = features.pNext;
       features.pNext = &memoryFeatures;
       }
+    if(props.hasTimelineSemaphore) {
+      timelineFeatures.pNext = features.pNext;
+      features.pNext = &timelineFeatures;
+      }
 
     auto vkGetPhysicalDeviceFeatures2   = PFN_vkGetPhysicalDeviceFeatures2  (vkGetInstanceProcAddr(instance,"vkGetPhysicalDeviceFeatures2KHR"));
     auto vkGetPhysicalDeviceProperties2 = PFN_vkGetPhysicalDeviceProperties2(vkGetInstanceProcAddr(instance,"vkGetPhysicalDeviceProperties2KHR"));
@@ -403,6 +419,7 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
 
     props.hasSync2                = (sync2.synchronization2==VK_TRUE);
     props.hasDynRendering         = (dynRendering.dynamicRendering==VK_TRUE);
+    props.hasTimelineSemaphore    = (timelineFeatures.timelineSemaphore==VK_TRUE);
     props.hasDeviceAddress        = (bdaFeatures.bufferDeviceAddress==VK_TRUE);
     props.raytracing.rayQuery     = (rayQueryFeatures.rayQuery==VK_TRUE);
     props.meshlets.taskShader     = (meshFeatures.taskShader==VK_TRUE);
@@ -438,6 +455,9 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
       props.descriptors.nonUniformIndexing &=
         (indexingFeatures.descriptorBindingSampledImageUpdateAfterBind ==VK_TRUE) &&
         (indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind==VK_TRUE);
+      props.descriptors.bindlessHeap = props.descriptors.nonUniformIndexing &&
+        (indexingFeatures.descriptorBindingPartiallyBound           ==VK_TRUE) &&
+        (indexingFeatures.descriptorBindingUpdateUnusedWhilePending==VK_TRUE);
       }
 
     if(indexingFeatures.runtimeDescriptorArray!=VK_FALSE) {
@@ -487,6 +507,9 @@ void VulkanInstance::devicePropsShort(VkPhysicalDevice physicalDevice, VkProp& p
   props.storeAndAtomicVs  = supportedFeatures.vertexPipelineStoresAndAtomics;
   props.storeAndAtomicFs  = supportedFeatures.fragmentStoresAndAtomics;
 
+  props.timestampPeriod   = devP.limits.timestampComputeAndGraphics ? devP.limits.timestampPeriod : 0.f;
+  props.hasPipelineStats  = supportedFeatures.pipelineStatisticsQuery;
+
   props.render.maxColorAttachments  = devP.limits.maxColorAttachments;
   props.render.maxViewportSize.w    = devP.limits.maxViewportDimensions[0];
   props.render.maxViewportSize.h    = devP.limits.maxViewportDimensions[1];
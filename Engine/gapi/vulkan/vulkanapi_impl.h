@@ -27,6 +27,8 @@ class VulkanInstance {
     struct VkProp:Tempest::AbstractGraphicsApi::Props {
       uint32_t graphicsFamily = uint32_t(-1);
       uint32_t presentFamily  = uint32_t(-1);
+      uint32_t transferFamily = uint32_t(-1); // transfer-only family, used for streaming uploads
+      uint32_t computeFamily  = uint32_t(-1); // compute family without graphics, used for async compute
 
       size_t   nonCoherentAtomSize = 0;
       size_t   bufferImageGranularity = 0;
@@ -47,6 +49,12 @@ class VulkanInstance {
       bool     hasRobustness2     = false;
       bool     hasStoreOpNone     = false;
       bool     hasMaintenance1    = false;
+      bool     hasMemoryBudget    = false;
+      bool     hasDescUpdTemplate = false;
+      bool     hasTimelineSemaphore = false;
+
+      float    timestampPeriod    = 0; // nanoseconds per tick; 0, if timestamps are not supported
+      bool     hasPipelineStats   = false;
       };
 
     static bool checkForExt(const std::vector<VkExtensionProperties>& list, const char* name);
@@ -0,0 +1,161 @@
+#if defined(TEMPEST_BUILD_VULKAN)
+
+#include "vuploadcommandbuffer.h"
+
+#include "vdevice.h"
+#include "vbuffer.h"
+#include "vtexture.h"
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+VUploadCommandBuffer::VUploadCommandBuffer(VDevice& device)
+  :VCommandBuffer(device) {
+  }
+
+VUploadCommandBuffer::~VUploadCommandBuffer() {
+  if(xfer!=VK_NULL_HANDLE)
+    vkFreeCommandBuffers(device.device.impl,xferPool->impl,1,&xfer);
+  }
+
+void VUploadCommandBuffer::begin(bool tranfer) {
+  streaming = false;
+  buffers.clear();
+  images.clear();
+  VCommandBuffer::begin(tranfer);
+  }
+
+void VUploadCommandBuffer::end() {
+  if(streaming) {
+    ownershipBarrier(xfer,true);
+    vkAssert(vkEndCommandBuffer(xfer));
+    ownershipBarrier(impl,false);
+    }
+  VCommandBuffer::end();
+  }
+
+void VUploadCommandBuffer::beginStreaming() {
+  begin(true);
+
+  if(xferPool==nullptr)
+    xferPool.reset(new VCommandPool(device,VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,device.transferQueue->family));
+  if(xfer==VK_NULL_HANDLE) {
+    VkCommandBufferAllocateInfo allocInfo = {};
+    allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool        = xferPool->impl;
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = 1;
+    vkAssert(vkAllocateCommandBuffers(device.device.impl,&allocInfo,&xfer));
+    }
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkAssert(vkBeginCommandBuffer(xfer,&beginInfo));
+  streaming = true;
+  }
+
+void VUploadCommandBuffer::streamCopy(VBuffer& dst, size_t offsetDest, const VBuffer& src, size_t offsetSrc, size_t size) {
+  VkBufferCopy copyRegion = {};
+  copyRegion.srcOffset = offsetSrc;
+  copyRegion.dstOffset = offsetDest;
+  copyRegion.size      = size;
+  vkCmdCopyBuffer(xfer,src.impl,dst.impl,1,&copyRegion);
+
+  for(auto i:buffers)
+    if(i==dst.impl)
+      return;
+  buffers.push_back(dst.impl);
+  }
+
+void VUploadCommandBuffer::streamCopy(VTexture& dst, uint32_t width, uint32_t height, uint32_t mip,
+                                      const VBuffer& src, size_t offset) {
+  bool known = false;
+  for(auto& i:images)
+    if(i.impl==dst.impl)
+      known = true;
+
+  if(!known) {
+    // content of fresh image is undefined: whole image goes to transfer layout
+    VkImageMemoryBarrier bx = {};
+    bx.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    bx.srcAccessMask                   = 0;
+    bx.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bx.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+    bx.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    bx.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    bx.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    bx.image                           = dst.impl;
+    bx.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    bx.subresourceRange.baseMipLevel   = 0;
+    bx.subresourceRange.levelCount     = dst.mipCnt;
+    bx.subresourceRange.baseArrayLayer = 0;
+    bx.subresourceRange.layerCount     = 1;
+    vkCmdPipelineBarrier(xfer,VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0,nullptr, 0,nullptr, 1,&bx);
+
+    Image img;
+    img.impl   = dst.impl;
+    img.mipCnt = dst.mipCnt;
+    images.push_back(img);
+    }
+
+  VkBufferImageCopy region = {};
+  region.bufferOffset                    = offset;
+  region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel       = mip;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount     = 1;
+  region.imageOffset                     = {0, 0, 0};
+  region.imageExtent                     = {width, height, 1};
+  vkCmdCopyBufferToImage(xfer,src.impl,dst.impl,VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,1,&region);
+  }
+
+void VUploadCommandBuffer::ownershipBarrier(VkCommandBuffer cmd, bool release) {
+  // release and acquire halves must describe the same transition
+  // https://registry.khronos.org/vulkan/specs/1.3-extensions/html/vkspec.html#synchronization-queue-transfers
+  const uint32_t srcFamily = device.transferQueue->family;
+  const uint32_t dstFamily = device.graphicsQueue->family;
+
+  SmallArray<VkBufferMemoryBarrier,32> bb(buffers.size());
+  for(size_t i=0; i<buffers.size(); ++i) {
+    auto& b = bb[i];
+    b = {};
+    b.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    b.srcAccessMask       = release ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+    b.dstAccessMask       = release ? 0 : (VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT);
+    b.srcQueueFamilyIndex = srcFamily;
+    b.dstQueueFamilyIndex = dstFamily;
+    b.buffer              = buffers[i];
+    b.offset              = 0;
+    b.size                = VK_WHOLE_SIZE;
+    }
+
+  SmallArray<VkImageMemoryBarrier,32> ib(images.size());
+  for(size_t i=0; i<images.size(); ++i) {
+    auto& b = ib[i];
+    b = {};
+    b.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    b.srcAccessMask                   = release ? VK_ACCESS_TRANSFER_WRITE_BIT : 0;
+    b.dstAccessMask                   = release ? 0 : VK_ACCESS_SHADER_READ_BIT;
+    b.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    b.newLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    b.srcQueueFamilyIndex             = srcFamily;
+    b.dstQueueFamilyIndex             = dstFamily;
+    b.image                           = images[i].impl;
+    b.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    b.subresourceRange.baseMipLevel   = 0;
+    b.subresourceRange.levelCount     = images[i].mipCnt;
+    b.subresourceRange.baseArrayLayer = 0;
+    b.subresourceRange.layerCount     = 1;
+    }
+
+  const VkPipelineStageFlags srcStage = release ? VK_PIPELINE_STAGE_TRANSFER_BIT       : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+  const VkPipelineStageFlags dstStage = release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+  vkCmdPipelineBarrier(cmd,srcStage,dstStage,0,
+                       0,nullptr,
+                       uint32_t(buffers.size()),bb.get(),
+                       uint32_t(images.size()), ib.get());
+  }
+
+#endif
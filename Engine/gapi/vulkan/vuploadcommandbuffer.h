@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+#include "vulkan_sdk.h"
+
+#include "vcommandbuffer.h"
+#include "vcommandpool.h"
+
+#include <memory>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+class VDevice;
+class VBuffer;
+class VTexture;
+
+// Command buffer of UploadEngine. In streaming mode, copies are recorded for dedicated transfer queue,
+// while this command buffer only acquires ownership of uploaded resources on graphics queue.
+// Streaming is meant for freshly created resources: no ownership is released by graphics queue.
+class VUploadCommandBuffer:public VCommandBuffer {
+  public:
+    explicit VUploadCommandBuffer(VDevice& device);
+    ~VUploadCommandBuffer();
+
+    void begin(bool tranfer) override;
+    void end() override;
+
+    void beginStreaming();
+    void streamCopy(VBuffer&  dst, size_t offsetDest, const VBuffer& src, size_t offsetSrc, size_t size);
+    void streamCopy(VTexture& dst, uint32_t width, uint32_t height, uint32_t mip, const VBuffer& src, size_t offset);
+
+    bool            isStreaming() const { return streaming; }
+    VkCommandBuffer transferCmd() const { return xfer; }
+
+  private:
+    struct Image {
+      VkImage  impl   = VK_NULL_HANDLE;
+      uint32_t mipCnt = 0;
+      };
+
+    void ownershipBarrier(VkCommandBuffer cmd, bool release);
+
+    std::unique_ptr<VCommandPool> xferPool;
+    VkCommandBuffer               xfer      = VK_NULL_HANDLE;
+    bool                          streaming = false;
+
+    std::vector<VkBuffer>         buffers;
+    std::vector<Image>            images;
+  };
+
+}}
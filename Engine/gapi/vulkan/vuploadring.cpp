@@ -0,0 +1,167 @@
+#if defined(TEMPEST_BUILD_VULKAN)
+
+#include "vuploadring.h"
+
+#include "vdevice.h"
+#include "vbuffer.h"
+
+#include <cstring>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+VUploadRing::VUploadRing(VDevice& dev)
+  :dev(dev) {
+  }
+
+VUploadRing::~VUploadRing() {
+  for(auto& i:inflight)
+    i.cmd->wait();
+  inflight.clear();
+
+  VkDevice device = dev.device.impl;
+  if(mapped!=nullptr)
+    vkUnmapMemory(device,memory);
+  if(buf!=VK_NULL_HANDLE)
+    vkDestroyBuffer(device,buf,nullptr);
+  if(memory!=VK_NULL_HANDLE)
+    vkFreeMemory(device,memory,nullptr);
+  }
+
+void VUploadRing::init() {
+  VkDevice device = dev.device.impl;
+
+  VkBufferCreateInfo createInfo = {};
+  createInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  createInfo.size        = Capacity;
+  createInfo.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  vkAssert(vkCreateBuffer(device,&createInfo,nullptr,&buf));
+
+  try {
+    VkMemoryRequirements rq = {};
+    vkGetBufferMemoryRequirements(device,buf,&rq);
+
+    // coherent memory: no explicit flush of written ranges
+    auto type = dev.memoryTypeIndex(rq.memoryTypeBits,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                    VK_IMAGE_TILING_LINEAR);
+    if(type.typeId==uint32_t(-1))
+      throw std::system_error(Tempest::GraphicsErrc::OutOfVideoMemory);
+
+    VkMemoryAllocateInfo info = {};
+    info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    info.allocationSize  = rq.size;
+    info.memoryTypeIndex = type.typeId;
+    vkAssert(vkAllocateMemory(device,&info,nullptr,&memory));
+    vkAssert(vkBindBufferMemory(device,buf,memory,0));
+
+    void* ptr = nullptr;
+    vkAssert(vkMapMemory(device,memory,0,VK_WHOLE_SIZE,0,&ptr));
+    mapped = reinterpret_cast<uint8_t*>(ptr);
+    }
+  catch(...) {
+    if(memory!=VK_NULL_HANDLE)
+      vkFreeMemory(device,memory,nullptr);
+    vkDestroyBuffer(device,buf,nullptr);
+    buf    = VK_NULL_HANDLE;
+    memory = VK_NULL_HANDLE;
+    throw;
+    }
+  }
+
+bool VUploadRing::push(VBuffer& dst, size_t offset, const void* data, size_t size) {
+  if(size>MaxUpload)
+    return false;
+
+  std::lock_guard<std::mutex> guard(sync);
+  if(buf==VK_NULL_HANDLE)
+    init();
+
+  const size_t sz = ((size+Alignment-1)/Alignment)*Alignment;
+  uint64_t     at = head;
+  if(at%Capacity+sz>Capacity)
+    at += Capacity-at%Capacity; // keep upload contiguous
+
+  while(at+sz-oldest()>Capacity) {
+    // wrapped onto in-flight data
+    if(inflight.empty())
+      flushLocked();
+    retire(true);
+    }
+
+  std::memcpy(mapped+at%Capacity,data,size);
+
+  if(pending.empty())
+    pendingBegin = at;
+  Pending p;
+  p.dst       = BufPtr(&dst);
+  p.dstOffset = offset;
+  p.srcOffset = size_t(at%Capacity);
+  p.size      = size;
+  pending.emplace_back(std::move(p));
+
+  head = at+sz;
+  return true;
+  }
+
+void VUploadRing::flush() {
+  std::lock_guard<std::mutex> guard(sync);
+  flushLocked();
+  }
+
+void VUploadRing::flushLocked() {
+  retire(false);
+  if(pending.empty())
+    return;
+
+  std::unique_ptr<Commands> cmd;
+  if(!spare.empty()) {
+    cmd = std::move(spare.back());
+    spare.pop_back();
+    } else {
+    cmd.reset(new Commands(dev));
+    }
+
+  cmd->begin(true);
+  for(auto& i:pending) {
+    cmd->hold(i.dst); // NOTE: VBuffer may be deleted, before copy is finished
+    cmd->copy(*i.dst.handler,i.dstOffset,buf,i.srcOffset,i.size);
+    }
+  cmd->end();
+  dev.submit(*cmd,&cmd->fence);
+
+  Batch b;
+  b.cmd   = std::move(cmd);
+  b.begin = pendingBegin;
+  b.end   = head;
+  inflight.emplace_back(std::move(b));
+  pending.clear();
+  }
+
+void VUploadRing::retire(bool wait) {
+  // wait=true: block on oldest batch only; otherwise release everything that is already complete
+  while(!inflight.empty()) {
+    auto& b = inflight.front();
+    if(wait) {
+      b.cmd->wait();
+      } else {
+      if(!b.cmd->wait(0))
+        return;
+      }
+    spare.emplace_back(std::move(b.cmd));
+    inflight.pop_front();
+    if(wait)
+      return;
+    }
+  }
+
+uint64_t VUploadRing::oldest() const {
+  if(!inflight.empty())
+    return inflight.front().begin;
+  if(!pending.empty())
+    return pendingBegin;
+  return head;
+  }
+
+#endif
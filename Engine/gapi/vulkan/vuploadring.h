@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Tempest/AbstractGraphicsApi>
+#include "vulkan_sdk.h"
+
+#include "gapi/uploadengine.h"
+#include "vcommandbuffer.h"
+#include "vfence.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace Tempest {
+namespace Detail {
+
+class VDevice;
+class VBuffer;
+
+// Persistently mapped staging ring for small buffer updates.
+// Updates are copied into the ring and recorded as one transfer batch, on next Device::submit;
+// ring only stalls, if it wraps onto a batch, that is still in flight.
+class VUploadRing {
+  public:
+    explicit VUploadRing(VDevice& dev);
+    VUploadRing(const VUploadRing&) = delete;
+    ~VUploadRing();
+
+    // false, if upload is too large for the ring; caller has to use dedicated staging buffer
+    bool push(VBuffer& dst, size_t offset, const void* data, size_t size);
+    void flush();
+
+  private:
+    enum : size_t {
+      Capacity  = 8*1024*1024,
+      MaxUpload = Capacity/4,
+      Alignment = 16,
+      };
+
+    using Commands = TransferCmd<VCommandBuffer,VFence>;
+    using BufPtr   = Detail::DSharedPtr<AbstractGraphicsApi::Buffer*>;
+
+    struct Pending {
+      BufPtr   dst;
+      size_t   dstOffset = 0;
+      size_t   srcOffset = 0;
+      size_t   size      = 0;
+      };
+
+    struct Batch {
+      std::unique_ptr<Commands> cmd;
+      uint64_t                  begin = 0;
+      uint64_t                  end   = 0;
+      };
+
+    void     init();
+    void     flushLocked();
+    void     retire(bool wait);
+    uint64_t oldest() const;
+
+    VDevice&                  dev;
+    std::mutex                sync;
+
+    VkBuffer                  buf    = VK_NULL_HANDLE;
+    VkDeviceMemory            memory = VK_NULL_HANDLE;
+    uint8_t*                  mapped = nullptr;
+
+    // offsets are monotonic; physical offset is `x%Capacity`
+    uint64_t                  head         = 0;
+    uint64_t                  pendingBegin = 0;
+    std::vector<Pending>      pending;
+    std::deque<Batch>         inflight;
+    std::vector<std::unique_ptr<Commands>> spare;
+  };
+
+}
+}
@@ -23,6 +23,8 @@
 #include <Tempest/Application>
 
 #include <libspirv/libspirv.h>
+#include <cstring>
+#include <algorithm>
 
 using namespace Tempest;
 using namespace Tempest::Detail;
@@ -126,8 +128,8 @@ AbstractGraphicsApi::PBuffer VulkanApi::createBuffer(AbstractGraphicsApi::Device
     return PBuffer(new VBuffer(std::move(buf)));
     }
 
-  DSharedPtr<Buffer*> pbuf(new VBuffer(std::move(buf)));
-  pbuf.handler->update(mem,0,size);
+  DSharedPtr<VBuffer*> pbuf(new VBuffer(std::move(buf)));
+  pbuf.handler->initialize(mem,size);
   return PBuffer(pbuf.handler);
   }
 
@@ -143,19 +145,32 @@ AbstractGraphicsApi::PTexture VulkanApi::createTexture(AbstractGraphicsApi::Devi
   Detail::DSharedPtr<Buffer*>  pstage(new Detail::VBuffer (std::move(stage)));
   Detail::DSharedPtr<Texture*> pbuf  (new Detail::VTexture(std::move(buf)));
 
+  auto& nSrc = *reinterpret_cast<Detail::VBuffer*> (pstage.handler);
+  auto& nDst = *reinterpret_cast<Detail::VTexture*>(pbuf.handler);
+
+  // mip generation requires blit on graphics queue; anything else is copied by transfer queue
+  const bool stream = (dx.transferQueue!=nullptr) && (isCompressedFormat(frm) || mipCnt==1);
+
   auto cmd = dx.dataMgr().get();
-  cmd->begin();
+  if(stream)
+    cmd->beginStreaming(); else
+    cmd->begin();
   cmd->hold(pstage);
   cmd->hold(pbuf);
 
-  if(isCompressedFormat(frm)) {
-    cmd->barrier(*pbuf.handler, ResourceAccess::None, ResourceAccess::TransferDst, uint32_t(-1));
+  if(stream && !isCompressedFormat(frm)) {
+    cmd->streamCopy(nDst,uint32_t(p.w()),uint32_t(p.h()),0,nSrc,0);
+    } else if(isCompressedFormat(frm)) {
+    if(!stream)
+      cmd->barrier(*pbuf.handler, ResourceAccess::None, ResourceAccess::TransferDst, uint32_t(-1));
     size_t blockSize  = Pixmap::blockSizeForFormat(frm);
     size_t bufferSize = 0;
 
     uint32_t w = uint32_t(p.w()), h = uint32_t(p.h());
     for(uint32_t i=0; i<mipCnt; i++){
-      cmd->copy(*pbuf.handler,w,h,i,*pstage.handler,bufferSize);
+      if(stream)
+        cmd->streamCopy(nDst,w,h,i,nSrc,bufferSize); else
+        cmd->copy(*pbuf.handler,w,h,i,*pstage.handler,bufferSize);
 
       Size bsz   = Pixmap::blockCount(frm,w,h);
       bufferSize += bsz.w*bsz.h*blockSize;
@@ -163,7 +178,8 @@ AbstractGraphicsApi::PTexture VulkanApi::createTexture(AbstractGraphicsApi::Devi
       h = std::max<uint32_t>(1,h/2);
       }
 
-    cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
+    if(!stream)
+      cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
     } else {
     cmd->barrier(*pbuf.handler, ResourceAccess::None, ResourceAccess::TransferDst, uint32_t(-1));
     cmd->copy(*pbuf.handler,p.w(),p.h(),0,*pstage.handler,0);
@@ -226,6 +242,110 @@ AbstractGraphicsApi::PTexture VulkanApi::createStorage(Device* d,
   return PTexture(pbuf.handler);
   }
 
+void VulkanApi::updateTexture(AbstractGraphicsApi::Device* d, PTexture& t, const Pixmap& p, const Rect* rgn, size_t rgnCount) {
+  if(rgnCount==0)
+    return;
+  if(isCompressedFormat(p.format()) || t.handler->mipCount()>1) {
+    AbstractGraphicsApi::updateTexture(d,t,p,rgn,rgnCount);
+    return;
+    }
+
+  Detail::VDevice& dx  = *reinterpret_cast<Detail::VDevice*>(d);
+  const size_t     bpp = p.bpp();
+  const size_t     row = p.w()*bpp;
+
+  // pack all regions into a single staging buffer; offsets are aligned to texel size and 4
+  std::vector<size_t> offset(rgnCount);
+  size_t              size = 0;
+  for(size_t i=0; i<rgnCount; ++i) {
+    offset[i] = size;
+    size     += ((size_t(rgn[i].w)*size_t(rgn[i].h)*bpp + 15)/16)*16;
+    }
+
+  std::unique_ptr<uint8_t[]> packed(new uint8_t[size]);
+  auto src = reinterpret_cast<const uint8_t*>(p.data());
+  for(size_t i=0; i<rgnCount; ++i) {
+    auto&        r  = rgn[i];
+    const size_t rw = size_t(r.w)*bpp;
+    for(int y=0; y<r.h; ++y)
+      std::memcpy(packed.get()+offset[i]+size_t(y)*rw, src+size_t(r.y+y)*row+size_t(r.x)*bpp, rw);
+    }
+
+  Detail::VBuffer  stage = dx.dataMgr().allocStagingMemory(packed.get(),size,MemUsage::TransferSrc,BufferHeap::Upload);
+  Detail::VTexture buf   = dx.allocator.alloc(p,1,Detail::nativeFormat(p.format()));
+
+  Detail::DSharedPtr<Buffer*>  pstage(new Detail::VBuffer (std::move(stage)));
+  Detail::DSharedPtr<Texture*> pbuf  (new Detail::VTexture(std::move(buf)));
+
+  // copy-on-write: frames in flight keep sampling previous texture, so new one is a GPU-side copy with regions patched
+  auto cmd = dx.dataMgr().get();
+  cmd->begin();
+  cmd->hold(pstage);
+  cmd->hold(pbuf);
+  cmd->hold(t);
+  cmd->barrier(*t.handler,    ResourceAccess::Sampler, ResourceAccess::TransferSrc, uint32_t(-1));
+  cmd->barrier(*pbuf.handler, ResourceAccess::None,    ResourceAccess::TransferDst, uint32_t(-1));
+  cmd->copy(*pbuf.handler, 0, 0, *t.handler, 0, 0, size_t(p.w()), size_t(p.h()), 0);
+  cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::TransferDst, uint32_t(-1));
+  for(size_t i=0; i<rgnCount; ++i) {
+    auto& r = rgn[i];
+    cmd->copy(*pbuf.handler, size_t(r.x), size_t(r.y), size_t(r.w), size_t(r.h), 0, *pstage.handler, offset[i]);
+    }
+  cmd->barrier(*t.handler,    ResourceAccess::TransferSrc, ResourceAccess::Sampler, uint32_t(-1));
+  cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
+  cmd->end();
+
+  // previous texture is released, once commands submitted before this upload are complete
+  dx.retire(t);
+  t = PTexture(pbuf.handler);
+  dx.dataMgr().submit(std::move(cmd));
+  }
+
+AbstractGraphicsApi::PTexture VulkanApi::composeTexture(Device* d, const Pixmap& p, const TextureCopy* cp, size_t cpCount) {
+  if(isCompressedFormat(p.format()))
+    return AbstractGraphicsApi::composeTexture(d,p,cp,cpCount);
+
+  Detail::VDevice&             dx = *reinterpret_cast<Detail::VDevice*>(d);
+  Detail::VTexture             buf = dx.allocator.alloc(p,1,Detail::nativeFormat(p.format()));
+  Detail::DSharedPtr<Texture*> pbuf(new Detail::VTexture(std::move(buf)));
+
+  std::vector<PTexture> src;
+  for(size_t i=0; i<cpCount; ++i) {
+    auto& s = cp[i].src;
+    if(std::find_if(src.begin(),src.end(),[&s](const PTexture& t){ return t.handler==s.handler; })==src.end())
+      src.push_back(s);
+    }
+
+  auto cmd = dx.dataMgr().get();
+  cmd->begin();
+  cmd->hold(pbuf);
+  cmd->barrier(*pbuf.handler, ResourceAccess::None, ResourceAccess::TransferDst, uint32_t(-1));
+  cmd->fill(*pbuf.handler, 0);
+  cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::TransferDst, uint32_t(-1));
+  for(auto& s:src) {
+    cmd->hold(s);
+    cmd->barrier(*s.handler, ResourceAccess::Sampler, ResourceAccess::TransferSrc, uint32_t(-1));
+    }
+  for(size_t i=0; i<cpCount; ++i) {
+    auto& c = cp[i];
+    cmd->copy(*pbuf.handler, size_t(c.at.x), size_t(c.at.y), *c.src.handler, size_t(c.rgn.x), size_t(c.rgn.y),
+              size_t(c.rgn.w), size_t(c.rgn.h), 0);
+    }
+  for(auto& s:src)
+    cmd->barrier(*s.handler, ResourceAccess::TransferSrc, ResourceAccess::Sampler, uint32_t(-1));
+  cmd->barrier(*pbuf.handler, ResourceAccess::TransferDst, ResourceAccess::Sampler, uint32_t(-1));
+  cmd->end();
+  dx.dataMgr().submit(std::move(cmd));
+
+  return PTexture(pbuf.handler);
+  }
+
+void VulkanApi::retireTexture(Device* d, PTexture& t) {
+  auto& dx = *reinterpret_cast<Detail::VDevice*>(d);
+  dx.retire(t);
+  t = PTexture();
+  }
+
 AbstractGraphicsApi::AccelerationStructure* VulkanApi::createBottomAccelerationStruct(Device* d, const RtGeometry* geom, size_t size) {
   auto& dx = *reinterpret_cast<VDevice*>(d);
   return new VAccelerationStructure(dx, geom, size);
@@ -291,6 +411,13 @@ AbstractGraphicsApi::CommandBuffer* VulkanApi::createCommandBuffer(AbstractGraph
   return new Detail::VCommandBuffer(*dx);
   }
 
+AbstractGraphicsApi::CommandBuffer* VulkanApi::createComputeCommandBuffer(AbstractGraphicsApi::Device* d) {
+  Detail::VDevice* dx=reinterpret_cast<Detail::VDevice*>(d);
+  if(dx->computeQueue==nullptr)
+    return createCommandBuffer(d);
+  return new Detail::VComputeCommandBuffer(*dx);
+  }
+
 void VulkanApi::present(Device*, Swapchain *sw) {
   Detail::VSwapchain* sx=reinterpret_cast<Detail::VSwapchain*>(sw);
   sx->present();
@@ -300,7 +427,33 @@ void VulkanApi::submit(Device *d, CommandBuffer* cmd, Fence *sync) {
   Detail::VDevice&        dx    = *reinterpret_cast<Detail::VDevice*>(d);
   Detail::VCommandBuffer& cx    = *reinterpret_cast<Detail::VCommandBuffer*>(cmd);
   auto*                   fence =  reinterpret_cast<Detail::VFence*>(sync);
-  dx.submit(cx,fence);
+  // batched buffer updates go first
+  dx.uploadRing.flush();
+  if(cx.isAsyncCompute())
+    dx.submit(reinterpret_cast<Detail::VComputeCommandBuffer&>(cx),fence); else
+    dx.submit(cx,fence);
+  }
+
+uint64_t VulkanApi::submitAsync(Device* d, CommandBuffer* cmd, Fence* sync) {
+  Detail::VDevice&        dx    = *reinterpret_cast<Detail::VDevice*>(d);
+  Detail::VCommandBuffer& cx    = *reinterpret_cast<Detail::VCommandBuffer*>(cmd);
+  auto*                   fence =  reinterpret_cast<Detail::VFence*>(sync);
+  dx.uploadRing.flush();
+  if(!cx.isAsyncCompute()) {
+    dx.submit(cx,fence);
+    return 0;
+    }
+  return dx.submitAsync(reinterpret_cast<Detail::VComputeCommandBuffer&>(cx),fence);
+  }
+
+void VulkanApi::submit(Device* d, CommandBuffer* cmd, uint64_t wait, Fence* sync) {
+  Detail::VDevice&        dx    = *reinterpret_cast<Detail::VDevice*>(d);
+  Detail::VCommandBuffer& cx    = *reinterpret_cast<Detail::VCommandBuffer*>(cmd);
+  auto*                   fence =  reinterpret_cast<Detail::VFence*>(sync);
+  dx.uploadRing.flush();
+  if(cx.isAsyncCompute())
+    dx.submit(reinterpret_cast<Detail::VComputeCommandBuffer&>(cx),fence); else
+    dx.submit(cx,fence,wait);
   }
 
 void VulkanApi::getCaps(Device *d, Props& props) {
@@ -308,4 +461,85 @@ void VulkanApi::getCaps(Device *d, Props& props) {
   props=dx->props;
   }
 
+std::vector<uint8_t> VulkanApi::pipelineCacheData(Device* d) {
+  Detail::VDevice* dx=reinterpret_cast<Detail::VDevice*>(d);
+  return dx->psoCache.serialize();
+  }
+
+bool VulkanApi::loadPipelineCache(Device* d, const void* data, size_t size) {
+  Detail::VDevice* dx=reinterpret_cast<Detail::VDevice*>(d);
+  return dx->psoCache.merge(data,size);
+  }
+
+void VulkanApi::setAsyncPipelines(Device* d, bool enable) {
+  Detail::VDevice* dx=reinterpret_cast<Detail::VDevice*>(d);
+  dx->asyncPso.store(enable);
+  }
+
+void VulkanApi::precompile(Device* d, Pipeline* p, const TextureFormat* frm, size_t count) {
+  Detail::VDevice*   dx = reinterpret_cast<Detail::VDevice*>(d);
+  Detail::VPipeline* px = reinterpret_cast<Detail::VPipeline*>(p);
+
+  VkFormat native[MaxFramebufferAttachments] = {};
+  for(size_t i=0; i<count; ++i)
+    native[i] = Detail::nativeFormat(frm[i]);
+
+  if(!dx->props.hasDynRendering) {
+    px->precompile(dx->fboMap.compatiblePass(native,count));
+    return;
+    }
+
+  // same layout, as produced by VCommandBuffer::beginRendering
+  VkFormat colorFrm[MaxFramebufferAttachments] = {};
+  VkPipelineRenderingCreateInfoKHR info = {};
+  info.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+  info.pColorAttachmentFormats = colorFrm;
+  info.depthAttachmentFormat   = VK_FORMAT_UNDEFINED;
+  for(size_t i=0; i<count; ++i) {
+    if(Detail::nativeIsDepthFormat(native[i])) {
+      info.depthAttachmentFormat = native[i];
+      } else {
+      colorFrm[info.colorAttachmentCount] = native[i];
+      ++info.colorAttachmentCount;
+      }
+    }
+  px->precompile(info);
+  }
+
+std::vector<GpuHeapBudget> VulkanApi::memoryBudget(Device* d) {
+  Detail::VDevice* dx=reinterpret_cast<Detail::VDevice*>(d);
+  return dx->memoryBudget();
+  }
+
+size_t VulkanApi::defragment(Device* d, size_t maxBytes) {
+  Detail::VDevice* dx=reinterpret_cast<Detail::VDevice*>(d);
+  // relocated buffers get new native handle, so old one must not be in use by GPU
+  dx->uploadRing.flush();
+  dx->waitIdle();
+  return dx->allocator.defragment(maxBytes);
+  }
+
+uint32_t VulkanApi::bindlessId(Device* d, Texture* t) {
+  Detail::VDevice*  dx = reinterpret_cast<Detail::VDevice*>(d);
+  Detail::VTexture& tx = *reinterpret_cast<Detail::VTexture*>(t);
+  if(!dx->bindless.isEnabled())
+    return uint32_t(-1);
+  return dx->bindless.id(tx);
+  }
+
+uint32_t VulkanApi::bindlessId(Device* d, Buffer* b) {
+  Detail::VDevice* dx = reinterpret_cast<Detail::VDevice*>(d);
+  Detail::VBuffer& bx = *reinterpret_cast<Detail::VBuffer*>(b);
+  if(!dx->bindless.isEnabled())
+    return uint32_t(-1);
+  return dx->bindless.id(bx);
+  }
+
+uint32_t VulkanApi::bindlessId(Device* d, const Sampler& smp) {
+  Detail::VDevice* dx = reinterpret_cast<Detail::VDevice*>(d);
+  if(!dx->bindless.isEnabled())
+    return uint32_t(-1);
+  return dx->bindless.id(dx->allocator.updateSampler(smp));
+  }
+
 #endif
@@ -38,6 +38,9 @@ class VulkanApi : public AbstractGraphicsApi {
     PTexture       createTexture(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) override;
     PTexture       createStorage(Device* d, const uint32_t w, const uint32_t h, uint32_t mips, TextureFormat frm) override;
     PTexture       createStorage(Device* d, const uint32_t w, const uint32_t h, const uint32_t depth, uint32_t mips, TextureFormat frm) override;
+    void           updateTexture(Device* d, PTexture& t, const Pixmap& p, const Rect* rgn, size_t rgnCount) override;
+    PTexture       composeTexture(Device* d, const Pixmap& p, const TextureCopy* cp, size_t cpCount) override;
+    void           retireTexture(Device* d, PTexture& t) override;
 
     AccelerationStructure* createBottomAccelerationStruct(Device* d, const RtGeometry* geom, size_t size) override;
     AccelerationStructure* createTopAccelerationStruct(Device* d, const RtInstance* inst, AccelerationStructure*const* as, size_t size) override;
@@ -47,13 +50,31 @@ class VulkanApi : public AbstractGraphicsApi {
     void           readBytes(Device* d, Buffer* buf, void* out, size_t size) override;
 
     CommandBuffer* createCommandBuffer(Device* d) override;
+    CommandBuffer* createComputeCommandBuffer(Device* d) override;
 
     void           present  (Device *d, Swapchain* sw) override;
 
-    void           submit   (Device *d, CommandBuffer* cmd, Fence* sync) override;
+    void           submit     (Device *d, CommandBuffer* cmd, Fence* sync) override;
+    uint64_t       submitAsync(Device *d, CommandBuffer* cmd, Fence* sync) override;
+    void           submit     (Device *d, CommandBuffer* cmd, uint64_t wait, Fence* sync) override;
 
     void           getCaps  (Device *d, Props& props) override;
 
+    std::vector<uint8_t>
+                   pipelineCacheData(Device* d) override;
+    bool           loadPipelineCache(Device* d, const void* data, size_t size) override;
+
+    void           setAsyncPipelines(Device* d, bool enable) override;
+    void           precompile(Device* d, Pipeline* p, const TextureFormat* frm, size_t count) override;
+
+    std::vector<GpuHeapBudget>
+                   memoryBudget(Device* d) override;
+    size_t         defragment(Device* d, size_t maxBytes) override;
+
+    uint32_t       bindlessId(Device* d, Texture* t) override;
+    uint32_t       bindlessId(Device* d, Buffer*  b) override;
+    uint32_t       bindlessId(Device* d, const Sampler& smp) override;
+
   private:
     struct Impl;
     std::unique_ptr<Impl> impl;
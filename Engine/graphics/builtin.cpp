@@ -11,19 +11,27 @@ Builtin::Builtin(Device& device)
   : device(device) {
   static bool internalShaders = true;
   if(internalShaders) {
-    brushE  = mkShaderSet(false);
-    brushT2 = mkShaderSet(true);
+    brushE   = mkShaderSet(Empty);
+    brushT2  = mkShaderSet(Texture);
+    brushSdf = mkShaderSet(Sdf);
     }
   }
 
-Builtin::Item Builtin::mkShaderSet(bool textures) {
+Builtin::Item Builtin::mkShaderSet(ShaderSet set) {
   Tempest::Shader vs, fs;
-  if(textures) {
-    vs = device.shader(tex_brush_vert_sprv,sizeof(tex_brush_vert_sprv));
-    fs = device.shader(tex_brush_frag_sprv,sizeof(tex_brush_frag_sprv));
-    } else {
-    vs = device.shader(empty_vert_sprv,    sizeof(empty_vert_sprv));
-    fs = device.shader(empty_frag_sprv,    sizeof(empty_frag_sprv));
+  switch(set) {
+    case Empty:
+      vs = device.shader(empty_vert_sprv,    sizeof(empty_vert_sprv));
+      fs = device.shader(empty_frag_sprv,    sizeof(empty_frag_sprv));
+      break;
+    case Texture:
+      vs = device.shader(tex_brush_vert_sprv,sizeof(tex_brush_vert_sprv));
+      fs = device.shader(tex_brush_frag_sprv,sizeof(tex_brush_frag_sprv));
+      break;
+    case Sdf:
+      vs = device.shader(tex_brush_vert_sprv,sizeof(tex_brush_vert_sprv));
+      fs = device.shader(sdf_brush_frag_sprv,sizeof(sdf_brush_frag_sprv));
+      break;
     }
 
   RenderState stNormal, stBlend, stAlpha;
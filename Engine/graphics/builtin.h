@@ -26,15 +26,22 @@ class Builtin final {
       Tempest::RenderPipeline brushA;
       };
 
-    const Item& texture2d() const { return brushT2; }
-    const Item& empty    () const { return brushE;  }
+    const Item& texture2d() const { return brushT2;  }
+    const Item& empty    () const { return brushE;   }
+    const Item& sdf      () const { return brushSdf; }
 
   private:
-    Item            mkShaderSet(bool textures);
+    enum ShaderSet : uint8_t {
+      Empty,
+      Texture,
+      Sdf,
+      };
+    Item            mkShaderSet(ShaderSet set);
 
     Device&         device;
     Item            brushT2;
     Item            brushE;
+    Item            brushSdf;
 
   friend class Device;
   };
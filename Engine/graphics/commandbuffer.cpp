@@ -24,3 +24,10 @@ Encoder<CommandBuffer> CommandBuffer::startEncoding(Device& device) {
     }
   return Encoder<CommandBuffer>(this);
   }
+
+const std::vector<GpuTiming>& CommandBuffer::timings() const {
+  static const std::vector<GpuTiming> empty;
+  if(impl.handler==nullptr)
+    return empty;
+  return impl.handler->timings();
+  }
@@ -27,6 +27,9 @@ class CommandBuffer final {
 
     auto startEncoding(Tempest::Device& dev) -> Encoder<CommandBuffer>;
 
+    // GPU timer scopes of previous recording; empty, if it wasn't submitted or device has no query support
+    const std::vector<GpuTiming>& timings() const;
+
   private:
     CommandBuffer(Tempest::Device& dev, AbstractGraphicsApi::CommandBuffer* impl);
 
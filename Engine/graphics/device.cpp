@@ -79,6 +79,73 @@ void Device::waitIdle() {
   impl.dev->waitIdle();
   }
 
+bool Device::loadPipelineCache(const char* path) {
+  std::vector<uint8_t> data;
+  try {
+    RFile f(path);
+    data.resize(f.size());
+    if(f.read(data.data(),data.size())!=data.size())
+      return false;
+    }
+  catch(...) {
+    return false;
+    }
+  return api.loadPipelineCache(dev,data.data(),data.size());
+  }
+
+void Device::savePipelineCache(const char* path) {
+  auto data = api.pipelineCacheData(dev);
+  if(data.empty())
+    return;
+  WFile f(path);
+  if(f.write(data.data(),data.size())!=data.size())
+    throw std::system_error(Tempest::SystemErrc::UnableToSaveAsset);
+  }
+
+void Device::setAsyncPipelines(bool enable) {
+  api.setAsyncPipelines(dev,enable);
+  }
+
+void Device::precompile(const RenderPipeline& pso, std::initializer_list<TextureFormat> color, TextureFormat depth) {
+  if(pso.isEmpty())
+    return;
+  if(color.size()+(depth!=TextureFormat::Undefined ? 1 : 0) > MaxFramebufferAttachments)
+    throw IncompleteFboException();
+
+  // same order, as in Encoder::setFramebuffer: colors first, then depth
+  TextureFormat frm[MaxFramebufferAttachments] = {};
+  size_t        cnt = 0;
+  for(auto i:color)
+    frm[cnt++] = i;
+  if(depth!=TextureFormat::Undefined)
+    frm[cnt++] = depth;
+  api.precompile(dev,pso.impl.handler,frm,cnt);
+  }
+
+std::vector<GpuHeapBudget> Device::memoryBudget() const {
+  return api.memoryBudget(dev);
+  }
+
+size_t Device::defragment(size_t maxBytes) {
+  return api.defragment(dev,maxBytes);
+  }
+
+uint32_t Device::bindlessId(const Texture2d& tex) {
+  if(tex.impl.handler==nullptr)
+    return uint32_t(-1);
+  return api.bindlessId(dev,tex.impl.handler);
+  }
+
+uint32_t Device::bindlessId(const StorageBuffer& buf) {
+  if(buf.impl.impl.handler==nullptr)
+    return uint32_t(-1);
+  return api.bindlessId(dev,buf.impl.impl.handler);
+  }
+
+uint32_t Device::bindlessId(const Sampler& smp) {
+  return api.bindlessId(dev,smp);
+  }
+
 void Device::submit(const CommandBuffer &cmd) {
   api.submit(dev,cmd.impl.handler,nullptr);
   }
@@ -87,6 +154,26 @@ void Device::submit(const CommandBuffer &cmd, Fence &fdone) {
   api.submit(dev,cmd.impl.handler,fdone.impl.handler);
   }
 
+void Device::submit(const CommandBuffer& cmd, const SyncPoint& wait) {
+  api.submit(dev,cmd.impl.handler,wait.value,nullptr);
+  }
+
+void Device::submit(const CommandBuffer& cmd, const SyncPoint& wait, Fence& fdone) {
+  api.submit(dev,cmd.impl.handler,wait.value,fdone.impl.handler);
+  }
+
+SyncPoint Device::submitAsync(const CommandBuffer& cmd) {
+  SyncPoint ret;
+  ret.value = api.submitAsync(dev,cmd.impl.handler,nullptr);
+  return ret;
+  }
+
+SyncPoint Device::submitAsync(const CommandBuffer& cmd, Fence& fdone) {
+  SyncPoint ret;
+  ret.value = api.submitAsync(dev,cmd.impl.handler,fdone.impl.handler);
+  return ret;
+  }
+
 void Device::present(Swapchain& sw) {
   api.present(dev,sw.impl.handler);
   }
@@ -189,6 +276,30 @@ Texture2d Device::texture(const Pixmap &pm, const bool mips) {
   return t;
   }
 
+void Device::implUpdate(Texture2d& t, const Pixmap& pm, const Rect* rgn, size_t rgnCount) {
+  if(rgnCount==0)
+    return;
+  api.updateTexture(dev,t.impl,pm,rgn,rgnCount);
+  }
+
+Texture2d Device::implCompose(const Pixmap& pm, const TextureCopy* cp, size_t cpCount) {
+  std::vector<AbstractGraphicsApi::TextureCopy> native(cpCount);
+  for(size_t i=0; i<cpCount; ++i) {
+    native[i].src = cp[i].src->impl;
+    native[i].rgn = cp[i].rgn;
+    native[i].at  = cp[i].at;
+    }
+  Texture2d t(*this,api.composeTexture(dev,pm,native.data(),native.size()),pm.w(),pm.h(),1,pm.format());
+  return t;
+  }
+
+void Device::implRetire(Texture2d& t) {
+  if(t.isEmpty())
+    return;
+  api.retireTexture(dev,t.impl);
+  t = Texture2d();
+  }
+
 StorageImage Device::image2d(TextureFormat frm, const uint32_t w, const uint32_t h, const bool mips) {
   if(!devProps.hasStorageFormat(frm))
     throw std::system_error(Tempest::GraphicsErrc::UnsupportedTextureFormat, formatName(frm));
@@ -355,6 +466,11 @@ CommandBuffer Device::commandBuffer() {
   return buf;
   }
 
+CommandBuffer Device::computeCommandBuffer() {
+  CommandBuffer buf(*this,api.createComputeCommandBuffer(dev));
+  return buf;
+  }
+
 const Builtin& Device::builtin() const {
   return builtins;
   }
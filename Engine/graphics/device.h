@@ -52,6 +52,16 @@ class Device {
 
     void                  submit(const CommandBuffer& cmd);
     void                  submit(const CommandBuffer& cmd, Fence& fdone);
+    void                  submit(const CommandBuffer& cmd, const SyncPoint& wait);
+    void                  submit(const CommandBuffer& cmd, const SyncPoint& wait, Fence& fdone);
+
+    // Async compute, see `Props::compute.asyncQueue`. Command buffer of `computeCommandBuffer` records dispatches and copies only;
+    // `submitAsync` runs it on dedicated compute queue, in parallel with graphics work, submitted after it.
+    // Resources, bound to it's dispatches, are handed over from graphics queue and back: graphics command buffer, that uses them next,
+    // has to be submitted with returned sync point, and compute command buffer can be recorded again, once that submit is complete.
+    // Without async queue, command buffer runs on graphics queue.
+    SyncPoint             submitAsync(const CommandBuffer& cmd);
+    SyncPoint             submitAsync(const CommandBuffer& cmd, Fence& fdone);
     void                  present(Swapchain& sw);
 
     Swapchain             swapchain(SystemApi::Window* w) const;
@@ -156,9 +166,36 @@ class Device {
 
     Fence                 fence();
     CommandBuffer         commandBuffer();
+    CommandBuffer         computeCommandBuffer();
 
     const Builtin&        builtin() const;
 
+    // Persistent pipeline cache. Loading merges file content into device cache; returns false,
+    // if file is missing, damaged, or was written by a different device/driver.
+    bool                  loadPipelineCache(const char* path);
+    void                  savePipelineCache(const char* path);
+
+    // With async pipelines enabled, a pipeline variant missing for current framebuffer is compiled in background,
+    // and draw calls with it are skipped until it's ready. precompile() queues such variant ahead of time,
+    // for framebuffer of the given color and depth formats.
+    void                  setAsyncPipelines(bool enable);
+    void                  precompile(const RenderPipeline& pso, std::initializer_list<TextureFormat> color,
+                                     TextureFormat depth = TextureFormat::Undefined);
+
+    // Per-heap memory budget and usage; use it to react on memory pressure.
+    std::vector<GpuHeapBudget> memoryBudget() const;
+    // Moves up to `maxBytes` of device-local vertex/index buffers out of sparsely used memory pages, and releases those pages.
+    // Stop-the-world: waits for device to be idle. Contract: moved buffers get new native handles, so every command buffer,
+    // recorded before this call, is invalid and must be recorded again before next submit. Returns bytes moved.
+    size_t                defragment(size_t maxBytes = 64*1024*1024);
+
+    // Stable index of resource in device-wide bindless heap, see `Props::descriptors.bindlessHeap`.
+    // Heap is bound at descriptor set 2: `texture2D textures[]` at binding 0, `sampler samplers[]` at binding 1,
+    // storage buffers at binding 2. Index of texture or buffer is released, when resource is destroyed.
+    uint32_t              bindlessId(const Texture2d&     tex);
+    uint32_t              bindlessId(const StorageBuffer& buf);
+    uint32_t              bindlessId(const Sampler&       smp);
+
   private:
     struct Impl {
       Impl(AbstractGraphicsApi& api, std::string_view name);
@@ -175,8 +212,17 @@ class Device {
     Props                           devProps;
     Tempest::Builtin                builtins;
 
+    struct TextureCopy {
+      const Texture2d* src = nullptr;
+      Rect             rgn;
+      Point            at;
+      };
+
     Detail::VideoBuffer   createVideoBuffer(const void* data, size_t size, MemUsage usage, BufferHeap flg);
     RenderPipeline        implPipeline(const RenderState &st, const Shader* shaders[], Topology tp);
+    void                  implUpdate(Texture2d& t, const Pixmap& pm, const Rect* rgn, size_t rgnCount);
+    Texture2d             implCompose(const Pixmap& pm, const TextureCopy* cp, size_t cpCount);
+    void                  implRetire(Texture2d& t);
     template<class T>
     UniformBuffer<T>      implUbo(BufferHeap ht, const void* data);
 
@@ -190,6 +236,8 @@ class Device {
   friend class DescriptorSet;
 
   friend class Texture2d;
+  friend class Sprite;
+  friend class TextureAtlas;
   };
 
 template<class T>
@@ -4,6 +4,7 @@
 #include <Tempest/ZBuffer>
 #include <Tempest/Texture2d>
 #include <Tempest/StorageBuffer>
+#include <Tempest/Except>
 #include <cassert>
 
 #include "utility/compiller_hints.h"
@@ -25,14 +26,21 @@ Encoder<Tempest::CommandBuffer>::Encoder(Tempest::CommandBuffer* ow)
   impl->begin();
   }
 
+Encoder<Tempest::CommandBuffer>::Encoder(AbstractGraphicsApi::CommandBuffer* secondary)
+  :impl(secondary), secondary(true) {
+  // already in recording state, inside of render pass
+  state.stage = Rendering;
+  }
+
 Encoder<CommandBuffer>::Encoder(Encoder<CommandBuffer> &&e)
-  :impl(e.impl),state(std::move(e.state)) {
+  :impl(e.impl),state(std::move(e.state)),secondary(e.secondary) {
   e.impl  = nullptr;
   }
 
 Encoder<CommandBuffer> &Encoder<CommandBuffer>::operator =(Encoder<CommandBuffer> &&e) {
-  impl   = e.impl;
-  state  = std::move(e.state);
+  impl      = e.impl;
+  state     = std::move(e.state);
+  secondary = e.secondary;
 
   e.impl = nullptr;
   return *this;
@@ -41,7 +49,7 @@ Encoder<CommandBuffer> &Encoder<CommandBuffer>::operator =(Encoder<CommandBuffer
 Encoder<Tempest::CommandBuffer>::~Encoder() noexcept(false) {
   if(impl==nullptr)
     return;
-  if(state.stage==Rendering)
+  if(!secondary && (state.stage==Rendering || state.stage==ParallelRendering))
     impl->endRendering();
   impl->end();
   }
@@ -66,6 +74,29 @@ void Encoder<Tempest::CommandBuffer>::setDebugMarker(std::string_view tag) {
   impl->setDebugMarker(tag);
   }
 
+void Encoder<Tempest::CommandBuffer>::beginTimer(std::string_view name) {
+  impl->beginTimer(name);
+  }
+
+void Encoder<Tempest::CommandBuffer>::endTimer() {
+  impl->endTimer();
+  }
+
+Encoder<CommandBuffer>::Timer Encoder<Tempest::CommandBuffer>::timer(std::string_view name) {
+  impl->beginTimer(name);
+  return Timer(this);
+  }
+
+Encoder<CommandBuffer>::Timer::Timer(Timer&& t)
+  :owner(t.owner) {
+  t.owner = nullptr;
+  }
+
+Encoder<CommandBuffer>::Timer::~Timer() {
+  if(owner!=nullptr && owner->impl!=nullptr)
+    owner->impl->endTimer();
+  }
+
 void Encoder<Tempest::CommandBuffer>::setUniforms(const RenderPipeline& p, const DescriptorSet &ubo, const void* data, size_t sz) {
   setUniforms(p);
   if(sz>0)
@@ -115,7 +146,7 @@ void Encoder<Tempest::CommandBuffer>::setUniforms(const ComputePipeline& p, cons
   }
 
 void Encoder<Tempest::CommandBuffer>::setUniforms(const ComputePipeline& p) {
-  if(state.stage==Rendering)
+  if(state.stage==Rendering || state.stage==ParallelRendering)
     throw std::system_error(Tempest::GraphicsErrc::ComputeCallInRenderPass);
   assert(p.impl.handler);
   if(state.curCompute!=p.impl.handler) {
@@ -180,13 +211,13 @@ void Encoder<Tempest::CommandBuffer>::dispatchMeshThreads(Size sz) {
   }
 
 void Encoder<CommandBuffer>::dispatch(size_t x, size_t y, size_t z) {
-  if(state.stage==Rendering)
+  if(state.stage==Rendering || state.stage==ParallelRendering)
     throw std::system_error(Tempest::GraphicsErrc::ComputeCallInRenderPass);
   impl->dispatch(x,y,z);
   }
 
 void Encoder<Tempest::CommandBuffer>::dispatchThreads(size_t x, size_t y, size_t z) {
-  if(state.stage==Rendering)
+  if(state.stage==Rendering || state.stage==ParallelRendering)
     throw std::system_error(Tempest::GraphicsErrc::ComputeCallInRenderPass);
   auto sz = state.curCompute->workGroupSize();
   x = (x+sz.x-1)/sz.x;
@@ -215,18 +246,45 @@ void Encoder<CommandBuffer>::setFramebuffer(std::initializer_list<AttachmentDesc
     return;
     }
   // rd.size==0 -> compute
-  if(state.stage!=Rendering)
+  if(secondary)
+    throw ConcurentRecordingException();
+  if(state.stage!=Rendering && state.stage!=ParallelRendering)
     return;
-  if(state.stage==Rendering)
-    impl->endRendering();
+  impl->endRendering();
   state.curPipeline = nullptr;
   state.curCompute  = nullptr;
   state.stage       = None;
   }
 
+auto Encoder<CommandBuffer>::setParallelFramebuffer(size_t count, std::initializer_list<AttachmentDesc> rd) -> std::vector<Encoder> {
+  return implSetParallelFramebuffer(count,rd.begin(),rd.size(),nullptr);
+  }
+
+auto Encoder<CommandBuffer>::setParallelFramebuffer(size_t count, std::initializer_list<AttachmentDesc> rd, AttachmentDesc zd) -> std::vector<Encoder> {
+  return implSetParallelFramebuffer(count,rd.begin(),rd.size(),&zd);
+  }
+
+auto Encoder<CommandBuffer>::implSetParallelFramebuffer(size_t count, const AttachmentDesc* rt, size_t rtSize,
+                                                        const AttachmentDesc* zd) -> std::vector<Encoder> {
+  if(rtSize==0 && zd==nullptr)
+    throw IncompleteFboException();
+
+  std::vector<AbstractGraphicsApi::CommandBuffer*> sec(count);
+  implSetFramebuffer(rt,rtSize,zd,sec.data(),count);
+
+  std::vector<Encoder> ret;
+  ret.reserve(count);
+  for(auto i:sec)
+    ret.push_back(Encoder(i));
+  return ret;
+  }
+
 void Tempest::Encoder<Tempest::CommandBuffer>::implSetFramebuffer(const AttachmentDesc* rt, size_t rtSize,
-                                                                  const AttachmentDesc* zd) {
-  if(state.stage==Rendering)
+                                                                  const AttachmentDesc* zd,
+                                                                  AbstractGraphicsApi::CommandBuffer** sec, size_t secCount) {
+  if(secondary)
+    throw ConcurentRecordingException();
+  if(state.stage==Rendering || state.stage==ParallelRendering)
     impl->endRendering();
 
   if((rtSize+(zd ? 1 : 0)) > MaxFramebufferAttachments)
@@ -271,9 +329,18 @@ void Tempest::Encoder<Tempest::CommandBuffer>::implSetFramebuffer(const Attachme
     att [rtSize] = zd->zbuffer->tImpl.impl.handler;
     }
 
-  impl->beginRendering(desc,rtSize+(zd ? 1 : 0),w,h,
-                       frm,att,sw,imgId);
-  state.stage      = Rendering;
+  if(sec==nullptr) {
+    impl->beginRendering(desc,rtSize+(zd ? 1 : 0),w,h,
+                         frm,att,sw,imgId);
+    state.stage = Rendering;
+    } else {
+    if(!impl->beginParallelRendering(desc,rtSize+(zd ? 1 : 0),w,h,
+                                     frm,att,sw,imgId,sec,secCount)) {
+      state.stage = None;
+      throw std::system_error(Tempest::GraphicsErrc::UnsupportedExtension);
+      }
+    state.stage = ParallelRendering;
+    }
   state.curPipeline = nullptr;
   }
 
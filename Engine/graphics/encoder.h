@@ -4,6 +4,9 @@
 #include <Tempest/RenderPipeline>
 #include <Tempest/ComputePipeline>
 #include <Tempest/DescriptorSet>
+#include "../utility/compiller_hints.h"
+
+#include <vector>
 
 namespace Tempest {
 
@@ -21,6 +24,18 @@ class Encoder;
 template<>
 class Encoder<Tempest::CommandBuffer> {
   public:
+    class Timer final {
+      public:
+        Timer(Timer&& t);
+        ~Timer();
+
+      private:
+        explicit Timer(Encoder* owner):owner(owner){}
+        Encoder* owner = nullptr;
+
+      friend class Encoder;
+      };
+
     Encoder(Encoder&& e);
     Encoder& operator = (Encoder&& e);
     virtual ~Encoder() noexcept(false);
@@ -28,6 +43,11 @@ class Encoder<Tempest::CommandBuffer> {
     void setFramebuffer(std::initializer_list<AttachmentDesc> rd);
     void setFramebuffer(std::initializer_list<AttachmentDesc> rd, AttachmentDesc zd);
 
+    // render pass, recorded by `count` encoders, that can be used from worker threads;
+    // their commands are executed in order of encoders, when render pass ends - each one has to be destroyed by then
+    auto setParallelFramebuffer(size_t count, std::initializer_list<AttachmentDesc> rd) -> std::vector<Encoder>;
+    auto setParallelFramebuffer(size_t count, std::initializer_list<AttachmentDesc> rd, AttachmentDesc zd) -> std::vector<Encoder>;
+
     void setUniforms(const RenderPipeline& p, const DescriptorSet &ubo, const void* data, size_t sz);
     void setUniforms(const RenderPipeline& p, const void* data, size_t sz);
     void setUniforms(const RenderPipeline& p, const DescriptorSet &ubo);
@@ -46,6 +66,11 @@ class Encoder<Tempest::CommandBuffer> {
 
     void setDebugMarker(std::string_view tag);
 
+    // GPU timer scopes; results are available from CommandBuffer::timings, once command buffer is recorded again
+    void  beginTimer(std::string_view name);
+    void  endTimer();
+    T_NODISCARD Timer timer(std::string_view name);
+
     // non-indexed + empty vbo
     void draw(std::nullptr_t vbo, size_t offset, size_t count) { implDraw({},0,offset,count,0,1); }
     void draw(std::nullptr_t vbo, size_t offset, size_t count, size_t firstInstance, size_t instanceCount) { implDraw({},0,offset,count,firstInstance,instanceCount); }
@@ -105,10 +130,12 @@ class Encoder<Tempest::CommandBuffer> {
 
   private:
     explicit Encoder(CommandBuffer* ow);
+    explicit Encoder(AbstractGraphicsApi::CommandBuffer* secondary);
 
     enum Stage : uint8_t {
       None = 0,
       Rendering,
+      ParallelRendering,
       Compute
       };
 
@@ -118,10 +145,13 @@ class Encoder<Tempest::CommandBuffer> {
       Stage                                    stage       = None;
       };
 
-    AbstractGraphicsApi::CommandBuffer* impl = nullptr;
+    AbstractGraphicsApi::CommandBuffer* impl      = nullptr;
     State                               state;
+    bool                                secondary = false;
 
-    void         implSetFramebuffer(const AttachmentDesc* rt, size_t rtSize, const AttachmentDesc* zs);
+    void         implSetFramebuffer(const AttachmentDesc* rt, size_t rtSize, const AttachmentDesc* zs,
+                                    AbstractGraphicsApi::CommandBuffer** sec = nullptr, size_t secCount = 0);
+    auto         implSetParallelFramebuffer(size_t count, const AttachmentDesc* rt, size_t rtSize, const AttachmentDesc* zs) -> std::vector<Encoder>;
     void         implDraw(const Detail::VideoBuffer& vbo, size_t stride, size_t offset, size_t size, size_t firstInstance, size_t instanceCount);
     void         implDraw(const Detail::VideoBuffer& vbo, size_t stride, const Detail::VideoBuffer &ibo, Detail::IndexClass index,
                           size_t offset, size_t size, size_t firstInstance, size_t instanceCount);
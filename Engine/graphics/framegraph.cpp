@@ -0,0 +1,185 @@
+#include "framegraph.h"
+
+#include <Tempest/Device>
+#include <Tempest/CommandBuffer>
+
+#include <typeinfo>
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+Attachment& FrameGraph::Resources::attachment(Resource r) const {
+  if(owner.plan.kind(r.id)!=FrameGraphPlan::K_Attachment)
+    throw std::bad_cast();
+  if(owner.plan.isImported(r.id))
+    return *owner.imported[r.id].attachment;
+  return owner.pool[owner.physMap[owner.plan.physical(r.id)]].attachment;
+  }
+
+ZBuffer& FrameGraph::Resources::zbuffer(Resource r) const {
+  if(owner.plan.kind(r.id)!=FrameGraphPlan::K_ZBuffer)
+    throw std::bad_cast();
+  if(owner.plan.isImported(r.id))
+    return *owner.imported[r.id].zbuffer;
+  return owner.pool[owner.physMap[owner.plan.physical(r.id)]].zbuffer;
+  }
+
+StorageBuffer& FrameGraph::Resources::buffer(Resource r) const {
+  if(owner.plan.kind(r.id)!=FrameGraphPlan::K_Buffer)
+    throw std::bad_cast();
+  return *owner.imported[r.id].buffer;
+  }
+
+FrameGraph::Pass& FrameGraph::Pass::read(Resource r) {
+  owner->plan.read(id,r.id);
+  owner->compiled = false;
+  return *this;
+  }
+
+FrameGraph::Pass& FrameGraph::Pass::write(Resource r) {
+  owner->plan.write(id,r.id);
+  owner->compiled = false;
+  return *this;
+  }
+
+FrameGraph::Pass& FrameGraph::Pass::sideEffect() {
+  owner->plan.setSideEffect(id);
+  owner->compiled = false;
+  return *this;
+  }
+
+FrameGraph::FrameGraph(Device& device)
+  :device(device) {
+  }
+
+FrameGraph::~FrameGraph() {
+  }
+
+FrameGraph::Resource FrameGraph::attachment(TextureFormat frm, uint32_t w, uint32_t h) {
+  return transient(FrameGraphPlan::K_Attachment,frm,w,h);
+  }
+
+FrameGraph::Resource FrameGraph::zbuffer(TextureFormat frm, uint32_t w, uint32_t h) {
+  return transient(FrameGraphPlan::K_ZBuffer,frm,w,h);
+  }
+
+FrameGraph::Resource FrameGraph::transient(FrameGraphPlan::Kind k, TextureFormat frm, uint32_t w, uint32_t h) {
+  FrameGraphPlan::Desc d;
+  d.kind   = k;
+  d.format = frm;
+  d.w      = w;
+  d.h      = h;
+  compiled = false;
+  imported.emplace_back();
+  return Resource(plan.addTransient(d));
+  }
+
+FrameGraph::Resource FrameGraph::import(Attachment& a) {
+  Imported im;
+  im.attachment = &a;
+  imported.push_back(im);
+  compiled = false;
+  return Resource(plan.addImported(FrameGraphPlan::K_Attachment));
+  }
+
+FrameGraph::Resource FrameGraph::import(ZBuffer& z) {
+  Imported im;
+  im.zbuffer = &z;
+  imported.push_back(im);
+  compiled = false;
+  return Resource(plan.addImported(FrameGraphPlan::K_ZBuffer));
+  }
+
+FrameGraph::Resource FrameGraph::import(StorageBuffer& b) {
+  Imported im;
+  im.buffer = &b;
+  imported.push_back(im);
+  compiled = false;
+  return Resource(plan.addImported(FrameGraphPlan::K_Buffer));
+  }
+
+FrameGraph::Pass FrameGraph::addPass(std::string_view name, Execute fn) {
+  PassData p;
+  p.name = std::string(name);
+  p.fn   = std::move(fn);
+  passes.emplace_back(std::move(p));
+  compiled = false;
+  return Pass(*this,plan.addPass(false));
+  }
+
+void FrameGraph::compile() {
+  plan.compile();
+  allocPhysical();
+  compiled = true;
+  }
+
+void FrameGraph::allocPhysical() {
+  for(auto& i:pool)
+    i.used = false;
+
+  physMap.resize(plan.physicalCount());
+  for(uint32_t i=0; i<plan.physicalCount(); ++i) {
+    auto&  d  = plan.physicalDesc(i);
+    size_t id = pool.size();
+    for(size_t r=0; r<pool.size(); ++r) {
+      if(pool[r].used || pool[r].desc!=d)
+        continue;
+      id = r;
+      break;
+      }
+
+    if(id==pool.size()) {
+      Physical p;
+      p.desc = d;
+      if(d.kind==FrameGraphPlan::K_ZBuffer)
+        p.zbuffer    = device.zbuffer(d.format,d.w,d.h); else
+        p.attachment = device.attachment(d.format,d.w,d.h);
+      pool.emplace_back(std::move(p));
+      }
+    pool[id].used = true;
+    physMap[i]    = uint32_t(id);
+    }
+
+  // textures, not needed by this compile, are released: graph of changed size or format doesn't grow pool
+  std::vector<uint32_t> remap(pool.size());
+  size_t                cnt = 0;
+  for(size_t r=0; r<pool.size(); ++r) {
+    if(!pool[r].used)
+      continue;
+    if(cnt!=r)
+      pool[cnt] = std::move(pool[r]);
+    remap[r] = uint32_t(cnt);
+    ++cnt;
+    }
+  pool.erase(pool.begin()+cnt,pool.end());
+  for(auto& i:physMap)
+    i = remap[i];
+  }
+
+void FrameGraph::execute(Encoder<CommandBuffer>& enc) {
+  if(!compiled)
+    compile();
+
+  // passes go into one encoder back to back: layout transitions, left by render pass,
+  // are flushed together with transitions of next pass
+  Resources res(*this);
+  for(uint32_t i=0; i<passes.size(); ++i) {
+    if(plan.isCulled(i))
+      continue;
+    enc.setDebugMarker(passes[i].name);
+    passes[i].fn(enc,res);
+    }
+  enc.setDebugMarker("");
+  }
+
+void FrameGraph::clear() {
+  plan.clear();
+  passes.clear();
+  imported.clear();
+  physMap.clear();
+  compiled = false;
+  }
+
+bool FrameGraph::isCulled(const Pass& p) const {
+  return plan.isCulled(p.id);
+  }
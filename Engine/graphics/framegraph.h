@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Tempest/Attachment>
+#include <Tempest/ZBuffer>
+#include <Tempest/StorageBuffer>
+#include <Tempest/Encoder>
+#include "../gapi/framegraphplan.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Tempest {
+
+class Device;
+class CommandBuffer;
+
+// Declarative frame: passes declare resources, they read and write, before anything is recorded.
+// `compile` culls passes, that don't contribute to imported resources or side effects, and places
+// transient attachments of same format and size, that are never alive at the same time, into one texture.
+// Transient textures are pooled between frames; compile releases ones, that new graph doesn't use, so frames,
+// that still refer them, must be complete before graph of different shape is compiled.
+// Content of transient resource is undefined, until first pass writes it: first writer has to clear or discard.
+class FrameGraph final {
+  public:
+    class Resource final {
+      public:
+        Resource() = default;
+        bool isEmpty() const { return id==Detail::FrameGraphPlan::NoId; }
+
+      private:
+        explicit Resource(uint32_t id):id(id){}
+        uint32_t id = Detail::FrameGraphPlan::NoId;
+
+      friend class FrameGraph;
+      };
+
+    class Resources final {
+      public:
+        Attachment&    attachment(Resource r) const;
+        ZBuffer&       zbuffer   (Resource r) const;
+        StorageBuffer& buffer    (Resource r) const;
+
+      private:
+        explicit Resources(FrameGraph& owner):owner(owner){}
+        FrameGraph& owner;
+
+      friend class FrameGraph;
+      };
+
+    using Execute = std::function<void(Encoder<CommandBuffer>& enc, const Resources& res)>;
+
+    class Pass final {
+      public:
+        Pass& read (Resource r);
+        Pass& write(Resource r);
+        // pass is never culled; for passes, that write anything, not known to graph
+        Pass& sideEffect();
+
+      private:
+        Pass(FrameGraph& owner, uint32_t id):owner(&owner),id(id){}
+        FrameGraph* owner = nullptr;
+        uint32_t    id    = 0;
+
+      friend class FrameGraph;
+      };
+
+    explicit FrameGraph(Device& device);
+    FrameGraph(const FrameGraph&) = delete;
+    ~FrameGraph();
+
+    Resource attachment(TextureFormat frm, uint32_t w, uint32_t h);
+    Resource zbuffer   (TextureFormat frm, uint32_t w, uint32_t h);
+
+    // resources, owned by application; writing one of them keeps pass alive
+    Resource import(Attachment&    a);
+    Resource import(ZBuffer&       z);
+    Resource import(StorageBuffer& b);
+
+    Pass     addPass(std::string_view name, Execute fn);
+
+    void     compile();
+    void     execute(Encoder<CommandBuffer>& enc);
+    // drops passes and resources, declared so far; pooled textures are kept for next frame
+    void     clear();
+
+    // valid after compile
+    bool     isCulled(const Pass& p) const;
+    size_t   transientCount() const { return pool.size(); }
+
+  private:
+    struct PassData {
+      std::string name;
+      Execute     fn;
+      };
+
+    struct Physical {
+      Detail::FrameGraphPlan::Desc desc;
+      Attachment                   attachment;
+      ZBuffer                      zbuffer;
+      bool                         used = false;
+      };
+
+    struct Imported {
+      Attachment*    attachment = nullptr;
+      ZBuffer*       zbuffer    = nullptr;
+      StorageBuffer* buffer     = nullptr;
+      };
+
+    Resource transient(Detail::FrameGraphPlan::Kind k, TextureFormat frm, uint32_t w, uint32_t h);
+    void     allocPhysical();
+
+    Device&                  device;
+    Detail::FrameGraphPlan   plan;
+    bool                     compiled = false;
+
+    std::vector<PassData>    passes;
+    std::vector<Imported>    imported;   // indexed by resource id; empty for transients
+    std::vector<uint32_t>    physMap;    // physical id of plan -> pool
+    std::vector<Physical>    pool;
+  };
+
+}
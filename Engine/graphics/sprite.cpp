@@ -17,13 +17,20 @@ const Texture2d& Sprite::pageRawData(Device& dev) const {
     return t;
     }
 
-  auto& mem=alloc.memory();
-  if( mem.changed ){
-    dev.waitIdle(); //FIXME: track usage of mem.gpu
-    mem.gpu=dev.texture(mem.cpu,false);
-    mem.changed=false;
-    }
-  return mem.gpu;
+  const Texture2d* ret = nullptr;
+  alloc.access([&](TextureAtlas::Memory& mem) {
+    if(mem.gpu.isEmpty()) {
+      mem.gpu=dev.texture(mem.cpu,false);
+      mem.dirty.clear();
+      }
+    else if(!mem.dirty.empty()) {
+      // upload only touched regions: page texture is replaced with patched copy, in-flight frames keep sampling previous one
+      dev.implUpdate(mem.gpu,mem.cpu,mem.dirty.data(),mem.dirty.size());
+      mem.dirty.clear();
+      }
+    ret = &mem.gpu;
+    });
+  return *ret;
   }
 
 const Rect Sprite::pageRect() const {
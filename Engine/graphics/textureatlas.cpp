@@ -1,15 +1,42 @@
 #include "textureatlas.h"
 
+#include <Tempest/Device>
 #include <Tempest/Sprite>
 #include <Tempest/Log>
 #include <cstring>
+#include <algorithm>
 
 #include "thirdparty/squish/squish.h"
 
 using namespace Tempest;
 
+void TextureAtlas::Memory::invalidate(const Rect& r) {
+  static const size_t maxDirtyRects = 32;
+  if(dirty.size()<maxDirtyRects) {
+    dirty.push_back(r);
+    return;
+    }
+  // too many small uploads - collapse into a bounding box
+  int x0 = r.x,     y0 = r.y;
+  int x1 = r.x+r.w, y1 = r.y+r.h;
+  for(auto& i:dirty) {
+    x0 = std::min(x0,i.x);
+    y0 = std::min(y0,i.y);
+    x1 = std::max(x1,i.x+i.w);
+    y1 = std::max(y1,i.y+i.h);
+    }
+  dirty.resize(1);
+  dirty[0] = Rect(x0,y0,x1-x0,y1-y0);
+  }
+
+void TextureAtlas::MemoryProvider::free(DeviceMemory& m) {
+  // page may be still sampled by frames in flight
+  device.implRetire(m.gpu);
+  m=DeviceMemory();
+  }
+
 TextureAtlas::TextureAtlas(Device& device)
-  :device(device),alloc(provider) {
+  :device(device),provider(device),alloc(provider) {
   }
 
 TextureAtlas::~TextureAtlas() {
@@ -20,18 +47,84 @@ Sprite TextureAtlas::load(const Pixmap &pm) {
   }
 
 Sprite TextureAtlas::load(const void *data, uint32_t w, uint32_t h, TextureFormat format) {
-  auto a = alloc.alloc(w,h);
-  auto p = a.pos();
-  emplace(a,data,w,h,format,uint32_t(p.x),uint32_t(p.y));
+  // pixels are written under allocator lock, as concurrent load() and compact() touch same page
+  auto a = alloc.alloc(w,h,[&](Memory& mem, const Point& p) {
+    emplace(mem,data,w,h,format,uint32_t(p.x),uint32_t(p.y));
+    });
   Sprite ret(std::move(a),w,h);
   return ret;
   }
 
-void TextureAtlas::emplace(TextureAtlas::Allocation &dest, const void* img,
+void TextureAtlas::setDefaultPageSize(uint32_t size) {
+  alloc.setDefaultPageSize(size);
+  }
+
+uint32_t TextureAtlas::defaultPageSize() const {
+  return alloc.defaultPageSize();
+  }
+
+TextureAtlas::Stats TextureAtlas::stats() const {
+  auto   st = alloc.stats();
+  Stats  ret;
+  ret.pageCount   = st.pageCount;
+  ret.spriteCount = st.allocationCount;
+  ret.usedArea    = st.usedArea;
+  ret.totalArea   = st.totalArea;
+  return ret;
+  }
+
+size_t TextureAtlas::compact() {
+  // regions, that are up to date on GPU, grouped by destination page
+  std::vector<std::pair<Memory*,Device::TextureCopy>> gpu;
+
+  auto move = [&gpu](const Memory& src, const Rect& r, Memory& dst, const Point& at) {
+    // cpu shadow is kept in sync: it's the source of partial uploads
+    const size_t sw   = size_t(src.cpu.w())*4;
+    const size_t dw   = size_t(dst.cpu.w())*4;
+    auto         sptr = reinterpret_cast<const uint8_t*>(src.cpu.data()) + size_t(r.y)*sw + size_t(r.x)*4;
+    auto         dptr = reinterpret_cast<uint8_t*>(dst.cpu.data())       + size_t(at.y)*dw + size_t(at.x)*4;
+    for(int i=0; i<r.h; ++i)
+      std::memcpy(dptr+size_t(i)*dw, sptr+size_t(i)*sw, size_t(r.w)*4);
+
+    bool clean = !src.gpu.isEmpty();
+    for(auto& d:src.dirty)
+      if(!d.intersected(r).size().isEmpty())
+        clean = false;
+    if(!clean) {
+      dst.invalidate(Rect(at.x,at.y,r.w,r.h));
+      return;
+      }
+    Device::TextureCopy cp;
+    cp.src = &src.gpu;
+    cp.rgn = r;
+    cp.at  = at;
+    gpu.emplace_back(&dst,cp);
+    };
+
+  auto flush = [this,&gpu]() {
+    std::stable_sort(gpu.begin(),gpu.end(),[](const std::pair<Memory*,Device::TextureCopy>& a,
+                                              const std::pair<Memory*,Device::TextureCopy>& b){
+      return a.first<b.first;
+      });
+    std::vector<Device::TextureCopy> cp;
+    for(size_t i=0; i<gpu.size();) {
+      Memory& dst = *gpu[i].first;
+      cp.clear();
+      for(; i<gpu.size() && gpu[i].first==&dst; ++i)
+        cp.push_back(gpu[i].second);
+      // content of regions, that were not copied, is uploaded from dirty list
+      dst.gpu = device.implCompose(dst.cpu,cp.data(),cp.size());
+      }
+    };
+
+  return alloc.compact(move,flush);
+  }
+
+void TextureAtlas::emplace(Memory& dest, const void* img,
                            uint32_t pw, uint32_t ph, TextureFormat format,
                            uint32_t x, uint32_t y) {
-  dest.memory().changed=true;
-  Pixmap&  cpu  = dest.memory().cpu;
+  dest.invalidate(Rect(int(x),int(y),int(pw),int(ph)));
+  Pixmap&  cpu  = dest.cpu;
   auto     data = reinterpret_cast<uint8_t*>(cpu.data());
   uint32_t dx   = x*4;
   uint32_t dw   = cpu.w()*4;
@@ -20,8 +20,26 @@ class TextureAtlas {
     TextureAtlas(const TextureAtlas&)=delete;
     virtual ~TextureAtlas();
 
-    Sprite load(const Pixmap& pm);
-    Sprite load(const void* data, uint32_t w, uint32_t h, TextureFormat format);
+    struct Stats {
+      size_t   pageCount   = 0;
+      size_t   spriteCount = 0;
+      uint64_t usedArea    = 0;
+      uint64_t totalArea   = 0;
+
+      float    occupancy() const { return totalArea==0 ? 0.f : float(double(usedArea)/double(totalArea)); }
+      };
+
+    Sprite   load(const Pixmap& pm);
+    Sprite   load(const void* data, uint32_t w, uint32_t h, TextureFormat format);
+
+    void     setDefaultPageSize(uint32_t size);
+    uint32_t defaultPageSize() const;
+    Stats    stats() const;
+
+    // Repacks sprites into fewer pages and frees emptied ones; returns number of freed pages.
+    // Sprites stay valid and are copied to new pages on GPU. VectorImage::Mesh::update remaps sprites, moved since painting;
+    // textures of freed pages are released by device, once frames submitted before are complete.
+    size_t   compact();
 
   private:
     struct Memory {
@@ -31,30 +49,33 @@ class TextureAtlas {
 
       Memory& operator=(Memory&&)=default;
 
-      Pixmap            cpu;
-      mutable Texture2d gpu;
-      mutable bool      changed=true;
+      void invalidate(const Rect& r);
+
+      Pixmap                    cpu;
+      mutable Texture2d         gpu;
+      mutable std::vector<Rect> dirty;
       };
 
     struct MemoryProvider {
       using DeviceMemory=Memory;
 
+      explicit MemoryProvider(Device& device):device(device){}
+
       DeviceMemory alloc(uint32_t w,uint32_t h){
         DeviceMemory ret(w,h);
         return ret;
         }
 
-      void free(DeviceMemory& m){
-        // nop
-        m=DeviceMemory();
-        }
+      void free(DeviceMemory& m);
+
+      Device& device;
       };
 
     using Allocation = typename Tempest::RectAllocator<MemoryProvider>::Allocation;
 
-    void emplace(Allocation& dest, const void *img,
-                 uint32_t w, uint32_t h, TextureFormat frm,
-                 uint32_t x, uint32_t y);
+    static void emplace(Memory& dest, const void *img,
+                        uint32_t w, uint32_t h, TextureFormat frm,
+                        uint32_t x, uint32_t y);
 
     Device&                                 device;
     MemoryProvider                          provider;
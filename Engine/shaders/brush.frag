@@ -16,7 +16,12 @@ layout(location = 0) out vec4 outColor;
 layout(location = 0) in  vec4 inColor;
 
 void main() {
-#if defined(TEXTURE)
+#if defined(TEXTURE) && defined(SDF)
+  // alpha channel holds distance to glyph outline, 0.5 is the edge
+  float dist = texture(texSampler,inUV).a;
+  float w    = max(fwidth(dist),1.0/255.0)*0.5;
+  outColor   = vec4(inColor.rgb, inColor.a*smoothstep(0.5-w,0.5+w,dist));
+#elif defined(TEXTURE)
   outColor = inColor*texture(texSampler,inUV);
 #else
   outColor = inColor;
@@ -5,9 +5,9 @@ out gl_PerVertex {
   vec4 gl_Position;
   };
 
-layout(location = 0) in vec3 inPos;
+layout(location = 0) in vec2 inPos;
 layout(location = 1) in vec2 inUV;
-layout(location = 2) in vec4 inColor;
+layout(location = 2) in uint inColor;
 
 layout(location = 0) out vec4 outColor;
 #if defined(TEXTURE)
@@ -15,8 +15,8 @@ layout(location = 1) out vec2 outUV;
 #endif
 
 void main() {
-  gl_Position = vec4(inPos, 1.0);
-  outColor    = inColor;
+  gl_Position = vec4(inPos, 0.0, 1.0);
+  outColor    = unpackUnorm4x8(inColor);
 #if defined(TEXTURE)
   outUV       = inUV;
 #endif
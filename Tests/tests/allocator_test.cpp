@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
 
 using namespace testing;
 using namespace Tempest::Detail;
@@ -91,3 +94,203 @@ TEST(main, DeviceAllocatorAlign1) {
   memory.free(p1);
   memory.free(p3);
   }
+
+struct MappedTestDevice : TestDevice {
+  int mapCount   = 0;
+  int unmapCount = 0;
+
+  void* map(DeviceMemory m, size_t /*size*/){
+    ++mapCount;
+    return m;
+    }
+
+  void unmap(DeviceMemory /*m*/){
+    ++unmapCount;
+    }
+  };
+
+TEST(main, DeviceAllocatorMapped) {
+  MappedTestDevice device;
+  {
+  DeviceAllocator<MappedTestDevice> memory(device);
+
+  auto p1 = memory.alloc(64, 1,0,0, true);
+  auto p2 = memory.alloc(64, 1,0,0, true);
+  auto p3 = memory.alloc(64, 1,1,1, false);
+  EXPECT_EQ(p1.page,p2.page);
+  EXPECT_EQ(p1.page->mapped,p1.page->memory);
+  EXPECT_EQ(p3.page->mapped,nullptr);
+  EXPECT_EQ(device.mapCount,1);
+
+  memory.free(p1);
+  EXPECT_EQ(device.unmapCount,0);
+  memory.free(p2);
+  EXPECT_EQ(device.unmapCount,1);
+
+  auto p4 = memory.alloc(64, 1,0,0, true);
+  EXPECT_EQ(device.mapCount,2);
+  memory.free(p3);
+  (void)p4;
+  }
+  EXPECT_EQ(device.unmapCount,2);
+  }
+
+TEST(main, DeviceAllocatorReuse) {
+  TestDevice device;
+  DeviceAllocator<TestDevice> memory(device);
+  memory.setDefaultPageSize(4096);
+
+  std::vector<DeviceAllocator<TestDevice>::Allocation> a;
+  for(size_t i=0; i<64; ++i) {
+    a.push_back(memory.alloc(64,1,0,0,false));
+    }
+  EXPECT_EQ(memory.stats()[0].pages,1u);
+
+  for(size_t i=0; i<a.size(); i+=2)
+    memory.free(a[i]);
+  auto st = memory.stats()[0];
+  EXPECT_EQ(st.allocated,  32u*64u);
+  EXPECT_EQ(st.largestFree,64u);
+  EXPECT_GT(st.fragmentation(),0.9);
+
+  for(size_t i=1; i<a.size(); i+=2)
+    memory.free(a[i]);
+  EXPECT_TRUE(memory.stats()[0].pages==0);
+  }
+
+TEST(main, DeviceAllocatorStress) {
+  TestDevice device;
+  DeviceAllocator<TestDevice> memory(device);
+  memory.setDefaultPageSize(1024*1024);
+
+  std::vector<DeviceAllocator<TestDevice>::Allocation> a;
+  uint32_t rnd = 1;
+  for(size_t i=0; i<20000; ++i) {
+    rnd = rnd*1103515245u + 12345u;
+    if(!a.empty() && (rnd>>16)%3==0) {
+      size_t id = (rnd>>8)%a.size();
+      memory.free(a[id]);
+      a[id] = a.back();
+      a.pop_back();
+      continue;
+      }
+    size_t sz    = 1 + (rnd>>10)%4000;
+    size_t align = size_t(1) << ((rnd>>4)%9);
+    auto   al    = memory.alloc(sz,align,0,0,false);
+    ASSERT_NE(al.page,nullptr);
+    EXPECT_EQ(al.offset%align,0u);
+    EXPECT_LE(al.offset+sz,al.page->allSize);
+    a.push_back(al);
+    }
+
+  // no overlaps within a page
+  std::sort(a.begin(),a.end(),[](auto& l, auto& r){ return std::tie(l.page,l.offset)<std::tie(r.page,r.offset); });
+  for(size_t i=1; i<a.size(); ++i) {
+    if(a[i].page==a[i-1].page) {
+      EXPECT_LE(a[i-1].offset+a[i-1].size,a[i].offset);
+      }
+    }
+
+  for(auto& i:a)
+    memory.free(i);
+  EXPECT_TRUE(memory.stats()[0].pages==0);
+  }
+
+TEST(main, DeviceAllocatorDefragment) {
+  TestDevice device;
+  DeviceAllocator<TestDevice> memory(device);
+  memory.setDefaultPageSize(1024);
+
+  int owner[64] = {};
+  std::vector<DeviceAllocator<TestDevice>::Allocation> a;
+  for(size_t i=0; i<32; ++i) {
+    a.push_back(memory.alloc(64,1,0,0,false));
+    memory.setOwner(a.back(),&owner[i]);
+    }
+  EXPECT_EQ(memory.stats()[0].pages,2u);
+
+  // leave 2 allocations in first page, 10 in second
+  for(size_t i=0; i<32; ++i) {
+    if(i<2 || (i>=16 && i<26))
+      continue;
+    memory.free(a[i]);
+    a[i].page = nullptr;
+    }
+
+  auto mv = memory.defragment(size_t(-1),0.25,[](void*) -> size_t { return 1; });
+  ASSERT_EQ(mv.size(),2u);
+  for(auto& m:mv) {
+    EXPECT_NE(m.from.page,m.to.page);
+    EXPECT_EQ(m.from.size,m.to.size);
+    memory.free(m.from);
+    }
+  memory.endDefragment();
+  EXPECT_EQ(memory.stats()[0].pages,1u);
+  EXPECT_EQ(memory.stats()[0].allocated,12u*64u);
+
+  for(auto& m:mv)
+    memory.free(m.to);
+  for(size_t i=16; i<26; ++i)
+    memory.free(a[i]);
+  EXPECT_EQ(memory.stats()[0].pages,0u);
+  }
+
+TEST(main, DeviceAllocatorDefragmentPinned) {
+  TestDevice device;
+  DeviceAllocator<TestDevice> memory(device);
+  memory.setDefaultPageSize(1024);
+
+  std::vector<DeviceAllocator<TestDevice>::Allocation> a;
+  for(size_t i=0; i<32; ++i)
+    a.push_back(memory.alloc(64,1,0,0,false));
+  for(size_t i=1; i<16; ++i)
+    memory.free(a[i]);
+
+  // no owner - can't move
+  auto mv = memory.defragment(size_t(-1),0.25,[](void*) -> size_t { return 1; });
+  EXPECT_TRUE(mv.empty());
+  memory.endDefragment();
+
+  // page is back in use
+  auto b = memory.alloc(64,1,0,0,false);
+  EXPECT_EQ(b.page,a[0].page);
+  memory.free(b);
+  memory.free(a[0]);
+  for(size_t i=16; i<32; ++i)
+    memory.free(a[i]);
+  }
+
+TEST(main, DeviceAllocatorOwnerReset) {
+  TestDevice device;
+  DeviceAllocator<TestDevice> memory(device);
+  memory.setDefaultPageSize(1024);
+
+  std::vector<DeviceAllocator<TestDevice>::Allocation> a;
+  for(size_t i=0; i<32; ++i)
+    a.push_back(memory.alloc(64,1,0,0,false));
+
+  int live = 0, dead = 0;
+  memory.setOwner(a[0],&live);
+  memory.setOwner(a[1],&dead);
+  for(size_t i=1; i<16; ++i)
+    memory.free(a[i]);
+
+  // reuses block of freed relocatable allocation, but is not owned by anyone
+  auto b = memory.alloc(64,1,0,0,false);
+  EXPECT_EQ(b.page,a[0].page);
+
+  std::vector<void*> owners;
+  auto mv = memory.defragment(size_t(-1),0.25,[&owners](void* owner) -> size_t {
+    owners.push_back(owner);
+    return 1;
+    });
+  EXPECT_TRUE(mv.empty());
+  memory.endDefragment();
+  for(auto i:owners)
+    EXPECT_NE(i,&dead);
+
+  memory.free(b);
+  memory.free(a[0]);
+  for(size_t i=16; i<32; ++i)
+    memory.free(a[i]);
+  }
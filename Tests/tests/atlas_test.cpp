@@ -3,6 +3,7 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
+#include <stdexcept>
 
 using namespace testing;
 using namespace Tempest::Detail;
@@ -44,6 +45,26 @@ TEST(main, AtlasAlloator1) {
   s1=Allocation();
   }
 
+TEST(main, AtlasAllocInit) {
+  TestDevice device;
+  Allocator  allocator(device);
+
+  void*          page = nullptr;
+  Tempest::Point at;
+  auto a = allocator.alloc(16,16,[&](void*& mem, const Tempest::Point& p) {
+    page = mem;
+    at   = p;
+    });
+  EXPECT_EQ(page, a.memory());
+  EXPECT_EQ(at,   a.pos());
+
+  a.access([&](void*& mem) { EXPECT_EQ(mem, page); });
+
+  // throwing init leaves nothing allocated
+  EXPECT_THROW(allocator.alloc(16,16,[](void*&, const Tempest::Point&){ throw std::runtime_error("init"); }), std::runtime_error);
+  EXPECT_EQ(allocator.stats().allocationCount, 1u);
+  }
+
 TEST(main, AtlasBlockAlloator0) {
   /*
   Allocator::Block<int> b;
@@ -65,3 +86,200 @@ TEST(main, AtlasBlockAlloator1) {
     b.free(st[i]);
     */
   }
+
+TEST(main, AtlasSkyline) {
+  TestDevice device;
+  Allocator  allocator(device);
+  allocator.setDefaultPageSize(256);
+
+  std::vector<Allocation> all;
+  for(int i=0; i<256; ++i)
+    all.push_back(allocator.alloc(16,16));
+
+  // 256 16x16 sprites fill 256x256 page exactly
+  auto st = allocator.stats();
+  EXPECT_EQ(st.pageCount,      1u);
+  EXPECT_EQ(st.allocationCount,256u);
+  EXPECT_EQ(st.occupancy(),    1.f);
+
+  for(size_t i=0; i<all.size(); ++i)
+    for(size_t r=i+1; r<all.size(); ++r) {
+      auto a = all[i].pos(), b = all[r].pos();
+      ASSERT_TRUE(std::abs(a.x-b.x)>=16 || std::abs(a.y-b.y)>=16);
+      }
+  }
+
+TEST(main, AtlasSkylineMixed) {
+  TestDevice device;
+  Allocator  allocator(device);
+  allocator.setDefaultPageSize(256);
+
+  // mixed sizes: skyline of many segments, with steps both up and down
+  std::vector<Allocation> all;
+  std::vector<Tempest::Size> sz;
+  uint32_t seed = 1;
+  for(int i=0; i<512; ++i) {
+    seed = seed*1103515245u + 12345u;
+    const uint32_t w = 1+(seed>>16)%40;
+    const uint32_t h = 1+(seed>>8)%40;
+    all.push_back(allocator.alloc(w,h));
+    sz.emplace_back(int(w),int(h));
+    if(i%3==0)
+      all[size_t(i/2)] = Allocation();
+    }
+
+  for(size_t i=0; i<all.size(); ++i) {
+    if(all[i].pageId()==nullptr)
+      continue;
+    const auto ra = all[i].pageRect();
+    ASSERT_LE(ra.x+sz[i].w,ra.w);
+    ASSERT_LE(ra.y+sz[i].h,ra.h);
+    for(size_t r=i+1; r<all.size(); ++r) {
+      if(all[r].pageId()!=all[i].pageId())
+        continue;
+      const auto rb = all[r].pageRect();
+      ASSERT_TRUE(ra.x+sz[i].w<=rb.x || rb.x+sz[r].w<=ra.x ||
+                  ra.y+sz[i].h<=rb.y || rb.y+sz[r].h<=ra.y);
+      }
+    }
+  }
+
+TEST(main, AtlasReuse) {
+  TestDevice device;
+  Allocator  allocator(device);
+  allocator.setDefaultPageSize(64);
+
+  auto a = allocator.alloc(64,32);
+  auto b = allocator.alloc(64,32);
+  EXPECT_EQ(allocator.stats().pageCount,1u);
+
+  // released rectangle is reused, instead of new page
+  auto pos = a.pos();
+  a = Allocation();
+  auto c = allocator.alloc(32,32);
+  auto d = allocator.alloc(32,32);
+  EXPECT_EQ(allocator.stats().pageCount,1u);
+  EXPECT_EQ(c.pos().y,pos.y);
+  EXPECT_EQ(d.pos().y,pos.y);
+
+  // empty page is reset
+  b = Allocation();
+  c = Allocation();
+  d = Allocation();
+  auto e = allocator.alloc(64,64);
+  EXPECT_EQ(allocator.stats().pageCount,1u);
+  EXPECT_EQ(allocator.stats().occupancy(),1.f);
+  }
+
+TEST(main, AtlasLargeSprite) {
+  TestDevice device;
+  Allocator  allocator(device);
+
+  auto a  = allocator.alloc(1024,16);
+  auto st = allocator.stats();
+  EXPECT_EQ(st.pageCount,1u);
+  EXPECT_EQ(st.totalArea,uint64_t(1024*512));
+  }
+
+TEST(main, AtlasCompact) {
+  TestDevice device;
+  Allocator  allocator(device);
+  allocator.setDefaultPageSize(64);
+
+  std::vector<Allocation> all;
+  for(int i=0; i<16; ++i) {
+    all.push_back(allocator.alloc(32,32));
+    auto  p   = all.back().pos();
+    auto  mem = reinterpret_cast<uint8_t*>(all.back().memory());
+    mem[p.y*64+p.x] = uint8_t(i);
+    }
+  EXPECT_EQ(allocator.stats().pageCount,4u);
+
+  // keep one sprite per page
+  std::vector<Allocation> live;
+  std::vector<int>        id;
+  for(int i=0; i<16; ++i)
+    if(i%4==0) {
+      live.push_back(all[size_t(i)]);
+      id.push_back(i);
+      }
+  all.clear();
+
+  size_t moves = 0;
+  auto   freed = allocator.compact([&](void* src, const Tempest::Rect& r, void* dst, const Tempest::Point& at) {
+    auto s = reinterpret_cast<uint8_t*>(src);
+    auto d = reinterpret_cast<uint8_t*>(dst);
+    d[at.y*64+at.x] = s[r.y*64+r.x];
+    ++moves;
+    });
+  EXPECT_EQ(freed,3u);
+  EXPECT_EQ(moves,4u);
+
+  auto st = allocator.stats();
+  EXPECT_EQ(st.pageCount,      1u);
+  EXPECT_EQ(st.allocationCount,4u);
+  EXPECT_EQ(st.occupancy(),    1.f);
+
+  for(size_t i=0; i<live.size(); ++i) {
+    auto p   = live[i].pos();
+    auto mem = reinterpret_cast<uint8_t*>(live[i].memory());
+    EXPECT_EQ(live[i].pageId(),live[0].pageId());
+    EXPECT_EQ(mem[p.y*64+p.x],uint8_t(id[i]));
+    for(size_t r=i+1; r<live.size(); ++r) {
+      auto b = live[r].pos();
+      ASSERT_TRUE(std::abs(p.x-b.x)>=32 || std::abs(p.y-b.y)>=32);
+      }
+    }
+
+  auto nop = [](void*, const Tempest::Rect&, void*, const Tempest::Point&){};
+  // nothing to gain
+  EXPECT_EQ(allocator.compact(nop),0u);
+
+  live.clear();
+  EXPECT_EQ(allocator.compact(nop),1u);
+  EXPECT_EQ(allocator.stats().pageCount,0u);
+  }
+
+TEST(main, AtlasCompactFlush) {
+  struct CountingDevice {
+    using DeviceMemory=void*;
+
+    DeviceMemory alloc(uint32_t w,uint32_t h){
+      return std::malloc(w*h);
+      }
+
+    void free(DeviceMemory m){
+      std::free(m);
+      ++freed;
+      }
+
+    size_t freed = 0;
+    };
+
+  CountingDevice                         device;
+  Tempest::RectAllocator<CountingDevice> allocator(device);
+  allocator.setDefaultPageSize(64);
+
+  std::vector<Tempest::RectAllocator<CountingDevice>::Allocation> all, live;
+  for(int i=0; i<16; ++i)
+    all.push_back(allocator.alloc(32,32));
+  for(size_t i=0; i<all.size(); i+=4)
+    live.push_back(all[i]);
+  all.clear();
+
+  size_t moves = 0, flushes = 0;
+  auto   move  = [&](void*, const Tempest::Rect&, void*, const Tempest::Point&){ ++moves; };
+  auto   flush = [&]() {
+    // old pages are still alive: source of GPU-side copies
+    EXPECT_EQ(moves,4u);
+    EXPECT_EQ(device.freed,0u);
+    ++flushes;
+    };
+  EXPECT_EQ(allocator.compact(move,flush),3u);
+  EXPECT_EQ(flushes,1u);
+  EXPECT_EQ(device.freed,4u);
+
+  // sprite, released after compact(), goes back to its new page
+  live.pop_back();
+  EXPECT_EQ(allocator.stats().allocationCount,3u);
+  }
@@ -0,0 +1,63 @@
+#include "../gapi/descriptorrefs.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+namespace {
+struct TestSet {
+  std::atomic<bool> stale{false};
+  };
+}
+
+TEST(main, DescriptorRefsInvalidate) {
+  DescriptorRefs<TestSet> refs;
+  TestSet a, b, c;
+
+  const uint64_t ha[] = {1, 2};
+  const uint64_t hb[] = {2, 3};
+  const uint64_t hc[] = {4};
+  refs.link(a,ha,2);
+  refs.link(b,hb,2);
+  refs.link(c,hc,1);
+  EXPECT_EQ(refs.size(),5u);
+
+  // unrelated handle
+  refs.invalidate(5);
+  EXPECT_FALSE(a.stale.load());
+  EXPECT_FALSE(b.stale.load());
+  EXPECT_FALSE(c.stale.load());
+
+  // only sets, that refer to destroyed handle
+  refs.invalidate(2);
+  EXPECT_TRUE (a.stale.load());
+  EXPECT_TRUE (b.stale.load());
+  EXPECT_FALSE(c.stale.load());
+  EXPECT_EQ(refs.size(),3u);
+
+  refs.invalidate(3);
+  EXPECT_FALSE(c.stale.load());
+  }
+
+TEST(main, DescriptorRefsUnlink) {
+  DescriptorRefs<TestSet> refs;
+  TestSet a, b;
+
+  const uint64_t ha[] = {1, 2};
+  const uint64_t hb[] = {1};
+  refs.link(a,ha,2);
+  refs.link(b,hb,1);
+
+  // evicted set is not touched by later invalidation
+  refs.unlink(a,ha,2);
+  EXPECT_EQ(refs.size(),1u);
+  refs.invalidate(1);
+  EXPECT_FALSE(a.stale.load());
+  EXPECT_TRUE (b.stale.load());
+  EXPECT_EQ(refs.size(),0u);
+
+  // handle of stale set was forgotten already
+  refs.unlink(b,hb,1);
+  EXPECT_EQ(refs.size(),0u);
+  }
@@ -0,0 +1,81 @@
+#include "../2d/drawbatcher.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+static DrawBatcher::Item mkItem(uint32_t key, size_t begin, size_t size, float x, float y, float w = 1, float h = 1) {
+  DrawBatcher::Item it;
+  it.key   = key;
+  it.begin = begin;
+  it.size  = size;
+  it.x0    = x;
+  it.y0    = y;
+  it.x1    = x+w;
+  it.y1    = y+h;
+  return it;
+  }
+
+TEST(main, DrawBatcherAdjacent) {
+  DrawBatcher b;
+  b.build({mkItem(0,0,6,0,0), mkItem(0,6,6,0,0), mkItem(1,12,3,0,0)});
+
+  ASSERT_EQ(b.batches().size(),2u);
+  EXPECT_FALSE(b.isReordered());
+  EXPECT_EQ(b.batches()[0].begin,0u);
+  EXPECT_EQ(b.batches()[0].size, 12u);
+  EXPECT_EQ(b.batches()[1].begin,12u);
+  EXPECT_EQ(b.batches()[1].size, 3u);
+  }
+
+TEST(main, DrawBatcherInterleaved) {
+  // text and shapes, that do not overlap: A B A B -> AA BB
+  DrawBatcher b;
+  b.build({mkItem(0,0,6,0,0), mkItem(1,6,6,2,0), mkItem(0,12,6,4,0), mkItem(1,18,6,6,0)});
+
+  ASSERT_EQ(b.batches().size(),2u);
+  EXPECT_TRUE(b.isReordered());
+  EXPECT_EQ(b.order(),(std::vector<size_t>{0,2,1,3}));
+  EXPECT_EQ(b.batches()[0].begin,0u);
+  EXPECT_EQ(b.batches()[0].size, 12u);
+  EXPECT_EQ(b.batches()[1].begin,12u);
+  EXPECT_EQ(b.batches()[1].size, 12u);
+  }
+
+TEST(main, DrawBatcherOverlap) {
+  // B is drawn over A; second A overlaps B, so it can't be moved before it
+  DrawBatcher b;
+  b.build({mkItem(0,0,6,0,0,4,4), mkItem(1,6,6,1,1), mkItem(0,12,6,1.5f,1.5f)});
+
+  ASSERT_EQ(b.batches().size(),3u);
+  EXPECT_FALSE(b.isReordered());
+  }
+
+TEST(main, DrawBatcherEmpty) {
+  DrawBatcher b;
+  b.build({mkItem(0,0,0,0,0), mkItem(1,0,3,0,0), mkItem(0,3,0,0,0)});
+  ASSERT_EQ(b.batches().size(),1u);
+  EXPECT_EQ(b.batches()[0].key,1u);
+  EXPECT_EQ(b.order(),(std::vector<size_t>{1}));
+  }
+
+TEST(main, DrawBatcherLinePadding) {
+  // line B ends half a pixel before second A, but may rasterize past its end point
+  auto line = mkItem(1,6,2,2,0,0.5f,0);
+  line.padX = 1;
+  line.padY = 1;
+
+  DrawBatcher b;
+  b.build({mkItem(0,0,6,0,0), line, mkItem(0,8,6,3,0)});
+  ASSERT_EQ(b.batches().size(),3u);
+  EXPECT_FALSE(b.isReordered());
+
+  // same geometry without padding: second A is moved before B
+  line.padX = 0;
+  line.padY = 0;
+  b.build({mkItem(0,0,6,0,0), line, mkItem(0,8,6,3,0)});
+  ASSERT_EQ(b.batches().size(),2u);
+  EXPECT_TRUE(b.isReordered());
+  }
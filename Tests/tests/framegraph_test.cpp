@@ -0,0 +1,98 @@
+#include "../gapi/framegraphplan.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static FrameGraphPlan::Desc attachment(TextureFormat frm, uint32_t w, uint32_t h) {
+  FrameGraphPlan::Desc d;
+  d.kind   = FrameGraphPlan::K_Attachment;
+  d.format = frm;
+  d.w      = w;
+  d.h      = h;
+  return d;
+  }
+
+TEST(main, FrameGraphCull) {
+  FrameGraphPlan plan;
+  auto gbuffer   = plan.addTransient(attachment(TextureFormat::RGBA8,  64,64));
+  auto unused    = plan.addTransient(attachment(TextureFormat::RGBA16, 64,64));
+  auto swapchain = plan.addImported(FrameGraphPlan::K_Attachment);
+
+  auto fill  = plan.addPass(false);
+  auto debug = plan.addPass(false);
+  auto light = plan.addPass(false);
+  auto query = plan.addPass(true);
+
+  plan.write(fill,  gbuffer);
+  plan.write(debug, unused);
+  plan.read (light, gbuffer);
+  plan.write(light, swapchain);
+  plan.compile();
+
+  EXPECT_FALSE(plan.isCulled(fill));
+  EXPECT_TRUE (plan.isCulled(debug));
+  EXPECT_FALSE(plan.isCulled(light));
+  EXPECT_FALSE(plan.isCulled(query));
+
+  EXPECT_EQ(plan.firstUse(gbuffer), fill);
+  EXPECT_EQ(plan.lastUse (gbuffer), light);
+  EXPECT_EQ(plan.firstUse(unused),  FrameGraphPlan::NoId);
+  EXPECT_EQ(plan.physicalCount(),   1u);
+  }
+
+TEST(main, FrameGraphCullOverwrite) {
+  // second write replaces content, so first writer contributes nothing
+  FrameGraphPlan plan;
+  auto tmp       = plan.addTransient(attachment(TextureFormat::RGBA8,64,64));
+  auto swapchain = plan.addImported(FrameGraphPlan::K_Attachment);
+
+  auto p0 = plan.addPass(false);
+  auto p1 = plan.addPass(false);
+  auto p2 = plan.addPass(false);
+  plan.write(p0,tmp);
+  plan.write(p1,tmp);
+  plan.read (p2,tmp);
+  plan.write(p2,swapchain);
+  plan.compile();
+
+  EXPECT_TRUE (plan.isCulled(p0));
+  EXPECT_FALSE(plan.isCulled(p1));
+  EXPECT_FALSE(plan.isCulled(p2));
+  }
+
+TEST(main, FrameGraphAliasing) {
+  FrameGraphPlan plan;
+  auto a         = plan.addTransient(attachment(TextureFormat::RGBA8,  64,64));
+  auto b         = plan.addTransient(attachment(TextureFormat::RGBA8,  64,64));
+  auto c         = plan.addTransient(attachment(TextureFormat::RGBA8,  64,64));
+  auto hdr       = plan.addTransient(attachment(TextureFormat::RGBA16, 64,64));
+  auto swapchain = plan.addImported(FrameGraphPlan::K_Attachment);
+
+  // a -> b -> c -> swapchain: a and c never overlap
+  auto p0 = plan.addPass(false);
+  auto p1 = plan.addPass(false);
+  auto p2 = plan.addPass(false);
+  auto p3 = plan.addPass(false);
+  plan.write(p0,a);
+  plan.read (p1,a);
+  plan.write(p1,b);
+  plan.write(p1,hdr);
+  plan.read (p2,b);
+  plan.read (p2,hdr);
+  plan.write(p2,c);
+  plan.read (p3,c);
+  plan.write(p3,swapchain);
+  plan.compile();
+
+  EXPECT_EQ (plan.physical(a), plan.physical(c));
+  EXPECT_NE (plan.physical(a), plan.physical(b));
+  EXPECT_NE (plan.physical(b), plan.physical(c));
+  EXPECT_NE (plan.physical(hdr), plan.physical(a));
+  EXPECT_EQ (plan.physical(swapchain), FrameGraphPlan::NoId);
+  EXPECT_EQ (plan.physicalCount(), 3u);
+  EXPECT_TRUE(plan.physicalDesc(plan.physical(hdr))==attachment(TextureFormat::RGBA16,64,64));
+  }
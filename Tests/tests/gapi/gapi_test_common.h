@@ -3,7 +3,10 @@
 #include <Tempest/Device>
 #include <Tempest/Except>
 #include <Tempest/Fence>
+#include <Tempest/FrameGraph>
 #include <Tempest/Pixmap>
+#include <Tempest/TextureAtlas>
+#include <Tempest/Sprite>
 #include <Tempest/Log>
 #include <Tempest/Matrix4x4>
 #include <Tempest/Vec>
@@ -1109,6 +1112,43 @@ void S3TC(const char* /*outImage*/) {
     }
   }
 
+template<class GraphicsApi>
+void TextureAtlas() {
+  using namespace Tempest;
+  try {
+    GraphicsApi           api{ApiFlags::Validation};
+    Device                device(api);
+    Tempest::TextureAtlas atlas(device);
+
+    Pixmap red(16,16,TextureFormat::RGBA8);
+    Pixmap green(8,8,TextureFormat::RGBA8);
+    for(size_t i=0; i<red.dataSize(); i+=4)
+      reinterpret_cast<uint32_t*>(red.data())[i/4] = 0xFF0000FF;
+    for(size_t i=0; i<green.dataSize(); i+=4)
+      reinterpret_cast<uint32_t*>(green.data())[i/4] = 0xFF00FF00;
+
+    auto  s0  = atlas.load(red);
+    auto& tex = s0.pageRawData(device);
+
+    // second sprite lands on the same page and is uploaded as a sub-region
+    auto  s1  = atlas.load(green);
+    ASSERT_EQ(s0.pageId(),s1.pageId());
+    EXPECT_EQ(&s1.pageRawData(device),&tex);
+
+    auto pm  = device.readPixels(tex);
+    auto px  = reinterpret_cast<const uint32_t*>(pm.data());
+    auto p0  = s0.pageRect();
+    auto p1  = s1.pageRect();
+    EXPECT_EQ(px[size_t(p0.y)*pm.w()+size_t(p0.x)],0xFF0000FF);
+    EXPECT_EQ(px[size_t(p1.y)*pm.w()+size_t(p1.x)],0xFF00FF00);
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 template<class GraphicsApi>
 void SsboWrite() {
   using namespace Tempest;
@@ -2144,4 +2184,38 @@ void DispathIndirect() {
       throw;
     }
   }
+template<class GraphicsApi>
+void FrameGraphPool() {
+  using namespace Tempest;
+
+  try {
+    GraphicsApi api{ApiFlags::Validation};
+    Device      device(api);
+    auto        out = device.attachment(TextureFormat::RGBA8,64,64);
+
+    FrameGraph graph(device);
+    auto build = [&](uint32_t w, uint32_t h) {
+      graph.clear();
+      auto tmp = graph.attachment(TextureFormat::RGBA8,w,h);
+      auto dst = graph.import(out);
+      graph.addPass("a",[](Encoder<CommandBuffer>&, const FrameGraph::Resources&){}).write(tmp);
+      graph.addPass("b",[](Encoder<CommandBuffer>&, const FrameGraph::Resources&){}).read(tmp).write(dst);
+      graph.compile();
+      };
+
+    build(64,64);
+    EXPECT_EQ(graph.transientCount(),1u);
+    // texture of old size is not used anymore
+    build(128,128);
+    EXPECT_EQ(graph.transientCount(),1u);
+    build(128,128);
+    EXPECT_EQ(graph.transientCount(),1u);
+    }
+  catch(std::system_error& e) {
+    if(e.code()==Tempest::GraphicsErrc::NoDevice)
+      Log::d("Skipping graphics testcase: ", e.what()); else
+      throw;
+    }
+  }
+
 }
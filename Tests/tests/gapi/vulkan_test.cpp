@@ -186,6 +186,12 @@ TEST(VulkanApi,S3TC) {
 #endif
   }
 
+TEST(VulkanApi,TextureAtlas) {
+#if !defined(__OSX__)
+  GapiTestCommon::TextureAtlas<VulkanApi>();
+#endif
+  }
+
 TEST(VulkanApi,PsoTess) {
 #if !defined(__OSX__)
   GapiTestCommon::PsoTess<VulkanApi>();
@@ -305,3 +311,9 @@ TEST(VulkanApi,DispathIndirect) {
   GapiTestCommon::DispathIndirect<VulkanApi>();
 #endif
   }
+
+TEST(VulkanApi,FrameGraphPool) {
+#if !defined(__OSX__)
+  GapiTestCommon::FrameGraphPool<VulkanApi>();
+#endif
+  }
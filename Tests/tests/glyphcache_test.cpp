@@ -0,0 +1,138 @@
+#include "../formats/glyphcache.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <string>
+#include <thread>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+using Cache = GlyphCache<int>;
+
+TEST(main, GlyphCacheFind) {
+  Cache cache;
+
+  int a18 = 0, a24 = 0, b18 = 0;
+  EXPECT_FALSE(cache.find(Cache::key(18.f,'a'),a18));
+  cache.insert(Cache::key(18.f,'a'),1,0);
+  cache.insert(Cache::key(24.f,'a'),2,0);
+
+  ASSERT_TRUE(cache.find(Cache::key(18.f,'a'),a18));
+  ASSERT_TRUE(cache.find(Cache::key(24.f,'a'),a24));
+  EXPECT_EQ(a18,1);
+  EXPECT_EQ(a24,2);
+  EXPECT_FALSE(cache.find(Cache::key(18.f,'b'),b18));
+  EXPECT_EQ(cache.size(),2u);
+  }
+
+TEST(main, GlyphCacheReplace) {
+  Cache cache;
+
+  cache.insert(Cache::key(18.f,'a'),1,0);
+  cache.insert(Cache::key(18.f,'a'),2,0);
+
+  int a = 0;
+  ASSERT_TRUE(cache.find(Cache::key(18.f,'a'),a));
+  EXPECT_EQ(a,2);
+  EXPECT_EQ(cache.size(),1u);
+  }
+
+TEST(main, GlyphCacheGrow) {
+  Cache cache;
+
+  for(char32_t ch=0; ch<0x10000; ++ch)
+    cache.insert(Cache::key(12.f,ch),int(ch),0);
+  for(char32_t ch=0; ch<0x10000; ++ch) {
+    int v = -1;
+    ASSERT_TRUE(cache.find(Cache::key(12.f,ch),v));
+    EXPECT_EQ(v,int(ch));
+    }
+  }
+
+TEST(main, GlyphCacheBudget) {
+  Cache cache;
+  cache.setBudget(64*1024);
+
+  for(char32_t ch=0; ch<4096; ++ch)
+    cache.insert(Cache::key(12.f,ch),int(ch),1024);
+  EXPECT_LE(cache.memoryUsage(),cache.memoryBudget());
+
+  // most recent glyph is always resident
+  int v = -1;
+  ASSERT_TRUE(cache.find(Cache::key(12.f,4095),v));
+  EXPECT_EQ(v,4095);
+  EXPECT_FALSE(cache.find(Cache::key(12.f,0),v));
+
+  // glyphs, touched since last eviction pass, are kept
+  cache.setBudget(0);
+  EXPECT_GT(cache.size(),0u);
+  cache.setBudget(0);
+  EXPECT_EQ(cache.size(),0u);
+  EXPECT_EQ(cache.memoryUsage(),0u);
+  }
+
+TEST(main, GlyphCacheLru) {
+  Cache cache;
+  cache.setBudget(64*1024);
+
+  cache.insert(Cache::key(12.f,'a'),-1,1024);
+  for(char32_t ch=0; ch<4096; ++ch) {
+    // keep 'a' hot
+    int a = 0;
+    ASSERT_TRUE(cache.find(Cache::key(12.f,'a'),a));
+    cache.insert(Cache::key(16.f,ch),int(ch),1024);
+    }
+  int a = 0;
+  ASSERT_TRUE(cache.find(Cache::key(12.f,'a'),a));
+  EXPECT_EQ(a,-1);
+  }
+
+TEST(main, GlyphCacheKey) {
+  // sizes, that differ less than 1/100, or overflow 32 bits when scaled, are distinct
+  EXPECT_NE(Cache::key(12.f,'a'),    Cache::key(12.001f,'a'));
+  EXPECT_NE(Cache::key(5e7f,'a'),    Cache::key(6e7f,'a'));
+  EXPECT_NE(Cache::key(12.f,0x10FFFF),Cache::key(12.f,'a'));
+  EXPECT_EQ(Cache::key(0.f,'a'),     Cache::key(-0.f,'a'));
+  }
+
+TEST(main, GlyphCacheConcurrent) {
+  // copied value stays intact, while writer evicts and recycles nodes
+  GlyphCache<std::string> cache;
+  cache.setBudget(16*1024);
+
+  std::atomic<bool> done{false};
+  std::atomic<int>  bad{0};
+  std::thread reader([&](){
+    while(!done.load()) {
+      for(char32_t ch=0; ch<256; ++ch) {
+        std::string v;
+        if(cache.find(GlyphCache<std::string>::key(12.f,ch),v) && v!=std::string(64,char('a'+ch%26)))
+          bad.fetch_add(1);
+        }
+      }
+    });
+  for(int i=0; i<64; ++i)
+    for(char32_t ch=0; ch<256; ++ch)
+      cache.insert(GlyphCache<std::string>::key(12.f,ch),std::string(64,char('a'+ch%26)),256);
+  done.store(true);
+  reader.join();
+  EXPECT_EQ(bad.load(),0);
+  }
+
+TEST(main, GlyphCacheRetired) {
+  Cache cache;
+  cache.setBudget(0);
+
+  // replaced value is released by eviction pass, that runs after replacement
+  cache.insert(Cache::key(12.f,'a'),1,0);
+  cache.insert(Cache::key(12.f,'a'),2,0);
+  cache.setBudget(0);
+  cache.setBudget(0);
+  EXPECT_EQ(cache.size(),0u);
+  EXPECT_EQ(cache.memoryUsage(),0u);
+
+  int a = 0;
+  EXPECT_FALSE(cache.find(Cache::key(12.f,'a'),a));
+  }
@@ -0,0 +1,78 @@
+#include "../gapi/gputimerscopes.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+TEST(main, GpuTimerScopesLifecycle) {
+  GpuTimerScopes s;
+
+  // recording, that started before pools were reset: scopes are tracked, but no queries issued
+  EXPECT_EQ(s.beginScope("early"),uint32_t(GpuTimerScopes::NoQuery));
+  EXPECT_EQ(s.endScope(),         uint32_t(GpuTimerScopes::NoQuery));
+
+  s.begin(8,4);
+  EXPECT_TRUE(s.isReady());
+  EXPECT_TRUE(s.isEmpty());
+
+  EXPECT_EQ(s.beginScope("frame"),0u);
+  EXPECT_EQ(s.beginPass(),0u);
+  EXPECT_EQ(s.endPass(),  0u);
+  EXPECT_EQ(s.beginScope("shadow"),2u);
+  EXPECT_EQ(s.beginPass(),1u);
+  EXPECT_EQ(s.endPass(),  1u);
+  EXPECT_EQ(s.endScope(),3u);
+
+  // "frame" is left open: closed at the end of recording
+  std::vector<uint32_t> closed;
+  s.end([&](uint32_t ts){ closed.push_back(ts); });
+  EXPECT_EQ(closed,std::vector<uint32_t>({1u}));
+  EXPECT_FALSE(s.isReady());
+  EXPECT_EQ(s.timestampCount(), 4u);
+  EXPECT_EQ(s.statisticsCount(),2u);
+  EXPECT_FALSE(s.isOverflow());
+
+  // results are read back, once command buffer is recorded again
+  const uint64_t ts[4] = {100, 300, 150, 250};
+  const uint64_t st[2*GpuTimerScopes::StatCount] = {1,2,3,4, 10,20,30,40};
+  std::vector<GpuTiming> out;
+  s.resolve(ts,st,0.5,out);
+
+  ASSERT_EQ(out.size(),2u);
+  EXPECT_EQ(out[0].name,"frame");
+  EXPECT_EQ(out[0].parent,uint32_t(-1));
+  EXPECT_EQ(out[0].begin,   0.0);
+  EXPECT_EQ(out[0].duration,100.0);
+  EXPECT_EQ(out[0].inputPrimitives,11u);
+  EXPECT_EQ(out[0].fsInvocations,  44u);
+
+  EXPECT_EQ(out[1].name,"shadow");
+  EXPECT_EQ(out[1].parent,0u);
+  EXPECT_EQ(out[1].depth, 1u);
+  EXPECT_EQ(out[1].begin,   25.0);
+  EXPECT_EQ(out[1].duration,50.0);
+  EXPECT_EQ(out[1].inputPrimitives,10u);
+  EXPECT_TRUE(s.isEmpty());
+  }
+
+TEST(main, GpuTimerScopesOverflow) {
+  GpuTimerScopes s;
+  s.begin(2,0);
+
+  EXPECT_EQ(s.beginScope("a"),0u);
+  // no room for second pair
+  EXPECT_EQ(s.beginScope("b"),uint32_t(GpuTimerScopes::NoQuery));
+  EXPECT_TRUE(s.isOverflow());
+  // no statistics pool: not an overflow, just no query
+  EXPECT_EQ(s.beginPass(),uint32_t(GpuTimerScopes::NoQuery));
+  EXPECT_EQ(s.endPass(),  uint32_t(GpuTimerScopes::NoQuery));
+  s.end([](uint32_t){});
+
+  // larger pools on next recording
+  s.begin(4,0);
+  EXPECT_FALSE(s.isOverflow());
+  EXPECT_EQ(s.beginScope("a"),0u);
+  EXPECT_EQ(s.beginScope("b"),2u);
+  }
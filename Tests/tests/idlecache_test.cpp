@@ -0,0 +1,84 @@
+#include "../gapi/idlecache.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+namespace {
+struct TestObj {
+  explicit TestObj(int key):key(key){}
+  int key = 0;
+  };
+}
+
+TEST(main, IdleCacheFind) {
+  IdleCache<TestObj> cache(4);
+  int                created = 0;
+
+  auto get = [&](uint64_t hash, int key) {
+    auto match = [key](const TestObj& o){ return o.key==key; };
+    auto mk    = [&created,key](){ ++created; return std::make_shared<TestObj>(key); };
+    return cache.find(hash,match,mk);
+    };
+
+  auto a = get(1,10);
+  auto b = get(1,11); // hash collision: distinct object
+  EXPECT_NE(a,b);
+  EXPECT_EQ(get(1,10),a);
+  EXPECT_EQ(get(1,11),b);
+  EXPECT_EQ(created,2);
+  EXPECT_EQ(cache.size(),2u);
+  }
+
+TEST(main, IdleCacheEviction) {
+  IdleCache<TestObj> cache(4);
+  std::vector<int>   released;
+
+  auto get = [&](uint64_t hash, int key) {
+    auto match = [key](const TestObj& o){ return o.key==key; };
+    auto mk    = [key](){ return std::make_shared<TestObj>(key); };
+    return cache.find(hash,match,mk);
+    };
+  auto release = [&](TestObj& o){ released.push_back(o.key); };
+
+  get(1,1);
+  get(2,2);
+  auto held = get(3,3); // referenced by command buffer
+
+  for(int i=0; i<3; ++i) {
+    cache.nextFrame(release);
+    get(2,2);
+    }
+  // 4th frame: idle ones are checked
+  cache.nextFrame(release);
+  EXPECT_EQ(released,std::vector<int>({1}));
+  EXPECT_EQ(cache.size(),2u);
+
+  held.reset();
+  for(int i=0; i<4; ++i)
+    cache.nextFrame(release);
+  EXPECT_EQ(cache.size(),0u);
+  EXPECT_EQ(released.size(),3u);
+  }
+
+TEST(main, IdleCacheErase) {
+  IdleCache<TestObj> cache(4);
+  std::vector<int>   released;
+
+  for(int i=0; i<4; ++i) {
+    auto match = [i](const TestObj& o){ return o.key==i; };
+    auto mk    = [i](){ return std::make_shared<TestObj>(i); };
+    cache.find(uint64_t(i),match,mk);
+    }
+  auto isOdd = [](const TestObj& o){ return o.key%2==1; };
+  cache.erase(isOdd,[&](TestObj& o){ released.push_back(o.key); });
+  EXPECT_EQ(cache.size(),2u);
+  EXPECT_EQ(released.size(),2u);
+
+  int cnt = 0;
+  cache.forEach([&](TestObj& o){ EXPECT_EQ(o.key%2,0); ++cnt; });
+  EXPECT_EQ(cnt,2);
+  }
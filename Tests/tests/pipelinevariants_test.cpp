@@ -0,0 +1,75 @@
+#include "../gapi/pipelinevariants.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <thread>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+namespace {
+struct TestInst {
+  enum State : uint8_t {
+    Ready,
+    Pending,
+    Failed,
+    };
+  TestInst(int key, int val):key(key),val(val){}
+
+  int   key   = 0;
+  int   val   = 0;
+  State state = Ready;
+  };
+}
+
+TEST(main, PipelineVariantsFailedAsync) {
+  PipelineVariants<TestInst> v;
+  int                        compiled = 0;
+  int                        queued   = 0;
+
+  auto match   = [](const TestInst& i){ return i.key==1; };
+  auto mk      = [](int val){ return TestInst(1,val); };
+  auto fail    = [&]() -> int { ++compiled; throw std::runtime_error("compile"); };
+  auto enqueue = [&](){ ++queued; };
+
+  EXPECT_EQ(v.get(true,match,mk,fail,enqueue), 0);
+  EXPECT_EQ(queued, 1);
+  EXPECT_EQ(v.get(true,match,mk,fail,enqueue), 0); // still pending
+  EXPECT_EQ(queued, 1);
+
+  EXPECT_TRUE(v.complete(match,0,false));
+  // async lookup must not drop failed variant silently
+  EXPECT_THROW(v.get(true,match,mk,fail,enqueue), std::runtime_error);
+  EXPECT_EQ(compiled, 1);
+
+  EXPECT_TRUE(v.inst.empty());
+
+  auto ok = []{ return 42; };
+  EXPECT_EQ(v.get(false,match,mk,ok,enqueue), 42);
+  EXPECT_EQ(v.get(true, match,mk,ok,enqueue), 42);
+  EXPECT_EQ(queued, 1);
+  }
+
+TEST(main, PipelineVariantsWaitPending) {
+  PipelineVariants<TestInst> v;
+  auto match = [](const TestInst& i){ return i.key==1; };
+  auto mk    = [](int val){ return TestInst(1,val); };
+
+  std::thread worker;
+  v.get(true,match,mk,[]{ return -1; },[&](){
+    worker = std::thread([&v,match](){
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      v.complete(match,7,true);
+      });
+    });
+
+  // synchronous lookup waits for worker, rather than compiling a duplicate
+  int  compiled = 0;
+  auto compile  = [&]{ ++compiled; return -1; };
+  auto nop      = []{};
+  EXPECT_EQ(v.get(false,match,mk,compile,nop), 7);
+  EXPECT_EQ(compiled, 0);
+  EXPECT_EQ(v.inst.size(), 1u);
+  worker.join();
+  }
@@ -4,6 +4,7 @@
 
 #include <gtest/gtest.h>
 #include <gmock/gmock-matchers.h>
+#include <chrono>
 #include <sstream>
 
 using namespace testing;
@@ -60,45 +61,45 @@ struct TestTexture : Tempest::AbstractGraphicsApi::Texture {
   };
 
 struct TestCommandBuffer : Tempest::AbstractGraphicsApi::CommandBuffer {
-  void beginRendering(const AttachmentDesc* desc, size_t descSize,
-                      uint32_t w, uint32_t h,
-                      const TextureFormat* frm,
-                      AbstractGraphicsApi::Texture** att,
-                      AbstractGraphicsApi::Swapchain** sw, const uint32_t* imgId) override {}
+  void beginRendering(const AttachmentDesc* /*desc*/, size_t /*descSize*/,
+                      uint32_t /*w*/, uint32_t /*h*/,
+                      const TextureFormat* /*frm*/,
+                      AbstractGraphicsApi::Texture** /*att*/,
+                      AbstractGraphicsApi::Swapchain** /*sw*/, const uint32_t* /*imgId*/) override {}
   void endRendering() override {}
 
   void barrier(const AbstractGraphicsApi::BarrierDesc* desc, size_t cnt) override;
 
-  void generateMipmap(AbstractGraphicsApi::Texture& image, uint32_t texWidth, uint32_t texHeight, uint32_t mipLevels) override {}
-  void copy(AbstractGraphicsApi::Buffer& dest, size_t offset, AbstractGraphicsApi::Texture& src, uint32_t width, uint32_t height, uint32_t mip) override {}
+  void generateMipmap(AbstractGraphicsApi::Texture& /*image*/, uint32_t /*texWidth*/, uint32_t /*texHeight*/, uint32_t /*mipLevels*/) override {}
+  void copy(AbstractGraphicsApi::Buffer& /*dest*/, size_t /*offset*/, AbstractGraphicsApi::Texture& /*src*/, uint32_t /*width*/, uint32_t /*height*/, uint32_t /*mip*/) override {}
 
   bool isRecording() const override { return true; }
   void begin() override {}
   void end() override {}
   void reset() override {}
 
-  void setPipeline(AbstractGraphicsApi::Pipeline& p) override {}
-  void setComputePipeline(AbstractGraphicsApi::CompPipeline& p) override {}
+  void setPipeline(AbstractGraphicsApi::Pipeline& /*p*/) override {}
+  void setComputePipeline(AbstractGraphicsApi::CompPipeline& /*p*/) override {}
 
-  void setBytes   (AbstractGraphicsApi::Pipeline &p, const void* data, size_t size) override {}
-  void setUniforms(AbstractGraphicsApi::Pipeline& p, AbstractGraphicsApi::Desc& u) override {}
+  void setBytes   (AbstractGraphicsApi::Pipeline &/*p*/, const void* /*data*/, size_t /*size*/) override {}
+  void setUniforms(AbstractGraphicsApi::Pipeline& /*p*/, AbstractGraphicsApi::Desc& /*u*/) override {}
 
-  void setBytes   (AbstractGraphicsApi::CompPipeline &p, const void* data, size_t size) override {}
-  void setUniforms(AbstractGraphicsApi::CompPipeline& p, AbstractGraphicsApi::Desc& u) override {}
+  void setBytes   (AbstractGraphicsApi::CompPipeline &/*p*/, const void* /*data*/, size_t /*size*/) override {}
+  void setUniforms(AbstractGraphicsApi::CompPipeline& /*p*/, AbstractGraphicsApi::Desc& /*u*/) override {}
 
-  void setViewport(const Rect& r) override {}
-  void setScissor (const Rect& r) override {}
-  void setDebugMarker(std::string_view tag) override {}
+  void setViewport(const Rect& /*r*/) override {}
+  void setScissor (const Rect& /*r*/) override {}
+  void setDebugMarker(std::string_view /*tag*/) override {}
 
-  void draw        (const AbstractGraphicsApi::Buffer* vbo, size_t stride, size_t offset, size_t vertexCount,
-            size_t firstInstance, size_t instanceCount) override {}
-  void drawIndexed (const AbstractGraphicsApi::Buffer* vbo, size_t stride, size_t voffset,
-                    const AbstractGraphicsApi::Buffer& ibo, Detail::IndexClass cls, size_t ioffset, size_t isize,
-                   size_t firstInstance, size_t instanceCount) override {}
-  void drawIndirect(const AbstractGraphicsApi::Buffer& indirect, size_t offset) override {}
+  void draw        (const AbstractGraphicsApi::Buffer* /*vbo*/, size_t /*stride*/, size_t /*offset*/, size_t /*vertexCount*/,
+            size_t /*firstInstance*/, size_t /*instanceCount*/) override {}
+  void drawIndexed (const AbstractGraphicsApi::Buffer* /*vbo*/, size_t /*stride*/, size_t /*voffset*/,
+                    const AbstractGraphicsApi::Buffer& /*ibo*/, Detail::IndexClass /*cls*/, size_t /*ioffset*/, size_t /*isize*/,
+                   size_t /*firstInstance*/, size_t /*instanceCount*/) override {}
+  void drawIndirect(const AbstractGraphicsApi::Buffer& /*indirect*/, size_t /*offset*/) override {}
 
-  void dispatch    (size_t x, size_t y, size_t z) override {}
-  void dispatchIndirect(const AbstractGraphicsApi::Buffer& indirect, size_t offset) override {}
+  void dispatch    (size_t /*x*/, size_t /*y*/, size_t /*z*/) override {}
+  void dispatchIndirect(const AbstractGraphicsApi::Buffer& /*indirect*/, size_t /*offset*/) override {}
   };
 
 void TestCommandBuffer::barrier(const AbstractGraphicsApi::BarrierDesc* desc, size_t cnt) {
@@ -207,3 +208,108 @@ TEST(main, ResourceStateIndirectAndUAVWithSubsequentWriteAccess) {
 
 
 
+
+TEST(main, ResourceStateSecondary) {
+  struct RecordingCommandBuffer : TestCommandBuffer {
+    void barrier(const AbstractGraphicsApi::BarrierDesc* desc, size_t cnt) override {
+      for(size_t i=0; i<cnt; ++i)
+        log.push_back(toString(desc[i].prev) + " -> " + toString(desc[i].next));
+      }
+    std::vector<std::string> log;
+    };
+
+  auto record = [](ResourceState& a, ResourceState& b) {
+    a.onUavUsage(NonUniqResId(0x1), NonUniqResId::I_None, PipelineStage::S_Graphics);
+    a.onUavUsage(NonUniqResId(0x1), NonUniqResId::I_None, PipelineStage::S_Graphics);
+    b.onUavUsage(NonUniqResId::I_None, NonUniqResId(0x2), PipelineStage::S_Graphics);
+    b.onUavUsage(NonUniqResId(0x2), NonUniqResId::I_None, PipelineStage::S_Indirect);
+    };
+
+  RecordingCommandBuffer inl, par;
+  {
+    ResourceState rs;
+    record(rs,rs);
+    rs.onUavUsage(NonUniqResId(0x2), NonUniqResId::I_None, PipelineStage::S_Compute);
+    rs.flush(inl);
+  }
+  {
+    ResourceState rs, a, b;
+    a.setDeferred(true);
+    b.setDeferred(true);
+    record(a,b);
+    rs.join(a);
+    rs.join(b);
+    rs.onUavUsage(NonUniqResId(0x2), NonUniqResId::I_None, PipelineStage::S_Compute);
+    rs.flush(par);
+  }
+  EXPECT_FALSE(inl.log.empty());
+  EXPECT_EQ(inl.log, par.log);
+  }
+
+TEST(main, ResourceStateQueueOwnership) {
+  struct TestBuffer : Tempest::AbstractGraphicsApi::Buffer {
+    void update(const void*, size_t, size_t) override {}
+    void read  (      void*, size_t, size_t) override {}
+    };
+  struct RecordingCommandBuffer : TestCommandBuffer {
+    void barrier(const AbstractGraphicsApi::BarrierDesc* desc, size_t cnt) override {
+      for(size_t i=0; i<cnt; ++i)
+        log.push_back(desc[i]);
+      }
+    std::vector<AbstractGraphicsApi::BarrierDesc> log;
+    };
+
+  TestBuffer             b;
+  TestTexture            t;
+  RecordingCommandBuffer cmd;
+
+  ResourceState rs;
+  rs.onQueueUsage(b);
+  rs.onQueueUsage(t, ResourceAccess::Sampler);
+  rs.onQueueUsage(b);
+  EXPECT_TRUE(rs.hasQueueUsage());
+
+  rs.queueOwnership(cmd, QueueOwnership::ToCompute);
+  ASSERT_EQ(cmd.log.size(), 2u);
+  for(auto& i:cmd.log) {
+    EXPECT_EQ(i.ownership, QueueOwnership::ToCompute);
+    EXPECT_EQ(i.prev, i.next);
+    }
+
+  rs.clearQueueUsage();
+  EXPECT_FALSE(rs.hasQueueUsage());
+  }
+
+TEST(main, ResourceStateScaling) {
+  struct TestBuffer : Tempest::AbstractGraphicsApi::Buffer {
+    void update(const void*, size_t, size_t) override {}
+    void read  (      void*, size_t, size_t) override {}
+    };
+  struct CountingCommandBuffer : TestCommandBuffer {
+    void barrier(const AbstractGraphicsApi::BarrierDesc*, size_t cnt) override { count += cnt; }
+    size_t count = 0;
+    };
+
+  // every draw touches all bound storage buffers, as ssboBarriers does
+  for(size_t n:{100, 1000, 10000}) {
+    std::vector<TestBuffer>  buf(n);
+    std::vector<TestTexture> tex(n);
+    CountingCommandBuffer    cmd;
+    ResourceState            rs;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int draw=0; draw<4; ++draw) {
+      const ResourceAccess lay = (draw%2==0 ? ResourceAccess::UavReadWriteGr : ResourceAccess::UavReadComp);
+      for(auto& b:buf)
+        rs.setLayout(b, lay);
+      for(auto& t:tex)
+        rs.setLayout(t, (draw%2==0 ? ResourceAccess::ColorAttach : ResourceAccess::Sampler), false);
+      rs.flush(cmd);
+      }
+    rs.finalize(cmd);
+    auto dt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start);
+
+    EXPECT_EQ(cmd.count, 4*2*n + n); // transitions per draw + return of buffers at finalize
+    Log::d("ResourceState: ", n, " buffers + ", n, " textures, 4 draws: ", uint64_t(dt.count()), "us");
+    }
+  }
@@ -0,0 +1,61 @@
+#include "../gapi/retirequeue.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+TEST(main, RetireQueueFrames) {
+  RetireQueue<int,int> q;
+  std::vector<int>     items, marks;
+  int                  complete = 0;
+
+  auto done = [&](int m){ return m<=complete; };
+  auto fn   = [&](int i){ items.push_back(i); };
+  auto free = [&](int m){ marks.push_back(m); };
+
+  EXPECT_TRUE(q.empty());
+  q.push(10);
+  q.push(11);
+  EXPECT_FALSE(q.empty());
+  q.seal(1);
+  EXPECT_TRUE(q.empty());
+  q.push(20);
+  q.seal(2);
+  // released after last seal: not covered by any fence yet
+  q.push(30);
+  EXPECT_EQ(q.inFlight(),2u);
+
+  // nothing complete: slots are still in use
+  q.recycle(done,fn,free);
+  EXPECT_TRUE(items.empty());
+
+  complete = 1;
+  q.recycle(done,fn,free);
+  EXPECT_EQ(items,std::vector<int>({10,11}));
+  EXPECT_EQ(marks,std::vector<int>({1}));
+  EXPECT_EQ(q.inFlight(),1u);
+
+  complete = 5;
+  q.recycle(done,fn,free);
+  EXPECT_EQ(items,std::vector<int>({10,11,20}));
+  EXPECT_EQ(marks,std::vector<int>({1,2}));
+  EXPECT_EQ(q.inFlight(),0u);
+  EXPECT_FALSE(q.empty());
+  }
+
+TEST(main, RetireQueueInOrder) {
+  RetireQueue<int,int> q;
+  std::vector<int>     items;
+
+  q.push(1);
+  q.seal(1);
+  q.push(2);
+  q.seal(2);
+
+  // frames are recycled in order of submission: later mark alone doesn't release anything
+  auto onlySecond = [](int m){ return m==2; };
+  q.recycle(onlySecond,[&](int i){ items.push_back(i); },[](int){});
+  EXPECT_TRUE(items.empty());
+  EXPECT_EQ(q.inFlight(),2u);
+  }
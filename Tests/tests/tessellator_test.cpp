@@ -0,0 +1,149 @@
+#include "../2d/tessellator.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+#include <cmath>
+
+using namespace testing;
+using namespace Tempest::Detail;
+
+using Vec = Tessellator::Vec;
+
+static float area(const std::vector<Vec>& trig) {
+  float s = 0;
+  for(size_t i=0; i+2<trig.size(); i+=3) {
+    auto& a = trig[i];
+    auto& b = trig[i+1];
+    auto& c = trig[i+2];
+    s += std::abs((b.x-a.x)*(c.y-a.y)-(c.x-a.x)*(b.y-a.y))*0.5f;
+    }
+  return s;
+  }
+
+static void rect(Tessellator& t, float x, float y, float w, float h, bool ccw=false) {
+  t.moveTo({x,y});
+  if(ccw) {
+    t.lineTo({x,  y+h});
+    t.lineTo({x+w,y+h});
+    t.lineTo({x+w,y  });
+    } else {
+    t.lineTo({x+w,y  });
+    t.lineTo({x+w,y+h});
+    t.lineTo({x,  y+h});
+    }
+  t.closePath();
+  }
+
+TEST(main, TessellatorFill) {
+  Tessellator      t;
+  std::vector<Vec> out;
+  rect(t,0,0,10,10);
+  t.fill(Tessellator::NonZero,out);
+  EXPECT_EQ(out.size()%3,0u);
+  EXPECT_NEAR(area(out),100.f,1e-3f);
+  }
+
+TEST(main, TessellatorFillRule) {
+  Tessellator      t;
+  std::vector<Vec> out;
+  rect(t,0,0,10,10);
+  rect(t,2,2,6,6);
+
+  // same orientation: hole only for even-odd
+  t.fill(Tessellator::EvenOdd,out);
+  EXPECT_NEAR(area(out),64.f,1e-3f);
+  out.clear();
+  t.fill(Tessellator::NonZero,out);
+  EXPECT_NEAR(area(out),100.f,1e-3f);
+
+  // opposite orientation: hole for both rules
+  t.clear();
+  out.clear();
+  rect(t,0,0,10,10);
+  rect(t,2,2,6,6,true);
+  t.fill(Tessellator::NonZero,out);
+  EXPECT_NEAR(area(out),64.f,1e-3f);
+  }
+
+TEST(main, TessellatorSelfIntersect) {
+  // bow-tie: two triangles of area 25 each
+  Tessellator      t;
+  std::vector<Vec> out;
+  t.moveTo({0,0});
+  t.lineTo({10,10});
+  t.lineTo({10,0});
+  t.lineTo({0,10});
+  t.closePath();
+  t.fill(Tessellator::NonZero,out);
+  EXPECT_NEAR(area(out),50.f,1e-2f);
+  }
+
+TEST(main, TessellatorLargeCoords) {
+  // crossing is closer to top of slab, than float precision at this y: split must not stall
+  const float      y = 1e8f;
+  Tessellator      t;
+  std::vector<Vec> out;
+  t.moveTo({0,     y   });
+  t.lineTo({100,   y+64});
+  t.lineTo({-100,  y+64});
+  t.lineTo({0.001f,y   });
+  t.closePath();
+  t.fill(Tessellator::NonZero,out);
+  EXPECT_FALSE(out.empty());
+  }
+
+TEST(main, TessellatorCubic) {
+  // circle of radius 50, out of 4 cubic arcs
+  const float k = 0.5522847f*50.f;
+  Tessellator t(0.1f);
+  t.moveTo ({50,0});
+  t.cubicTo({50,k},  {k,50},  {0,50});
+  t.cubicTo({-k,50}, {-50,k}, {-50,0});
+  t.cubicTo({-50,-k},{-k,-50},{0,-50});
+  t.cubicTo({k,-50}, {50,-k}, {50,0});
+  t.closePath();
+
+  std::vector<Vec> out;
+  t.fill(Tessellator::NonZero,out);
+  EXPECT_NEAR(area(out),3.14159265f*50.f*50.f,0.01f*3.14159265f*50.f*50.f);
+
+  // adaptive: coarser tolerance gives fewer points
+  Tessellator c(4.f);
+  c.moveTo ({50,0});
+  c.cubicTo({50,k},{k,50},{0,50});
+  EXPECT_LT(c.pointCount(),t.pointCount()/4);
+  EXPECT_GE(c.pointCount(),2u);
+  }
+
+TEST(main, TessellatorStroke) {
+  Tessellator      t(0.01f);
+  std::vector<Vec> out;
+  t.moveTo({0,0});
+  t.lineTo({10,0});
+
+  Tessellator::Stroke st;
+  st.width = 2;
+  t.stroke(st,out);
+  EXPECT_NEAR(area(out),20.f,1e-3f);
+
+  out.clear();
+  st.cap = Tessellator::SquareCap;
+  t.stroke(st,out);
+  EXPECT_NEAR(area(out),24.f,1e-3f);
+
+  out.clear();
+  st.cap = Tessellator::RoundCap;
+  t.stroke(st,out);
+  EXPECT_NEAR(area(out),20.f+3.14159265f,0.1f);
+
+  // closed square outline: miter joins fill corners exactly
+  t.clear();
+  out.clear();
+  rect(t,0,0,10,10);
+  st.cap  = Tessellator::ButtCap;
+  st.join = Tessellator::MiterJoin;
+  t.stroke(st,out);
+  // segments overlap on the inner side; miter and bevel add corners on the outer side
+  EXPECT_NEAR(area(out),4*20.f+4*1.f,1e-3f);
+  }
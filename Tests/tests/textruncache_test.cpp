@@ -0,0 +1,61 @@
+#include "../formats/textruncache.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock-matchers.h>
+
+using namespace testing;
+using namespace Tempest;
+using namespace Tempest::Detail;
+
+static TextRunCache::Key mkKey(const char* txt, float size, int w = 0) {
+  TextRunCache::Key k;
+  k.kind = TextRunCache::WrapExtent;
+  k.text = txt;
+  k.size = size;
+  k.w    = w;
+  return k;
+  }
+
+static TextRun mkRun(int w, int h) {
+  TextRun r;
+  r.size = Size(w,h);
+  return r;
+  }
+
+TEST(main, TextRunCacheFind) {
+  TextRunCache cache;
+
+  EXPECT_EQ(cache.find(mkKey("Hello",18.f)),nullptr);
+  cache.insert(mkKey("Hello",18.f),mkRun(40,18));
+
+  auto run = cache.find(mkKey("Hello",18.f));
+  ASSERT_NE(run,nullptr);
+  EXPECT_EQ(run->size,Size(40,18));
+
+  EXPECT_EQ(cache.find(mkKey("Hello",24.f)),   nullptr);
+  EXPECT_EQ(cache.find(mkKey("Hello",18.f,64)),nullptr);
+  EXPECT_EQ(cache.find(mkKey("Hell", 18.f)),   nullptr);
+
+  auto st = cache.stats();
+  EXPECT_EQ(st.hits,  1u);
+  EXPECT_EQ(st.misses,4u);
+  EXPECT_EQ(st.size,  1u);
+  }
+
+TEST(main, TextRunCacheLru) {
+  TextRunCache cache;
+  cache.setCapacity(2);
+
+  cache.insert(mkKey("a",18.f),mkRun(1,1));
+  cache.insert(mkKey("b",18.f),mkRun(2,1));
+  ASSERT_NE(cache.find(mkKey("a",18.f)),nullptr);
+  cache.insert(mkKey("c",18.f),mkRun(3,1));
+
+  EXPECT_NE(cache.find(mkKey("a",18.f)),nullptr);
+  EXPECT_EQ(cache.find(mkKey("b",18.f)),nullptr);
+  EXPECT_NE(cache.find(mkKey("c",18.f)),nullptr);
+  EXPECT_EQ(cache.stats().size,2u);
+
+  cache.setCapacity(0);
+  EXPECT_EQ(cache.stats().size,0u);
+  }